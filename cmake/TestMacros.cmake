@@ -4,3 +4,7 @@ macro(setup_test TARGET TEST_SOURCES)
     target_link_libraries(${TARGET} PRIVATE cmocka-static)
     add_test(NAME ${TARGET} COMMAND ${TARGET})
 endmacro()
+
+macro(setup_bench TARGET BENCH_SOURCES)
+    add_executable(${TARGET} ${ARGN} bench/${TARGET}.c)
+endmacro()
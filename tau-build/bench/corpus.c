@@ -0,0 +1,218 @@
+//
+// Created on 10/17/26.
+//
+
+#include "corpus.h"
+
+#include <assert.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CORPUS_MIN_CAPACITY 4096
+#define CORPUS_EXPR_DEPTH 48
+#define CORPUS_BLOCK_DEPTH 12
+#define CORPUS_STRING_MIN 64
+#define CORPUS_STRING_SPREAD 448
+
+struct corpus_gen {
+  char *buf;
+  size_t len;
+  size_t capacity;
+  uint32_t seed;
+  uint32_t counter;
+};
+
+typedef void (*corpus_decl_func_t)(struct corpus_gen *gen);
+
+const char *corpus_shape_name_table[] = {
+    [CORPUS_SHAPE_DEEP_EXPRS] = "deep_exprs",       [CORPUS_SHAPE_WIDE_DECLS] = "wide_decls",
+    [CORPUS_SHAPE_STRING_TABLES] = "string_tables", [CORPUS_SHAPE_NESTED_BLOCKS] = "nested_blocks",
+    [CORPUS_SHAPE_MIXED] = "mixed",
+};
+
+const char *corpus_get_shape_name(enum corpus_shape shape) {
+  if (shape < CORPUS_SHAPE_COUNT) {
+    return corpus_shape_name_table[shape];
+  }
+
+  return "(invalid)";
+}
+
+enum corpus_shape corpus_find_shape(const char *name) {
+  for (int shape = 0; shape < CORPUS_SHAPE_COUNT; shape++) {
+    if (strcmp(corpus_shape_name_table[shape], name) == 0) {
+      return shape;
+    }
+  }
+
+  return CORPUS_SHAPE_COUNT;
+}
+
+static uint32_t next_random(struct corpus_gen *gen) {
+  gen->seed = gen->seed * 1664525u + 1013904223u;
+  return gen->seed >> 8;
+}
+
+__attribute__((format(printf, 2, 3))) static void emit(struct corpus_gen *gen, const char *fmt, ...) {
+  va_list args;
+  va_start(args, fmt);
+  int len = vsnprintf(gen->buf + gen->len, gen->capacity - gen->len, fmt, args);
+  va_end(args);
+  assert(len >= 0 && "emit: invalid format");
+
+  if (gen->len + (size_t)len + 1 > gen->capacity) {
+    while (gen->len + (size_t)len + 1 > gen->capacity) {
+      gen->capacity *= 2;
+    }
+
+    gen->buf = realloc(gen->buf, gen->capacity);
+    assert(gen->buf != NULL && "emit: out of memory");
+    va_start(args, fmt);
+    vsnprintf(gen->buf + gen->len, gen->capacity - gen->len, fmt, args);
+    va_end(args);
+  }
+
+  gen->len += (size_t)len;
+}
+
+static void emit_atom(struct corpus_gen *gen) {
+  uint32_t r = next_random(gen);
+  switch (r % 6) {
+    case 0:
+      emit(gen, "%u", r % 1000);
+      break;
+    case 1:
+      emit(gen, "value_%u", r % 97);
+      break;
+    case 2:
+      emit(gen, "f%u(a, b + %u)", r % 13, r % 7);
+      break;
+    case 3:
+      emit(gen, "table[i + %u]", r % 5);
+      break;
+    case 4:
+      emit(gen, "pkg::item_%u.field", r % 31);
+      break;
+    default:
+      emit(gen, "-x%u", r % 11);
+      break;
+  }
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static void emit_expr(struct corpus_gen *gen, int depth) {
+  static const char *ops[] = {"+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^", "==", "<", ">=", "&&", "||"};
+  if (depth == 0) {
+    emit_atom(gen);
+    return;
+  }
+
+  emit(gen, "(");
+  emit_expr(gen, depth - 1);
+  emit(gen, " %s ", ops[next_random(gen) % (sizeof(ops) / sizeof(ops[0]))]);
+  emit_atom(gen);
+  emit(gen, ")");
+}
+
+static void emit_deep_expr(struct corpus_gen *gen) {
+  emit(gen, "let deep_%u: U64 = ", gen->counter++);
+  emit_expr(gen, CORPUS_EXPR_DEPTH / 2 + (int)(next_random(gen) % (CORPUS_EXPR_DEPTH / 2)));
+  emit(gen, "\n");
+}
+
+static void emit_wide_decl(struct corpus_gen *gen) {
+  uint32_t id = gen->counter++;
+  uint32_t r = next_random(gen);
+  switch (r % 4) {
+    case 0:
+      emit(gen, "let v%u: U32 = %u\n", id, r % 4096);
+      break;
+    case 1:
+      emit(gen, "type T%u prototype\n", id);
+      break;
+    case 2:
+      emit(gen, "proc p%u(a: U32, b: T%u): U32 = a * %u + b\n", id, r % 64, r % 9);
+      break;
+    default:
+      emit(gen, "let c%u: Bool = true\n", id);
+      break;
+  }
+}
+
+static void emit_string_table(struct corpus_gen *gen) {
+  static const char *escapes[] = {"\\n", "\\t", "\\\"", "\\\\", "\\x41", "\\u00e9"};
+  emit(gen, "let message_%u: Str = \"", gen->counter++);
+  size_t body = CORPUS_STRING_MIN + next_random(gen) % CORPUS_STRING_SPREAD;
+  for (size_t i = 0; i < body; i++) {
+    uint32_t r = next_random(gen);
+    if (r % 32 == 0) {
+      emit(gen, "%s", escapes[(r >> 5) % (sizeof(escapes) / sizeof(escapes[0]))]);
+    } else {
+      emit(gen, "%c", r % 8 == 0 ? ' ' : 'a' + (char)(r % 26));
+    }
+  }
+
+  emit(gen, "\"\n");
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static void emit_block_stmt(struct corpus_gen *gen, int depth, int indent) {
+  if (depth == 0) {
+    emit(gen, "acc += %u", next_random(gen) % 100);
+    return;
+  }
+
+  uint32_t r = next_random(gen);
+  switch (r % 3) {
+    case 0:
+      emit(gen, "if acc > %u { ", r % 1000);
+      break;
+    case 1:
+      emit(gen, "while acc < %u { ", r % 1000);
+      break;
+    default:
+      emit(gen, "if acc == %u { acc -= 1\n%*s} elif acc != 0 { ", r % 1000, indent, "");
+      break;
+  }
+
+  emit_block_stmt(gen, depth - 1, indent + 2);
+  emit(gen, "\n%*sacc = acc * 2\n%*s}", indent + 2, "", indent, "");
+}
+
+static void emit_nested_blocks(struct corpus_gen *gen) {
+  emit(gen, "proc nested_%u(acc: U32): U32 { ", gen->counter++);
+  emit_block_stmt(gen, CORPUS_BLOCK_DEPTH / 2 + (int)(next_random(gen) % (CORPUS_BLOCK_DEPTH / 2)), 2);
+  emit(gen, "\n  return acc\n}\n");
+}
+
+static void emit_mixed(struct corpus_gen *gen) {
+  static const corpus_decl_func_t funcs[] = {emit_deep_expr, emit_wide_decl, emit_wide_decl, emit_wide_decl,
+                                             emit_string_table, emit_nested_blocks};
+  funcs[next_random(gen) % (sizeof(funcs) / sizeof(funcs[0]))](gen);
+}
+
+static const corpus_decl_func_t corpus_decl_func_table[] = {
+    [CORPUS_SHAPE_DEEP_EXPRS] = emit_deep_expr,         [CORPUS_SHAPE_WIDE_DECLS] = emit_wide_decl,
+    [CORPUS_SHAPE_STRING_TABLES] = emit_string_table,   [CORPUS_SHAPE_NESTED_BLOCKS] = emit_nested_blocks,
+    [CORPUS_SHAPE_MIXED] = emit_mixed,
+};
+
+char *corpus_generate(enum corpus_shape shape, uint32_t seed, size_t target_size, size_t *size) {
+  assert(shape < CORPUS_SHAPE_COUNT && "corpus_generate: invalid shape");
+  assert(size != NULL && "corpus_generate: size cannot be NULL");
+
+  struct corpus_gen gen = {.capacity = CORPUS_MIN_CAPACITY, .seed = seed};
+  gen.buf = malloc(gen.capacity);
+  assert(gen.buf != NULL && "corpus_generate: out of memory");
+  gen.buf[0] = '\0';
+
+  emit(&gen, "module bench::%s\n", corpus_get_shape_name(shape));
+  while (gen.len < target_size) {
+    corpus_decl_func_table[shape](&gen);
+  }
+
+  *size = gen.len;
+  return gen.buf;
+}
@@ -0,0 +1,29 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_CORPUS_H
+#define TAU_CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Shapes of synthetic Tau programs, each one stressing a different part of the lexer and parser
+enum corpus_shape {
+  CORPUS_SHAPE_DEEP_EXPRS,     // long chains of nested, parenthesized expressions
+  CORPUS_SHAPE_WIDE_DECLS,     // thousands of short top level declarations
+  CORPUS_SHAPE_STRING_TABLES,  // long string literals with escapes
+  CORPUS_SHAPE_NESTED_BLOCKS,  // procedures made of deeply nested if/while blocks
+  CORPUS_SHAPE_MIXED,          // all of the above interleaved
+  CORPUS_SHAPE_COUNT,
+};
+
+const char *corpus_get_shape_name(enum corpus_shape shape);
+// CORPUS_SHAPE_COUNT when name is not a known shape
+enum corpus_shape corpus_find_shape(const char *name);
+
+// Generates a valid compilation unit of about target_size bytes. The output only depends on shape, seed and
+// target_size. The returned buffer is NUL terminated and owned by the caller.
+char *corpus_generate(enum corpus_shape shape, uint32_t seed, size_t target_size, size_t *size);
+
+#endif  // TAU_CORPUS_H
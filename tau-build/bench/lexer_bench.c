@@ -0,0 +1,148 @@
+//
+// Created on 10/17/26.
+//
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../src/lexer.h"
+#include "../src/scan.h"
+
+#define BENCH_TARGET_SIZE ((size_t)8 * 1024 * 1024)
+#define BENCH_ROUNDS 5
+
+typedef size_t (*bench_gen_func_t)(char *buf, size_t buf_size);
+
+struct bench_case {
+  const char *name;
+  bench_gen_func_t gen;
+  enum tau_token_type counted_type;
+};
+
+// Identifiers mixed with keywords and words that share a prefix with them, so the keyword classifier sees every
+// kind of miss and hit.
+static size_t gen_identifiers(char *buf, size_t buf_size) {
+  const char *words[] = {
+      "let",   "letter", "a",      "value", "proc",      "procedure", "if",   "iffy", "type",
+      "types", "x1",     "return", "ret",   "continue_", "module",    "else", "elsa", "while",
+      "w",     "as",     "nil",    "nils",  "counter",   "extern",    "i",    "j_$2", "prototype",
+  };
+  size_t words_count = sizeof(words) / sizeof(words[0]);
+
+  size_t len = 0;
+  uint32_t seed = 0x9E3779B9u;
+  while (len + 32 < buf_size) {
+    seed = seed * 1664525u + 1013904223u;
+    const char *word = words[(seed >> 16) % words_count];
+    size_t word_len = strlen(word);
+    memcpy(buf + len, word, word_len);
+    len += word_len;
+    buf[len++] = (seed >> 8) % 16 == 0 ? '\n' : ' ';
+  }
+
+  buf[len] = '\0';
+  return len;
+}
+
+// Arithmetic and bitwise expressions with every operator shape, as emitted by our code generators.
+static size_t gen_operators(char *buf, size_t buf_size) {
+  const char *ops[] = {
+      "+", "-", "*", "/", "%", "<<", ">>", "&", "|", "^", "==", "!=", "<", "<=", ">", ">=", "&&", "||",
+  };
+  const char *assigns[] = {
+      "=", ":=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=", ">>=",
+  };
+  size_t ops_count = sizeof(ops) / sizeof(ops[0]);
+  size_t assigns_count = sizeof(assigns) / sizeof(assigns[0]);
+
+  size_t len = 0;
+  uint32_t seed = 0x85EBCA6Bu;
+  while (len + 128 < buf_size) {
+    seed = seed * 1664525u + 1013904223u;
+    len += (size_t)sprintf(buf + len, "v%u %s (a%u", seed % 64, assigns[(seed >> 8) % assigns_count], seed % 7);
+    for (int term = 0; term < 6; term++) {
+      seed = seed * 1664525u + 1013904223u;
+      len += (size_t)sprintf(buf + len, "%s%u", ops[(seed >> 8) % ops_count], (seed >> 20) % 100);
+    }
+
+    len += (size_t)sprintf(buf + len, ")*~b[i]\n");
+  }
+
+  buf[len] = '\0';
+  return len;
+}
+
+// Deeply indented string tables, the shape of our generated message and lookup tables.
+static size_t gen_strings(char *buf, size_t buf_size) {
+  size_t len = 0;
+  uint32_t seed = 0xC2B2AE35u;
+  while (len + 256 < buf_size) {
+    seed = seed * 1664525u + 1013904223u;
+    size_t indent = 8 + (seed >> 24) % 32;
+    memset(buf + len, ' ', indent);
+    len += indent;
+    len += (size_t)sprintf(buf + len, "entry_%u := \"", seed % 1000);
+    size_t body = 40 + (seed >> 12) % 120;
+    for (size_t i = 0; i < body; i++) {
+      buf[len++] = (char)('a' + (i * 7 + seed) % 26);
+    }
+
+    len += (size_t)sprintf(buf + len, "%s\"\n", (seed >> 4) % 8 == 0 ? "\\n" : "");
+  }
+
+  buf[len] = '\0';
+  return len;
+}
+
+static double now_seconds(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void run_case(const struct bench_case *bench) {
+  char *buf = malloc(BENCH_TARGET_SIZE + 1);
+  size_t buf_size = bench->gen(buf, BENCH_TARGET_SIZE);
+
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+
+  double best = 0;
+  for (int round = 0; round < BENCH_ROUNDS; round++) {
+    double start = now_seconds();
+    tau_token_table_lex(&table, NULL, bench->name, buf, buf_size);
+    double elapsed = now_seconds() - start;
+    if (round == 0 || elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  size_t counted = 0;
+  for (uint32_t i = 0; i < table.count; i++) {
+    counted += table.types[i] == bench->counted_type ? 1 : 0;
+  }
+
+  printf("%-12s %8.2f MB/s %10.2f M tokens/s %10.2f M %s/s\n", bench->name, (double)buf_size / best / 1e6,
+         (double)table.count / best / 1e6, (double)counted / best / 1e6, tau_token_get_name(bench->counted_type));
+
+  tau_token_table_free(&table);
+  free(buf);
+}
+
+int main() {
+  printf("scanners: %s\n", tau_scan_get_isa_name(tau_scan_selected()));
+  const struct bench_case cases[] = {
+      {.name = "identifiers", .gen = gen_identifiers, .counted_type = TAU_TOKEN_TYPE_IDENTIFIER},
+      {.name = "operators", .gen = gen_operators, .counted_type = TAU_TOKEN_TYPE_PUNCT},
+      {.name = "strings", .gen = gen_strings, .counted_type = TAU_TOKEN_TYPE_STR_LIT},
+  };
+
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+    run_case(&cases[i]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+//
+// Created on 10/17/26.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <tau/parser.h>
+#include <time.h>
+
+#include "../src/lexer.h"
+#include "../src/scan.h"
+#include "corpus.h"
+
+#define BENCH_DEFAULT_SIZE ((size_t)4 * 1024 * 1024)
+#define BENCH_DEFAULT_ROUNDS 5
+#define BENCH_SEED 0x7A0u
+
+struct bench_options {
+  size_t size;
+  int rounds;
+  bool json;
+  enum corpus_shape only;  // CORPUS_SHAPE_COUNT runs every shape
+};
+
+struct bench_result {
+  enum corpus_shape shape;
+  size_t bytes;
+  size_t tokens;
+  size_t nodes;
+  size_t errors;
+  double lex_seconds;    // best round
+  double parse_seconds;  // best round, parsing only (the token table is already built)
+};
+
+static double now_seconds(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// kilobytes on linux
+static long peak_rss_kb(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+static struct bench_result run_shape(enum corpus_shape shape, const struct bench_options *options) {
+  struct bench_result result = {.shape = shape};
+  char *buf = corpus_generate(shape, BENCH_SEED + shape, options->size, &result.bytes);
+
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  for (int round = 0; round < options->rounds; round++) {
+    double start = now_seconds();
+    tau_token_table_lex(&table, NULL, corpus_get_shape_name(shape), buf, result.bytes);
+    double elapsed = now_seconds() - start;
+    if (round == 0 || elapsed < result.lex_seconds) {
+      result.lex_seconds = elapsed;
+    }
+  }
+
+  result.tokens = table.count;
+  tau_token_table_free(&table);
+
+  for (int round = 0; round < options->rounds; round++) {
+    struct tau_parse_result *parse = tau_parse_buffer(corpus_get_shape_name(shape), buf, result.bytes, NULL);
+    struct tau_parse_stats stats = tau_parse_result_stats(parse);
+    double elapsed = (double)stats.parse_ns / 1e9;
+    if (round == 0 || elapsed < result.parse_seconds) {
+      result.parse_seconds = elapsed;
+    }
+
+    result.nodes = stats.node_count;
+    result.errors = tau_parse_result_ok(parse) ? 0 : tau_parse_result_diagnostic_count(parse);
+    tau_parse_result_free(parse);
+  }
+
+  free(buf);
+  return result;
+}
+
+static double per_second(double count, double seconds) { return seconds > 0 ? count / seconds : 0.0; }
+
+static void print_text(const struct bench_result *results, size_t count, long rss_kb) {
+  printf("scanners: %s\n", tau_scan_get_isa_name(tau_scan_selected()));
+  printf("%-14s %10s %12s %14s %12s %14s %8s\n", "shape", "MB", "lex MB/s", "lex Mtok/s", "parse MB/s",
+         "parse Mnode/s", "errors");
+  for (size_t i = 0; i < count; i++) {
+    const struct bench_result *r = &results[i];
+    printf("%-14s %10.2f %12.2f %14.2f %12.2f %14.2f %8zu\n", corpus_get_shape_name(r->shape), (double)r->bytes / 1e6,
+           per_second((double)r->bytes, r->lex_seconds) / 1e6, per_second((double)r->tokens, r->lex_seconds) / 1e6,
+           per_second((double)r->bytes, r->parse_seconds) / 1e6, per_second((double)r->nodes, r->parse_seconds) / 1e6,
+           r->errors);
+  }
+
+  printf("peak rss: %ld KB\n", rss_kb);
+}
+
+// One JSON document per run, keys kept stable so runs of different commits can be diffed
+static void print_json(const struct bench_result *results, size_t count, long rss_kb,
+                       const struct bench_options *options) {
+  printf("{\n  \"scanners\": \"%s\",\n  \"target_size\": %zu,\n  \"rounds\": %d,\n  \"cases\": [\n",
+         tau_scan_get_isa_name(tau_scan_selected()), options->size, options->rounds);
+  for (size_t i = 0; i < count; i++) {
+    const struct bench_result *r = &results[i];
+    printf("    {\"shape\": \"%s\", \"bytes\": %zu, \"tokens\": %zu, \"nodes\": %zu, \"errors\": %zu, "
+           "\"lex_mb_per_s\": %.3f, \"lex_tokens_per_s\": %.0f, "
+           "\"parse_mb_per_s\": %.3f, \"parse_nodes_per_s\": %.0f}%s\n",
+           corpus_get_shape_name(r->shape), r->bytes, r->tokens, r->nodes, r->errors,
+           per_second((double)r->bytes, r->lex_seconds) / 1e6, per_second((double)r->tokens, r->lex_seconds),
+           per_second((double)r->bytes, r->parse_seconds) / 1e6, per_second((double)r->nodes, r->parse_seconds),
+           i + 1 < count ? "," : "");
+  }
+
+  printf("  ],\n  \"peak_rss_kb\": %ld\n}\n", rss_kb);
+}
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [--size MB] [--rounds N] [--shape NAME] [--json]\n", argv0);
+  fprintf(stderr, "  shapes:");
+  for (int shape = 0; shape < CORPUS_SHAPE_COUNT; shape++) {
+    fprintf(stderr, " %s", corpus_get_shape_name(shape));
+  }
+
+  fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv) {
+  struct bench_options options = {
+      .size = BENCH_DEFAULT_SIZE,
+      .rounds = BENCH_DEFAULT_ROUNDS,
+      .json = false,
+      .only = CORPUS_SHAPE_COUNT,
+  };
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+      options.size = (size_t)(strtod(argv[++i], NULL) * 1024 * 1024);
+    } else if (strcmp(argv[i], "--rounds") == 0 && i + 1 < argc) {
+      options.rounds = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--shape") == 0 && i + 1 < argc) {
+      options.only = corpus_find_shape(argv[++i]);
+      if (options.only == CORPUS_SHAPE_COUNT) {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (strcmp(argv[i], "--json") == 0) {
+      options.json = true;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (options.rounds < 1) {
+    options.rounds = 1;
+  }
+
+  struct bench_result results[CORPUS_SHAPE_COUNT];
+  size_t count = 0;
+  size_t errors = 0;
+  for (int shape = 0; shape < CORPUS_SHAPE_COUNT; shape++) {
+    if (options.only == CORPUS_SHAPE_COUNT || options.only == (enum corpus_shape)shape) {
+      results[count] = run_shape(shape, &options);
+      errors += results[count].errors;
+      count++;
+    }
+  }
+
+  long rss_kb = peak_rss_kb();
+  if (options.json) {
+    print_json(results, count, rss_kb, &options);
+  } else {
+    print_text(results, count, rss_kb);
+  }
+
+  // the generator must only produce valid programs, otherwise the numbers are meaningless
+  return errors == 0 ? 0 : 1;
+}
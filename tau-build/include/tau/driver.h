@@ -0,0 +1,61 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_DRIVER_H
+#define TAU_DRIVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tau/parser.h>
+
+struct tau_driver_result;
+
+struct tau_driver_options {
+  size_t thread_count;            // 0 means one thread per online core
+  struct tau_interner *interner;  // shared by every module, NULL to have the result own one
+  size_t diagnostic_limit;        // diagnostics kept per module, 0 keeps every one
+  bool fold_diagnostics;          // see tau_parse_options
+  const char *cache_dir;          // see tau_parse_options
+};
+
+struct tau_driver_diagnostic {
+  const char *path;
+  struct tau_parse_diagnostic diagnostic;
+};
+
+struct tau_driver_stats {
+  uint64_t wall_ns;
+  size_t thread_count;
+  size_t steal_count;  // files a worker took from another worker's queue
+  size_t byte_count;
+  size_t token_count;
+  size_t node_count;
+  size_t error_count;
+  size_t cache_hit_count;  // modules loaded from the parse cache instead of being parsed
+};
+
+// Reads and parses every file on a work-stealing thread pool, largest files first. Modules keep the order of paths;
+// a file that cannot be read has no parse result and reports a single error diagnostic instead. options may be NULL.
+struct tau_driver_result *tau_driver_parse_files(const char *const *paths, size_t path_count,
+                                                 const struct tau_driver_options *options);
+void tau_driver_result_free(struct tau_driver_result *result);
+
+// True when every file was read and parsed without errors
+bool tau_driver_result_ok(const struct tau_driver_result *result);
+size_t tau_driver_result_module_count(const struct tau_driver_result *result);
+const char *tau_driver_result_module_path(const struct tau_driver_result *result, size_t index);
+// NULL when the file could not be read
+const struct tau_parse_result *tau_driver_result_module(const struct tau_driver_result *result, size_t index);
+// Symbols of every module come from this single interner, so equal names are equal symbols across files
+struct tau_interner *tau_driver_result_interner(const struct tau_driver_result *result);
+// Diagnostics of every module, grouped by module in the order of paths
+size_t tau_driver_result_diagnostic_count(const struct tau_driver_result *result);
+struct tau_driver_diagnostic tau_driver_result_diagnostic(const struct tau_driver_result *result, size_t index);
+// Renders the diagnostics of every module in memory and writes them to out at once
+void tau_driver_result_write_diagnostics(const struct tau_driver_result *result, enum tau_parse_format format,
+                                         FILE *out);
+struct tau_driver_stats tau_driver_result_stats(const struct tau_driver_result *result);
+
+#endif  // TAU_DRIVER_H
@@ -0,0 +1,28 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_INTERNER_H
+#define TAU_INTERNER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint32_t tau_symbol_t;
+
+#define TAU_SYMBOL_NONE ((tau_symbol_t)0)
+
+struct tau_interner;
+
+// Maps strings to 32-bit symbols, equal strings always getting the same symbol, so names can be compared as integers.
+// One interner can be shared by every file of a build: interning may happen from many threads at once and symbols
+// are resolved back to their text without locking.
+struct tau_interner *tau_interner_new(void);
+void tau_interner_free(struct tau_interner *interner);
+
+tau_symbol_t tau_interner_intern(struct tau_interner *interner, const char *text, size_t len);
+// NUL terminated copy of the interned text, valid until the interner is freed
+const char *tau_interner_text(const struct tau_interner *interner, tau_symbol_t symbol, size_t *len);
+size_t tau_interner_count(const struct tau_interner *interner);
+
+#endif  // TAU_INTERNER_H
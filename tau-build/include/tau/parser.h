@@ -5,11 +5,128 @@
 #ifndef TAU_PARSER_H
 #define TAU_PARSER_H
 
+#include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <tau/interner.h>
 
-struct tau_node;
+struct tau_ast;
+struct tau_parse_result;
 
-void tau_node_free(struct tau_node *node);
-struct tau_node *tau_parse_buffer(const char *buf_name, const char *buf_data, size_t buf_len);
+enum tau_parse_severity {
+  TAU_PARSE_SEVERITY_NOTE,
+  TAU_PARSE_SEVERITY_WARNING,
+  TAU_PARSE_SEVERITY_ERROR,
+};
+
+enum tau_parse_format {
+  TAU_PARSE_FORMAT_TEXT,  // one `file:row:col severity[code]: message` line per diagnostic
+  TAU_PARSE_FORMAT_JSON,  // a single {"diagnostics": [...], "dropped": n} document
+};
+
+struct tau_parse_diagnostic {
+  enum tau_parse_severity severity;
+  size_t row;
+  size_t col;
+  const char *message;
+  const char *code;     // stable name tools can match on, such as E0003
+  size_t len;           // bytes of source covered from row and col
+  size_t repeat_count;  // identical diagnostics folded into this one
+};
+
+struct tau_parse_options {
+  struct tau_interner *interner;  // as for tau_parse_buffer
+  size_t diagnostic_limit;        // diagnostics kept at most, 0 keeps every one
+  bool fold_diagnostics;          // diagnostics with the code and arguments of a kept one only bump its repeat_count
+  const char *cache_dir;          // existing directory holding the parse cache, NULL to always parse
+  bool keep_doc_comments;         // keeps `///` and `/** */` comments for tau_parse_result_node_doc
+};
+
+// A single text replacement: the old_len bytes at offset in the previous buffer became the new_len bytes at offset
+struct tau_parse_edit {
+  size_t offset;
+  size_t old_len;
+  size_t new_len;
+};
+
+struct tau_parse_stats {
+  uint64_t lex_ns;
+  uint64_t parse_ns;
+  size_t buf_size;
+  size_t token_count;
+  size_t node_count;
+  size_t token_bytes;     // memory held by the token table
+  size_t arena_reserved;  // memory held by the ast arena
+  size_t arena_peak;      // bytes handed out by the ast arena
+  bool cached;            // the ast was loaded from the parse cache, nothing was lexed or parsed
+};
+
+// Parses a whole buffer into a compilation unit. The result owns everything it points to (ast, diagnostics messages)
+// but not the buffer, which must outlive it. Identifiers and string literals are interned into interner, which may be
+// shared by many parses, or into a private interner owned by the result when it is NULL. Results share no other
+// state, so buffers can be parsed from many threads at once.
+struct tau_parse_result *tau_parse_buffer(const char *buf_name, const char *buf_data, size_t buf_len,
+                                          struct tau_interner *interner);
+// Same as tau_parse_buffer, but maps the file read-only and lexes it in place instead of copying it. The mapping lives
+// as long as the result. Returns NULL and sets errno when the file cannot be opened.
+struct tau_parse_result *tau_parse_file(const char *path, struct tau_interner *interner);
+// Same as tau_parse_buffer and tau_parse_file, with limits on the diagnostics kept so that a generated file repeating
+// one mistake cannot pile up millions of them. options may be NULL.
+//
+// With a cache_dir, the tree of a buffer that parsed without any diagnostic is stored there keyed by a hash of its
+// bytes, and a buffer with the same bytes later gets its tree loaded from there instead of being lexed and parsed. A
+// loaded tree is the one a parse would build, but the result has no tokens, so its first reparse is a full parse.
+// Failing to write the cache only costs the next run a parse.
+struct tau_parse_result *tau_parse_buffer_with_options(const char *buf_name, const char *buf_data, size_t buf_len,
+                                                       const struct tau_parse_options *options);
+struct tau_parse_result *tau_parse_file_with_options(const char *path, const struct tau_parse_options *options);
+void tau_parse_result_free(struct tau_parse_result *result);
+// Brings result up to date with buf_data, the previous buffer with edit applied, which from now on must outlive the
+// result instead. Only the top level declarations around the edit are lexed and parsed again, errors and diagnostics
+// included; the others keep their nodes, whose offsets count from the start of their declaration, so the ones after
+// the edit only have that start moved. The tree and the diagnostics are the ones tau_parse_buffer would produce for
+// buf_data, up to node ids. Falls back to a full parse, and returns false, when the edit touches the module header,
+// when no declaration before it starts a line outside of brackets and after one without errors, when diagnostics are
+// limited or folded and either text has some, or when the memory reparses added since the last full parse (replaced
+// nodes, values of the literals they parsed and their strings) grew past both a megabyte and the memory that parse
+// took.
+bool tau_parse_result_reparse(struct tau_parse_result *result, const char *buf_data, size_t buf_len,
+                              struct tau_parse_edit edit);
+
+// True when a compilation unit was built and no error was reported
+bool tau_parse_result_ok(const struct tau_parse_result *result);
+const struct tau_ast *tau_parse_result_ast(const struct tau_parse_result *result);
+uint32_t tau_parse_result_root(const struct tau_parse_result *result);
+// tau_hash64 of the buffer the result was built from, computed on first use unless the parse cache already did
+uint64_t tau_parse_result_content_hash(struct tau_parse_result *result);
+// Merkle hash of a node and everything under it: node types, token kinds and token text, but not positions. List
+// members such as declarations or statements don't cover the members after them, so a procedure keeps its hash
+// across edits anywhere else in the file. Hashes of the whole tree are computed on first use, after parsing or a
+// reparse, and are zero for nodes no longer in the tree.
+uint64_t tau_parse_result_node_hash(struct tau_parse_result *result, uint32_t id);
+// Doc comments on the lines right before the first token of a node, markers included, or NULL when there are none.
+// Only kept when parsing with keep_doc_comments, which skips the parse cache and makes every reparse a full one.
+const char *tau_parse_result_node_doc(const struct tau_parse_result *result, uint32_t id, size_t *len);
+// Value of an integer or float literal node, false for any other node and for nodes no longer in the tree. Out of range
+// integers are UINT64_MAX and out of range floats infinity, both also reported as diagnostics.
+bool tau_parse_result_node_int(const struct tau_parse_result *result, uint32_t id, uint64_t *value);
+bool tau_parse_result_node_float(const struct tau_parse_result *result, uint32_t id, double *value);
+// Text of a string literal node with the quotes left out and escapes decoded, NULL for any other node and for nodes
+// no longer in the tree. It may hold NULs and points into the pool tau_parse_result_strings hands out, valid until the
+// result is parsed again.
+const char *tau_parse_result_node_string(struct tau_parse_result *result, uint32_t id, size_t *len);
+// Every distinct string literal of the buffer once, each followed by a NUL, ready to emit as read-only data. Literals
+// of declarations replaced by a reparse stay until the next full parse.
+const char *tau_parse_result_strings(struct tau_parse_result *result, size_t *size);
+// The interner node symbols belong to
+const struct tau_interner *tau_parse_result_interner(const struct tau_parse_result *result);
+size_t tau_parse_result_diagnostic_count(const struct tau_parse_result *result);
+struct tau_parse_diagnostic tau_parse_result_diagnostic(const struct tau_parse_result *result, size_t index);
+// Every error reported, the ones folded into another diagnostic or dropped past the limit included
+size_t tau_parse_result_error_count(const struct tau_parse_result *result);
+// Renders the diagnostics in memory and writes them to out at once
+void tau_parse_result_write_diagnostics(const struct tau_parse_result *result, enum tau_parse_format format, FILE *out);
+struct tau_parse_stats tau_parse_result_stats(const struct tau_parse_result *result);
 
 #endif  // TAU_PARSER_H
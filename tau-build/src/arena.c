@@ -0,0 +1,105 @@
+//
+// Created on 10/17/26.
+//
+
+#include "arena.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define ARENA_ALIGNMENT alignof(max_align_t)
+#define ARENA_MIN_BLOCK_SIZE ((size_t)64 * 1024)
+#define ARENA_MAX_BLOCK_SIZE ((size_t)16 * 1024 * 1024)
+
+struct tau_arena_block {
+  struct tau_arena_block *prev;
+  size_t size;
+  size_t used;
+  alignas(max_align_t) char data[];
+};
+
+static size_t align_up(size_t size) { return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1); }
+
+static struct tau_arena_block *block_new(struct tau_arena_block *prev, size_t min_size) {
+  // blocks grow geometrically so the number of blocks stays logarithmic on the allocated size
+  size_t size = prev != NULL ? prev->size * 2 : ARENA_MIN_BLOCK_SIZE;
+  if (size > ARENA_MAX_BLOCK_SIZE) {
+    size = ARENA_MAX_BLOCK_SIZE;
+  }
+
+  if (size < min_size) {
+    size = min_size;
+  }
+
+  struct tau_arena_block *block = malloc(sizeof(struct tau_arena_block) + size);
+  assert(block != NULL && "block_new: out of memory");
+  block->prev = prev;
+  block->size = size;
+  block->used = 0;
+  return block;
+}
+
+void tau_arena_init(struct tau_arena *arena) {
+  assert(arena != NULL && "tau_arena_init: arena cannot be NULL");
+  *arena = (struct tau_arena){0};
+}
+
+void *tau_arena_alloc(struct tau_arena *arena, size_t size) {
+  assert(arena != NULL && "tau_arena_alloc: arena cannot be NULL");
+  size = align_up(size);
+
+  struct tau_arena_block *block = arena->head;
+  if (block == NULL || block->size - block->used < size) {
+    block = block_new(block, size);
+    arena->head = block;
+    arena->stats.reserved += block->size;
+  }
+
+  void *ptr = block->data + block->used;
+  block->used += size;
+  arena->stats.used += size;
+  arena->stats.allocs += 1;
+  if (arena->stats.used > arena->stats.peak) {
+    arena->stats.peak = arena->stats.used;
+  }
+
+  return ptr;
+}
+
+void tau_arena_reset(struct tau_arena *arena) {
+  assert(arena != NULL && "tau_arena_reset: arena cannot be NULL");
+  if (arena->head == NULL) {
+    return;
+  }
+
+  // keep the newest (biggest) block around, it is the one most likely to fit the next workload
+  struct tau_arena_block *block = arena->head->prev;
+  while (block != NULL) {
+    struct tau_arena_block *prev = block->prev;
+    free(block);
+    block = prev;
+  }
+
+  arena->head->prev = NULL;
+  arena->head->used = 0;
+  arena->stats.used = 0;
+  arena->stats.allocs = 0;
+  arena->stats.reserved = arena->head->size;
+}
+
+void tau_arena_free(struct tau_arena *arena) {
+  assert(arena != NULL && "tau_arena_free: arena cannot be NULL");
+  struct tau_arena_block *block = arena->head;
+  while (block != NULL) {
+    struct tau_arena_block *prev = block->prev;
+    free(block);
+    block = prev;
+  }
+
+  arena->head = NULL;
+  arena->stats.used = 0;
+  arena->stats.allocs = 0;
+  arena->stats.reserved = 0;
+}
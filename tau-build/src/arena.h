@@ -0,0 +1,30 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_ARENA_H
+#define TAU_ARENA_H
+
+#include <stddef.h>
+
+struct tau_arena_block;
+
+struct tau_arena_stats {
+  size_t used;      // bytes handed out since the last reset
+  size_t reserved;  // bytes currently held in blocks
+  size_t peak;      // highest `used` seen during the arena lifetime
+  size_t allocs;    // allocations served since the last reset
+};
+
+// Bump allocator: allocations are never freed one by one, the whole arena is released (or reset) at once.
+struct tau_arena {
+  struct tau_arena_block *head;
+  struct tau_arena_stats stats;
+};
+
+void tau_arena_init(struct tau_arena *arena);
+void *tau_arena_alloc(struct tau_arena *arena, size_t size);
+void tau_arena_reset(struct tau_arena *arena);
+void tau_arena_free(struct tau_arena *arena);
+
+#endif  // TAU_ARENA_H
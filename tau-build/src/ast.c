@@ -0,0 +1,284 @@
+//
+// Created on 10/17/26.
+//
+
+#include "ast.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash.h"
+
+#define AST_MIN_CHUNK_CAPACITY 16
+#define AST_MIN_SEGMENT_CAPACITY 64
+#define AST_VISIT_INLINE_DEPTH 64
+#define AST_HASH_SEED 0x7A0A57ull
+
+static_assert(TAU_NODE_COUNT <= UINT8_MAX && "node type does not fit in tau_node.type");
+static_assert(sizeof(struct tau_node) <= 32 && "tau_node grew over 32 bytes");
+
+static void push_chunk(struct tau_ast *ast) {
+  if (ast->chunk_count == ast->chunk_capacity) {
+    ast->chunk_capacity = ast->chunk_capacity == 0 ? AST_MIN_CHUNK_CAPACITY : ast->chunk_capacity * 2;
+    ast->chunks = realloc(ast->chunks, ast->chunk_capacity * sizeof(struct tau_node *));
+    assert(ast->chunks != NULL && "push_chunk: out of memory");
+  }
+
+  ast->chunks[ast->chunk_count++] = tau_arena_alloc(&ast->arena, AST_CHUNK_NODES * sizeof(struct tau_node));
+}
+
+void ast_init(struct tau_ast *ast, const char *buf_name, const char *buf, size_t buf_size) {
+  assert(ast != NULL && "ast_init: ast cannot be NULL");
+  assert(buf_size <= UINT32_MAX && "ast_init: buffer too big for 32-bit node spans");
+  *ast = (struct tau_ast){
+      .buf_name = buf_name,
+      .buf = buf,
+      .buf_size = buf_size,
+  };
+  tau_arena_init(&ast->arena);
+  tau_line_index_init(&ast->lines);
+
+  // id 0 is reserved as NODE_NULL
+  push_chunk(ast);
+  ast->chunks[0][0] = (struct tau_node){.type = TAU_NODE_NONE};
+  ast->node_count = 1;
+  ast_begin_segment(ast, 0);
+}
+
+void ast_free(struct tau_ast *ast) {
+  assert(ast != NULL && "ast_free: ast cannot be NULL");
+  tau_arena_free(&ast->arena);
+  tau_line_index_free(&ast->lines);
+  free(ast->chunks);
+  free(ast->segments);
+  ast->chunks = NULL;
+  ast->chunk_count = 0;
+  ast->chunk_capacity = 0;
+  ast->node_count = 0;
+  ast->segments = NULL;
+  ast->segment_count = 0;
+  ast->segment_capacity = 0;
+}
+
+node_id_t ast_node_new(struct tau_ast *ast, enum tau_node_type type, node_id_t left, node_id_t right) {
+  assert(ast != NULL && "ast_node_new: ast cannot be NULL");
+  assert(ast->node_count < UINT32_MAX && "ast_node_new: too many nodes");
+  if ((ast->node_count & AST_CHUNK_MASK) == 0) {
+    push_chunk(ast);
+  }
+
+  node_id_t id = ast->node_count++;
+  *ast_node(ast, id) = (struct tau_node){.left = left, .right = right, .type = type};
+  return id;
+}
+
+uint32_t ast_begin_segment(struct tau_ast *ast, uint32_t base) {
+  assert(ast != NULL && "ast_begin_segment: ast cannot be NULL");
+  // a segment no node was created in yet is taken over instead of left empty
+  if (ast->segment_count > 0 && ast->segments[ast->segment_count - 1].first == ast->node_count) {
+    ast->segment_count--;
+  }
+
+  if (ast->segment_count == ast->segment_capacity) {
+    ast->segment_capacity = ast->segment_capacity == 0 ? AST_MIN_SEGMENT_CAPACITY : ast->segment_capacity * 2;
+    ast->segments = realloc(ast->segments, ast->segment_capacity * sizeof(struct ast_segment));
+    assert(ast->segments != NULL && "ast_begin_segment: out of memory");
+  }
+
+  ast->segments[ast->segment_count] = (struct ast_segment){.first = ast->node_count, .base = base, .origin = base};
+  return ast->segment_count++;
+}
+
+uint32_t ast_node_segment(const struct tau_ast *ast, node_id_t id) {
+  // last segment starting at or before id
+  uint32_t low = 0;
+  uint32_t high = ast->segment_count;
+  while (high - low > 1) {
+    uint32_t mid = low + (high - low) / 2;
+    if (ast->segments[mid].first <= id) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+
+  return low;
+}
+
+uint32_t ast_node_offset(const struct tau_ast *ast, node_id_t id) {
+  return ast->segments[ast_node_segment(ast, id)].base + ast_node(ast, id)->offset;
+}
+
+size_t ast_size(const struct tau_ast *ast) { return ast->node_count > 0 ? ast->node_count - 1 : 0; }
+
+enum tau_node_type ast_node_type(const struct tau_ast *ast, node_id_t id) { return ast_node(ast, id)->type; }
+
+node_id_t ast_node_left(const struct tau_ast *ast, node_id_t id) { return ast_node(ast, id)->left; }
+
+node_id_t ast_node_right(const struct tau_ast *ast, node_id_t id) { return ast_node(ast, id)->right; }
+
+enum tau_token_type ast_node_token_type(const struct tau_ast *ast, node_id_t id) {
+  return ast_node(ast, id)->token_type;
+}
+
+tau_symbol_t ast_node_symbol(const struct tau_ast *ast, node_id_t id) { return ast_node(ast, id)->symbol; }
+
+const char *ast_node_text(const struct tau_ast *ast, node_id_t id, size_t *len) {
+  const struct tau_node *node = ast_node(ast, id);
+  if (len != NULL) {
+    *len = node->len;
+  }
+
+  return ast->buf + ast_node_offset(ast, id);
+}
+
+struct tau_loc ast_node_loc(struct tau_ast *ast, node_id_t id) {
+  return tau_line_index_loc(&ast->lines, ast->buf_name, ast->buf, ast->buf_size, ast_node_offset(ast, id));
+}
+
+enum visit_state {
+  VISIT_STATE_ENTER,
+  VISIT_STATE_RIGHT,
+  VISIT_STATE_LEAVE,
+};
+
+struct visit_frame {
+  node_id_t id;
+  uint8_t state;  // enum visit_state
+};
+
+struct visit_stack {
+  struct visit_frame *frames;
+  size_t count;
+  size_t capacity;
+  struct visit_frame inline_frames[AST_VISIT_INLINE_DEPTH];
+};
+
+static void visit_push(struct visit_stack *stack, node_id_t id) {
+  if (stack->count == stack->capacity) {
+    stack->capacity *= 2;
+    if (stack->frames == stack->inline_frames) {
+      stack->frames = malloc(stack->capacity * sizeof(struct visit_frame));
+      assert(stack->frames != NULL && "visit_push: out of memory");
+      memcpy(stack->frames, stack->inline_frames, sizeof(stack->inline_frames));
+    } else {
+      stack->frames = realloc(stack->frames, stack->capacity * sizeof(struct visit_frame));
+      assert(stack->frames != NULL && "visit_push: out of memory");
+    }
+  }
+
+  stack->frames[stack->count++] = (struct visit_frame){.id = id, .state = VISIT_STATE_ENTER};
+}
+
+bool ast_visit(const struct tau_ast *ast, node_id_t root, const struct ast_visitor *visitor) {
+  assert(ast != NULL && "ast_visit: ast cannot be NULL");
+  assert(visitor != NULL && "ast_visit: visitor cannot be NULL");
+  if (root == NODE_NULL) {
+    return true;
+  }
+
+  struct visit_stack stack = {.capacity = AST_VISIT_INLINE_DEPTH};
+  stack.frames = stack.inline_frames;
+  visit_push(&stack, root);
+
+  bool completed = true;
+  while (stack.count > 0) {
+    struct visit_frame *frame = &stack.frames[stack.count - 1];
+    const struct tau_node *node = ast_node(ast, frame->id);
+    enum ast_visit_action action = AST_VISIT_CONTINUE;
+    switch (frame->state) {
+      case VISIT_STATE_ENTER:
+        action = visitor->enter != NULL ? visitor->enter(ast, frame->id, visitor->ctx) : AST_VISIT_CONTINUE;
+        frame->state = action == AST_VISIT_SKIP ? VISIT_STATE_LEAVE : VISIT_STATE_RIGHT;
+        if (action == AST_VISIT_CONTINUE && node->left != NODE_NULL) {
+          visit_push(&stack, node->left);
+        }
+        break;
+      case VISIT_STATE_RIGHT:
+        if (node->right != NODE_NULL && visitor->leave == NULL) {
+          // nothing left to do on this node, so its right sibling takes its frame and chains stay flat
+          *frame = (struct visit_frame){.id = node->right, .state = VISIT_STATE_ENTER};
+          break;
+        }
+
+        frame->state = VISIT_STATE_LEAVE;
+        if (node->right != NODE_NULL) {
+          visit_push(&stack, node->right);
+        }
+        break;
+      case VISIT_STATE_LEAVE:
+        action = visitor->leave != NULL ? visitor->leave(ast, frame->id, visitor->ctx) : AST_VISIT_CONTINUE;
+        stack.count--;
+        break;
+    }
+
+    if (action == AST_VISIT_STOP) {
+      completed = false;
+      break;
+    }
+  }
+
+  if (stack.frames != stack.inline_frames) {
+    free(stack.frames);
+  }
+
+  return completed;
+}
+
+// Members of lists link to the member that follows them through right instead of to a child
+static bool is_list_member(uint8_t type) {
+  switch (type) {
+    case TAU_NODE_CALLING_ARG:
+    case TAU_NODE_INDEXING_ARG:
+    case TAU_NODE_MAIN_BRANCH:
+    case TAU_NODE_ELIF_BRANCH:
+    case TAU_NODE_FORMAL_ARG:
+    case TAU_NODE_STATEMENT_OR_DECL:
+    case TAU_NODE_DECL:
+      return true;
+    default:
+      return false;
+  }
+}
+
+struct hash_pass {
+  uint64_t *hashes;
+  uint64_t *chains;  // hash of a list member and every member after it, for the parent holding the list
+};
+
+static uint64_t link_hash(const struct hash_pass *pass, const struct tau_ast *ast, node_id_t id) {
+  if (id == NODE_NULL) {
+    return 0;
+  }
+
+  return is_list_member(ast_node(ast, id)->type) ? pass->chains[id] : pass->hashes[id];
+}
+
+// Runs once both links of the node are hashed
+static enum ast_visit_action hash_node(const struct tau_ast *ast, node_id_t id, void *ctx) {
+  struct hash_pass *pass = ctx;
+  const struct tau_node *node = ast_node(ast, id);
+  bool member = is_list_member(node->type);
+  uint64_t kind = (uint64_t)node->type << 16 | (uint64_t)node->token_type << 8 | node->token_code;
+  uint64_t parts[3] = {
+      tau_hash64(ast->buf + ast_node_offset(ast, id), node->len, kind),
+      link_hash(pass, ast, node->left),
+      member ? 0 : link_hash(pass, ast, node->right),
+  };
+  pass->hashes[id] = tau_hash64(parts, sizeof(parts), AST_HASH_SEED);
+  if (member) {
+    uint64_t chain[2] = {pass->hashes[id], link_hash(pass, ast, node->right)};
+    pass->chains[id] = tau_hash64(chain, sizeof(chain), AST_HASH_SEED);
+  }
+
+  return AST_VISIT_CONTINUE;
+}
+
+void ast_hash_subtrees(const struct tau_ast *ast, node_id_t root, uint64_t *hashes) {
+  assert(ast != NULL && "ast_hash_subtrees: ast cannot be NULL");
+  assert(hashes != NULL && "ast_hash_subtrees: hashes cannot be NULL");
+  struct hash_pass pass = {.hashes = hashes, .chains = calloc(ast->node_count, sizeof(uint64_t))};
+  assert(pass.chains != NULL && "ast_hash_subtrees: out of memory");
+  ast_visit(ast, root, &(struct ast_visitor){.leave = hash_node, .ctx = &pass});
+  free(pass.chains);
+}
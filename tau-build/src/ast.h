@@ -0,0 +1,193 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_AST_H
+#define TAU_AST_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "arena.h"
+#include "common.h"
+#include "lexer.h"
+#include "line_index.h"
+
+#define AST_CHUNK_BITS 10
+#define AST_CHUNK_NODES (1u << AST_CHUNK_BITS)
+#define AST_CHUNK_MASK (AST_CHUNK_NODES - 1)
+#define NODE_NULL ((node_id_t)0)
+
+enum tau_node_type {
+  TAU_NODE_NONE,
+  TAU_NODE_CALLING_ARGS,
+  TAU_NODE_CALLING_ARG,
+  TAU_NODE_INDEXING_ARGS,
+  TAU_NODE_INDEXING_ARG,
+  TAU_NODE_CAST_EXPR,
+  TAU_NODE_LOG_OR_EXPR,
+  TAU_NODE_LOG_AND_EXPR,
+  TAU_NODE_EQ_EXPR,
+  TAU_NODE_NE_EXPR,
+  TAU_NODE_LT_EXPR,
+  TAU_NODE_LE_EXPR,
+  TAU_NODE_GT_EXPR,
+  TAU_NODE_GE_EXPR,
+  TAU_NODE_BIT_OR_EXPR,
+  TAU_NODE_BIT_XOR_EXPR,
+  TAU_NODE_BIT_AND_EXPR,
+  TAU_NODE_LSH_EXPR,
+  TAU_NODE_RSH_EXPR,
+  TAU_NODE_ADD_EXPR,
+  TAU_NODE_SUB_EXPR,
+  TAU_NODE_MUL_EXPR,
+  TAU_NODE_DIV_EXPR,
+  TAU_NODE_REM_EXPR,
+  TAU_NODE_U_REF_EXPR,
+  TAU_NODE_PROOF_EXPR,
+  TAU_NODE_STATIC_LOOKUP_EXPR,
+  TAU_NODE_VALUE_LOOKUP_EXPR,
+  TAU_NODE_U_POS_EXPR,
+  TAU_NODE_U_NEG_EXPR,
+  TAU_NODE_U_LOG_NOT_EXPR,
+  TAU_NODE_U_BIT_NOT_EXPR,
+  TAU_NODE_SUBSCRIPTION_EXPR,
+  TAU_NODE_ATOM,
+  TAU_NODE_RETURN_STMT,
+  TAU_NODE_CONTINUE_STMT,
+  TAU_NODE_BREAK_STMT,
+  TAU_NODE_IF_STMT,
+  TAU_NODE_MAIN_BRANCH,
+  TAU_NODE_ELIF_BRANCH,
+  TAU_NODE_ELSE_BRANCH,
+  TAU_NODE_WHILE_STMT,
+  TAU_NODE_ASSIGN_STMT,
+  TAU_NODE_ACCUM_ADD_STMT,
+  TAU_NODE_ACCUM_SUB_STMT,
+  TAU_NODE_ACCUM_MUL_STMT,
+  TAU_NODE_ACCUM_DIV_STMT,
+  TAU_NODE_ACCUM_REM_STMT,
+  TAU_NODE_ACCUM_BIT_AND_STMT,
+  TAU_NODE_ACCUM_BIT_OR_STMT,
+  TAU_NODE_ACCUM_BIT_XOR_STMT,
+  TAU_NODE_ACCUM_RSH_STMT,
+  TAU_NODE_ACCUM_LSH_STMT,
+  TAU_NODE_STATEMENT_OR_DECL,
+  TAU_NODE_BLOCK,
+  TAU_NODE_EXPR_WITH_BLOCK,
+  TAU_NODE_TYPE_BIND,
+  TAU_NODE_DATA_BIND,
+  TAU_NODE_LET_DECONSTRUCTION,
+  TAU_NODE_PROC_SIGNATURE,
+  TAU_NODE_FORMAL_ARGS,
+  TAU_NODE_FORMAL_ARG,
+  TAU_NODE_ARG_BIND,
+  TAU_NODE_PROC_DECONSTRUCTION,
+  TAU_NODE_TYPE_DECONSTRUCTION,
+  TAU_NODE_MODULE_DECL,
+  TAU_NODE_PROTOTYPE_SUFFIX,
+  TAU_NODE_LET_DECL,
+  TAU_NODE_PROC_DECL,
+  TAU_NODE_TYPE_DECL,
+  TAU_NODE_EXTERN_DECL,
+  TAU_NODE_DECL,
+  TAU_NODE_DECLS,
+  TAU_NODE_COMPILATION_UNIT,
+  TAU_NODE_ERROR,  // tokens skipped while recovering from a syntax error
+  TAU_NODE_COUNT,
+};
+
+typedef uint32_t node_id_t;
+
+// Nodes don't keep lexer state, only the span of the token that produced them in the source buffer, location
+// (row/col) is recovered on demand through the ast line index.
+struct tau_node {
+  uint32_t offset;  // from the base of the node's segment, ast_node_offset gives the one in the buffer
+  uint32_t len;
+  node_id_t left;
+  node_id_t right;
+  tau_symbol_t symbol;  // symbol of identifier and string literal tokens, TAU_SYMBOL_NONE otherwise
+  uint8_t type;         // enum tau_node_type
+  uint8_t token_type;   // enum tau_token_type
+  uint8_t token_code;   // enum tau_punct, enum tau_keyword or enum tau_num_base depending on token_type
+};
+
+// Nodes from first up to the first node of the next segment, their offsets count from base. The parser opens one per
+// top level declaration, so text edited before a declaration only moves its base and none of its nodes.
+struct ast_segment {
+  node_id_t first;
+  uint32_t base;
+  uint32_t origin;  // base when the segment was opened, where its offsets count from in the tokens it was parsed from
+  bool stale;       // its nodes were replaced by a reparse and are no longer in the tree
+};
+
+// Owner of every node of a compilation unit. Nodes are addressed by id (0 is never a valid node) and stored in
+// fixed-size chunks taken from the arena, so node addresses never move while the tree grows.
+struct tau_ast {
+  struct tau_arena arena;
+  struct tau_node **chunks;
+  uint32_t chunk_count;
+  uint32_t chunk_capacity;
+  uint32_t node_count;
+  struct ast_segment *segments;  // ascending by first node, ast_init opens one with a base of 0
+  uint32_t segment_count;
+  uint32_t segment_capacity;
+  const char *buf_name;
+  const char *buf;
+  size_t buf_size;
+  struct tau_line_index lines;
+};
+
+void ast_init(struct tau_ast *ast, const char *buf_name, const char *buf, size_t buf_size);
+void ast_free(struct tau_ast *ast);
+node_id_t ast_node_new(struct tau_ast *ast, enum tau_node_type type, node_id_t left, node_id_t right);
+
+static inline struct tau_node *ast_node(const struct tau_ast *ast, node_id_t id) {
+  assert(id != NODE_NULL && id < ast->node_count && "ast_node: invalid node id");
+  return &ast->chunks[id >> AST_CHUNK_BITS][id & AST_CHUNK_MASK];
+}
+
+// Nodes created from now on get offsets counting from base, returns the index of their segment
+uint32_t ast_begin_segment(struct tau_ast *ast, uint32_t base);
+// Index of the segment holding id
+uint32_t ast_node_segment(const struct tau_ast *ast, node_id_t id);
+// Offset of the node in the buffer
+uint32_t ast_node_offset(const struct tau_ast *ast, node_id_t id);
+size_t ast_size(const struct tau_ast *ast);
+enum tau_node_type ast_node_type(const struct tau_ast *ast, node_id_t id);
+node_id_t ast_node_left(const struct tau_ast *ast, node_id_t id);
+node_id_t ast_node_right(const struct tau_ast *ast, node_id_t id);
+enum tau_token_type ast_node_token_type(const struct tau_ast *ast, node_id_t id);
+tau_symbol_t ast_node_symbol(const struct tau_ast *ast, node_id_t id);
+const char *ast_node_text(const struct tau_ast *ast, node_id_t id, size_t *len);
+struct tau_loc ast_node_loc(struct tau_ast *ast, node_id_t id);
+
+enum ast_visit_action {
+  AST_VISIT_CONTINUE,
+  AST_VISIT_SKIP,  // don't descend into the left and right of the node just entered, it is still left
+  AST_VISIT_STOP,
+};
+
+typedef enum ast_visit_action (*ast_visit_func_t)(const struct tau_ast *ast, node_id_t id, void *ctx);
+
+// enter runs before the children of a node (left, then right) and leave after them, either may be NULL
+struct ast_visitor {
+  ast_visit_func_t enter;
+  ast_visit_func_t leave;
+  void *ctx;
+};
+
+// Depth-first walk driven by an explicit stack instead of recursion, so sibling chains of any length (blocks and decl
+// lists link their members through `right`) are bounded by memory rather than by the thread stack. Returns false when
+// a callback stopped the walk.
+bool ast_visit(const struct tau_ast *ast, node_id_t root, const struct ast_visitor *visitor);
+
+// Merkle hash of every node under root, written to hashes at the node id (node_count entries, the others are left
+// alone). A hash covers the node type, its token kind and text and the hashes of its children, never offsets, so moved
+// but unchanged code keeps its hash. The members of a list (declarations, statements, arguments, branches) don't cover
+// the members after them, while the node holding the list covers all of them.
+void ast_hash_subtrees(const struct tau_ast *ast, node_id_t root, uint64_t *hashes);
+
+#endif  // TAU_AST_H
@@ -0,0 +1,354 @@
+//
+// Created on 10/17/26.
+//
+
+#define _DEFAULT_SOURCE
+
+#include "cache.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <stdalign.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_MIN_SLOTS 64
+#define CACHE_MIN_STRINGS 64
+
+// Interner symbols of the nodes written so far and the index they got in the string table
+struct cache_symbols {
+  tau_symbol_t *slots;     // open addressing over symbols, TAU_SYMBOL_NONE marks an empty slot
+  uint32_t *slot_indices;  // string index of the symbol in the same slot
+  uint32_t slot_count;
+  tau_symbol_t *order;  // symbols by string index, 0 unused
+  uint32_t count;
+  uint32_t capacity;
+};
+
+static void cache_path(char *path, const char *dir, uint64_t content_hash) {
+  snprintf(path, PATH_MAX, "%s/%016" PRIx64 ".tast", dir, content_hash);
+}
+
+static uint32_t symbol_slot(tau_symbol_t symbol, uint32_t mask) { return (symbol * 0x9E3779B1u) & mask; }
+
+static void symbols_rehash(struct cache_symbols *symbols, uint32_t slot_count) {
+  tau_symbol_t *slots = calloc(slot_count, sizeof(tau_symbol_t));
+  uint32_t *slot_indices = malloc(slot_count * sizeof(uint32_t));
+  assert(slots != NULL && slot_indices != NULL && "symbols_rehash: out of memory");
+  for (uint32_t index = 1; index < symbols->count; index++) {
+    uint32_t i = symbol_slot(symbols->order[index], slot_count - 1);
+    while (slots[i] != TAU_SYMBOL_NONE) {
+      i = (i + 1) & (slot_count - 1);
+    }
+
+    slots[i] = symbols->order[index];
+    slot_indices[i] = index;
+  }
+
+  free(symbols->slots);
+  free(symbols->slot_indices);
+  symbols->slots = slots;
+  symbols->slot_indices = slot_indices;
+  symbols->slot_count = slot_count;
+}
+
+static uint32_t symbols_index(struct cache_symbols *symbols, tau_symbol_t symbol) {
+  if (symbol == TAU_SYMBOL_NONE) {
+    return 0;
+  }
+
+  // kept at most half full
+  if (symbols->count * 2 >= symbols->slot_count) {
+    symbols_rehash(symbols, symbols->slot_count == 0 ? CACHE_MIN_SLOTS : symbols->slot_count * 2);
+  }
+
+  uint32_t mask = symbols->slot_count - 1;
+  uint32_t i = symbol_slot(symbol, mask);
+  for (; symbols->slots[i] != TAU_SYMBOL_NONE; i = (i + 1) & mask) {
+    if (symbols->slots[i] == symbol) {
+      return symbols->slot_indices[i];
+    }
+  }
+
+  if (symbols->count >= symbols->capacity) {
+    symbols->capacity = symbols->capacity == 0 ? CACHE_MIN_STRINGS : symbols->capacity * 2;
+    symbols->order = realloc(symbols->order, symbols->capacity * sizeof(tau_symbol_t));
+    assert(symbols->order != NULL && "symbols_index: out of memory");
+  }
+
+  symbols->slots[i] = symbol;
+  symbols->slot_indices[i] = symbols->count;
+  symbols->order[symbols->count] = symbol;
+  return symbols->count++;
+}
+
+static void symbols_free(struct cache_symbols *symbols) {
+  free(symbols->slots);
+  free(symbols->slot_indices);
+  free(symbols->order);
+}
+
+// Nodes reachable from root only, so declarations replaced by a reparse are not written. Reachable nodes keep their
+// ids, unreachable ones are written as empty nodes.
+static bool *mark_reachable(const struct tau_ast *ast, node_id_t root) {
+  bool *reachable = calloc(ast->node_count, sizeof(bool));
+  node_id_t *stack = malloc(ast->node_count * sizeof(node_id_t));
+  assert(reachable != NULL && stack != NULL && "mark_reachable: out of memory");
+  size_t top = 0;
+  if (root != NODE_NULL) {
+    reachable[root] = true;
+    stack[top++] = root;
+  }
+
+  // marked when pushed, so the stack never holds more than every node once
+  while (top > 0) {
+    const struct tau_node *node = ast_node(ast, stack[--top]);
+    if (node->left != NODE_NULL && !reachable[node->left]) {
+      reachable[node->left] = true;
+      stack[top++] = node->left;
+    }
+
+    if (node->right != NODE_NULL && !reachable[node->right]) {
+      reachable[node->right] = true;
+      stack[top++] = node->right;
+    }
+  }
+
+  free(stack);
+  return reachable;
+}
+
+static bool write_image(FILE *out, uint64_t content_hash, const struct tau_ast *ast, node_id_t root,
+                        const struct tau_interner *interner) {
+  struct tau_cache_header header = {
+      .magic = TAU_CACHE_MAGIC,
+      .version = TAU_CACHE_VERSION,
+      .node_size = sizeof(struct tau_node),
+      .content_hash = content_hash,
+      .content_size = ast->buf_size,
+      .node_count = ast->node_count,
+      .root = root,
+      .nodes_offset = sizeof(struct tau_cache_header),
+  };
+
+  // the header is written again once the string table is known
+  bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+  bool *reachable = mark_reachable(ast, root);
+  struct cache_symbols symbols = {.count = 1};
+  for (node_id_t id = 0; id < ast->node_count && ok; id++) {
+    struct tau_node node = {.type = TAU_NODE_NONE};
+    if (reachable[id]) {
+      node = *ast_node(ast, id);
+      node.offset = ast_node_offset(ast, id);
+      node.symbol = symbols_index(&symbols, node.symbol);
+    }
+
+    ok = fwrite(&node, sizeof(node), 1, out) == 1;
+  }
+
+  free(reachable);
+  header.string_count = symbols.count;
+  header.strings_offset = header.nodes_offset + (uint64_t)header.node_count * sizeof(struct tau_node);
+  header.text_offset = header.strings_offset + (uint64_t)header.string_count * sizeof(struct tau_cache_string);
+  struct tau_cache_string string = {0};
+  for (uint32_t index = 0; index < symbols.count && ok; index++) {
+    if (index > 0) {
+      size_t len = 0;
+      tau_interner_text(interner, symbols.order[index], &len);
+      string = (struct tau_cache_string){.offset = header.text_size, .len = (uint32_t)len};
+      header.text_size += (uint32_t)len;
+    }
+
+    ok = fwrite(&string, sizeof(string), 1, out) == 1;
+  }
+
+  for (uint32_t index = 1; index < symbols.count && ok; index++) {
+    size_t len = 0;
+    const char *text = tau_interner_text(interner, symbols.order[index], &len);
+    ok = fwrite(text, 1, len, out) == len;
+  }
+
+  symbols_free(&symbols);
+  header.file_size = header.text_offset + header.text_size;
+  return ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1;
+}
+
+int tau_cache_store(const char *dir, uint64_t content_hash, const struct tau_ast *ast, node_id_t root,
+                    const struct tau_interner *interner) {
+  assert(dir != NULL && "tau_cache_store: dir cannot be NULL");
+  assert(ast != NULL && "tau_cache_store: ast cannot be NULL");
+  assert(interner != NULL && "tau_cache_store: interner cannot be NULL");
+
+  char path[PATH_MAX];
+  char tmp_path[PATH_MAX + sizeof(".XXXXXX")];
+  cache_path(path, dir, content_hash);
+  snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", path);
+  int fd = mkstemp(tmp_path);
+  if (fd < 0) {
+    return errno;
+  }
+
+  FILE *out = fdopen(fd, "wb");
+  if (out == NULL) {
+    int err = errno;
+    close(fd);
+    unlink(tmp_path);
+    return err;
+  }
+
+  errno = 0;
+  int err = 0;
+  if (!write_image(out, content_hash, ast, root, interner)) {
+    err = errno != 0 ? errno : EIO;
+  }
+
+  if (fclose(out) != 0 && err == 0) {
+    err = errno;
+  }
+
+  if (err == 0 && rename(tmp_path, path) != 0) {
+    err = errno;
+  }
+
+  if (err != 0) {
+    unlink(tmp_path);
+  }
+
+  return err;
+}
+
+static bool section_fits(uint64_t offset, uint64_t count, size_t item_size, size_t align, uint64_t file_size) {
+  return offset % align == 0 && offset <= file_size && count <= (file_size - offset) / item_size;
+}
+
+// False when a node is reached twice from root, through a cycle or a link shared by two parents. Walks of the loaded
+// tree count on every node having a single parent. Links must already be known to be in bounds.
+static bool image_tree(const struct tau_node *nodes, uint32_t node_count, node_id_t root) {
+  bool *reached = calloc(node_count, sizeof(bool));
+  node_id_t *stack = malloc(node_count * sizeof(node_id_t));
+  assert(reached != NULL && stack != NULL && "image_tree: out of memory");
+  size_t top = 0;
+  if (root != NODE_NULL) {
+    reached[root] = true;
+    stack[top++] = root;
+  }
+
+  // a node is pushed once at most, so the stack never holds more than every node
+  bool tree = true;
+  while (top > 0 && tree) {
+    const struct tau_node *node = &nodes[stack[--top]];
+    node_id_t links[] = {node->left, node->right};
+    for (size_t i = 0; i < sizeof(links) / sizeof(links[0]) && tree; i++) {
+      if (links[i] == NODE_NULL) {
+        continue;
+      }
+
+      tree = !reached[links[i]];
+      if (tree) {
+        reached[links[i]] = true;
+        stack[top++] = links[i];
+      }
+    }
+  }
+
+  free(reached);
+  free(stack);
+  return tree;
+}
+
+// Everything a reader relies on, so that a corrupted image is a miss instead of a crash
+static bool image_valid(const struct tau_cache_image *image, uint64_t content_hash, size_t content_size) {
+  const struct tau_cache_header *header = image->header;
+  if (header->magic != TAU_CACHE_MAGIC || header->version != TAU_CACHE_VERSION ||
+      header->node_size != sizeof(struct tau_node) || header->content_hash != content_hash ||
+      header->content_size != content_size || header->file_size != image->map_size) {
+    return false;
+  }
+
+  if (!section_fits(header->nodes_offset, header->node_count, sizeof(struct tau_node), alignof(struct tau_node),
+                    header->file_size) ||
+      !section_fits(header->strings_offset, header->string_count, sizeof(struct tau_cache_string),
+                    alignof(struct tau_cache_string), header->file_size) ||
+      !section_fits(header->text_offset, header->text_size, 1, 1, header->file_size)) {
+    return false;
+  }
+
+  if (header->node_count == 0 || header->root >= header->node_count || header->string_count == 0) {
+    return false;
+  }
+
+  const char *base = (const char *)header;
+  const struct tau_node *nodes = (const struct tau_node *)(base + header->nodes_offset);
+  for (uint32_t id = 0; id < header->node_count; id++) {
+    const struct tau_node *node = &nodes[id];
+    if (node->type >= TAU_NODE_COUNT || node->left >= header->node_count || node->right >= header->node_count ||
+        node->symbol >= header->string_count || (uint64_t)node->offset + node->len > content_size) {
+      return false;
+    }
+  }
+
+  if (!image_tree(nodes, header->node_count, header->root)) {
+    return false;
+  }
+
+  const struct tau_cache_string *strings = (const struct tau_cache_string *)(base + header->strings_offset);
+  for (uint32_t index = 0; index < header->string_count; index++) {
+    if ((uint64_t)strings[index].offset + strings[index].len > header->text_size) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool tau_cache_map(struct tau_cache_image *image, const char *dir, uint64_t content_hash, size_t content_size) {
+  assert(image != NULL && "tau_cache_map: image cannot be NULL");
+  assert(dir != NULL && "tau_cache_map: dir cannot be NULL");
+  *image = (struct tau_cache_image){0};
+
+  char path[PATH_MAX];
+  cache_path(path, dir, content_hash);
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat st;
+  void *base = MAP_FAILED;
+  if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && (size_t)st.st_size >= sizeof(struct tau_cache_header)) {
+    base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  close(fd);
+  if (base == MAP_FAILED) {
+    return false;
+  }
+
+  image->header = base;
+  image->map_size = (size_t)st.st_size;
+  if (!image_valid(image, content_hash, content_size)) {
+    tau_cache_unmap(image);
+    return false;
+  }
+
+  image->nodes = (const struct tau_node *)((const char *)base + image->header->nodes_offset);
+  image->strings = (const struct tau_cache_string *)((const char *)base + image->header->strings_offset);
+  image->text = (const char *)base + image->header->text_offset;
+  return true;
+}
+
+void tau_cache_unmap(struct tau_cache_image *image) {
+  assert(image != NULL && "tau_cache_unmap: image cannot be NULL");
+  if (image->header != NULL) {
+    munmap((void *)image->header, image->map_size);
+  }
+
+  *image = (struct tau_cache_image){0};
+}
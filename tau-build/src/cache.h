@@ -0,0 +1,60 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_CACHE_H
+#define TAU_CACHE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <tau/interner.h>
+
+#include "ast.h"
+
+#define TAU_CACHE_MAGIC 0x5453414455415400ull  // "\0TAUDAST" read as a little endian word
+#define TAU_CACHE_VERSION 1
+
+// Layout of a cached ast. Sections are addressed by offsets from the start of the file, nodes are struct tau_node as
+// is with links being node ids, offsets from the start of the source and symbols indices into the string table, so a
+// mapped image is used without fixing up any pointer. An image is only ever read by the build that wrote it: the magic,
+// version and node size reject images of another byte order or node layout.
+struct tau_cache_header {
+  uint64_t magic;
+  uint32_t version;
+  uint32_t node_size;
+  uint64_t content_hash;  // tau_hash64 of the source the ast was parsed from
+  uint64_t content_size;
+  uint32_t node_count;    // node 0 included, it is always empty
+  node_id_t root;
+  uint32_t string_count;  // string 0 included, it stands for TAU_SYMBOL_NONE
+  uint32_t text_size;
+  uint64_t nodes_offset;
+  uint64_t strings_offset;
+  uint64_t text_offset;
+  uint64_t file_size;
+};
+
+struct tau_cache_string {
+  uint32_t offset;  // from the start of the text section, not NUL terminated
+  uint32_t len;
+};
+
+// A validated image mapped read-only, every id, symbol and span in it is in bounds and its nodes form a tree
+struct tau_cache_image {
+  const struct tau_cache_header *header;
+  const struct tau_node *nodes;
+  const struct tau_cache_string *strings;
+  const char *text;
+  size_t map_size;
+};
+
+// Writes the tree under root to dir, keyed by content_hash. The image goes to a temporary file renamed into place, so
+// concurrent builds sharing a cache never see a partial one. Returns 0 or the errno value of the failing call.
+int tau_cache_store(const char *dir, uint64_t content_hash, const struct tau_ast *ast, node_id_t root,
+                    const struct tau_interner *interner);
+// False when dir has no usable image for content_hash: missing, written by another build, truncated or corrupted
+bool tau_cache_map(struct tau_cache_image *image, const char *dir, uint64_t content_hash, size_t content_size);
+void tau_cache_unmap(struct tau_cache_image *image);
+
+#endif  // TAU_CACHE_H
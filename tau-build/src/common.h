@@ -11,6 +11,7 @@ struct tau_loc {
   const char *buf_name;
   size_t row;
   size_t col;
+  size_t offset;  // byte the row and column were worked out for
 };
 
 typedef void(free_func_t)(void *);
@@ -0,0 +1,341 @@
+//
+// Created on 10/17/26.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "diag.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utf8.h"
+
+#define DIAG_LIST_MIN_CAPACITY 8
+#define DIAG_MIN_FOLD_SLOTS 64u
+
+struct diag_code_info {
+  const char *name;
+  enum tau_log_level level;
+  uint8_t arg_count;
+  const char *format;  // each %s takes the next argument
+};
+
+static const struct diag_code_info diag_code_table[TAU_DIAG_CODE_COUNT] = {
+    [TAU_DIAG_NONE] = {"E0000", TAU_LOG_ERROR, 0, ""},
+    [TAU_DIAG_UNKNOWN_CHARACTER] = {"E0001", TAU_LOG_ERROR, 2, "unknown unicode character `%s` (%s)"},
+    [TAU_DIAG_UNCLOSED_STRING] = {"E0002", TAU_LOG_ERROR, 0,
+                                  "unclosed string literal, new line (U+000A) found before quotation mark (\" U+0022)"},
+    [TAU_DIAG_UNEXPECTED_TOKEN] = {"E0003", TAU_LOG_ERROR, 2, "unexpected `%s`, was expecting %s"},
+    [TAU_DIAG_CANNOT_READ_FILE] = {"E0004", TAU_LOG_ERROR, 1, "cannot read file: %s"},
+    [TAU_DIAG_INVALID_UTF8] = {"E0005", TAU_LOG_ERROR, 1, "invalid UTF-8 byte `%s`"},
+    [TAU_DIAG_UNCLOSED_COMMENT] = {"E0006", TAU_LOG_ERROR, 0, "unclosed block comment, end of file found before `*/`"},
+    [TAU_DIAG_INVALID_NUM_LIT] = {"E0007", TAU_LOG_ERROR, 1, "invalid numeric literal `%s`, digits missing"},
+    [TAU_DIAG_NUM_LIT_OUT_OF_RANGE] = {"E0008", TAU_LOG_ERROR, 1, "numeric literal `%s` out of range"},
+    [TAU_DIAG_INVALID_ESCAPE] = {"E0009", TAU_LOG_ERROR, 1, "invalid escape sequence `%s`"},
+};
+
+const char *tau_diag_get_code_name(enum tau_diag_code code) {
+  if (code < TAU_DIAG_CODE_COUNT) {
+    return diag_code_table[code].name;
+  }
+
+  return "(invalid)";
+}
+
+void tau_diag_list_init(struct tau_diag_list *list) {
+  assert(list != NULL && "tau_diag_list_init: list cannot be NULL");
+  *list = (struct tau_diag_list){0};
+  tau_arena_init(&list->arena);
+}
+
+void tau_diag_list_free(struct tau_diag_list *list) {
+  assert(list != NULL && "tau_diag_list_free: list cannot be NULL");
+  tau_arena_free(&list->arena);
+  free(list->items);
+  free(list->fold_slots);
+  *list = (struct tau_diag_list){0};
+}
+
+void tau_diag_list_set_policy(struct tau_diag_list *list, struct tau_diag_policy policy) {
+  assert(list != NULL && "tau_diag_list_set_policy: list cannot be NULL");
+  assert(list->count == 0 && list->dropped_count == 0 && "tau_diag_list_set_policy: list is not empty");
+  list->policy = policy;
+}
+
+// FNV-1a over the code and the arguments, the location is left out on purpose
+static uint32_t diag_hash(enum tau_diag_code code, const struct tau_diag_arg *args) {
+  uint32_t hash = (2166136261u ^ (uint32_t)code) * 16777619u;
+  for (uint8_t i = 0; i < diag_code_table[code].arg_count; i++) {
+    for (size_t j = 0; j < args[i].len; j++) {
+      hash = (hash ^ (uint8_t)args[i].text[j]) * 16777619u;
+    }
+
+    hash = (hash ^ 0xFFu) * 16777619u;
+  }
+
+  return hash;
+}
+
+static bool diag_same(const struct tau_diag *diag, enum tau_diag_code code, const struct tau_diag_arg *args) {
+  if (diag->code != code) {
+    return false;
+  }
+
+  for (uint8_t i = 0; i < diag_code_table[code].arg_count; i++) {
+    if (strncmp(diag->args[i], args[i].text, args[i].len) != 0 || diag->args[i][args[i].len] != '\0') {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void fold_rehash(struct tau_diag_list *list, size_t slot_count) {
+  uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+  assert(slots != NULL && "fold_rehash: out of memory");
+  for (size_t index = 0; index < list->count; index++) {
+    const struct tau_diag *diag = &list->items[index];
+    struct tau_diag_arg args[TAU_DIAG_MAX_ARGS] = {0};
+    for (uint8_t j = 0; j < diag_code_table[diag->code].arg_count; j++) {
+      args[j] = (struct tau_diag_arg){.text = diag->args[j], .len = strlen(diag->args[j])};
+    }
+
+    size_t i = diag_hash(diag->code, args) & (slot_count - 1);
+    while (slots[i] != 0) {
+      i = (i + 1) & (slot_count - 1);
+    }
+
+    slots[i] = (uint32_t)index + 1;
+  }
+
+  free(list->fold_slots);
+  list->fold_slots = slots;
+  list->fold_slot_count = slot_count;
+}
+
+// The kept diagnostic a new one folds into. When there is none and reserve is set, the slot is taken for the new one.
+static struct tau_diag *fold_find(struct tau_diag_list *list, enum tau_diag_code code, const struct tau_diag_arg *args,
+                                  bool reserve) {
+  if (reserve && (list->count + 1) * 2 > list->fold_slot_count) {
+    fold_rehash(list, list->fold_slot_count == 0 ? DIAG_MIN_FOLD_SLOTS : list->fold_slot_count * 2);
+  }
+
+  if (list->fold_slot_count == 0) {
+    return NULL;
+  }
+
+  size_t mask = list->fold_slot_count - 1;
+  for (size_t i = diag_hash(code, args) & mask;; i = (i + 1) & mask) {
+    if (list->fold_slots[i] == 0) {
+      if (reserve) {
+        list->fold_slots[i] = (uint32_t)list->count + 1;
+      }
+
+      return NULL;
+    }
+
+    struct tau_diag *diag = &list->items[list->fold_slots[i] - 1];
+    if (diag_same(diag, code, args)) {
+      return diag;
+    }
+  }
+}
+
+static void copy_args(struct tau_arena *arena, uint8_t arg_count, const struct tau_diag_arg *args,
+                      const char **copies) {
+  for (uint8_t i = 0; i < arg_count; i++) {
+    char *copy = tau_arena_alloc(arena, args[i].len + 1);
+    memcpy(copy, args[i].text, args[i].len);
+    copy[args[i].len] = '\0';
+    copies[i] = copy;
+  }
+}
+
+static char *diag_format(struct tau_arena *arena, const char *format, const char *const *args) {
+  size_t len = 0;
+  uint8_t arg = 0;
+  for (const char *c = format; *c != '\0'; c++) {
+    if (c[0] == '%' && c[1] == 's') {
+      len += strlen(args[arg++]);
+      c++;
+    } else {
+      len++;
+    }
+  }
+
+  char *message = tau_arena_alloc(arena, len + 1);
+  char *out = message;
+  arg = 0;
+  for (const char *c = format; *c != '\0'; c++) {
+    if (c[0] == '%' && c[1] == 's') {
+      size_t arg_len = strlen(args[arg]);
+      memcpy(out, args[arg++], arg_len);
+      out += arg_len;
+      c++;
+    } else {
+      *out++ = *c;
+    }
+  }
+
+  *out = '\0';
+  return message;
+}
+
+void tau_diag_report(struct tau_diag_list *list, enum tau_diag_code code, struct tau_loc loc, size_t len,
+                     const struct tau_diag_arg *args) {
+  assert(code > TAU_DIAG_NONE && code < TAU_DIAG_CODE_COUNT && "tau_diag_report: invalid code");
+  const struct diag_code_info *info = &diag_code_table[code];
+  assert((args != NULL || info->arg_count == 0) && "tau_diag_report: missing arguments");
+
+  const char *copies[TAU_DIAG_MAX_ARGS] = {0};
+  if (list == NULL) {
+    struct tau_arena scratch;
+    tau_arena_init(&scratch);
+    copy_args(&scratch, info->arg_count, args, copies);
+    tau_log(info->level, loc, "%s", diag_format(&scratch, info->format, copies));
+    tau_arena_free(&scratch);
+    return;
+  }
+
+  if (info->level == TAU_LOG_ERROR) {
+    list->error_count++;
+  }
+
+  // past the limit nothing new is kept, but repeats of the kept diagnostics are still counted
+  bool at_limit = list->policy.limit != 0 && list->count >= list->policy.limit;
+  if (list->policy.fold) {
+    struct tau_diag *same = fold_find(list, code, args, !at_limit);
+    if (same != NULL) {
+      same->repeat_count++;
+      return;
+    }
+  }
+
+  if (at_limit) {
+    list->dropped_count++;
+    return;
+  }
+
+  copy_args(&list->arena, info->arg_count, args, copies);
+  if (list->count == list->capacity) {
+    list->capacity = list->capacity == 0 ? DIAG_LIST_MIN_CAPACITY : list->capacity * 2;
+    list->items = realloc(list->items, list->capacity * sizeof(struct tau_diag));
+    assert(list->items != NULL && "tau_diag_report: out of memory");
+  }
+
+  struct tau_diag *diag = &list->items[list->count++];
+  *diag = (struct tau_diag){
+      .level = info->level,
+      .code = code,
+      .loc = loc,
+      .len = len,
+      .message = diag_format(&list->arena, info->format, copies),
+  };
+  memcpy(diag->args, copies, sizeof(copies));
+}
+
+void tau_diag_writer_init(struct tau_diag_writer *writer, enum tau_diag_format format, FILE *target) {
+  assert(writer != NULL && "tau_diag_writer_init: writer cannot be NULL");
+  assert(target != NULL && "tau_diag_writer_init: target cannot be NULL");
+  *writer = (struct tau_diag_writer){.format = format, .target = target};
+  writer->stream = open_memstream(&writer->buf, &writer->buf_len);
+  assert(writer->stream != NULL && "tau_diag_writer_init: out of memory");
+  if (format == TAU_DIAG_FORMAT_JSON) {
+    fputs("{\"diagnostics\": [", writer->stream);
+  }
+}
+
+static void write_json_string(FILE *out, const char *text) {
+  fputc('"', out);
+  for (const char *c = text; *c != '\0'; c++) {
+    switch (*c) {
+      case '"':
+        fputs("\\\"", out);
+        break;
+      case '\\':
+        fputs("\\\\", out);
+        break;
+      case '\n':
+        fputs("\\n", out);
+        break;
+      case '\t':
+        fputs("\\t", out);
+        break;
+      default:
+        if ((uint8_t)*c < 0x20) {
+          fprintf(out, "\\u%04x", (unsigned)(uint8_t)*c);
+        } else if ((uint8_t)*c < 0x80) {
+          fputc(*c, out);
+        } else {
+          // arguments are source text, so a malformed byte is written as U+FFFD to keep the document valid UTF-8
+          uint8_t len = tau_utf8_sequence_len(c, strnlen(c, 4));
+          if (len == 0) {
+            fputs("\\ufffd", out);
+          } else {
+            fwrite(c, 1, len, out);
+            c += len - 1;
+          }
+        }
+
+        break;
+    }
+  }
+
+  fputc('"', out);
+}
+
+static void writer_add(struct tau_diag_writer *writer, const struct tau_diag *diag) {
+  FILE *out = writer->stream;
+  const char *buf_name = diag->loc.buf_name != NULL ? diag->loc.buf_name : "";
+  if (writer->format == TAU_DIAG_FORMAT_TEXT) {
+    fprintf(out, "%s:%zu:%zu %s[%s]: %s", buf_name, diag->loc.row, diag->loc.col, tau_log_get_level_name(diag->level),
+            tau_diag_get_code_name(diag->code), diag->message);
+    if (diag->repeat_count != 0) {
+      fprintf(out, " (repeated %zu more times)", diag->repeat_count);
+    }
+
+    fputc('\n', out);
+  } else {
+    fputs(writer->written == 0 ? "\n  {\"file\": " : ",\n  {\"file\": ", out);
+    write_json_string(out, buf_name);
+    fprintf(out, ", \"row\": %zu, \"col\": %zu, \"len\": %zu, \"severity\": \"%s\", \"code\": \"%s\", \"message\": ",
+            diag->loc.row, diag->loc.col, diag->len, tau_log_get_level_name(diag->level),
+            tau_diag_get_code_name(diag->code));
+    write_json_string(out, diag->message);
+    fputs(", \"args\": [", out);
+    for (uint8_t i = 0; i < diag_code_table[diag->code].arg_count; i++) {
+      fputs(i == 0 ? "" : ", ", out);
+      write_json_string(out, diag->args[i]);
+    }
+
+    fprintf(out, "], \"repeats\": %zu}", diag->repeat_count);
+  }
+
+  writer->written++;
+}
+
+void tau_diag_writer_add_list(struct tau_diag_writer *writer, const struct tau_diag_list *list) {
+  assert(writer != NULL && writer->stream != NULL && "tau_diag_writer_add_list: writer is not open");
+  assert(list != NULL && "tau_diag_writer_add_list: list cannot be NULL");
+  for (size_t i = 0; i < list->count; i++) {
+    writer_add(writer, &list->items[i]);
+  }
+
+  writer->dropped_count += list->dropped_count;
+}
+
+void tau_diag_writer_finish(struct tau_diag_writer *writer) {
+  assert(writer != NULL && writer->stream != NULL && "tau_diag_writer_finish: writer is not open");
+  if (writer->format == TAU_DIAG_FORMAT_JSON) {
+    fprintf(writer->stream, "%s], \"dropped\": %zu}\n", writer->written == 0 ? "" : "\n", writer->dropped_count);
+  } else if (writer->dropped_count != 0) {
+    fprintf(writer->stream, "note: %zu more diagnostics were dropped\n", writer->dropped_count);
+  }
+
+  fclose(writer->stream);
+  fwrite(writer->buf, 1, writer->buf_len, writer->target);
+  free(writer->buf);
+  *writer = (struct tau_diag_writer){0};
+}
@@ -0,0 +1,105 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_DIAG_H
+#define TAU_DIAG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "arena.h"
+#include "common.h"
+#include "log.h"
+
+#define TAU_DIAG_MAX_ARGS 2
+
+// Everything the lexer, parser and driver can report. Codes are rendered as stable names (E0001...) that tools can
+// match on, so new ones only ever go at the end.
+enum tau_diag_code {
+  TAU_DIAG_NONE,
+  TAU_DIAG_UNKNOWN_CHARACTER,     // character, code point
+  TAU_DIAG_UNCLOSED_STRING,       //
+  TAU_DIAG_UNEXPECTED_TOKEN,      // token text, what was expected instead
+  TAU_DIAG_CANNOT_READ_FILE,      // reason
+  TAU_DIAG_INVALID_UTF8,          // offending byte
+  TAU_DIAG_UNCLOSED_COMMENT,      //
+  TAU_DIAG_INVALID_NUM_LIT,       // literal text
+  TAU_DIAG_NUM_LIT_OUT_OF_RANGE,  // literal text
+  TAU_DIAG_INVALID_ESCAPE,        // escape sequence text
+  TAU_DIAG_CODE_COUNT,
+};
+
+enum tau_diag_format {
+  TAU_DIAG_FORMAT_TEXT,  // one `name:row:col level[code]: message` line per diagnostic
+  TAU_DIAG_FORMAT_JSON,  // a single {"diagnostics": [...], "dropped": n} document
+};
+
+// An argument as it appears in the source, not NUL terminated
+struct tau_diag_arg {
+  const char *text;
+  size_t len;
+};
+
+struct tau_diag {
+  enum tau_log_level level;
+  enum tau_diag_code code;
+  struct tau_loc loc;
+  size_t len;                           // bytes of source covered from loc
+  const char *args[TAU_DIAG_MAX_ARGS];  // NUL terminated copies, as many as the code takes
+  const char *message;                  // the code's message with its arguments in place
+  size_t repeat_count;                  // identical diagnostics folded into this one
+};
+
+// What a list keeps. A generated file with a systematic error can otherwise report millions of diagnostics.
+struct tau_diag_policy {
+  size_t limit;  // diagnostics kept at most, 0 keeps every one
+  bool fold;     // diagnostics with the same code and arguments as a kept one only bump its repeat_count
+};
+
+// Diagnostics collected by a single lexer/parser run instead of being printed, so concurrent runs never share an
+// output stream. Messages and arguments live in the list arena.
+struct tau_diag_list {
+  struct tau_diag *items;
+  size_t count;
+  size_t capacity;
+  size_t error_count;    // every error reported, folded and dropped ones included
+  size_t dropped_count;  // diagnostics past the policy limit
+  struct tau_diag_policy policy;
+  struct tau_arena arena;
+  uint32_t *fold_slots;  // open addressing over item index + 1 when folding, 0 marks an empty slot
+  size_t fold_slot_count;
+};
+
+// Buffers rendered diagnostics in memory and hands them to target in a single write once finished, so the stream lock
+// is taken once and lists rendered from different threads never interleave.
+struct tau_diag_writer {
+  enum tau_diag_format format;
+  FILE *target;
+  FILE *stream;
+  char *buf;
+  size_t buf_len;
+  size_t written;
+  size_t dropped_count;
+};
+
+const char *tau_diag_get_code_name(enum tau_diag_code code);
+
+void tau_diag_list_init(struct tau_diag_list *list);
+void tau_diag_list_free(struct tau_diag_list *list);
+// Only allowed while the list is empty
+void tau_diag_list_set_policy(struct tau_diag_list *list, struct tau_diag_policy policy);
+
+// Appends to the list, or logs right away through tau_log when the list is NULL. The level is the one of the code and
+// args must hold as many arguments as it takes.
+void tau_diag_report(struct tau_diag_list *list, enum tau_diag_code code, struct tau_loc loc, size_t len,
+                     const struct tau_diag_arg *args);
+
+void tau_diag_writer_init(struct tau_diag_writer *writer, enum tau_diag_format format, FILE *target);
+void tau_diag_writer_add_list(struct tau_diag_writer *writer, const struct tau_diag_list *list);
+// Closes the document, notes how many diagnostics were dropped and writes everything to target
+void tau_diag_writer_finish(struct tau_diag_writer *writer);
+
+#endif  // TAU_DIAG_H
@@ -0,0 +1,254 @@
+//
+// Created on 10/17/26.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <tau/driver.h>
+#include <time.h>
+
+#include "common.h"
+#include "diag.h"
+#include "parser_internal.h"
+#include "pool.h"
+
+#define DRIVER_READ_ERROR_MAX 128
+
+struct driver_module {
+  const char *path;
+  size_t size_hint;
+  struct tau_parse_result *parse;
+  size_t diag_offset;  // index of the first diagnostic of this module in the aggregate list
+  bool read_failed;
+  struct tau_diag_list read_diags;  // the single read error of a module that could not be read
+};
+
+struct tau_driver_result {
+  struct driver_module *modules;
+  size_t module_count;
+  struct tau_interner *interner;  // shared by every module
+  bool owns_interner;
+  struct tau_parse_options parse_options;
+  size_t diag_count;
+  struct tau_driver_stats stats;
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void module_fail(struct driver_module *module, int err) {
+  char reason[DRIVER_READ_ERROR_MAX];
+  if (strerror_r(err, reason, sizeof(reason)) != 0) {
+    snprintf(reason, sizeof(reason), "error %d", err);
+  }
+
+  tau_diag_list_init(&module->read_diags);
+  tau_diag_report(&module->read_diags, TAU_DIAG_CANNOT_READ_FILE, (struct tau_loc){.buf_name = module->path}, 0,
+                  (struct tau_diag_arg[]){{reason, strlen(reason)}});
+  module->read_failed = true;
+}
+
+static void parse_module(void *ctx, size_t task, size_t worker) {
+  UNUSED(worker);
+  struct tau_driver_result *result = ctx;
+  struct driver_module *module = &result->modules[task];
+  module->parse = tau_parse_file_with_options(module->path, &result->parse_options);
+  if (module->parse == NULL) {
+    module_fail(module, errno);
+  }
+}
+
+struct driver_order {
+  size_t size;
+  size_t index;
+};
+
+static int compare_by_size_desc(const void *a, const void *b) {
+  size_t size_a = ((const struct driver_order *)a)->size;
+  size_t size_b = ((const struct driver_order *)b)->size;
+  return size_a < size_b ? 1 : size_a > size_b ? -1 : 0;
+}
+
+struct tau_driver_result *tau_driver_parse_files(const char *const *paths, size_t path_count,
+                                                 const struct tau_driver_options *options) {
+  assert((paths != NULL || path_count == 0) && "tau_driver_parse_files: paths cannot be NULL");
+  struct tau_driver_result *result = calloc(1, sizeof(struct tau_driver_result));
+  assert(result != NULL && "tau_driver_parse_files: out of memory");
+  result->module_count = path_count;
+  result->owns_interner = options == NULL || options->interner == NULL;
+  result->interner = result->owns_interner ? tau_interner_new() : options->interner;
+  result->parse_options = (struct tau_parse_options){
+      .interner = result->interner,
+      .diagnostic_limit = options != NULL ? options->diagnostic_limit : 0,
+      .fold_diagnostics = options != NULL && options->fold_diagnostics,
+      .cache_dir = options != NULL ? options->cache_dir : NULL,
+  };
+  result->modules = calloc(path_count > 0 ? path_count : 1, sizeof(struct driver_module));
+  struct driver_order *sizes = malloc((path_count > 0 ? path_count : 1) * sizeof(struct driver_order));
+  size_t *order = malloc((path_count > 0 ? path_count : 1) * sizeof(size_t));
+  assert(result->modules != NULL && sizes != NULL && order != NULL && "tau_driver_parse_files: out of memory");
+
+  uint64_t start = now_ns();
+  for (size_t i = 0; i < path_count; i++) {
+    assert(paths[i] != NULL && "tau_driver_parse_files: path cannot be NULL");
+    struct stat st;
+    result->modules[i].path = paths[i];
+    result->modules[i].size_hint = stat(paths[i], &st) == 0 && st.st_size > 0 ? (size_t)st.st_size : 0;
+    sizes[i] = (struct driver_order){.size = result->modules[i].size_hint, .index = i};
+  }
+
+  // Big modules go first so the tail of the build is made of small ones that balance out across workers
+  qsort(sizes, path_count, sizeof(struct driver_order), compare_by_size_desc);
+  for (size_t i = 0; i < path_count; i++) {
+    order[i] = sizes[i].index;
+  }
+
+  free(sizes);
+  struct tau_pool_stats pool_stats = {0};
+  tau_pool_run(options != NULL ? options->thread_count : 0, order, path_count, parse_module, result, &pool_stats);
+  free(order);
+
+  result->stats = (struct tau_driver_stats){
+      .wall_ns = now_ns() - start,
+      .thread_count = pool_stats.thread_count,
+      .steal_count = pool_stats.steal_count,
+  };
+
+  for (size_t i = 0; i < path_count; i++) {
+    struct driver_module *module = &result->modules[i];
+    module->diag_offset = result->diag_count;
+    if (module->read_failed) {
+      result->diag_count += module->read_diags.count;
+      result->stats.error_count += module->read_diags.error_count;
+      continue;
+    }
+
+    struct tau_parse_stats parse_stats = tau_parse_result_stats(module->parse);
+    result->diag_count += tau_parse_result_diagnostic_count(module->parse);
+    result->stats.error_count += tau_parse_result_error_count(module->parse);
+    result->stats.byte_count += parse_stats.buf_size;
+    result->stats.token_count += parse_stats.token_count;
+    result->stats.node_count += parse_stats.node_count;
+    result->stats.cache_hit_count += parse_stats.cached;
+  }
+
+  return result;
+}
+
+void tau_driver_result_free(struct tau_driver_result *result) {
+  if (result == NULL) {
+    return;
+  }
+
+  for (size_t i = 0; i < result->module_count; i++) {
+    tau_parse_result_free(result->modules[i].parse);
+    if (result->modules[i].read_failed) {
+      tau_diag_list_free(&result->modules[i].read_diags);
+    }
+  }
+
+  free(result->modules);
+  if (result->owns_interner) {
+    tau_interner_free(result->interner);
+  }
+
+  free(result);
+}
+
+bool tau_driver_result_ok(const struct tau_driver_result *result) {
+  assert(result != NULL && "tau_driver_result_ok: result cannot be NULL");
+  for (size_t i = 0; i < result->module_count; i++) {
+    if (result->modules[i].read_failed || !tau_parse_result_ok(result->modules[i].parse)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t tau_driver_result_module_count(const struct tau_driver_result *result) {
+  assert(result != NULL && "tau_driver_result_module_count: result cannot be NULL");
+  return result->module_count;
+}
+
+const char *tau_driver_result_module_path(const struct tau_driver_result *result, size_t index) {
+  assert(result != NULL && "tau_driver_result_module_path: result cannot be NULL");
+  assert(index < result->module_count && "tau_driver_result_module_path: index out of bounds");
+  return result->modules[index].path;
+}
+
+const struct tau_parse_result *tau_driver_result_module(const struct tau_driver_result *result, size_t index) {
+  assert(result != NULL && "tau_driver_result_module: result cannot be NULL");
+  assert(index < result->module_count && "tau_driver_result_module: index out of bounds");
+  return result->modules[index].parse;
+}
+
+struct tau_interner *tau_driver_result_interner(const struct tau_driver_result *result) {
+  assert(result != NULL && "tau_driver_result_interner: result cannot be NULL");
+  return result->interner;
+}
+
+size_t tau_driver_result_diagnostic_count(const struct tau_driver_result *result) {
+  assert(result != NULL && "tau_driver_result_diagnostic_count: result cannot be NULL");
+  return result->diag_count;
+}
+
+struct tau_driver_diagnostic tau_driver_result_diagnostic(const struct tau_driver_result *result, size_t index) {
+  assert(result != NULL && "tau_driver_result_diagnostic: result cannot be NULL");
+  assert(index < result->diag_count && "tau_driver_result_diagnostic: index out of bounds");
+
+  // last module whose first diagnostic is at or before index
+  size_t low = 0;
+  size_t high = result->module_count;
+  while (high - low > 1) {
+    size_t mid = low + (high - low) / 2;
+    if (result->modules[mid].diag_offset <= index) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+
+  const struct driver_module *module = &result->modules[low];
+  if (module->read_failed) {
+    const struct tau_diag *diag = &module->read_diags.items[index - module->diag_offset];
+    return (struct tau_driver_diagnostic){
+        .path = module->path,
+        .diagnostic = {.severity = TAU_PARSE_SEVERITY_ERROR,
+                       .message = diag->message,
+                       .code = tau_diag_get_code_name(diag->code)},
+    };
+  }
+
+  return (struct tau_driver_diagnostic){
+      .path = module->path,
+      .diagnostic = tau_parse_result_diagnostic(module->parse, index - module->diag_offset),
+  };
+}
+
+void tau_driver_result_write_diagnostics(const struct tau_driver_result *result, enum tau_parse_format format,
+                                         FILE *out) {
+  assert(result != NULL && "tau_driver_result_write_diagnostics: result cannot be NULL");
+  struct tau_diag_writer writer;
+  tau_diag_writer_init(&writer, format == TAU_PARSE_FORMAT_JSON ? TAU_DIAG_FORMAT_JSON : TAU_DIAG_FORMAT_TEXT, out);
+  for (size_t i = 0; i < result->module_count; i++) {
+    const struct driver_module *module = &result->modules[i];
+    tau_diag_writer_add_list(&writer, module->read_failed ? &module->read_diags : parse_result_diags(module->parse));
+  }
+
+  tau_diag_writer_finish(&writer);
+}
+
+struct tau_driver_stats tau_driver_result_stats(const struct tau_driver_result *result) {
+  assert(result != NULL && "tau_driver_result_stats: result cannot be NULL");
+  return result->stats;
+}
@@ -0,0 +1,95 @@
+//
+// Created on 10/17/26.
+//
+
+#include "hash.h"
+
+#include <assert.h>
+#include <string.h>
+
+#define HASH_PRIME_1 0x9E3779B185EBCA87ull
+#define HASH_PRIME_2 0xC2B2AE3D27D4EB4Full
+#define HASH_PRIME_3 0x165667B19E3779F9ull
+#define HASH_PRIME_4 0x85EBCA77C2B2AE63ull
+#define HASH_PRIME_5 0x27D4EB2F165667C5ull
+#define HASH_STRIPE_LEN 32
+
+static inline uint64_t rotl64(uint64_t x, int bits) { return (x << bits) | (x >> (64 - bits)); }
+
+// unaligned little endian reads, memcpy compiles down to a single load
+static inline uint64_t read64(const uint8_t *p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint64_t hash_round(uint64_t acc, uint64_t input) {
+  acc += input * HASH_PRIME_2;
+  acc = rotl64(acc, 31);
+  return acc * HASH_PRIME_1;
+}
+
+static inline uint64_t hash_merge_round(uint64_t acc, uint64_t val) {
+  acc ^= hash_round(0, val);
+  return acc * HASH_PRIME_1 + HASH_PRIME_4;
+}
+
+uint64_t tau_hash64(const void *data, size_t len, uint64_t seed) {
+  assert((data != NULL || len == 0) && "tau_hash64: data cannot be NULL");
+  const uint8_t *p = data;
+  const uint8_t *end = p + len;
+  uint64_t h;
+
+  if (len >= HASH_STRIPE_LEN) {
+    uint64_t v1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+    uint64_t v2 = seed + HASH_PRIME_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - HASH_PRIME_1;
+    const uint8_t *limit = end - HASH_STRIPE_LEN;
+    do {
+      v1 = hash_round(v1, read64(p));
+      v2 = hash_round(v2, read64(p + 8));
+      v3 = hash_round(v3, read64(p + 16));
+      v4 = hash_round(v4, read64(p + 24));
+      p += HASH_STRIPE_LEN;
+    } while (p <= limit);
+
+    h = rotl64(v1, 1) + rotl64(v2, 7) + rotl64(v3, 12) + rotl64(v4, 18);
+    h = hash_merge_round(h, v1);
+    h = hash_merge_round(h, v2);
+    h = hash_merge_round(h, v3);
+    h = hash_merge_round(h, v4);
+  } else {
+    h = seed + HASH_PRIME_5;
+  }
+
+  h += (uint64_t)len;
+  for (; p + 8 <= end; p += 8) {
+    h ^= hash_round(0, read64(p));
+    h = rotl64(h, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+  }
+
+  if (p + 4 <= end) {
+    h ^= (uint64_t)read32(p) * HASH_PRIME_1;
+    h = rotl64(h, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+    p += 4;
+  }
+
+  for (; p < end; p++) {
+    h ^= *p * HASH_PRIME_5;
+    h = rotl64(h, 11) * HASH_PRIME_1;
+  }
+
+  h ^= h >> 33;
+  h *= HASH_PRIME_2;
+  h ^= h >> 29;
+  h *= HASH_PRIME_3;
+  h ^= h >> 32;
+  return h;
+}
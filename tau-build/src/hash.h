@@ -0,0 +1,15 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_HASH_H
+#define TAU_HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// XXH64 of len bytes, 32 bytes per round so hashing a source file costs a fraction of lexing it. The value is stable
+// across runs and builds, which is what lets it key anything stored on disk.
+uint64_t tau_hash64(const void *data, size_t len, uint64_t seed);
+
+#endif  // TAU_HASH_H
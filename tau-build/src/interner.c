@@ -0,0 +1,195 @@
+//
+// Created on 10/17/26.
+//
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tau/interner.h>
+#include <threads.h>
+
+#include "arena.h"
+
+#define INTERNER_SHARD_BITS 4
+#define INTERNER_SHARD_COUNT (1u << INTERNER_SHARD_BITS)
+#define INTERNER_SHARD_MASK (INTERNER_SHARD_COUNT - 1)
+#define INTERNER_CHUNK_BITS 12
+#define INTERNER_CHUNK_ENTRIES (1u << INTERNER_CHUNK_BITS)
+#define INTERNER_CHUNK_MASK (INTERNER_CHUNK_ENTRIES - 1)
+#define INTERNER_MAX_CHUNKS 4096u
+#define INTERNER_MIN_SLOTS 64u
+#define INTERNER_CACHE_LINE 64
+
+struct interner_entry {
+  const char *text;
+  uint32_t len;
+  uint32_t hash;
+};
+
+// Strings are spread over shards by hash so threads interning different names rarely wait on the same lock. Entries
+// live in fixed-size chunks that never move once published, which is what lets tau_interner_text skip the lock.
+struct interner_shard {
+  _Alignas(INTERNER_CACHE_LINE) mtx_t lock;
+  struct tau_arena arena;
+  uint32_t *slots;  // open addressing over entry index + 1, 0 marks an empty slot
+  uint32_t slot_count;
+  atomic_uint_least32_t count;
+  _Atomic(struct interner_entry *) chunks[INTERNER_MAX_CHUNKS];
+};
+
+struct tau_interner {
+  struct interner_shard shards[INTERNER_SHARD_COUNT];
+};
+
+static_assert(((uint64_t)INTERNER_MAX_CHUNKS * INTERNER_CHUNK_ENTRIES << INTERNER_SHARD_BITS) < UINT32_MAX &&
+              "interner symbols do not fit in 32 bits");
+
+// FNV-1a, with a final avalanche so both the low (shard) and high (slot) bits are usable
+static uint32_t interner_hash(const char *text, size_t len) {
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < len; i++) {
+    hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+  }
+
+  hash ^= hash >> 16;
+  hash *= 0x7FEB352Du;
+  hash ^= hash >> 15;
+  return hash;
+}
+
+static inline tau_symbol_t symbol_from(uint32_t shard, uint32_t index) {
+  return ((index << INTERNER_SHARD_BITS) | shard) + 1;
+}
+
+static inline struct interner_entry *shard_entry(const struct interner_shard *shard, uint32_t index) {
+  struct interner_entry *chunk =
+      atomic_load_explicit(&shard->chunks[index >> INTERNER_CHUNK_BITS], memory_order_acquire);
+  assert(chunk != NULL && "shard_entry: invalid entry index");
+  return &chunk[index & INTERNER_CHUNK_MASK];
+}
+
+static void shard_rehash(struct interner_shard *shard, uint32_t slot_count) {
+  uint32_t *slots = calloc(slot_count, sizeof(uint32_t));
+  assert(slots != NULL && "shard_rehash: out of memory");
+  uint32_t count = atomic_load_explicit(&shard->count, memory_order_relaxed);
+  for (uint32_t index = 0; index < count; index++) {
+    uint32_t i = (shard_entry(shard, index)->hash >> INTERNER_SHARD_BITS) & (slot_count - 1);
+    while (slots[i] != 0) {
+      i = (i + 1) & (slot_count - 1);
+    }
+
+    slots[i] = index + 1;
+  }
+
+  free(shard->slots);
+  shard->slots = slots;
+  shard->slot_count = slot_count;
+}
+
+static uint32_t shard_push(struct interner_shard *shard, const char *text, uint32_t len, uint32_t hash) {
+  uint32_t index = atomic_load_explicit(&shard->count, memory_order_relaxed);
+  uint32_t chunk = index >> INTERNER_CHUNK_BITS;
+  assert(chunk < INTERNER_MAX_CHUNKS && "shard_push: too many symbols");
+  if ((index & INTERNER_CHUNK_MASK) == 0) {
+    struct interner_entry *entries =
+        tau_arena_alloc(&shard->arena, INTERNER_CHUNK_ENTRIES * sizeof(struct interner_entry));
+    atomic_store_explicit(&shard->chunks[chunk], entries, memory_order_release);
+  }
+
+  char *copy = tau_arena_alloc(&shard->arena, (size_t)len + 1);
+  memcpy(copy, text, len);
+  copy[len] = '\0';
+  *shard_entry(shard, index) = (struct interner_entry){.text = copy, .len = len, .hash = hash};
+  atomic_store_explicit(&shard->count, index + 1, memory_order_release);
+  return index;
+}
+
+struct tau_interner *tau_interner_new(void) {
+  struct tau_interner *interner = aligned_alloc(INTERNER_CACHE_LINE, sizeof(struct tau_interner));
+  assert(interner != NULL && "tau_interner_new: out of memory");
+  memset(interner, 0, sizeof(struct tau_interner));
+  for (uint32_t i = 0; i < INTERNER_SHARD_COUNT; i++) {
+    struct interner_shard *shard = &interner->shards[i];
+    int res = mtx_init(&shard->lock, mtx_plain);
+    assert(res == thrd_success && "tau_interner_new: cannot create shard lock");
+    tau_arena_init(&shard->arena);
+    atomic_init(&shard->count, 0);
+  }
+
+  return interner;
+}
+
+void tau_interner_free(struct tau_interner *interner) {
+  if (interner == NULL) {
+    return;
+  }
+
+  for (uint32_t i = 0; i < INTERNER_SHARD_COUNT; i++) {
+    struct interner_shard *shard = &interner->shards[i];
+    mtx_destroy(&shard->lock);
+    tau_arena_free(&shard->arena);
+    free(shard->slots);
+  }
+
+  free(interner);
+}
+
+tau_symbol_t tau_interner_intern(struct tau_interner *interner, const char *text, size_t len) {
+  assert(interner != NULL && "tau_interner_intern: interner cannot be NULL");
+  assert((text != NULL || len == 0) && "tau_interner_intern: text cannot be NULL");
+  assert(len < UINT32_MAX && "tau_interner_intern: text too long");
+
+  uint32_t hash = interner_hash(text, len);
+  uint32_t shard_id = hash & INTERNER_SHARD_MASK;
+  struct interner_shard *shard = &interner->shards[shard_id];
+  mtx_lock(&shard->lock);
+
+  uint32_t count = atomic_load_explicit(&shard->count, memory_order_relaxed);
+  if ((count + 1) * 2 > shard->slot_count) {
+    shard_rehash(shard, shard->slot_count == 0 ? INTERNER_MIN_SLOTS : shard->slot_count * 2);
+  }
+
+  uint32_t mask = shard->slot_count - 1;
+  uint32_t i = (hash >> INTERNER_SHARD_BITS) & mask;
+  uint32_t index;
+  for (;; i = (i + 1) & mask) {
+    if (shard->slots[i] == 0) {
+      index = shard_push(shard, text, (uint32_t)len, hash);
+      shard->slots[i] = index + 1;
+      break;
+    }
+
+    const struct interner_entry *entry = shard_entry(shard, shard->slots[i] - 1);
+    if (entry->hash == hash && entry->len == len && memcmp(entry->text, text, len) == 0) {
+      index = shard->slots[i] - 1;
+      break;
+    }
+  }
+
+  mtx_unlock(&shard->lock);
+  return symbol_from(shard_id, index);
+}
+
+const char *tau_interner_text(const struct tau_interner *interner, tau_symbol_t symbol, size_t *len) {
+  assert(interner != NULL && "tau_interner_text: interner cannot be NULL");
+  assert(symbol != TAU_SYMBOL_NONE && "tau_interner_text: invalid symbol");
+  const struct interner_shard *shard = &interner->shards[(symbol - 1) & INTERNER_SHARD_MASK];
+  const struct interner_entry *entry = shard_entry(shard, (symbol - 1) >> INTERNER_SHARD_BITS);
+  if (len != NULL) {
+    *len = entry->len;
+  }
+
+  return entry->text;
+}
+
+size_t tau_interner_count(const struct tau_interner *interner) {
+  assert(interner != NULL && "tau_interner_count: interner cannot be NULL");
+  size_t count = 0;
+  for (uint32_t i = 0; i < INTERNER_SHARD_COUNT; i++) {
+    count += atomic_load_explicit(&interner->shards[i].count, memory_order_acquire);
+  }
+
+  return count;
+}
@@ -5,11 +5,16 @@
 #include "lexer.h"
 
 #include <assert.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "log.h"
+#include "num_lit.h"
+#include "scan.h"
 #include "uc_names.h"
 #include "utf8.h"
 
@@ -19,6 +24,9 @@
 #define EXHAUSTIVE_PUNCT_TABLE_COUNT 44
 #define EXHAUSTIVE_KEYWORD_TABLE_COUNT 19
 #define EXHAUSTIVE_TOKEN_NAME_TABLE_COUNT 12
+#define TOKEN_TABLE_MIN_CAPACITY 256
+#define LITERAL_TABLE_MIN_CAPACITY 64
+#define SCAN_INLINE_BYTES 16
 
 // TABLES
 const char *punct_table[] = {
@@ -36,6 +44,33 @@ const char *punct_table[] = {
 };
 static_assert(TAU_PUNCT_COUNT == EXHAUSTIVE_PUNCT_TABLE_COUNT && "outdated exhaustive punct table");
 
+// First byte dispatch for tokenize_as_punct, one table per punct shape
+static const uint8_t punct_single_table[UINT8_MAX + 1] = {
+    ['('] = TAU_PUNCT_LPAR,  [')'] = TAU_PUNCT_RPAR,  ['['] = TAU_PUNCT_LSBR,   [']'] = TAU_PUNCT_RSBR,
+    ['{'] = TAU_PUNCT_LCBR,  ['}'] = TAU_PUNCT_RCBR,  [':'] = TAU_PUNCT_COLON,  ['.'] = TAU_PUNCT_DOT,
+    [','] = TAU_PUNCT_COMMA, ['='] = TAU_PUNCT_EQ,    ['!'] = TAU_PUNCT_BANG,   ['<'] = TAU_PUNCT_LT,
+    ['>'] = TAU_PUNCT_GT,    ['+'] = TAU_PUNCT_PLUS,  ['-'] = TAU_PUNCT_HYPHEN, ['*'] = TAU_PUNCT_AST,
+    ['/'] = TAU_PUNCT_SLASH, ['%'] = TAU_PUNCT_PCT,   ['|'] = TAU_PUNCT_PIPE,   ['&'] = TAU_PUNCT_AMP,
+    ['^'] = TAU_PUNCT_CIRC,  ['~'] = TAU_PUNCT_TILDE, ['\''] = TAU_PUNCT_APOS,
+};
+
+static const uint8_t punct_doubled_table[UINT8_MAX + 1] = {
+    ['='] = TAU_PUNCT_D_EQ,  ['>'] = TAU_PUNCT_D_GT,   ['<'] = TAU_PUNCT_D_LT,
+    ['&'] = TAU_PUNCT_D_AMP, ['|'] = TAU_PUNCT_D_PIPE, [':'] = TAU_PUNCT_D_COLON,
+};
+
+static const uint8_t punct_with_eq_table[UINT8_MAX + 1] = {
+    [':'] = TAU_PUNCT_COLON_EQ, ['!'] = TAU_PUNCT_BANG_EQ,   ['>'] = TAU_PUNCT_GT_EQ,   ['<'] = TAU_PUNCT_LT_EQ,
+    ['+'] = TAU_PUNCT_PLUS_EQ,  ['-'] = TAU_PUNCT_HYPHEN_EQ, ['*'] = TAU_PUNCT_AST_EQ,  ['/'] = TAU_PUNCT_SLASH_EQ,
+    ['%'] = TAU_PUNCT_PCT_EQ,   ['&'] = TAU_PUNCT_AMP_EQ,    ['|'] = TAU_PUNCT_PIPE_EQ, ['^'] = TAU_PUNCT_CIRC_EQ,
+};
+
+static const uint8_t punct_doubled_eq_table[UINT8_MAX + 1] = {
+    ['>'] = TAU_PUNCT_D_GT_EQ,
+    ['<'] = TAU_PUNCT_D_LT_EQ,
+};
+static_assert(TAU_PUNCT_COUNT <= UINT8_MAX && "punct dispatch tables cannot hold every punct");
+
 const char *keyword_table[] = {
     [TAU_KEYWORD_NIL] = "nil",       [TAU_KEYWORD_UNIT] = "unit",
     [TAU_KEYWORD_TRUE] = "true",     [TAU_KEYWORD_FALSE] = "false",
@@ -66,35 +101,83 @@ const char *token_name_table[] = {
 };
 static_assert(TAU_TOKEN_TYPE_COUNT == EXHAUSTIVE_TOKEN_NAME_TABLE_COUNT && "outdated exhaustive token name table");
 
-bool is_space(const uint32_t uc) { return uc == UC_TAB || uc == UC_SPACE; }
+// ASCII character classes, every class the scanners look for is 7-bit so non-ASCII code points have no class
+enum char_class {
+  CHAR_CLASS_SPACE = 1 << 0,
+  CHAR_CLASS_NEWLINE = 1 << 1,
+  CHAR_CLASS_BIN_DIGIT = 1 << 2,
+  CHAR_CLASS_OCT_DIGIT = 1 << 3,
+  CHAR_CLASS_DEC_DIGIT = 1 << 4,
+  CHAR_CLASS_HEX_DIGIT = 1 << 5,
+  CHAR_CLASS_IDENT_START = 1 << 6,
+  CHAR_CLASS_IDENT_BODY = 1 << 7,
+};
 
-bool is_newline(const uint32_t uc) { return uc == UC_NEW_LINE || uc == UC_CARRIAGE_RETURN; }
+#define CHAR_CLASS_WORD (CHAR_CLASS_IDENT_START | CHAR_CLASS_IDENT_BODY)
+#define CHAR_CLASS_HEX_LETTER (CHAR_CLASS_HEX_DIGIT | CHAR_CLASS_WORD)
+#define CHAR_CLASS_DIGITS_FROM_TWO                                                             \
+  (CHAR_CLASS_OCT_DIGIT | CHAR_CLASS_DEC_DIGIT | CHAR_CLASS_HEX_DIGIT | CHAR_CLASS_IDENT_BODY)
+#define CHAR_CLASS_DIGITS_FROM_EIGHT (CHAR_CLASS_DEC_DIGIT | CHAR_CLASS_HEX_DIGIT | CHAR_CLASS_IDENT_BODY)
+
+static const uint8_t ascii_class_table[UC_DELETE] = {
+    ['\t'] = CHAR_CLASS_SPACE,
+    [' '] = CHAR_CLASS_SPACE,
+    ['\n'] = CHAR_CLASS_NEWLINE,
+    ['\r'] = CHAR_CLASS_NEWLINE,
+    ['$'] = CHAR_CLASS_WORD,
+    ['_'] = CHAR_CLASS_WORD,
+    ['0' ... '1'] = CHAR_CLASS_BIN_DIGIT | CHAR_CLASS_DIGITS_FROM_TWO,
+    ['2' ... '7'] = CHAR_CLASS_DIGITS_FROM_TWO,
+    ['8' ... '9'] = CHAR_CLASS_DIGITS_FROM_EIGHT,
+    ['A' ... 'F'] = CHAR_CLASS_HEX_LETTER,
+    ['G' ... 'Z'] = CHAR_CLASS_WORD,
+    ['a' ... 'f'] = CHAR_CLASS_HEX_LETTER,
+    ['g' ... 'z'] = CHAR_CLASS_WORD,
+};
 
-bool is_digit(const uint32_t uc, enum tau_num_base base) {
-  switch (base) {
-    case TAU_NUM_BASE_DEC:
-      return uc >= UC_DIGIT_ZERO && uc <= UC_DIGIT_NINE;
-    case TAU_NUM_BASE_BIN:
-      return uc == UC_DIGIT_ZERO || uc == UC_DIGIT_ONE;
-    case TAU_NUM_BASE_OCT:
-      return uc >= UC_DIGIT_ZERO && uc <= UC_DIGIT_SEVEN;
-    case TAU_NUM_BASE_HEX:
-      return (uc >= UC_DIGIT_ZERO && uc <= UC_DIGIT_NINE) ||
-             (uc >= UC_LATIN_CAPITAL_LETTER_A && uc <= UC_LATIN_CAPITAL_LETTER_F) ||
-             (uc >= UC_LATIN_SMALL_LETTER_A && uc <= UC_LATIN_SMALL_LETTER_F);
-  }
+static const uint8_t num_base_class_table[] = {
+    [TAU_NUM_BASE_DEC] = CHAR_CLASS_DEC_DIGIT,
+    [TAU_NUM_BASE_BIN] = CHAR_CLASS_BIN_DIGIT,
+    [TAU_NUM_BASE_OCT] = CHAR_CLASS_OCT_DIGIT,
+    [TAU_NUM_BASE_HEX] = CHAR_CLASS_HEX_DIGIT,
+};
+
+static inline bool has_class(const uint32_t uc, uint8_t char_class) {
+  return uc < UC_DELETE && (ascii_class_table[uc] & char_class) != 0;
 }
 
-bool is_ident_start(const uint32_t uc) {
-  return uc == UC_DOLLAR_SIGN || uc == UC_LOW_LINE ||
-         (uc >= UC_LATIN_CAPITAL_LETTER_A && uc <= UC_LATIN_CAPITAL_LETTER_Z) ||
-         (uc >= UC_LATIN_SMALL_LETTER_A && uc <= UC_LATIN_SMALL_LETTER_Z);
+// Every character class is ASCII, so a byte of a multibyte sequence never matches one and is taken as is instead of
+// being decoded and checked. Only the unknown character path, where a diagnostic needs the code point, decodes.
+static inline uint8_t dec_cp(const char *ahead, uint32_t *uc) {
+  *uc = (uint8_t)*ahead;
+  return 1;
 }
 
-bool is_ident_body(const uint32_t uc) {
-  return uc == UC_DOLLAR_SIGN || uc == UC_LOW_LINE || (uc >= UC_DIGIT_ZERO && uc <= UC_DIGIT_NINE) ||
-         (uc >= UC_LATIN_CAPITAL_LETTER_A && uc <= UC_LATIN_CAPITAL_LETTER_Z) ||
-         (uc >= UC_LATIN_SMALL_LETTER_A && uc <= UC_LATIN_SMALL_LETTER_Z);
+bool is_space(const uint32_t uc) { return has_class(uc, CHAR_CLASS_SPACE); }
+
+bool is_newline(const uint32_t uc) { return has_class(uc, CHAR_CLASS_NEWLINE); }
+
+bool is_digit(const uint32_t uc, enum tau_num_base base) { return has_class(uc, num_base_class_table[base]); }
+
+bool is_ident_start(const uint32_t uc) { return has_class(uc, CHAR_CLASS_IDENT_START); }
+
+bool is_ident_body(const uint32_t uc) { return has_class(uc, CHAR_CLASS_IDENT_BODY); }
+
+// Most identifiers and indentation runs are short, so the first bytes are classified inline and the vectorized
+// scanners only take over runs longer than that
+static inline size_t scan_class_run(const char *buf, size_t len, uint8_t char_class,
+                                    size_t (*scan)(const char *, size_t)) {
+  size_t inline_len = len < SCAN_INLINE_BYTES ? len : SCAN_INLINE_BYTES;
+  size_t i = 0;
+  while (i < inline_len && has_class((uint8_t)buf[i], char_class)) {
+    i++;
+  }
+
+  if (i == SCAN_INLINE_BYTES) {
+    i += scan(buf + i, len - i);
+  }
+
+  return i;
 }
 
 void move_len_ahead(struct tau_token *cur, const char *ahead) {
@@ -120,28 +203,185 @@ void skip_spaces(struct tau_token *cur) {
 
   uint32_t uc = 0;
   uint8_t uc_len;
-  size_t col_count = cur->loc.col;
-  size_t row_count = cur->loc.row;
   const char *ahead = cur->buf;
 
-  uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+  uc_len = dec_cp(ahead, &uc);
   if (is_space(uc) || (is_newline(uc) && should_omit_newlines(cur))) {
-    do {
-      if (is_newline(uc)) {
-        col_count = 0;
-        row_count += 1;
-      } else {
-        col_count += 1;
+    ahead += uc_len;
+    ahead += scan_class_run(ahead, cur->rem - uc_len, CHAR_CLASS_SPACE, tau_scan_spaces);
+    move_base_ahead(cur, ahead);
+  }
+}
+
+// Location of a byte inside or ahead of the token being lexed, which only differs from the token in where it starts
+static struct tau_loc loc_at(const struct tau_token *cur, const char *at) {
+  struct tau_token token = *cur;
+  token.buf = at;
+  token.len = 0;
+  token.rem = cur->rem - (at - cur->buf);
+  return tau_token_loc(&token);
+}
+
+static void report_invalid_utf8(const struct tau_token *cur, const char *at) {
+  char invalid_byte[8] = {0};
+  snprintf(invalid_byte, sizeof(invalid_byte), "0x%02X", (uint8_t)*at);
+  tau_diag_report(cur->diags, TAU_DIAG_INVALID_UTF8, loc_at(cur, at), 1,
+                  (struct tau_diag_arg[]){{invalid_byte, strlen(invalid_byte)}});
+}
+
+// String bodies and comments are skipped without classifying their bytes, so they are validated as a whole instead,
+// ASCII a vector at a time. Every byte that does not start a well formed sequence is reported on its own, the same as
+// the unknown character path does for bytes between tokens.
+static void check_utf8(const struct tau_token *cur, const char *buf, size_t len) {
+  size_t offset = 0;
+  while ((offset += tau_utf8_validate(buf + offset, len - offset)) < len) {
+    report_invalid_utf8(cur, buf + offset);
+    offset++;
+  }
+}
+
+// Length of the comment at buf, 0 if there is none. Line comments stop before their newline so that it still ends the
+// line. The end of a block comment is found with memchr, comment bodies are never decoded. A block comment without an
+// end takes the rest of the buffer and clears closed.
+static size_t comment_len(const char *buf, size_t rem, bool *closed) {
+  *closed = true;
+  if (rem < 2 || buf[0] != '/') {
+    return 0;
+  }
+
+  if (buf[1] == '/') {
+    const char *newline = memchr(buf, '\n', rem);
+    return newline != NULL ? (size_t)(newline - buf) : rem;
+  }
+
+  if (buf[1] != '*') {
+    return 0;
+  }
+
+  const char *end = buf + rem;
+  for (const char *star = buf + 2; (star = memchr(star, '*', end - star)) != NULL; star++) {
+    if (star + 1 < end && star[1] == '/') {
+      return (size_t)(star + 2 - buf);
+    }
+  }
+
+  *closed = false;
+  return rem;
+}
+
+// `///` and `/** */`, while longer runs such as `////` or `/***` are plain rulers and `/**/` is empty
+static bool is_doc_comment(const char *buf, size_t len) {
+  return len >= 3 && buf[2] == buf[1] && (len == 3 || buf[3] != buf[1]) && !(buf[1] == '*' && len == 4);
+}
+
+// Spaces and comments after the token start a line when it is an end of line or where lexing starts
+static bool starts_line(const struct tau_token *prev) {
+  return prev->type == TAU_TOKEN_TYPE_EOL || (prev->type == TAU_TOKEN_TYPE_NONE && prev->len == 0);
+}
+
+// Spaces and comments before a token. Once a comment that starts a line is skipped, which is one right after an end of
+// line token or at the start of lexing, the newlines after it are skipped too: a comment alone on its lines, such as a
+// license header, never makes an end of line token of its own.
+static void skip_trivia(struct tau_token *cur, bool line_start) {
+  bool skip_newlines = false;
+  while (cur->rem > 0) {
+    skip_spaces(cur);
+    if (cur->rem == 0) {
+      return;
+    }
+
+    if (skip_newlines && is_newline((uint8_t)*cur->buf)) {
+      move_base_ahead(cur, cur->buf + 1);
+      continue;
+    }
+
+    bool closed;
+    size_t len = comment_len(cur->buf, cur->rem, &closed);
+    if (len == 0) {
+      return;
+    }
+
+    if (!closed) {
+      tau_diag_report(cur->diags, TAU_DIAG_UNCLOSED_COMMENT, tau_token_loc(cur), len, NULL);
+    }
+
+    check_utf8(cur, cur->buf, len);
+
+    // comments are rare enough that the mode is only checked once one is found
+    if (cur->keep_docs && line_start && is_doc_comment(cur->buf, len)) {
+      cur->doc = cur->doc != NULL ? cur->doc : cur->buf;
+      cur->doc_len = (size_t)(cur->buf + len - cur->doc);
+    }
+
+    move_base_ahead(cur, cur->buf + len);
+    skip_newlines = line_start;
+  }
+}
+
+// Lexing can go on from at inside the comment of len bytes at buf once its opening stands right before at: at starts a
+// code point, so no error before it depends on the bytes from at on, and is not the slash closing the comment
+static bool comment_resumable(const char *buf, size_t len, bool closed, const char *at) {
+  return ((uint8_t)*at & 0xC0) != 0x80 && !(closed && buf[1] == '*' && at + 1 == buf + len);
+}
+
+struct tau_trivia_cut tau_token_trivia_cut(struct tau_token prev, const char *limit) {
+  assert(limit >= prev.buf + prev.len && "tau_token_trivia_cut: limit is behind the token");
+  struct tau_token cur = prev;
+  cur.buf = prev.buf + prev.len;
+  cur.len = 0;
+  bool line_start = starts_line(&prev);
+  enum tau_token_type type = line_start ? TAU_TOKEN_TYPE_EOL : TAU_TOKEN_TYPE_PUNCT;
+  struct tau_trivia_cut cut = {.at = cur.buf, .stand_in = "", .type = type};
+  bool skip_newlines = false;
+  // walks the way skip_trivia does, each of its passes can be started over from where it begins
+  while (cur.rem > 0 && cur.buf <= limit) {
+    cut = (struct tau_trivia_cut){.at = cur.buf, .stand_in = skip_newlines ? "/**/" : "", .type = type};
+    const char *run = cur.buf;
+    skip_spaces(&cur);
+    // after the first byte of a run, which can be a newline inside brackets, spaces only go on with it
+    if (cur.buf > limit) {
+      cut.at = limit > run ? limit : run;
+      return cut;
+    }
+
+    if (cur.rem == 0) {
+      return cut;
+    }
+
+    if (skip_newlines && is_newline((uint8_t)*cur.buf)) {
+      move_base_ahead(&cur, cur.buf + 1);
+      continue;
+    }
+
+    bool closed;
+    size_t len = comment_len(cur.buf, cur.rem, &closed);
+    if (len == 0) {
+      return cut;
+    }
+
+    // a comment can be started over from its opening, doc comments are kept whole for the token after them
+    bool doc = cur.keep_docs && line_start && is_doc_comment(cur.buf, len);
+    if (doc || cur.buf + len > limit) {
+      const char *at = limit;
+      while (!doc && at > cur.buf + 2 && !comment_resumable(cur.buf, len, closed, at)) {
+        at--;
       }
 
-      ahead += uc_len;
-      uc_len = tau_dec_bytes_to_cp(ahead, &uc);
-    } while (is_space(uc));
+      cut.at = cur.buf;
+      if (!doc && at >= cur.buf + 2 && comment_resumable(cur.buf, len, closed, at)) {
+        // a space after the opening so that it never reads as a doc comment
+        cut = (struct tau_trivia_cut){.at = at, .stand_in = cur.buf[1] == '*' ? "/* " : "// ", .type = type,
+                                      .comment = cur.buf, .comment_closed = closed};
+      }
 
-    move_base_ahead(cur, ahead);
-    cur->loc.col = col_count;
-    cur->loc.row = row_count;
+      return cut;
+    }
+
+    move_base_ahead(&cur, cur.buf + len);
+    skip_newlines = line_start;
   }
+
+  return cut;
 }
 
 bool tokenize_as_eol(struct tau_token *cur) {
@@ -150,34 +390,48 @@ bool tokenize_as_eol(struct tau_token *cur) {
 
   uint32_t uc = 0;
   uint8_t uc_len;
-  size_t col_count = cur->loc.col;
-  size_t row_count = cur->loc.row;
   const char *ahead = cur->buf;
 
-  uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+  uc_len = dec_cp(ahead, &uc);
   if (is_newline(uc) || uc == UC_SEMICOLON) {
-    do {
-      if (is_newline(uc)) {
-        col_count = 0;
-        row_count += 1;
-      } else {
-        col_count += 1;
+    // Comments on lines of their own are part of the end of line, so the next token starts right at the next line of
+    // code. Doc comments kept for the next token and unclosed block comments, which need reporting, are left out.
+    for (;;) {
+      ahead += uc_len;
+      bool closed;
+      size_t len = comment_len(ahead, cur->rem - (ahead - cur->buf), &closed);
+      if (len != 0 && closed && !(cur->keep_docs && is_doc_comment(ahead, len))) {
+        check_utf8(cur, ahead, len);
+        uc_len = 0;
+        ahead += len;
+        continue;
       }
 
-      ahead += uc_len;
-      uc_len = tau_dec_bytes_to_cp(ahead, &uc);
-    } while (is_space(uc) || is_newline(uc) || uc == UC_SEMICOLON);
+      uc_len = dec_cp(ahead, &uc);
+      if (!is_space(uc) && !is_newline(uc) && uc != UC_SEMICOLON) {
+        break;
+      }
+    }
 
     move_len_ahead(cur, ahead);
     cur->type = TAU_TOKEN_TYPE_EOL;
-    cur->loc.col = col_count;
-    cur->loc.row = row_count;
     return true;
   }
 
   return false;
 }
 
+static void decode_num_lit(struct tau_token *cur) {
+  enum tau_num_lit_status status =
+      cur->type == TAU_TOKEN_TYPE_INT_LIT
+          ? tau_num_lit_decode_int(cur->buf, cur->len, cur->num_base, &cur->literal.int_value)
+          : tau_num_lit_decode_float(cur->buf, cur->len, &cur->literal.flt_value);
+  if (status != TAU_NUM_LIT_OK) {
+    enum tau_diag_code code = status == TAU_NUM_LIT_INVALID ? TAU_DIAG_INVALID_NUM_LIT : TAU_DIAG_NUM_LIT_OUT_OF_RANGE;
+    tau_diag_report(cur->diags, code, tau_token_loc(cur), cur->len, (struct tau_diag_arg[]){{cur->buf, cur->len}});
+  }
+}
+
 bool tokenize_as_num_lit(struct tau_token *cur) {
   assert(cur != NULL && "tokenize_as_number: cur token cannot be NULL");
   assert(cur->buf != NULL && "tokenize_as_number: cur buffer cannot be NULL");
@@ -187,7 +441,7 @@ bool tokenize_as_num_lit(struct tau_token *cur) {
   enum tau_num_base base = TAU_NUM_BASE_DEC;
   const char *ahead = cur->buf;
 
-  uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+  uc_len = dec_cp(ahead, &uc);
   if (is_digit(uc, base)) {
     if (cur->rem > DIGITS_BASE_PREFIX_LEN && strncmp(ahead, "0b", DIGITS_BASE_PREFIX_LEN) == 0) {
       base = TAU_NUM_BASE_BIN;
@@ -202,13 +456,13 @@ bool tokenize_as_num_lit(struct tau_token *cur) {
 
     do {
       ahead += uc_len;
-      uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+      uc_len = dec_cp(ahead, &uc);
     } while (is_digit(uc, base));
 
     if (base == TAU_NUM_BASE_DEC && *ahead == '.') {
       do {
         ahead += uc_len;
-        uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+        uc_len = dec_cp(ahead, &uc);
       } while (is_digit(uc, base));
 
       if (strncmp(ahead, "e+", EXPONENT_WITH_SIGN_PREFIX_LEN) == 0 ||
@@ -216,88 +470,191 @@ bool tokenize_as_num_lit(struct tau_token *cur) {
         uc_len = 2;
         do {
           ahead += uc_len;
-          uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+          uc_len = dec_cp(ahead, &uc);
         } while (is_digit(uc, base));
       }
 
       move_len_ahead(cur, ahead);
       cur->type = TAU_TOKEN_TYPE_FLT_LIT;
       cur->num_base = base;
+      decode_num_lit(cur);
       return true;
     }
 
     move_len_ahead(cur, ahead);
     cur->type = TAU_TOKEN_TYPE_INT_LIT;
     cur->num_base = base;
+    decode_num_lit(cur);
     return true;
   }
 
   return false;
 }
-// "\'" | "\"" | "\\" | "\n" | "\r" | "\t" | "\b" | "\f" | "\v" | "\0"
-bool skip_escape_seq(const char *ahead, uint8_t *len) {
-  if (strncmp(ahead, "\\'", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\n", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\r", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\t", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\b", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\f", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\v", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\0", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\\"", ESCAPE_SEQUENCE_PREFIX_LEN) == 0 ||
-      strncmp(ahead, "\\\\", ESCAPE_SEQUENCE_PREFIX_LEN) == 0) {
-    *len += 2;
-    return true;
-  } else if (strncmp(ahead, "\\x", ESCAPE_SEQUENCE_PREFIX_LEN) == 0) {
-    *len += 4;
-    return true;
-  } else if (strncmp(ahead, "\\u", ESCAPE_SEQUENCE_PREFIX_LEN) == 0) {
-    *len += 6;
-    return true;
-  } else if (strncmp(ahead, "\\U", ESCAPE_SEQUENCE_PREFIX_LEN) == 0) {
-    *len += 10;
-    return true;
+// What the escape after the backslash stands for, "\'" | "\"" | "\\" | "\n" | "\r" | "\t" | "\b" | "\f" | "\v" | "\0"
+static const char simple_escape_table[UINT8_MAX + 1] = {
+    ['\''] = '\'', ['"'] = '"',  ['\\'] = '\\', ['n'] = '\n', ['r'] = '\r',
+    ['t'] = '\t',  ['b'] = '\b', ['f'] = '\f',  ['v'] = '\v', ['0'] = '\0',
+};
+
+// Hex digits after "\x", "\u" and "\U"
+static const uint8_t hex_escape_digits_table[UINT8_MAX + 1] = {['x'] = 2, ['u'] = 4, ['U'] = 8};
+
+static inline uint32_t hex_digit_value(char c) {
+  return c <= '9' ? (uint32_t)(c - '0') : (uint32_t)((c | 0x20) - 'a' + 10);
+}
+
+// The escape sequence at ahead, backslash included. Returns how many bytes it takes and writes the bytes it stands for
+// to dest, or returns 0 when it is not a valid one: "\x" takes any byte, "\u" and "\U" a code point that is no
+// surrogate, encoded as UTF-8.
+static uint8_t decode_escape_seq(const char *ahead, const char *end, char *dest, uint8_t *dest_len) {
+  if (end - ahead < ESCAPE_SEQUENCE_PREFIX_LEN) {
+    return 0;
   }
 
-  return false;
+  uint8_t escape = (uint8_t)ahead[1];
+  if (simple_escape_table[escape] != '\0' || escape == '0') {
+    *dest = simple_escape_table[escape];
+    *dest_len = 1;
+    return ESCAPE_SEQUENCE_PREFIX_LEN;
+  }
+
+  uint8_t digits = hex_escape_digits_table[escape];
+  if (digits == 0 || end - ahead < ESCAPE_SEQUENCE_PREFIX_LEN + digits) {
+    return 0;
+  }
+
+  uint32_t value = 0;
+  for (const char *digit = ahead + ESCAPE_SEQUENCE_PREFIX_LEN; digit < ahead + ESCAPE_SEQUENCE_PREFIX_LEN + digits;
+       digit++) {
+    if (!is_digit((uint8_t)*digit, TAU_NUM_BASE_HEX)) {
+      return 0;
+    }
+
+    value = value << 4 | hex_digit_value(*digit);
+  }
+
+  if (escape == 'x') {
+    *dest = (char)value;
+    *dest_len = 1;
+  } else if (value <= UC_MAX && (value < UC_SURROGATE_FIRST || value > UC_SURROGATE_LAST)) {
+    *dest_len = tau_enc_cp_to_bytes(value, dest);
+  } else {
+    return 0;
+  }
+
+  return ESCAPE_SEQUENCE_PREFIX_LEN + digits;
+}
+
+// Reports the escape at ahead with the hex digits it has, a backslash that ends the line is left to the unclosed
+// string error
+static void report_invalid_escape(const struct tau_token *cur, const char *ahead, const char *end) {
+  if (end - ahead < ESCAPE_SEQUENCE_PREFIX_LEN || is_newline((uint8_t)ahead[1])) {
+    return;
+  }
+
+  size_t len = ESCAPE_SEQUENCE_PREFIX_LEN;
+  uint8_t digits = hex_escape_digits_table[(uint8_t)ahead[1]];
+  if (digits == 0) {
+    uint8_t uc_len = tau_utf8_sequence_len(ahead + 1, end - ahead - 1);
+    len += uc_len > 1 ? uc_len - 1 : 0;
+  }
+
+  while (digits > 0 && ahead + len < end && is_digit((uint8_t)ahead[len], TAU_NUM_BASE_HEX)) {
+    len++;
+    digits--;
+  }
+
+  tau_diag_report(cur->diags, TAU_DIAG_INVALID_ESCAPE, loc_at(cur, ahead), len, (struct tau_diag_arg[]){{ahead, len}});
+}
+
+size_t tau_str_lit_decode(const char *body, size_t len, char *dest) {
+  assert((body != NULL || len == 0) && "tau_str_lit_decode: body cannot be NULL");
+  const char *ahead = body;
+  const char *end = body + len;
+  char *out = dest;
+  while (ahead < end) {
+    // runs without escapes are copied whole
+    size_t run = tau_scan_str_body(ahead, end - ahead);
+    memcpy(out, ahead, run);
+    out += run;
+    ahead += run;
+    if (ahead == end) {
+      break;
+    }
+
+    uint8_t decoded_len = 0;
+    uint8_t escape_len = *ahead == '\\' ? decode_escape_seq(ahead, end, out, &decoded_len) : 0;
+    if (escape_len == 0) {
+      *out++ = *ahead++;
+    } else {
+      out += decoded_len;
+      ahead += escape_len;
+    }
+  }
+
+  return out - dest;
+}
+
+// Literals without escapes go to the pool straight from the buffer, the others are decoded in place at its end
+static void intern_str_lit(struct tau_token *cur, const char *body, size_t len, bool escaped) {
+  uint32_t offset;
+  if (escaped) {
+    char *dest = tau_str_pool_reserve(cur->strings, len);
+    len = tau_str_lit_decode(body, len, dest);
+    offset = tau_str_pool_commit(cur->strings, len);
+  } else {
+    offset = tau_str_pool_intern(cur->strings, body, len);
+  }
+
+  cur->literal.str_value.offset = offset;
+  cur->literal.str_value.len = (uint32_t)len;
 }
 
 bool tokenize_as_str_lit(struct tau_token *cur) {
-  assert(cur != NULL && "tokenize_as_number: cur token cannot be NULL");
-  assert(cur->buf != NULL && "tokenize_as_number: cur buffer cannot be NULL");
+  assert(cur != NULL && "tokenize_as_str_lit: cur token cannot be NULL");
+  assert(cur->buf != NULL && "tokenize_as_str_lit: cur buffer cannot be NULL");
 
-  uint32_t uc = 0;
-  uint8_t uc_len;
   const char *ahead = cur->buf;
-
-  uc_len = tau_dec_bytes_to_cp(ahead, &uc);
-  if (uc == UC_QUOTATION_MARK) {
+  const char *end = cur->buf + cur->rem;
+  if (*ahead == '"') {
     // We accept the current double quote
-    ahead += uc_len;
-    uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+    ahead += 1;
+
+    // Consume everything up to the closing quote or a new line, stopping only to check escape sequences. UTF-8
+    // continuation bytes are never ASCII so multi-byte code points can be skipped byte by byte and the body validated
+    // once its end is known. An invalid escape only takes its backslash, so a quote or new line among its would be
+    // digits still ends the literal.
+    bool escaped = false;
+    while (true) {
+      ahead += tau_scan_str_body(ahead, end - ahead);
+      if (ahead == end || *ahead != '\\') {
+        break;
+      }
 
-    // Consume all unicode characters
-    do {
-      // look ahead for escape sequences
-      if (!skip_escape_seq(ahead, &uc_len)) {
-        // stop if a new line or other double quote is found
-        if (uc == UC_QUOTATION_MARK || is_newline(uc)) {
-          break;
-        }
+      char decoded[4];
+      uint8_t decoded_len = 0;
+      uint8_t escape_len = decode_escape_seq(ahead, end, decoded, &decoded_len);
+      if (escape_len == 0) {
+        report_invalid_escape(cur, ahead, end);
+        escape_len = 1;
       }
 
-      ahead += uc_len;
-      uc_len = tau_dec_bytes_to_cp(ahead, &uc);
-    } while (uc_len > 0 && uc_len <= 4);
+      escaped = true;
+      ahead += escape_len;
+    }
 
-    if (uc == UC_QUOTATION_MARK) {
-      ahead += uc_len;
+    check_utf8(cur, cur->buf + 1, ahead - cur->buf - 1);
+    if (ahead < end && *ahead == '"') {
+      if (cur->strings != NULL) {
+        intern_str_lit(cur, cur->buf + 1, ahead - cur->buf - 1, escaped);
+      }
+
+      ahead += 1;
       move_len_ahead(cur, ahead);
       cur->type = TAU_TOKEN_TYPE_STR_LIT;
     } else {
       move_len_ahead(cur, ahead);
-      tau_log(TAU_LOG_ERROR, cur->loc,
-              "unclosed string literal, new line (U+000A) found before quotation mark (\" U+0022)");
+      tau_diag_report(cur->diags, TAU_DIAG_UNCLOSED_STRING, tau_token_loc(cur), cur->len, NULL);
       cur->type = TAU_TOKEN_TYPE_NONE;
     }
 
@@ -310,17 +667,104 @@ bool tokenize_as_str_lit(struct tau_token *cur) {
 bool tokenize_as_punct(struct tau_token *cur) {
   assert(cur != NULL && "tokenize_as_punct: cur token cannot be NULL");
   assert(cur->buf != NULL && "tokenize_as_punct: cur buffer cannot be NULL");
-  for (enum tau_punct i = TAU_PUNCT_NONE + 1; i < TAU_PUNCT_COUNT; i++) {
-    const char *comparing_punct = punct_table[i];
-    size_t comparing_punct_len = strlen(comparing_punct);
-    if (strncmp(cur->buf, comparing_punct, comparing_punct_len) == 0) {
-      move_len_ahead(cur, cur->buf + comparing_punct_len);
-      cur->type = TAU_TOKEN_TYPE_PUNCT;
-      cur->punct = i;
-      return true;
-    }
+
+  // maximal munch, longest shape first: `cc=`, `cc`, `c=` and then `c` alone
+  const uint8_t *ahead = (const uint8_t *)cur->buf;
+  uint8_t first = ahead[0];
+  enum tau_punct punct;
+  size_t len;
+  if (cur->rem >= 3 && punct_doubled_eq_table[first] != TAU_PUNCT_NONE && ahead[1] == first && ahead[2] == '=') {
+    punct = punct_doubled_eq_table[first];
+    len = 3;
+  } else if (cur->rem >= 2 && punct_doubled_table[first] != TAU_PUNCT_NONE && ahead[1] == first) {
+    punct = punct_doubled_table[first];
+    len = 2;
+  } else if (cur->rem >= 2 && punct_with_eq_table[first] != TAU_PUNCT_NONE && ahead[1] == '=') {
+    punct = punct_with_eq_table[first];
+    len = 2;
+  } else if (punct_single_table[first] != TAU_PUNCT_NONE) {
+    punct = punct_single_table[first];
+    len = 1;
+  } else {
+    return false;
+  }
+
+  move_len_ahead(cur, cur->buf + len);
+  cur->type = TAU_TOKEN_TYPE_PUNCT;
+  cur->punct = punct;
+  return true;
+}
+
+static enum tau_keyword keyword_or_none(const char *word, size_t len, enum tau_keyword keyword) {
+  return memcmp(word, keyword_table[keyword], len) == 0 ? keyword : TAU_KEYWORD_NONE;
+}
+
+// Keywords are told apart by their exact length and then their first byte, so an identifier costs at most one
+// memcmp against a single candidate keyword (and prefixes like `letter` are never taken for `let`).
+static enum tau_keyword classify_keyword(const char *word, size_t len) {
+  switch (len) {
+    case 2:
+      switch (word[0]) {
+        case 'a':
+          return keyword_or_none(word, len, TAU_KEYWORD_AS);
+        case 'i':
+          return keyword_or_none(word, len, TAU_KEYWORD_IF);
+        default:
+          return TAU_KEYWORD_NONE;
+      }
+    case 3:
+      switch (word[0]) {
+        case 'l':
+          return keyword_or_none(word, len, TAU_KEYWORD_LET);
+        case 'n':
+          return keyword_or_none(word, len, TAU_KEYWORD_NIL);
+        default:
+          return TAU_KEYWORD_NONE;
+      }
+    case 4:
+      switch (word[0]) {
+        case 'e':
+          return word[1] == 'l' && word[2] == 'i' ? keyword_or_none(word, len, TAU_KEYWORD_ELIF)
+                                                  : keyword_or_none(word, len, TAU_KEYWORD_ELSE);
+        case 'p':
+          return keyword_or_none(word, len, TAU_KEYWORD_PROC);
+        case 't':
+          return word[1] == 'r' ? keyword_or_none(word, len, TAU_KEYWORD_TRUE)
+                                : keyword_or_none(word, len, TAU_KEYWORD_TYPE);
+        case 'u':
+          return keyword_or_none(word, len, TAU_KEYWORD_UNIT);
+        default:
+          return TAU_KEYWORD_NONE;
+      }
+    case 5:
+      switch (word[0]) {
+        case 'b':
+          return keyword_or_none(word, len, TAU_KEYWORD_BREAK);
+        case 'f':
+          return keyword_or_none(word, len, TAU_KEYWORD_FALSE);
+        case 'w':
+          return keyword_or_none(word, len, TAU_KEYWORD_WHILE);
+        default:
+          return TAU_KEYWORD_NONE;
+      }
+    case 6:
+      switch (word[0]) {
+        case 'e':
+          return keyword_or_none(word, len, TAU_KEYWORD_EXTERN);
+        case 'm':
+          return keyword_or_none(word, len, TAU_KEYWORD_MODULE);
+        case 'r':
+          return keyword_or_none(word, len, TAU_KEYWORD_RETURN);
+        default:
+          return TAU_KEYWORD_NONE;
+      }
+    case 8:
+      return keyword_or_none(word, len, TAU_KEYWORD_CONTINUE);
+    case 9:
+      return keyword_or_none(word, len, TAU_KEYWORD_PROTOTYPE);
+    default:
+      return TAU_KEYWORD_NONE;
   }
-  return false;
 }
 
 bool tokenize_as_word(struct tau_token *cur) {
@@ -332,23 +776,12 @@ bool tokenize_as_word(struct tau_token *cur) {
   const char *start = cur->buf;
   const char *ahead = cur->buf;
 
-  uc_len = tau_dec_bytes_to_cp(ahead, &uc);
+  uc_len = dec_cp(ahead, &uc);
   if (is_ident_start(uc)) {
-    do {
-      ahead += uc_len;
-      uc_len = tau_dec_bytes_to_cp(ahead, &uc);
-    } while (is_ident_body(uc));
-
-    cur->keyword = TAU_KEYWORD_NONE;
-    for (enum tau_keyword i = TAU_KEYWORD_NONE + 1; i < TAU_KEYWORD_COUNT; i++) {
-      const char *comparing_keyword = keyword_table[i];
-      size_t comparing_keyword_len = strlen(comparing_keyword);
-      if (strncmp(start, comparing_keyword, comparing_keyword_len) == 0) {
-        cur->keyword = i;
-        break;
-      }
-    }
+    ahead += uc_len;
+    ahead += scan_class_run(ahead, cur->rem - uc_len, CHAR_CLASS_IDENT_BODY, tau_scan_ident_body);
 
+    cur->keyword = classify_keyword(start, ahead - start);
     move_len_ahead(cur, ahead);
     if (cur->keyword == TAU_KEYWORD_TRUE || cur->keyword == TAU_KEYWORD_FALSE) {
       cur->type = TAU_TOKEN_TYPE_BOL_LIT;
@@ -413,9 +846,14 @@ struct tau_token tau_token_start(const char *name, const char *buf_data, size_t
       .par_balance = 0,
       .sbr_balance = 0,
       .cbr_balance = 0,
-      .loc.buf_name = name,
-      .loc.row = 0,
-      .loc.col = 0,
+      .buf_name = name,
+      .buf_data = buf_data,
+      .diags = NULL,
+      .lines = NULL,
+      .strings = NULL,
+      .doc = NULL,
+      .doc_len = 0,
+      .keep_docs = false,
       .type = TAU_TOKEN_TYPE_NONE,
       .punct = TAU_PUNCT_NONE,
       .keyword = TAU_KEYWORD_NONE,
@@ -431,9 +869,14 @@ struct tau_token tau_token_next(const struct tau_token prev) {
       .par_balance = prev.par_balance,
       .sbr_balance = prev.sbr_balance,
       .cbr_balance = prev.cbr_balance,
-      .loc.buf_name = prev.loc.buf_name,
-      .loc.row = prev.loc.row,
-      .loc.col = prev.loc.col + prev.len,
+      .buf_name = prev.buf_name,
+      .buf_data = prev.buf_data,
+      .diags = prev.diags,
+      .lines = prev.lines,
+      .strings = prev.strings,
+      .doc = NULL,
+      .doc_len = 0,
+      .keep_docs = prev.keep_docs,
       .type = TAU_TOKEN_TYPE_EOF,
       .punct = TAU_PUNCT_NONE,
       .keyword = TAU_KEYWORD_NONE,
@@ -445,8 +888,11 @@ struct tau_token tau_token_next(const struct tau_token prev) {
     return cur;
   }
 
-  // Skip spaces and count offsets for token begin, and row/col
-  skip_spaces(&cur);
+  // Skip spaces and comments up to the token begin, a token of no length is where lexing started
+  skip_trivia(&cur, starts_line(&prev));
+  if (*cur.buf == '\0' || cur.rem == 0) {
+    return cur;
+  }
 
   // If new line found, tokenize as EOL
   if (tokenize_as_eol(&cur)) {
@@ -478,12 +924,192 @@ struct tau_token tau_token_next(const struct tau_token prev) {
   }
 
   // Token it's not recognized, but we still have to skip it to avoid infinite loops
+  if (tau_utf8_sequence_len(cur.buf, cur.rem) == 0) {
+    report_invalid_utf8(&cur, cur.buf);
+    move_len_ahead(&cur, cur.buf + 1);
+    cur.type = TAU_TOKEN_TYPE_NONE;
+    return cur;
+  }
+
   uint32_t unknown_uc = 0;
   uint8_t unknown_uc_len = tau_dec_bytes_to_cp(cur.buf, &unknown_uc);
   char unknown_uc_enc[10] = {0};
+  char unknown_uc_name[16] = {0};
   tau_enc_cp_to_bytes(unknown_uc, unknown_uc_enc);
-  tau_log(TAU_LOG_ERROR, cur.loc, "unknown unicode character `%s` (U+%ld)", unknown_uc_enc, unknown_uc);
+  snprintf(unknown_uc_name, sizeof(unknown_uc_name), "U+%04" PRIX32, unknown_uc);
+  tau_diag_report(cur.diags, TAU_DIAG_UNKNOWN_CHARACTER, tau_token_loc(&cur), unknown_uc_len,
+                  (struct tau_diag_arg[]){{unknown_uc_enc, strlen(unknown_uc_enc)},
+                                          {unknown_uc_name, strlen(unknown_uc_name)}});
   move_len_ahead(&cur, cur.buf + unknown_uc_len);
   cur.type = TAU_TOKEN_TYPE_NONE;
   return cur;
 }
+
+struct tau_loc tau_token_loc(const struct tau_token *token) {
+  assert(token != NULL && "tau_token_loc: token cannot be NULL");
+  // rem only counts what follows the token
+  size_t offset = token->buf - token->buf_data;
+  if (token->lines == NULL) {
+    return tau_line_index_scan_loc(token->buf_name, token->buf_data, offset);
+  }
+
+  return tau_line_index_loc(token->lines, token->buf_name, token->buf_data, offset + token->len + token->rem,
+                            offset);
+}
+
+void tau_token_table_init(struct tau_token_table *table) {
+  assert(table != NULL && "tau_token_table_init: table cannot be NULL");
+  *table = (struct tau_token_table){0};
+}
+
+void tau_token_table_free(struct tau_token_table *table) {
+  assert(table != NULL && "tau_token_table_free: table cannot be NULL");
+  free(table->types);
+  free(table->codes);
+  free(table->offsets);
+  free(table->lens);
+  free(table->symbols);
+  free(table->doc_offsets);
+  free(table->doc_lens);
+  free(table->literal_tokens);
+  free(table->literals);
+  tau_str_pool_free(&table->strings);
+  *table = (struct tau_token_table){0};
+}
+
+static void token_table_grow(struct tau_token_table *table, uint32_t capacity) {
+  table->capacity = capacity;
+  table->types = realloc(table->types, capacity * sizeof(uint8_t));
+  table->codes = realloc(table->codes, capacity * sizeof(uint8_t));
+  table->offsets = realloc(table->offsets, capacity * sizeof(uint32_t));
+  table->lens = realloc(table->lens, capacity * sizeof(uint32_t));
+  table->symbols = realloc(table->symbols, capacity * sizeof(tau_symbol_t));
+  assert(table->types != NULL && table->codes != NULL && table->offsets != NULL && table->lens != NULL &&
+         table->symbols != NULL && "token_table_grow: out of memory");
+  if (table->keep_docs) {
+    table->doc_offsets = realloc(table->doc_offsets, capacity * sizeof(uint32_t));
+    table->doc_lens = realloc(table->doc_lens, capacity * sizeof(uint32_t));
+    assert(table->doc_offsets != NULL && table->doc_lens != NULL && "token_table_grow: out of memory");
+  }
+}
+
+static void literal_table_grow(struct tau_token_table *table, uint32_t capacity) {
+  table->literal_capacity = capacity;
+  table->literal_tokens = realloc(table->literal_tokens, capacity * sizeof(token_id_t));
+  table->literals = realloc(table->literals, capacity * sizeof(union tau_literal));
+  assert(table->literal_tokens != NULL && table->literals != NULL && "literal_table_grow: out of memory");
+}
+
+// First literal of a token at or after token
+static uint32_t literal_from_token(const struct tau_token_table *table, token_id_t token) {
+  uint32_t lo = 0;
+  uint32_t hi = table->literal_count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (table->literal_tokens[mid] < token) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static uint8_t token_code(const struct tau_token *token) {
+  switch (token->type) {
+    case TAU_TOKEN_TYPE_PUNCT:
+      return token->punct;
+    case TAU_TOKEN_TYPE_KEYWORD:
+    case TAU_TOKEN_TYPE_BOL_LIT:
+    case TAU_TOKEN_TYPE_NIL_LIT:
+    case TAU_TOKEN_TYPE_UNI_LIT:
+      return token->keyword;
+    case TAU_TOKEN_TYPE_INT_LIT:
+    case TAU_TOKEN_TYPE_FLT_LIT:
+      return token->num_base;
+    default:
+      return 0;
+  }
+}
+
+void tau_token_table_lex(struct tau_token_table *table, struct tau_diag_list *diags, const char *name,
+                         const char *buf_data, size_t buf_size) {
+  assert(table != NULL && "tau_token_table_lex: table cannot be NULL");
+  assert(buf_data != NULL && "tau_token_table_lex: buf_data cannot be NULL");
+  assert(buf_size < UINT32_MAX && "tau_token_table_lex: buffer too big for 32-bit token offsets");
+
+  // sources average well over 4 bytes per token, so this is a good first guess that avoids most regrowing
+  table->count = 0;
+  table->literal_count = 0;
+  tau_str_pool_clear(&table->strings);
+  uint32_t guess = (uint32_t)(buf_size / 4) + 1;
+  if (table->capacity < guess) {
+    token_table_grow(table, guess < TOKEN_TABLE_MIN_CAPACITY ? TOKEN_TABLE_MIN_CAPACITY : guess);
+  }
+
+  // only built if an error needs a location
+  struct tau_line_index lines;
+  tau_line_index_init(&lines);
+  struct tau_token token = tau_token_start(name, buf_data, buf_size);
+  token.diags = diags;
+  token.lines = &lines;
+  token.strings = &table->strings;
+  token.keep_docs = table->keep_docs;
+  do {
+    token = tau_token_next(token);
+    tau_token_table_push(table, &token, buf_data);
+  } while (token.type != TAU_TOKEN_TYPE_EOF);
+
+  tau_line_index_free(&lines);
+}
+
+void tau_token_table_push(struct tau_token_table *table, const struct tau_token *token, const char *buf_data) {
+  assert(table != NULL && "tau_token_table_push: table cannot be NULL");
+  assert(token != NULL && "tau_token_table_push: token cannot be NULL");
+  if (table->count == table->capacity) {
+    token_table_grow(table,
+                     table->capacity < TOKEN_TABLE_MIN_CAPACITY ? TOKEN_TABLE_MIN_CAPACITY : table->capacity * 2);
+  }
+
+  table->types[table->count] = token->type;
+  table->codes[table->count] = token_code(token);
+  table->offsets[table->count] = (uint32_t)(token->buf - buf_data);
+  table->lens[table->count] = (uint32_t)token->len;
+  table->symbols[table->count] = TAU_SYMBOL_NONE;
+  if (table->interner != NULL &&
+      (token->type == TAU_TOKEN_TYPE_IDENTIFIER || token->type == TAU_TOKEN_TYPE_STR_LIT)) {
+    table->symbols[table->count] = tau_interner_intern(table->interner, token->buf, token->len);
+  }
+
+  if (table->keep_docs) {
+    table->doc_offsets[table->count] = token->doc != NULL ? (uint32_t)(token->doc - buf_data) : 0;
+    table->doc_lens[table->count] = (uint32_t)token->doc_len;
+  }
+
+  if (token->type == TAU_TOKEN_TYPE_INT_LIT || token->type == TAU_TOKEN_TYPE_FLT_LIT ||
+      (token->type == TAU_TOKEN_TYPE_STR_LIT && token->strings != NULL)) {
+    if (table->literal_count == table->literal_capacity) {
+      literal_table_grow(table, table->literal_capacity < LITERAL_TABLE_MIN_CAPACITY ? LITERAL_TABLE_MIN_CAPACITY
+                                                                                      : table->literal_capacity * 2);
+    }
+
+    table->literal_tokens[table->literal_count] = table->count;
+    table->literals[table->literal_count] = token->literal;
+    table->literal_count++;
+  }
+
+  table->count++;
+}
+
+bool tau_token_table_literal(const struct tau_token_table *table, token_id_t token, union tau_literal *literal) {
+  assert(table != NULL && "tau_token_table_literal: table cannot be NULL");
+  assert(literal != NULL && "tau_token_table_literal: literal cannot be NULL");
+  uint32_t index = literal_from_token(table, token);
+  if (index == table->literal_count || table->literal_tokens[index] != token) {
+    return false;
+  }
+
+  *literal = table->literals[index];
+  return true;
+}
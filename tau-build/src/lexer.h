@@ -6,8 +6,12 @@
 #define TAU_LEXER_H
 
 #include <stdint.h>
+#include <tau/interner.h>
 
 #include "common.h"
+#include "diag.h"
+#include "line_index.h"
+#include "str_pool.h"
 
 enum tau_token_type {
   TAU_TOKEN_TYPE_NONE,
@@ -103,6 +107,16 @@ enum tau_num_base {
   TAU_NUM_BASE_HEX,
 };
 
+// Value of a literal token, decoded as it is lexed so nothing after the lexer reads the literal text again
+union tau_literal {
+  uint64_t int_value;  // TAU_TOKEN_TYPE_INT_LIT, UINT64_MAX when out of range
+  double flt_value;    // TAU_TOKEN_TYPE_FLT_LIT
+  struct {
+    uint32_t offset;  // into the string pool the token was decoded into
+    uint32_t len;
+  } str_value;  // TAU_TOKEN_TYPE_STR_LIT, quotes left out and escapes decoded
+};
+
 struct tau_token {
   const char *buf;
   size_t rem;
@@ -110,18 +124,83 @@ struct tau_token {
   int32_t par_balance;
   int32_t sbr_balance;
   int32_t cbr_balance;
-  struct tau_loc loc;
+  const char *buf_name;
+  const char *buf_data;          // start of the buffer, rows and columns are only worked out from it on demand
+  struct tau_diag_list *diags;   // where lexing errors go, logged right away when NULL
+  struct tau_line_index *lines;  // resolves lexing error locations, the buffer is scanned each time when NULL
+  struct tau_str_pool *strings;  // where string literals are decoded to, escapes are only checked when NULL
+  const char *doc;               // doc comments between the previous line and the token, only set with keep_docs
+  size_t doc_len;
+  bool keep_docs;
   enum tau_token_type type;
   enum tau_punct punct;
   enum tau_keyword keyword;
   enum tau_num_base num_base;
+  union tau_literal literal;  // only set for INT_LIT and FLT_LIT tokens, and STR_LIT ones when strings is set
 };
 
 const char *tau_token_get_name(enum tau_token_type type);
 const char *tau_token_get_punct_name(enum tau_punct punct);
 const char *tau_token_get_keyword_name(enum tau_keyword keyword);
 
+typedef uint32_t token_id_t;
+
+// A whole buffer tokenized at once, one column per token attribute so the parser can address tokens by index. The
+// last token of a lexed table is always TAU_TOKEN_TYPE_EOF. When an interner is set, identifiers and string literals
+// (quotes included) are interned as they are lexed and every other token gets TAU_SYMBOL_NONE. The doc columns are
+// only allocated when keep_docs is set, before the first token is pushed. Few tokens are literals, so their values go
+// to a side table of their own, string literals as offsets into the table's own pool.
+struct tau_token_table {
+  uint8_t *types;         // enum tau_token_type
+  uint8_t *codes;         // enum tau_punct, enum tau_keyword or enum tau_num_base depending on the type
+  uint32_t *offsets;      // from the start of the buffer
+  uint32_t *lens;
+  tau_symbol_t *symbols;  // only filled when interner is set
+  uint32_t *doc_offsets;  // doc comments before each token, a doc_len of 0 when there are none
+  uint32_t *doc_lens;
+  uint32_t count;
+  uint32_t capacity;
+  token_id_t *literal_tokens;  // tokens with a value in ascending order, literals[i] is the one of literal_tokens[i]
+  union tau_literal *literals;
+  uint32_t literal_count;
+  uint32_t literal_capacity;
+  struct tau_str_pool strings;  // where tau_token_table_lex decodes string literals to
+  struct tau_interner *interner;
+  bool keep_docs;
+};
+
+// A point inside the spaces and comments before a token where lexing can start over, see tau_token_trivia_cut
+struct tau_trivia_cut {
+  const char *at;
+  const char *stand_in;      // written over the bytes right before at: nothing, an empty comment or a comment opening
+  enum tau_token_type type;  // of the token of no length to lex from, which tells whether the spaces start a line
+  const char *comment;       // where the comment holding at opens, NULL when at is in none
+  bool comment_closed;       // it ends before the end of the buffer
+};
+
 struct tau_token tau_token_start(const char *name, const char *buf_data, size_t buf_size);
+// Comments are skipped like spaces: `//` up to the end of the line, `/* */` wherever it is, without nesting. With
+// keep_docs, `///` and `/** */` comments that start a line are kept as the doc of the token after them instead.
 struct tau_token tau_token_next(struct tau_token prev);
+// The point closest to limit, and not past it, in the spaces and comments tau_token_next skips after prev where lexing
+// can start over without the bytes before it. Lexing from a token of no length right before at, of the given type and
+// with the brackets of prev, with stand_in written over the bytes in front of at, skips the rest the same way and
+// reports the same errors from at on. Only doc comments are never cut into, they are kept whole for their token.
+struct tau_trivia_cut tau_token_trivia_cut(struct tau_token prev, const char *limit);
+// Decodes the text between the quotes of a string literal into dest, which needs room for len bytes since decoding
+// never makes a literal longer. Invalid escapes are kept as they are written. Returns the decoded length.
+size_t tau_str_lit_decode(const char *body, size_t len, char *dest);
+// Where the token starts. Only meant for diagnostics and tests, tokens do not track rows and columns while lexing.
+struct tau_loc tau_token_loc(const struct tau_token *token);
+
+void tau_token_table_init(struct tau_token_table *table);
+void tau_token_table_free(struct tau_token_table *table);
+void tau_token_table_lex(struct tau_token_table *table, struct tau_diag_list *diags, const char *name,
+                         const char *buf_data, size_t buf_size);
+// Appends a single token produced by tau_token_next, its offset is taken relative to buf_data. String literals are
+// only kept when the lexer decoded them into a pool, their values point into that one even when it is not the table's.
+void tau_token_table_push(struct tau_token_table *table, const struct tau_token *token, const char *buf_data);
+// False for tokens that are not literals
+bool tau_token_table_literal(const struct tau_token_table *table, token_id_t token, union tau_literal *literal);
 
 #endif  // TAU_LEXER_H
@@ -0,0 +1,96 @@
+//
+// Created on 10/17/26.
+//
+
+#include "line_index.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "utf8.h"
+
+#define LINE_INDEX_MIN_CAPACITY 64
+
+static void push_line_start(struct tau_line_index *index, uint32_t start) {
+  if (index->count == index->capacity) {
+    index->capacity = index->capacity == 0 ? LINE_INDEX_MIN_CAPACITY : index->capacity * 2;
+    index->starts = realloc(index->starts, index->capacity * sizeof(uint32_t));
+    assert(index->starts != NULL && "push_line_start: out of memory");
+  }
+
+  index->starts[index->count++] = start;
+}
+
+static void build_line_starts(struct tau_line_index *index, const char *buf, size_t buf_size) {
+  push_line_start(index, 0);
+  const char *ahead = buf;
+  const char *end = buf + buf_size;
+  while (ahead < end) {
+    const char *newline = memchr(ahead, '\n', end - ahead);
+    if (newline == NULL) {
+      break;
+    }
+
+    push_line_start(index, (uint32_t)(newline + 1 - buf));
+    ahead = newline + 1;
+  }
+}
+
+void tau_line_index_init(struct tau_line_index *index) {
+  assert(index != NULL && "tau_line_index_init: index cannot be NULL");
+  *index = (struct tau_line_index){0};
+}
+
+void tau_line_index_free(struct tau_line_index *index) {
+  assert(index != NULL && "tau_line_index_free: index cannot be NULL");
+  free(index->starts);
+  *index = (struct tau_line_index){0};
+}
+
+struct tau_loc tau_line_index_loc(struct tau_line_index *index, const char *buf_name, const char *buf,
+                                  size_t buf_size, size_t offset) {
+  assert(index != NULL && "tau_line_index_loc: index cannot be NULL");
+  assert(offset <= buf_size && "tau_line_index_loc: offset is past the end of the buffer");
+  if (index->count == 0) {
+    build_line_starts(index, buf, buf_size);
+  }
+
+  // last line start that is not after the offset
+  uint32_t low = 0;
+  uint32_t high = index->count;
+  while (high - low > 1) {
+    uint32_t mid = low + (high - low) / 2;
+    if (index->starts[mid] <= offset) {
+      low = mid;
+    } else {
+      high = mid;
+    }
+  }
+
+  return (struct tau_loc){
+      .buf_name = buf_name,
+      .row = low,
+      .col = tau_utf8_count_codepoints(buf + index->starts[low], offset - index->starts[low]),
+      .offset = offset,
+  };
+}
+
+struct tau_loc tau_line_index_scan_loc(const char *buf_name, const char *buf, size_t offset) {
+  assert(buf != NULL && "tau_line_index_scan_loc: buf cannot be NULL");
+  size_t row = 0;
+  const char *line = buf;
+  const char *end = buf + offset;
+  const char *newline;
+  while (line < end && (newline = memchr(line, '\n', end - line)) != NULL) {
+    row++;
+    line = newline + 1;
+  }
+
+  return (struct tau_loc){
+      .buf_name = buf_name,
+      .row = row,
+      .col = tau_utf8_count_codepoints(line, end - line),
+      .offset = offset,
+  };
+}
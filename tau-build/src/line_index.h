@@ -0,0 +1,29 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_LINE_INDEX_H
+#define TAU_LINE_INDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "common.h"
+
+// Start offset of every line of a buffer, it is only built the first time a location is requested. Rows and columns
+// start at 0 and columns count code points, not bytes.
+struct tau_line_index {
+  uint32_t *starts;
+  uint32_t count;
+  uint32_t capacity;
+};
+
+void tau_line_index_init(struct tau_line_index *index);
+void tau_line_index_free(struct tau_line_index *index);
+struct tau_loc tau_line_index_loc(struct tau_line_index *index, const char *buf_name, const char *buf,
+                                  size_t buf_size, size_t offset);
+// Same location without an index, scanning the buffer up to offset. Fine for a handful of lookups, anything reporting
+// many locations in the same buffer should keep an index instead.
+struct tau_loc tau_line_index_scan_loc(const char *buf_name, const char *buf, size_t offset);
+
+#endif  // TAU_LINE_INDEX_H
@@ -6,36 +6,67 @@
 
 #include <stdarg.h>
 #include <stdio.h>
+#include <stdlib.h>
 
+#define LOG_LINE_MAX 512
+
+static const char *log_level_name_table[] = {
+    [TAU_LOG_TRACE] = "trace", [TAU_LOG_DEBUG] = "debug", [TAU_LOG_INFO] = "info",
+    [TAU_LOG_WARN] = "warn",   [TAU_LOG_ERROR] = "error",
+};
+
+const char *tau_log_get_level_name(enum tau_log_level level) {
+  if (level <= TAU_LOG_ERROR) {
+    return log_level_name_table[level];
+  }
+
+  return "(invalid)";
+}
+
+// The line is built first and written at once, concurrent loggers then take the stream lock once per line and never
+// interleave within one
 void tau_log(enum tau_log_level level, struct tau_loc loc, const char *fmt, ...) {
   FILE *target = stdout;
   if (level == TAU_LOG_ERROR) {
     target = stderr;
   }
 
+  char line[LOG_LINE_MAX];
+  int prefix_len = snprintf(line, sizeof(line), "%s:%zu:%zu %s: ", loc.buf_name, loc.row, loc.col,
+                            tau_log_get_level_name(level));
+  if (prefix_len < 0) {
+    return;
+  }
+
   va_list list;
   va_start(list, fmt);
+  va_list copy;
+  va_copy(copy, list);
+  size_t used = (size_t)prefix_len < sizeof(line) ? (size_t)prefix_len : sizeof(line) - 1;
+  int message_len = vsnprintf(line + used, sizeof(line) - used, fmt, list);
+  va_end(list);
+  if (message_len < 0) {
+    va_end(copy);
+    return;
+  }
 
-  fprintf(target, "%s:%ld:%ld ", loc.buf_name, loc.row, loc.col);
-  switch (level) {
-    case TAU_LOG_TRACE:
-      fprintf(target, "trace: ");
-      break;
-    case TAU_LOG_DEBUG:
-      fprintf(target, "debug: ");
-      break;
-    case TAU_LOG_INFO:
-      fprintf(target, "info: ");
-      break;
-    case TAU_LOG_WARN:
-      fprintf(target, "warn: ");
-      break;
-    case TAU_LOG_ERROR:
-      fprintf(target, "error: ");
-      break;
+  size_t len = (size_t)prefix_len + (size_t)message_len;
+  char *out = line;
+  if (len + 2 > sizeof(line)) {
+    out = malloc(len + 2);
+    if (out == NULL) {
+      va_end(copy);
+      return;
+    }
+
+    snprintf(out, len + 1, "%s:%zu:%zu %s: ", loc.buf_name, loc.row, loc.col, tau_log_get_level_name(level));
+    vsnprintf(out + prefix_len, (size_t)message_len + 1, fmt, copy);
   }
 
-  vfprintf(target, fmt, list);
-  fprintf(target, "\n");
-  va_end(list);
+  va_end(copy);
+  out[len] = '\n';
+  fwrite(out, 1, len + 1, target);
+  if (out != line) {
+    free(out);
+  }
 }
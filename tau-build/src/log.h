@@ -17,6 +17,7 @@ enum tau_log_level {
   TAU_LOG_ERROR,
 };
 
+const char *tau_log_get_level_name(enum tau_log_level level);
 void tau_log(enum tau_log_level level, struct tau_loc loc, const char *fmt, ...);
 
 #endif  // TAU_LOG_H
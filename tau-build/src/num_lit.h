@@ -0,0 +1,26 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_NUM_LIT_H
+#define TAU_NUM_LIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lexer.h"
+
+enum tau_num_lit_status {
+  TAU_NUM_LIT_OK,
+  TAU_NUM_LIT_INVALID,       // a base prefix or an exponent sign without a digit after it
+  TAU_NUM_LIT_OUT_OF_RANGE,  // an integer above UINT64_MAX or a float that rounds to infinity
+};
+
+// Both take a literal as the lexer delimits it, base prefix included. Integers are read eight digits at a time in
+// every base and decode as UINT64_MAX when out of range.
+enum tau_num_lit_status tau_num_lit_decode_int(const char *text, size_t len, enum tau_num_base base, uint64_t *value);
+// Rounded to the nearest double, ties to even. Up to 19 significant digits are exact for powers of ten up to 22 and
+// otherwise go through the Eisel-Lemire 128-bit product, the few literals that leaves undecided go through strtod.
+enum tau_num_lit_status tau_num_lit_decode_float(const char *text, size_t len, double *value);
+
+#endif  // TAU_NUM_LIT_H
@@ -2,8 +2,943 @@
 // Created on 1/5/23.
 //
 
+#define _POSIX_C_SOURCE 200809L
+
 #include <assert.h>
-#include <malloc.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 #include <tau/parser.h>
+#include <time.h>
 
+#include "cache.h"
+#include "hash.h"
+#include "num_lit.h"
 #include "parser_internal.h"
+#include "parser_match.h"
+#include "source.h"
+
+// Bytes reparses may add to a result before a full parse compacts it, whatever the ratio to the ones it parsed
+#define PARSE_REPARSE_BYTE_FLOOR ((size_t)1 << 20)
+#define PARSE_MIN_DECL_CAPACITY 64
+#define PARSE_MIN_LITERAL_CAPACITY 64
+
+// A top level declaration as tau_parse_result_reparse sees it, its start is the base of its segment
+struct parse_decl {
+  node_id_t id;
+  uint32_t segment;
+  uint32_t token_count;  // up to the first token of the next declaration, the end of file one included for the last
+  bool restartable;      // right after an end of line with no parenthesis or bracket open, lexing can restart there
+};
+
+struct tau_parse_result {
+  struct tau_parser parser;  // its tokens are the ones of the last full parse, only its nodes were parsed from them
+  node_id_t root;
+  struct tau_parse_stats stats;
+  struct tau_source source;  // only set by tau_parse_file, the ast points into it
+  size_t stale_node_count;   // nodes of declarations replaced by tau_parse_result_reparse, still held by the arena
+  struct parse_decl *decls;  // top level declarations in source order, built by the first reparse
+  uint32_t decl_count;
+  uint32_t decl_capacity;
+  node_id_t parsed_node_count;  // nodes of the last full parse, reparses add theirs after them
+  node_id_t *literal_nodes;     // nodes added by reparses that have a value in ascending order, see literals
+  union tau_literal *literals;  // literals[i] is the value of literal_nodes[i], the tokens it came from are gone
+  uint32_t literal_count;
+  uint32_t literal_capacity;
+  uint32_t token_count;                // tokens of the buffer as it is now, the ones a full parse would lex
+  size_t parsed_bytes;                 // nodes, tokens and strings of the last full parse
+  size_t parsed_string_bytes;          // the strings alone, reparses add theirs to the same pool
+  size_t lex_diag_count;               // diagnostics of the lexer, ahead of the parser ones in the list
+  struct tau_diag_policy diag_policy;  // kept for the full parses reparse falls back to
+  bool keep_docs;
+  uint64_t content_hash;               // only valid once content_hashed is set
+  bool content_hashed;
+  uint64_t *node_hashes;  // merkle hashes by node id, built by the first tau_parse_result_node_hash
+  struct tau_str_pool_entry *node_strings;  // string literals by node id of trees loaded from the parse cache
+};
+
+static uint64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static enum tau_parse_severity severity_from_log_level(enum tau_log_level level) {
+  switch (level) {
+    case TAU_LOG_ERROR:
+      return TAU_PARSE_SEVERITY_ERROR;
+    case TAU_LOG_WARN:
+      return TAU_PARSE_SEVERITY_WARNING;
+    default:
+      return TAU_PARSE_SEVERITY_NOTE;
+  }
+}
+
+static size_t token_table_bytes(const struct tau_token_table *tokens) {
+  return tokens->capacity * (2 * sizeof(uint8_t) + 2 * sizeof(uint32_t));
+}
+
+static size_t str_pool_bytes(const struct tau_str_pool *strings) {
+  return strings->capacity + strings->entry_capacity * sizeof(struct tau_str_pool_entry) +
+         strings->slot_count * sizeof(uint32_t);
+}
+
+static void update_stats(struct tau_parse_result *result, uint64_t lex_ns, uint64_t parse_ns) {
+  const struct tau_parser *parser = &result->parser;
+  result->stats = (struct tau_parse_stats){
+      .lex_ns = lex_ns,
+      .parse_ns = parse_ns,
+      .buf_size = parser->ast.buf_size,
+      .token_count = result->token_count,
+      .node_count = ast_size(&parser->ast),
+      .token_bytes = token_table_bytes(&parser->tokens),
+      .arena_reserved = parser->ast.arena.stats.reserved,
+      .arena_peak = parser->ast.arena.stats.peak,
+  };
+}
+
+static void parse_into(struct tau_parse_result *result, const char *buf_name, const char *buf_data, size_t buf_len,
+                       struct tau_interner *interner) {
+  struct tau_parser *parser = &result->parser;
+
+  uint64_t lex_start = now_ns();
+  parser_init_untokenized(parser, interner, &result->diag_policy, buf_name, buf_data, buf_len);
+  parser->tokens.keep_docs = result->keep_docs;
+  tau_token_table_lex(&parser->tokens, &parser->diags, buf_name, buf_data, buf_len);
+  result->token_count = parser->tokens.count;
+  result->lex_diag_count = parser->diags.count;
+  uint64_t parse_start = now_ns();
+  result->root = parse_compilation_unit(parser);
+  uint64_t parse_end = now_ns();
+  result->parsed_node_count = (node_id_t)parser->ast.node_count;
+  result->parsed_string_bytes = str_pool_bytes(&parser->tokens.strings);
+  result->parsed_bytes = ast_size(&parser->ast) * sizeof(struct tau_node) + token_table_bytes(&parser->tokens) +
+                         result->parsed_string_bytes;
+  update_stats(result, parse_start - lex_start, parse_end - parse_start);
+}
+
+// False when the cache holds no tree for the buffer, result is left untouched then
+static bool load_cached(struct tau_parse_result *result, const char *cache_dir, uint64_t content_hash,
+                        const char *buf_name, const char *buf_data, size_t buf_len, struct tau_interner *interner) {
+  uint64_t load_start = now_ns();
+  struct tau_cache_image image;
+  if (!tau_cache_map(&image, cache_dir, content_hash, buf_len)) {
+    return false;
+  }
+
+  struct tau_parser *parser = &result->parser;
+  parser_init_untokenized(parser, interner, &result->diag_policy, buf_name, buf_data, buf_len);
+  tau_symbol_t *symbols = malloc(image.header->string_count * sizeof(tau_symbol_t));
+  assert(symbols != NULL && "load_cached: out of memory");
+  symbols[0] = TAU_SYMBOL_NONE;
+  for (uint32_t i = 1; i < image.header->string_count; i++) {
+    symbols[i] = tau_interner_intern(parser->interner, image.text + image.strings[i].offset, image.strings[i].len);
+  }
+
+  // node ids are kept, so links are copied as they are
+  for (node_id_t id = 1; id < image.header->node_count; id++) {
+    const struct tau_node *cached = &image.nodes[id];
+    struct tau_node *node = node_at(parser, ast_node_new(&parser->ast, cached->type, cached->left, cached->right));
+    *node = *cached;
+    node->symbol = symbols[cached->symbol];
+  }
+
+  result->root = image.header->root;
+  free(symbols);
+  tau_cache_unmap(&image);
+  update_stats(result, 0, now_ns() - load_start);
+  result->stats.cached = true;
+  return true;
+}
+
+static void parse_with_cache(struct tau_parse_result *result, const char *cache_dir, const char *buf_name,
+                             const char *buf_data, size_t buf_len, struct tau_interner *interner) {
+  // loaded trees come without tokens, so there would be no doc comments to hand out
+  if (cache_dir == NULL || result->keep_docs) {
+    parse_into(result, buf_name, buf_data, buf_len, interner);
+    return;
+  }
+
+  uint64_t content_hash = tau_hash64(buf_data, buf_len, 0);
+  result->content_hash = content_hash;
+  result->content_hashed = true;
+  if (load_cached(result, cache_dir, content_hash, buf_name, buf_data, buf_len, interner)) {
+    return;
+  }
+
+  parse_into(result, buf_name, buf_data, buf_len, interner);
+  // diagnostics are not cached, so only clean trees are
+  if (tau_parse_result_ok(result) && result->parser.diags.count == 0) {
+    tau_cache_store(cache_dir, content_hash, &result->parser.ast, result->root, result->parser.interner);
+  }
+}
+
+static struct tau_diag_policy diag_policy_from(const struct tau_parse_options *options) {
+  if (options == NULL) {
+    return (struct tau_diag_policy){0};
+  }
+
+  return (struct tau_diag_policy){.limit = options->diagnostic_limit, .fold = options->fold_diagnostics};
+}
+
+struct tau_parse_result *tau_parse_buffer(const char *buf_name, const char *buf_data, size_t buf_len,
+                                          struct tau_interner *interner) {
+  return tau_parse_buffer_with_options(buf_name, buf_data, buf_len, &(struct tau_parse_options){.interner = interner});
+}
+
+struct tau_parse_result *tau_parse_file(const char *path, struct tau_interner *interner) {
+  return tau_parse_file_with_options(path, &(struct tau_parse_options){.interner = interner});
+}
+
+struct tau_parse_result *tau_parse_buffer_with_options(const char *buf_name, const char *buf_data, size_t buf_len,
+                                                       const struct tau_parse_options *options) {
+  assert(buf_name != NULL && "tau_parse_buffer_with_options: buf_name cannot be NULL");
+  assert(buf_data != NULL && "tau_parse_buffer_with_options: buf_data cannot be NULL");
+
+  struct tau_parse_result *result = calloc(1, sizeof(struct tau_parse_result));
+  assert(result != NULL && "tau_parse_buffer_with_options: out of memory");
+  result->diag_policy = diag_policy_from(options);
+  result->keep_docs = options != NULL && options->keep_doc_comments;
+  parse_with_cache(result, options != NULL ? options->cache_dir : NULL, buf_name, buf_data, buf_len,
+                   options != NULL ? options->interner : NULL);
+  return result;
+}
+
+struct tau_parse_result *tau_parse_file_with_options(const char *path, const struct tau_parse_options *options) {
+  assert(path != NULL && "tau_parse_file_with_options: path cannot be NULL");
+
+  struct tau_parse_result *result = calloc(1, sizeof(struct tau_parse_result));
+  assert(result != NULL && "tau_parse_file_with_options: out of memory");
+  int err = tau_source_open(&result->source, path);
+  if (err != 0) {
+    free(result);
+    errno = err;
+    return NULL;
+  }
+
+  result->diag_policy = diag_policy_from(options);
+  result->keep_docs = options != NULL && options->keep_doc_comments;
+  parse_with_cache(result, options != NULL ? options->cache_dir : NULL, path, result->source.data,
+                   result->source.size, options != NULL ? options->interner : NULL);
+  return result;
+}
+
+// Index of the first token starting at or after offset
+static token_id_t token_from_offset(const struct tau_token_table *tokens, uint32_t offset) {
+  token_id_t lo = 0;
+  token_id_t hi = tokens->count;
+  while (lo < hi) {
+    token_id_t mid = lo + (hi - lo) / 2;
+    if (tokens->offsets[mid] < offset) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  return lo;
+}
+
+static bool node_stale(const struct tau_parse_result *result, node_id_t id) {
+  const struct tau_ast *ast = &result->parser.ast;
+  return ast->segments[ast_node_segment(ast, id)].stale;
+}
+
+// Offset of a node in the tokens it was parsed from
+static uint32_t node_origin(const struct tau_ast *ast, node_id_t id) {
+  return ast->segments[ast_node_segment(ast, id)].origin + ast_node(ast, id)->offset;
+}
+
+// Token a node was parsed from, false for nodes added by reparses or no longer in the tree and for trees loaded from
+// the parse cache
+static bool node_token(const struct tau_parse_result *result, node_id_t id, token_id_t *token) {
+  if (id >= result->parsed_node_count || node_stale(result, id)) {
+    return false;
+  }
+
+  const struct tau_token_table *tokens = &result->parser.tokens;
+  uint32_t offset = node_origin(&result->parser.ast, id);
+  *token = token_from_offset(tokens, offset);
+  return *token < tokens->count && tokens->offsets[*token] == offset;
+}
+
+// Value the lexer decoded for a node still in the tree, false for nodes that are not literals
+static bool node_value(const struct tau_parse_result *result, node_id_t id, union tau_literal *literal) {
+  token_id_t token;
+  if (id < result->parsed_node_count) {
+    return node_token(result, id, &token) && tau_token_table_literal(&result->parser.tokens, token, literal);
+  }
+
+  if (node_stale(result, id)) {
+    return false;
+  }
+
+  uint32_t lo = 0;
+  uint32_t hi = result->literal_count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (result->literal_nodes[mid] < id) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo == result->literal_count || result->literal_nodes[lo] != id) {
+    return false;
+  }
+
+  *literal = result->literals[lo];
+  return true;
+}
+
+// Keeps the values of the literals parsed by a reparse from first on, so its tokens can go right after it
+static void keep_literals(struct tau_parse_result *result, const struct tau_token_table *tokens, node_id_t first) {
+  const struct tau_ast *ast = &result->parser.ast;
+  for (node_id_t id = first; id < ast->node_count; id++) {
+    enum tau_token_type type = ast_node(ast, id)->token_type;
+    if (type != TAU_TOKEN_TYPE_INT_LIT && type != TAU_TOKEN_TYPE_FLT_LIT && type != TAU_TOKEN_TYPE_STR_LIT) {
+      continue;
+    }
+
+    uint32_t offset = node_origin(ast, id);
+    token_id_t token = token_from_offset(tokens, offset);
+    union tau_literal literal;
+    if (token == tokens->count || tokens->offsets[token] != offset ||
+        !tau_token_table_literal(tokens, token, &literal)) {
+      continue;
+    }
+
+    if (result->literal_count == result->literal_capacity) {
+      result->literal_capacity =
+          result->literal_capacity == 0 ? PARSE_MIN_LITERAL_CAPACITY : result->literal_capacity * 2;
+      result->literal_nodes = realloc(result->literal_nodes, result->literal_capacity * sizeof(node_id_t));
+      result->literals = realloc(result->literals, result->literal_capacity * sizeof(union tau_literal));
+      assert(result->literal_nodes != NULL && result->literals != NULL && "keep_literals: out of memory");
+    }
+
+    result->literal_nodes[result->literal_count] = id;
+    result->literals[result->literal_count] = literal;
+    result->literal_count++;
+  }
+}
+
+static void free_literals(struct tau_parse_result *result) {
+  free(result->literal_nodes);
+  free(result->literals);
+  result->literal_nodes = NULL;
+  result->literals = NULL;
+  result->literal_count = 0;
+  result->literal_capacity = 0;
+}
+
+// Memory reparses added since the last full parse: nodes no longer in the tree, the values kept for the literals of
+// the runs and the strings decoded from them
+static size_t reparse_bytes(const struct tau_parse_result *result) {
+  size_t literal_bytes = result->literal_capacity * (sizeof(node_id_t) + sizeof(union tau_literal));
+  size_t string_bytes = str_pool_bytes(&result->parser.tokens.strings) - result->parsed_string_bytes;
+  return result->stale_node_count * sizeof(struct tau_node) + literal_bytes + string_bytes;
+}
+
+static enum ast_visit_action count_stale_node(const struct tau_ast *ast, node_id_t id, void *ctx) {
+  UNUSED(ast);
+  UNUSED(id);
+  (*(size_t *)ctx)++;
+  return AST_VISIT_CONTINUE;
+}
+
+static uint32_t decl_start(const struct tau_parse_result *result, uint32_t index) {
+  return result->parser.ast.segments[result->decls[index].segment].base;
+}
+
+// Parsing can restart from the declaration unless the one before it is an error, which skips everything up to the
+// next declaration keyword and so ends wherever the text after it has one
+static bool decl_restartable(struct tau_parse_result *result, uint32_t index) {
+  struct tau_parser *parser = &result->parser;
+  node_id_t prev = index > 0 ? node_at(parser, result->decls[index - 1].id)->left : NODE_NULL;
+  return result->decls[index].restartable && (prev == NODE_NULL || node_at(parser, prev)->type != TAU_NODE_ERROR);
+}
+
+// Token counts of the declarations first up to end, parsed in that order from tokens with the last one running up to
+// token end. Lexing from the first byte of a declaration gives the tokens lexing the whole buffer did when no
+// parenthesis or bracket was open there and it starts a line, which is what makes it restartable.
+static void scan_decl_tokens(struct tau_parse_result *result, const struct tau_token_table *tokens, uint32_t first,
+                             uint32_t end, token_id_t end_token) {
+  const struct tau_ast *ast = &result->parser.ast;
+  int32_t par_balance = 0;
+  int32_t sbr_balance = 0;
+  token_id_t token = 0;
+  token_id_t start = 0;
+  for (uint32_t i = first; i < end; i++) {
+    uint32_t origin = ast->segments[result->decls[i].segment].origin;
+    for (; tokens->offsets[token] < origin; token++) {
+      if (tokens->types[token] == TAU_TOKEN_TYPE_PUNCT) {
+        uint8_t punct = tokens->codes[token];
+        par_balance += punct == TAU_PUNCT_LPAR ? 1 : punct == TAU_PUNCT_RPAR ? -1 : 0;
+        sbr_balance += punct == TAU_PUNCT_LSBR ? 1 : punct == TAU_PUNCT_RSBR ? -1 : 0;
+      }
+    }
+
+    if (i > first) {
+      result->decls[i - 1].token_count = token - start;
+    }
+
+    start = token;
+    result->decls[i].restartable =
+        par_balance == 0 && sbr_balance == 0 && (token == 0 || tokens->types[token - 1] == TAU_TOKEN_TYPE_EOL);
+  }
+
+  if (end > first) {
+    result->decls[end - 1].token_count = end_token - start;
+  }
+}
+
+static void build_decl_index(struct tau_parse_result *result, node_id_t decls) {
+  struct tau_parser *parser = &result->parser;
+  result->decl_count = 0;
+  for (node_id_t decl = node_at(parser, decls)->left; decl != NODE_NULL; decl = node_at(parser, decl)->right) {
+    result->decl_count++;
+  }
+
+  result->decl_capacity = result->decl_count > PARSE_MIN_DECL_CAPACITY ? result->decl_count : PARSE_MIN_DECL_CAPACITY;
+  result->decls = malloc(result->decl_capacity * sizeof(struct parse_decl));
+  assert(result->decls != NULL && "build_decl_index: out of memory");
+  uint32_t i = 0;
+  for (node_id_t decl = node_at(parser, decls)->left; decl != NODE_NULL; decl = node_at(parser, decl)->right) {
+    result->decls[i++] = (struct parse_decl){.id = decl, .segment = ast_node_segment(&parser->ast, decl)};
+  }
+
+  scan_decl_tokens(result, &parser->tokens, 0, result->decl_count, parser->tokens.count);
+}
+
+// Replaces count entries at first by the added declarations chained from head, parsed from tokens up to token end
+static void decl_index_splice(struct tau_parse_result *result, uint32_t first, uint32_t count, node_id_t head,
+                              uint32_t added, const struct tau_token_table *tokens, token_id_t end_token) {
+  uint32_t decl_count = result->decl_count - count + added;
+  if (decl_count > result->decl_capacity) {
+    result->decl_capacity = decl_count * 2;
+    result->decls = realloc(result->decls, result->decl_capacity * sizeof(struct parse_decl));
+    assert(result->decls != NULL && "decl_index_splice: out of memory");
+  }
+
+  if (added != count) {
+    memmove(result->decls + first + added, result->decls + first + count,
+            (result->decl_count - first - count) * sizeof(struct parse_decl));
+  }
+
+  node_id_t decl = head;
+  for (uint32_t i = 0; i < added; i++) {
+    result->decls[first + i] = (struct parse_decl){.id = decl, .segment = ast_node_segment(&result->parser.ast, decl)};
+    decl = node_at(&result->parser, decl)->right;
+  }
+
+  result->decl_count = decl_count;
+  scan_decl_tokens(result, tokens, first, first + added, end_token);
+}
+
+// Bytes lexed again by a reparse: from start up to old_end in the old buffer, which became start up to new_end
+struct parse_damage {
+  uint32_t start;
+  uint32_t old_end;  // UINT32_MAX when lexing ran to the end of the buffer
+  uint32_t new_end;
+};
+
+// Appends to out the diagnostics from first up to end reported in [from, to). Moved ones are located again in the new
+// buffer, delta bytes away from where they were reported.
+static size_t copy_diags(struct tau_ast *ast, struct tau_diag *out, const struct tau_diag *items, size_t first,
+                         size_t end, size_t from, size_t to, bool moved, int64_t delta) {
+  size_t count = 0;
+  for (size_t i = first; i < end; i++) {
+    if (items[i].loc.offset < from || items[i].loc.offset >= to) {
+      continue;
+    }
+
+    out[count] = items[i];
+    if (moved) {
+      size_t offset = (size_t)((int64_t)items[i].loc.offset + delta);
+      out[count].loc = tau_line_index_loc(&ast->lines, ast->buf_name, ast->buf, ast->buf_size, offset);
+    }
+
+    count++;
+  }
+
+  return count;
+}
+
+// Swaps the diagnostics of the replaced text for the ones reported from first_new on by lexing it again and from
+// first_parse on by parsing it again. The list ends up as a full parse leaves it: lexer diagnostics ahead of parser
+// ones, each in source order.
+static void splice_diags(struct tau_parse_result *result, size_t first_new, size_t first_parse,
+                         struct parse_damage damage, int64_t delta) {
+  struct tau_diag_list *diags = &result->parser.diags;
+  struct tau_ast *ast = &result->parser.ast;
+  if (diags->count == 0) {
+    return;
+  }
+
+  struct tau_diag *items = malloc(diags->count * sizeof(struct tau_diag));
+  assert(items != NULL && "splice_diags: out of memory");
+  size_t lexed = result->lex_diag_count;
+  size_t count = copy_diags(ast, items, diags->items, 0, lexed, 0, damage.start, false, 0);
+  count += copy_diags(ast, items + count, diags->items, first_new, first_parse, 0, damage.new_end, false, 0);
+  count += copy_diags(ast, items + count, diags->items, 0, lexed, damage.old_end, SIZE_MAX, true, delta);
+  result->lex_diag_count = count;
+  count += copy_diags(ast, items + count, diags->items, lexed, first_new, 0, damage.start, false, 0);
+  count += copy_diags(ast, items + count, diags->items, first_parse, diags->count, 0, damage.new_end, false, 0);
+  count += copy_diags(ast, items + count, diags->items, lexed, first_new, damage.old_end, SIZE_MAX, true, delta);
+
+  free(diags->items);
+  diags->items = items;
+  diags->capacity = diags->count;
+  diags->count = count;
+  diags->error_count = 0;
+  for (size_t i = 0; i < count; i++) {
+    diags->error_count += items[i].level == TAU_LOG_ERROR;
+  }
+}
+
+// Top level declarations that start a line with no parenthesis or bracket open, after one that is not an error, are
+// where lexing and parsing can restart. The damaged run begins at the closest of them holding or preceding the byte
+// before the edit (inserted blanks can extend its end of line) and ends at the first end of line landing on the start
+// of another one, untouched by the edit. Everything from there on is reused as is, only the start of each declaration
+// moves, its nodes count from there. Diagnostics of the run are replaced like its nodes unless the list folds or drops
+// some.
+static bool reparse_decls(struct tau_parse_result *result, const char *buf_data, size_t buf_len,
+                          struct tau_parse_edit edit) {
+  struct tau_parser *parser = &result->parser;
+  struct tau_ast *ast = &parser->ast;
+  // a tree loaded from the cache has no tokens to restart lexing from
+  if (result->root == NODE_NULL || parser->tokens.count == 0) {
+    return false;
+  }
+
+  bool keeps_diags = parser->diags.policy.limit == 0 && !parser->diags.policy.fold;
+  if (!keeps_diags && parser->diags.count != 0) {
+    return false;
+  }
+
+  size_t garbage = reparse_bytes(result);
+  if (garbage > PARSE_REPARSE_BYTE_FLOOR && garbage > result->parsed_bytes) {
+    return false;
+  }
+
+  node_id_t decls = node_at(parser, result->root)->right;
+  if (result->decls == NULL) {
+    build_decl_index(result, decls);
+  }
+
+  // last declaration starting at or before the byte preceding the edit
+  size_t damage_start = edit.offset > 0 ? edit.offset - 1 : 0;
+  size_t damage_end = edit.offset + edit.old_len;
+  uint32_t lo = 0;
+  uint32_t hi = result->decl_count;
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    if (decl_start(result, mid) <= damage_start) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+
+  if (lo == 0) {
+    return false;
+  }
+
+  uint32_t first = lo - 1;
+  while (first > 0 && !decl_restartable(result, first)) {
+    first--;
+  }
+
+  if (!decl_restartable(result, first)) {
+    return false;
+  }
+
+  uint64_t lex_start = now_ns();
+  int64_t delta = (int64_t)edit.new_len - (int64_t)edit.old_len;
+  struct parse_damage damage = {.start = decl_start(result, first), .old_end = UINT32_MAX, .new_end = UINT32_MAX};
+  struct tau_token_table relexed;
+  tau_token_table_init(&relexed);
+  relexed.interner = parser->interner;
+  ast->buf = buf_data;
+  ast->buf_size = buf_len;
+  tau_line_index_free(&ast->lines);
+  tau_line_index_init(&ast->lines);
+  struct tau_token token = tau_token_start(ast->buf_name, buf_data, buf_len);
+  token.buf += damage.start;  // locations still count from the start of the buffer
+  token.rem -= damage.start;
+  token.diags = &parser->diags;
+  token.lines = &ast->lines;
+  token.strings = &parser->tokens.strings;  // the pool of the whole buffer
+  size_t first_new_diag = parser->diags.count;
+  uint32_t sync = first + 1;  // first old declaration kept, decl_count when lexing ran to the end of the buffer
+  for (;;) {
+    token = tau_token_next(token);
+    tau_token_table_push(&relexed, &token, buf_data);
+    if (token.type == TAU_TOKEN_TYPE_EOF) {
+      sync = result->decl_count;
+      break;
+    }
+
+    if (token.type != TAU_TOKEN_TYPE_EOL || token.par_balance != 0 || token.sbr_balance != 0 ||
+        token.cbr_balance != 0) {
+      continue;
+    }
+
+    int64_t old_end = (int64_t)(token.buf + token.len - buf_data) - delta;
+    while (sync < result->decl_count && decl_start(result, sync) < old_end) {
+      sync++;
+    }
+
+    // the error left at the end of the file by a declaration running into it is parsed again along with it
+    if (sync < result->decl_count && decl_start(result, sync) == old_end && old_end >= (int64_t)damage_end &&
+        old_end + delta < (int64_t)buf_len && result->decls[sync].restartable) {
+      break;
+    }
+  }
+
+  // past the run the parser only gets to see the token a full parse would find there
+  bool at_end = sync == result->decl_count;
+  token_id_t stop = relexed.count - 1;
+  if (!at_end) {
+    damage.old_end = decl_start(result, sync);
+    damage.new_end = (uint32_t)((int64_t)damage.old_end + delta);
+    stop = relexed.count;
+    token = tau_token_next(token);
+    tau_token_table_push(&relexed, &token, buf_data);
+    token.buf += token.len;
+    token.len = 0;
+    token.type = TAU_TOKEN_TYPE_EOF;
+    tau_token_table_push(&relexed, &token, buf_data);
+  }
+
+  size_t first_parse_diag = parser->diags.count;
+  for (uint32_t i = first; i < sync; i++) {
+    struct ast_visitor visitor = {.enter = count_stale_node, .ctx = &result->stale_node_count};
+    ast_visit(ast, node_at(parser, result->decls[i].id)->left, &visitor);
+    result->stale_node_count++;
+    ast->segments[result->decls[i].segment].stale = true;
+    result->token_count -= result->decls[i].token_count;
+  }
+
+  token_id_t run_tokens = at_end ? relexed.count : stop;
+  result->token_count += run_tokens;
+  if (delta != 0) {
+    for (uint32_t i = sync; i < result->decl_count; i++) {
+      struct ast_segment *segment = &ast->segments[result->decls[i].segment];
+      segment->base = (uint32_t)((int64_t)segment->base + delta);
+    }
+  }
+
+  // the run is parsed from its own tokens, only the values of its literals outlive them
+  uint64_t parse_start = now_ns();
+  node_id_t first_node = (node_id_t)ast->node_count;
+  struct tau_token_table tokens = parser->tokens;
+  parser->tokens = relexed;
+  parser->ahead = 0;
+  parser->panicking = false;
+  node_id_t tail = NODE_NULL;
+  node_id_t head = parse_decl_run(parser, stop, &tail);
+  bool synced = parser->ahead == stop;
+  // the list takes the token of its first declaration, so it is replaced along with it
+  if (synced && first == 0) {
+    decls = node_new_empty(parser, TAU_NODE_DECLS, 0);
+    node_at(parser, result->root)->right = decls;
+    result->stale_node_count++;
+  }
+
+  relexed = parser->tokens;
+  parser->tokens = tokens;
+  if (!synced || (!keeps_diags && parser->diags.count != 0)) {
+    tau_token_table_free(&relexed);
+    return false;
+  }
+
+  uint32_t added = 0;
+  for (node_id_t decl = head; decl != NODE_NULL; decl = node_at(parser, decl)->right) {
+    added++;
+  }
+
+  node_id_t kept = at_end ? NODE_NULL : result->decls[sync].id;
+  if (tail != NODE_NULL) {
+    node_at(parser, tail)->right = kept;
+  }
+
+  if (first == 0) {
+    node_at(parser, decls)->left = head != NODE_NULL ? head : kept;
+  } else {
+    node_at(parser, result->decls[first - 1].id)->right = head != NODE_NULL ? head : kept;
+  }
+
+  decl_index_splice(result, first, sync - first, head, added, &relexed, run_tokens);
+  // a run of nothing but the end of the file adds its token to the declaration before it
+  if (added == 0 && first > 0) {
+    result->decls[first - 1].token_count += run_tokens;
+  }
+
+  splice_diags(result, first_new_diag, first_parse_diag, damage, delta);
+  keep_literals(result, &relexed, first_node);
+  tau_token_table_free(&relexed);
+  update_stats(result, parse_start - lex_start, now_ns() - parse_start);
+  return true;
+}
+
+bool tau_parse_result_reparse(struct tau_parse_result *result, const char *buf_data, size_t buf_len,
+                              struct tau_parse_edit edit) {
+  assert(result != NULL && "tau_parse_result_reparse: result cannot be NULL");
+  assert(buf_data != NULL && "tau_parse_result_reparse: buf_data cannot be NULL");
+  assert(edit.offset + edit.old_len <= result->parser.ast.buf_size && edit.offset + edit.new_len <= buf_len &&
+         "tau_parse_result_reparse: edit out of bounds");
+  assert(result->parser.ast.buf_size - edit.old_len + edit.new_len == buf_len &&
+         "tau_parse_result_reparse: edit does not match the new buffer length");
+
+  // a relexed declaration would start after its doc comments and lose them
+  bool incremental = !result->keep_docs && reparse_decls(result, buf_data, buf_len, edit);
+  if (!incremental) {
+    // keep a private interner alive across the full parse so symbols handed out so far stay valid
+    const char *buf_name = result->parser.ast.buf_name;
+    struct tau_interner *interner = result->parser.interner;
+    bool owns_interner = result->parser.owns_interner;
+    result->parser.owns_interner = false;
+    parser_free(&result->parser);
+    free_literals(result);
+    parse_into(result, buf_name, buf_data, buf_len, interner);
+    result->parser.owns_interner = owns_interner;
+    result->stale_node_count = 0;
+    free(result->decls);
+    result->decls = NULL;
+  }
+
+  // the buffer is the caller's from now on
+  tau_source_close(&result->source);
+  result->content_hashed = false;
+  free(result->node_hashes);
+  result->node_hashes = NULL;
+  free(result->node_strings);
+  result->node_strings = NULL;
+  return incremental;
+}
+
+void tau_parse_result_free(struct tau_parse_result *result) {
+  if (result == NULL) {
+    return;
+  }
+
+  parser_free(&result->parser);
+  tau_source_close(&result->source);
+  free_literals(result);
+  free(result->decls);
+  free(result->node_hashes);
+  free(result->node_strings);
+  free(result);
+}
+
+bool tau_parse_result_ok(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_ok: result cannot be NULL");
+  return result->root != NODE_NULL && result->parser.diags.error_count == 0;
+}
+
+const struct tau_ast *tau_parse_result_ast(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_ast: result cannot be NULL");
+  return &result->parser.ast;
+}
+
+uint32_t tau_parse_result_root(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_root: result cannot be NULL");
+  return result->root;
+}
+
+uint64_t tau_parse_result_content_hash(struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_content_hash: result cannot be NULL");
+  if (!result->content_hashed) {
+    result->content_hash = tau_hash64(result->parser.ast.buf, result->parser.ast.buf_size, 0);
+    result->content_hashed = true;
+  }
+
+  return result->content_hash;
+}
+
+uint64_t tau_parse_result_node_hash(struct tau_parse_result *result, uint32_t id) {
+  assert(result != NULL && "tau_parse_result_node_hash: result cannot be NULL");
+  const struct tau_ast *ast = &result->parser.ast;
+  assert(id != NODE_NULL && id < ast->node_count && "tau_parse_result_node_hash: invalid node id");
+  if (result->node_hashes == NULL) {
+    result->node_hashes = calloc(ast->node_count, sizeof(uint64_t));
+    assert(result->node_hashes != NULL && "tau_parse_result_node_hash: out of memory");
+    ast_hash_subtrees(ast, result->root, result->node_hashes);
+  }
+
+  return result->node_hashes[id];
+}
+
+const char *tau_parse_result_node_doc(const struct tau_parse_result *result, uint32_t id, size_t *len) {
+  assert(result != NULL && "tau_parse_result_node_doc: result cannot be NULL");
+  assert(id < result->parser.ast.node_count && "tau_parse_result_node_doc: invalid node id");
+  const struct tau_token_table *tokens = &result->parser.tokens;
+  token_id_t token;
+  if (!tokens->keep_docs || !node_token(result, id, &token) || tokens->doc_lens[token] == 0) {
+    *len = 0;
+    return NULL;
+  }
+
+  *len = tokens->doc_lens[token];
+  return result->parser.ast.buf + tokens->doc_offsets[token];
+}
+
+// Values the lexer decoded, trees loaded from the parse cache have no tokens and decode the node text instead
+static bool node_literal(const struct tau_parse_result *result, uint32_t id, enum tau_token_type type,
+                         union tau_literal *literal) {
+  const struct tau_node *node = ast_node(&result->parser.ast, id);
+  if (node->token_type != type) {
+    return false;
+  }
+
+  // nodes a reparse replaced have lost their token
+  if (result->parser.tokens.count != 0) {
+    return node_value(result, id, literal);
+  }
+
+  const char *text = result->parser.ast.buf + ast_node_offset(&result->parser.ast, id);
+  if (type == TAU_TOKEN_TYPE_INT_LIT) {
+    tau_num_lit_decode_int(text, node->len, node->token_code, &literal->int_value);
+  } else {
+    tau_num_lit_decode_float(text, node->len, &literal->flt_value);
+  }
+
+  return true;
+}
+
+bool tau_parse_result_node_int(const struct tau_parse_result *result, uint32_t id, uint64_t *value) {
+  assert(result != NULL && "tau_parse_result_node_int: result cannot be NULL");
+  assert(id < result->parser.ast.node_count && "tau_parse_result_node_int: invalid node id");
+  union tau_literal literal;
+  if (!node_literal(result, id, TAU_TOKEN_TYPE_INT_LIT, &literal)) {
+    return false;
+  }
+
+  *value = literal.int_value;
+  return true;
+}
+
+bool tau_parse_result_node_float(const struct tau_parse_result *result, uint32_t id, double *value) {
+  assert(result != NULL && "tau_parse_result_node_float: result cannot be NULL");
+  assert(id < result->parser.ast.node_count && "tau_parse_result_node_float: invalid node id");
+  union tau_literal literal;
+  if (!node_literal(result, id, TAU_TOKEN_TYPE_FLT_LIT, &literal)) {
+    return false;
+  }
+
+  *value = literal.flt_value;
+  return true;
+}
+
+// Trees loaded from the parse cache come without tokens, so their string literals are all decoded into the pool on
+// first use instead, which leaves it as it is for every lookup after that
+static void decode_cached_strings(struct tau_parse_result *result) {
+  const struct tau_ast *ast = &result->parser.ast;
+  struct tau_str_pool *strings = &result->parser.tokens.strings;
+  result->node_strings = calloc(ast->node_count, sizeof(struct tau_str_pool_entry));
+  assert(result->node_strings != NULL && "decode_cached_strings: out of memory");
+  for (node_id_t id = 1; id < ast->node_count; id++) {
+    const struct tau_node *node = ast_node(ast, id);
+    if (node->token_type != TAU_TOKEN_TYPE_STR_LIT) {
+      continue;
+    }
+
+    // quotes left out
+    char *dest = tau_str_pool_reserve(strings, node->len - 2);
+    uint32_t len = (uint32_t)tau_str_lit_decode(ast->buf + ast_node_offset(ast, id) + 1, node->len - 2, dest);
+    result->node_strings[id] = (struct tau_str_pool_entry){.offset = tau_str_pool_commit(strings, len), .len = len};
+  }
+}
+
+const char *tau_parse_result_node_string(struct tau_parse_result *result, uint32_t id, size_t *len) {
+  assert(result != NULL && "tau_parse_result_node_string: result cannot be NULL");
+  assert(id < result->parser.ast.node_count && "tau_parse_result_node_string: invalid node id");
+  assert(len != NULL && "tau_parse_result_node_string: len cannot be NULL");
+  const struct tau_node *node = ast_node(&result->parser.ast, id);
+  const struct tau_token_table *tokens = &result->parser.tokens;
+  if (node->token_type != TAU_TOKEN_TYPE_STR_LIT) {
+    *len = 0;
+    return NULL;
+  }
+
+  if (tokens->count == 0) {
+    if (result->node_strings == NULL) {
+      decode_cached_strings(result);
+    }
+
+    *len = result->node_strings[id].len;
+    return tokens->strings.data + result->node_strings[id].offset;
+  }
+
+  // nodes a reparse replaced have lost their token
+  union tau_literal literal;
+  if (!node_value(result, id, &literal)) {
+    *len = 0;
+    return NULL;
+  }
+
+  *len = literal.str_value.len;
+  return tokens->strings.data + literal.str_value.offset;
+}
+
+const char *tau_parse_result_strings(struct tau_parse_result *result, size_t *size) {
+  assert(result != NULL && "tau_parse_result_strings: result cannot be NULL");
+  assert(size != NULL && "tau_parse_result_strings: size cannot be NULL");
+  if (result->parser.tokens.count == 0 && result->node_strings == NULL) {
+    decode_cached_strings(result);
+  }
+
+  *size = result->parser.tokens.strings.size;
+  return result->parser.tokens.strings.data;
+}
+
+const struct tau_interner *tau_parse_result_interner(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_interner: result cannot be NULL");
+  return result->parser.interner;
+}
+
+size_t tau_parse_result_diagnostic_count(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_diagnostic_count: result cannot be NULL");
+  return result->parser.diags.count;
+}
+
+struct tau_parse_diagnostic tau_parse_result_diagnostic(const struct tau_parse_result *result, size_t index) {
+  assert(result != NULL && "tau_parse_result_diagnostic: result cannot be NULL");
+  assert(index < result->parser.diags.count && "tau_parse_result_diagnostic: index out of bounds");
+  const struct tau_diag *diag = &result->parser.diags.items[index];
+  return (struct tau_parse_diagnostic){
+      .severity = severity_from_log_level(diag->level),
+      .row = diag->loc.row,
+      .col = diag->loc.col,
+      .message = diag->message,
+      .code = tau_diag_get_code_name(diag->code),
+      .len = diag->len,
+      .repeat_count = diag->repeat_count,
+  };
+}
+
+const struct tau_diag_list *parse_result_diags(const struct tau_parse_result *result) {
+  assert(result != NULL && "parse_result_diags: result cannot be NULL");
+  return &result->parser.diags;
+}
+
+size_t tau_parse_result_error_count(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_error_count: result cannot be NULL");
+  return result->parser.diags.error_count;
+}
+
+void tau_parse_result_write_diagnostics(const struct tau_parse_result *result, enum tau_parse_format format,
+                                        FILE *out) {
+  assert(result != NULL && "tau_parse_result_write_diagnostics: result cannot be NULL");
+  struct tau_diag_writer writer;
+  tau_diag_writer_init(&writer, format == TAU_PARSE_FORMAT_JSON ? TAU_DIAG_FORMAT_JSON : TAU_DIAG_FORMAT_TEXT, out);
+  tau_diag_writer_add_list(&writer, &result->parser.diags);
+  tau_diag_writer_finish(&writer);
+}
+
+struct tau_parse_stats tau_parse_result_stats(const struct tau_parse_result *result) {
+  assert(result != NULL && "tau_parse_result_stats: result cannot be NULL");
+  return result->stats;
+}
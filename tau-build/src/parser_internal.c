@@ -4,293 +4,309 @@
 #include "parser_internal.h"
 
 #include <assert.h>
-#include <malloc.h>
+#include <string.h>
 
 #include "log.h"
 #include "parser_match.h"
 
-// NOLINTNEXTLINE(misc-no-recursion)
-void node_free(struct tau_node *node) {
-  if (node->left != NULL) {
-    node_free(node->left);
-  }
-
-  if (node->right != NULL) {
-    node_free(node->right);
-  }
-
-  free(node);
+void parser_init(struct tau_parser *parser, const char *buf_name, const char *buf_data, size_t buf_size) {
+  parser_init_shared(parser, NULL, NULL, buf_name, buf_data, buf_size);
 }
 
-struct tau_node *node_new_empty(enum tau_node_type type, struct tau_token token) {
-  struct tau_node *node = calloc(1, sizeof(struct tau_node));
-  node->token = token;
-  node->type = type;
-  return node;
+void parser_init_shared(struct tau_parser *parser, struct tau_interner *interner, const struct tau_diag_policy *policy,
+                        const char *buf_name, const char *buf_data, size_t buf_size) {
+  parser_init_untokenized(parser, interner, policy, buf_name, buf_data, buf_size);
+  tau_token_table_lex(&parser->tokens, &parser->diags, buf_name, buf_data, buf_size);
 }
 
-struct tau_node *node_new_unary(enum tau_node_type type, struct tau_token token, struct tau_node *operand) {
-  struct tau_node *node = calloc(1, sizeof(struct tau_node));
-  node->token = token;
-  node->left = operand;
-  node->type = type;
-  return node;
+void parser_init_untokenized(struct tau_parser *parser, struct tau_interner *interner,
+                             const struct tau_diag_policy *policy, const char *buf_name, const char *buf_data,
+                             size_t buf_size) {
+  assert(parser != NULL && "parser_init_untokenized: parser cannot be NULL");
+  parser->owns_interner = interner == NULL;
+  parser->interner = interner != NULL ? interner : tau_interner_new();
+  tau_diag_list_init(&parser->diags);
+  if (policy != NULL) {
+    tau_diag_list_set_policy(&parser->diags, *policy);
+  }
+
+  tau_token_table_init(&parser->tokens);
+  parser->tokens.interner = parser->interner;
+  parser->ahead = 0;
+  parser->origin = 0;
+  parser->panicking = false;
+  ast_init(&parser->ast, buf_name, buf_data, buf_size);
 }
 
-struct tau_node *node_new_binary(enum tau_node_type type, struct tau_token token, struct tau_node *left,
-                                 struct tau_node *right) {
-  struct tau_node *node = calloc(1, sizeof(struct tau_node));
-  node->token = token;
-  node->left = left;
-  node->right = right;
-  node->type = type;
-  return node;
-}
+void parser_free(struct tau_parser *parser) {
+  assert(parser != NULL && "parser_free: parser cannot be NULL");
+  tau_token_table_free(&parser->tokens);
+  tau_diag_list_free(&parser->diags);
+  ast_free(&parser->ast);
+  if (parser->owns_interner) {
+    tau_interner_free(parser->interner);
+  }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_expr: ahead cannot be NULL");
-  return parse_log_or_expr(ahead);
+  parser->interner = NULL;
 }
 
-struct tau_node *parse_cast_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_cast_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_log_or_expr(ahead);
-  for (;;) {
-    struct tau_token as_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_AS)) {
-      struct tau_node *right = parse_log_or_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_CAST_EXPR, as_token, left, right);
-      continue;
-    }
+struct tau_loc parser_token_loc(struct tau_parser *parser, token_id_t token) {
+  assert(token < parser->tokens.count && "parser_token_loc: invalid token id");
+  return tau_line_index_loc(&parser->ast.lines, parser->ast.buf_name, parser->ast.buf, parser->ast.buf_size,
+                            parser->tokens.offsets[token]);
+}
 
-    break;
+const char *parser_token_text(const struct tau_parser *parser, token_id_t token, size_t *len) {
+  assert(token < parser->tokens.count && "parser_token_text: invalid token id");
+  if (len != NULL) {
+    *len = parser->tokens.lens[token];
   }
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+  return parser->ast.buf + parser->tokens.offsets[token];
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_log_or_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_log_or_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_log_and_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_PIPE, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_log_and_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_LOG_OR_EXPR, infix_token, left, right);
-      continue;
-    }
-
-    break;
+void parser_report_unexpected(struct tau_parser *parser, const char *expecting) {
+  if (parser->panicking) {
+    return;
   }
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+  parser->panicking = true;
+  size_t ahead_len = 0;
+  const char *ahead_buf = parser_token_text(parser, parser->ahead, &ahead_len);
+  tau_diag_report(&parser->diags, TAU_DIAG_UNEXPECTED_TOKEN, parser_token_loc(parser, parser->ahead), ahead_len,
+                  (struct tau_diag_arg[]){{ahead_buf, ahead_len}, {expecting, strlen(expecting)}});
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_log_and_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_log_and_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_rel_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_AMP, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_rel_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_LOG_AND_EXPR, infix_token, left, right);
-      continue;
-    }
-
-    break;
+static bool is_sync_keyword(struct tau_parser *parser, token_id_t token) {
+  if (parser->tokens.types[token] != TAU_TOKEN_TYPE_KEYWORD) {
+    return false;
   }
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+  uint8_t code = parser->tokens.codes[token];
+  return code == TAU_KEYWORD_LET || code == TAU_KEYWORD_PROC || code == TAU_KEYWORD_TYPE || code == TAU_KEYWORD_EXTERN;
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_rel_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_rel_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_cmp_expr(ahead);
+// The lexer leaves no end of line inside parentheses or brackets, so only the braces skipped over need to be
+// balanced here. Every token is looked at once, which keeps recovery linear however broken the input is.
+node_id_t parser_recover(struct tau_parser *parser, token_id_t from, enum parser_sync sync) {
+  assert(from <= parser->ahead && "parser_recover: from cannot be past the token ahead");
+  uint32_t depth = 0;
   for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_EQ, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_cmp_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_EQ_EXPR, infix_token, left, right);
-      continue;
+    token_id_t token = parser->ahead;
+    enum tau_token_type type = parser->tokens.types[token];
+    bool closes = type == TAU_TOKEN_TYPE_PUNCT && parser->tokens.codes[token] == TAU_PUNCT_RCBR;
+    if (type == TAU_TOKEN_TYPE_EOF) {
+      break;
     }
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_BANG_EQ, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_cmp_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_NE_EXPR, infix_token, left, right);
-      continue;
+    if (token != from && depth == 0 &&
+        (is_sync_keyword(parser, token) || (sync == PARSER_SYNC_BLOCK && closes))) {
+      break;
     }
 
-    break;
+    consume(parser);
+    if (type == TAU_TOKEN_TYPE_PUNCT && parser->tokens.codes[token] == TAU_PUNCT_LCBR) {
+      depth++;
+    } else if (closes && depth > 0) {
+      depth--;
+    } else if (sync == PARSER_SYNC_BLOCK && depth == 0 && type == TAU_TOKEN_TYPE_EOL) {
+      break;
+    }
   }
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
+  node_id_t error = node_new_empty(parser, TAU_NODE_ERROR, from);
+  if (parser->ahead > from) {
+    token_id_t last = parser->ahead - 1;
+    uint32_t end = parser->tokens.offsets[last] + parser->tokens.lens[last];
+    node_at(parser, error)->len = end - parser->tokens.offsets[from];
   }
-  return NULL;
+
+  parser->panicking = false;
+  return error;
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_cmp_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_cmp_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_bit_or_expr(ahead);
-  enum tau_punct matching_punct[] = {TAU_PUNCT_LT, TAU_PUNCT_LT_EQ, TAU_PUNCT_GT, TAU_PUNCT_GT_EQ, TAU_PUNCT_NONE};
-  enum tau_node_type producing_types[] = {TAU_NODE_LT_EXPR, TAU_NODE_LE_EXPR, TAU_NODE_GT_EXPR, TAU_NODE_GE_EXPR,
-                                          TAU_NODE_NONE};
+// Appends node to the list linked through right from parent's left, tail is the last node appended so far
+static void node_append(struct tau_parser *parser, node_id_t parent, node_id_t *tail, node_id_t node) {
+  if (*tail == NODE_NULL) {
+    node_at(parser, parent)->left = node;
+  } else {
+    node_at(parser, *tail)->right = node;
+  }
 
-  for (;;) {
-    bool should_continue = false;
-    for (int i = 0; matching_punct[i] != TAU_PUNCT_NONE; i++) {
-      struct tau_token infix_token = *ahead;
-      if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, matching_punct[i], TAU_KEYWORD_NONE)) {
-        struct tau_node *right = parse_bit_or_expr(ahead);
-        MUST_OR_FAIL(right, ahead, "<expression>");
-        left = node_new_binary(producing_types[i], infix_token, left, right);
-        should_continue = true;
-        break;
-      }
-    }
+  *tail = node;
+}
 
-    if (!should_continue) {
-      break;
-    }
+// Appends node to the list running from head through right, tail is the last node appended so far
+static void node_append_run(struct tau_parser *parser, node_id_t *head, node_id_t *tail, node_id_t node) {
+  if (*tail == NODE_NULL) {
+    *head = node;
+  } else {
+    node_at(parser, *tail)->right = node;
   }
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+
+  *tail = node;
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_bit_or_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_bit_or_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_bit_and_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_PIPE, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_bit_and_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_BIT_OR_EXPR, infix_token, left, right);
-      continue;
-    }
+void node_set_token(struct tau_parser *parser, node_id_t id, token_id_t token) {
+  assert(token < parser->tokens.count && "node_set_token: invalid token id");
+  assert(parser->tokens.offsets[token] >= parser->origin && "node_set_token: token before the declaration start");
+  struct tau_node *node = node_at(parser, id);
+  node->offset = parser->tokens.offsets[token] - parser->origin;
+  node->len = parser->tokens.lens[token];
+  node->token_type = parser->tokens.types[token];
+  node->token_code = parser->tokens.codes[token];
+  node->symbol = parser->tokens.symbols[token];
+}
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_CIRC, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_bit_and_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_BIT_XOR_EXPR, infix_token, left, right);
-      continue;
-    }
+node_id_t node_new_empty(struct tau_parser *parser, enum tau_node_type type, token_id_t token) {
+  return node_new_binary(parser, type, token, NODE_NULL, NODE_NULL);
+}
 
-    break;
-  }
+node_id_t node_new_unary(struct tau_parser *parser, enum tau_node_type type, token_id_t token,
+                         node_id_t operand) {
+  return node_new_binary(parser, type, token, operand, NODE_NULL);
+}
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+node_id_t node_new_binary(struct tau_parser *parser, enum tau_node_type type, token_id_t token, node_id_t left,
+                          node_id_t right) {
+  node_id_t id = ast_node_new(&parser->ast, type, left, right);
+  node_set_token(parser, id, token);
+  return id;
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_bit_and_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_bit_and_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_bit_shift_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_AMP, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_bit_shift_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_BIT_AND_EXPR, infix_token, left, right);
-      continue;
-    }
+node_id_t node_new_like(struct tau_parser *parser, enum tau_node_type type, node_id_t like, node_id_t left,
+                        node_id_t right) {
+  node_id_t id = ast_node_new(&parser->ast, type, left, right);
+  const struct tau_node *source = node_at(parser, like);
+  struct tau_node *node = node_at(parser, id);
+  node->offset = source->offset;
+  node->len = source->len;
+  node->token_type = source->token_type;
+  node->token_code = source->token_code;
+  node->symbol = source->symbol;
+  return id;
+}
 
-    break;
+// Binding power of the infix operators, loosest first, every level is left associative. Levels up to
+// INFIX_PREC_PROOF take unary operands while the lookup levels only take primary expressions and are climbed
+// separately, below subscriptions, so `a(b).c` still stops before `.c`.
+enum infix_prec {
+  INFIX_PREC_NONE,
+  INFIX_PREC_LOG_OR,         // ||
+  INFIX_PREC_LOG_AND,        // &&
+  INFIX_PREC_REL,            // == !=
+  INFIX_PREC_CMP,            // < <= > >=
+  INFIX_PREC_BIT_OR,         // | ^
+  INFIX_PREC_BIT_AND,        // &
+  INFIX_PREC_BIT_SHIFT,      // << >>
+  INFIX_PREC_TERM,           // + -
+  INFIX_PREC_FACT,           // * / %
+  INFIX_PREC_PROOF,          // :
+  INFIX_PREC_VALUE_LOOKUP,   // .
+  INFIX_PREC_STATIC_LOOKUP,  // ::
+};
+
+struct infix_op {
+  uint8_t prec;  // enum infix_prec
+  uint8_t type;  // enum tau_node_type
+};
+
+static const struct infix_op infix_op_table[TAU_PUNCT_COUNT] = {
+    [TAU_PUNCT_D_PIPE] = {INFIX_PREC_LOG_OR, TAU_NODE_LOG_OR_EXPR},
+    [TAU_PUNCT_D_AMP] = {INFIX_PREC_LOG_AND, TAU_NODE_LOG_AND_EXPR},
+    [TAU_PUNCT_D_EQ] = {INFIX_PREC_REL, TAU_NODE_EQ_EXPR},
+    [TAU_PUNCT_BANG_EQ] = {INFIX_PREC_REL, TAU_NODE_NE_EXPR},
+    [TAU_PUNCT_LT] = {INFIX_PREC_CMP, TAU_NODE_LT_EXPR},
+    [TAU_PUNCT_LT_EQ] = {INFIX_PREC_CMP, TAU_NODE_LE_EXPR},
+    [TAU_PUNCT_GT] = {INFIX_PREC_CMP, TAU_NODE_GT_EXPR},
+    [TAU_PUNCT_GT_EQ] = {INFIX_PREC_CMP, TAU_NODE_GE_EXPR},
+    [TAU_PUNCT_PIPE] = {INFIX_PREC_BIT_OR, TAU_NODE_BIT_OR_EXPR},
+    [TAU_PUNCT_CIRC] = {INFIX_PREC_BIT_OR, TAU_NODE_BIT_XOR_EXPR},
+    [TAU_PUNCT_AMP] = {INFIX_PREC_BIT_AND, TAU_NODE_BIT_AND_EXPR},
+    [TAU_PUNCT_D_LT] = {INFIX_PREC_BIT_SHIFT, TAU_NODE_LSH_EXPR},
+    [TAU_PUNCT_D_GT] = {INFIX_PREC_BIT_SHIFT, TAU_NODE_RSH_EXPR},
+    [TAU_PUNCT_PLUS] = {INFIX_PREC_TERM, TAU_NODE_ADD_EXPR},
+    [TAU_PUNCT_HYPHEN] = {INFIX_PREC_TERM, TAU_NODE_SUB_EXPR},
+    [TAU_PUNCT_AST] = {INFIX_PREC_FACT, TAU_NODE_MUL_EXPR},
+    [TAU_PUNCT_SLASH] = {INFIX_PREC_FACT, TAU_NODE_DIV_EXPR},
+    [TAU_PUNCT_PCT] = {INFIX_PREC_FACT, TAU_NODE_REM_EXPR},
+    [TAU_PUNCT_COLON] = {INFIX_PREC_PROOF, TAU_NODE_PROOF_EXPR},
+    [TAU_PUNCT_DOT] = {INFIX_PREC_VALUE_LOOKUP, TAU_NODE_VALUE_LOOKUP_EXPR},
+    [TAU_PUNCT_D_COLON] = {INFIX_PREC_STATIC_LOOKUP, TAU_NODE_STATIC_LOOKUP_EXPR},
+};
+
+static const uint8_t unary_node_type_table[TAU_PUNCT_COUNT] = {
+    [TAU_PUNCT_PLUS] = TAU_NODE_U_POS_EXPR,
+    [TAU_PUNCT_HYPHEN] = TAU_NODE_U_NEG_EXPR,
+    [TAU_PUNCT_BANG] = TAU_NODE_U_LOG_NOT_EXPR,
+    [TAU_PUNCT_TILDE] = TAU_NODE_U_BIT_NOT_EXPR,
+};
+
+static_assert(TAU_NODE_NONE == 0 && "unary_node_type_table: TAU_NODE_NONE must be the zero value");
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static node_id_t parse_infix_operand(struct tau_parser *parser, int min_prec, int max_prec) {
+  if (max_prec > INFIX_PREC_PROOF) {
+    return parse_primary_expr(parser);
   }
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
+  // `&` takes a whole proof, so every operand but the right one of `:` may start with it
+  if (min_prec <= INFIX_PREC_PROOF && match(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_AMP, TAU_KEYWORD_NONE)) {
+    return parse_ref_expr(parser);
   }
-  return NULL;
+
+  return parse_unary_expr(parser);
 }
 
+// Precedence climbing over infix_op_table, one call per operand instead of one per level. Consumes operators from
+// min_prec up to max_prec, which is either INFIX_PREC_PROOF or INFIX_PREC_STATIC_LOOKUP. When a right operand is
+// missing the failing level yields NODE_NULL and only looser operators are taken afterwards, the same trees and
+// diagnostics a function per level would give.
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_bit_shift_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_bit_shift_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_term_expr(ahead);
+static node_id_t parse_infix_expr(struct tau_parser *parser, int min_prec, int max_prec) {
+  int cap_prec = max_prec;
+  node_id_t left = parse_infix_operand(parser, min_prec, max_prec);
   for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_LT, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_term_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_LSH_EXPR, infix_token, left, right);
-      continue;
+    token_id_t infix_token = parser->ahead;
+    if (parser->tokens.types[infix_token] != TAU_TOKEN_TYPE_PUNCT) {
+      break;
     }
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_GT, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_term_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_RSH_EXPR, infix_token, left, right);
+    struct infix_op op = infix_op_table[parser->tokens.codes[infix_token]];
+    if (op.prec < min_prec || op.prec > cap_prec) {
+      break;
+    }
+
+    consume(parser);
+    node_id_t right = parse_infix_expr(parser, op.prec + 1, max_prec);
+    if (right == NODE_NULL) {
+      parser_report_unexpected(parser, "<expression>");
+      left = NODE_NULL;
+      cap_prec = op.prec - 1;
       continue;
     }
 
-    break;
+    left = node_new_binary(parser, op.type, infix_token, left, right);
   }
 
   return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_term_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_term_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_fact_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_PLUS, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_fact_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_ADD_EXPR, infix_token, left, right);
-      continue;
-    }
+node_id_t parse_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_LOG_OR, INFIX_PREC_PROOF);
+}
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_HYPHEN, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_fact_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_SUB_EXPR, infix_token, left, right);
+node_id_t parse_cast_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_cast_expr: parser cannot be NULL");
+  node_id_t left = parse_log_or_expr(parser);
+  for (;;) {
+    token_id_t as_token = parser->ahead;
+    if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_AS)) {
+      node_id_t right = parse_log_or_expr(parser);
+      MUST_OR_RETURN_NULL(right, parser, "<expression>");
+      left = node_new_binary(parser, TAU_NODE_CAST_EXPR, as_token, left, right);
       continue;
     }
 
@@ -298,65 +314,76 @@ struct tau_node *parse_term_expr(struct tau_token *ahead) {
   }
 
   return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_fact_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_fact_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_ref_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_AST, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_ref_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_MUL_EXPR, infix_token, left, right);
-      continue;
-    }
+node_id_t parse_log_or_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_log_or_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_LOG_OR, INFIX_PREC_PROOF);
+}
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_SLASH, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_ref_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_DIV_EXPR, infix_token, left, right);
-      continue;
-    }
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_log_and_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_log_and_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_LOG_AND, INFIX_PREC_PROOF);
+}
 
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_PCT, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_ref_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_REM_EXPR, infix_token, left, right);
-      continue;
-    }
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_rel_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_rel_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_REL, INFIX_PREC_PROOF);
+}
 
-    break;
-  }
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_cmp_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_cmp_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_CMP, INFIX_PREC_PROOF);
+}
 
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_bit_or_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_bit_or_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_BIT_OR, INFIX_PREC_PROOF);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_bit_and_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_bit_and_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_BIT_AND, INFIX_PREC_PROOF);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_bit_shift_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_bit_shift_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_BIT_SHIFT, INFIX_PREC_PROOF);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_term_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_term_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_TERM, INFIX_PREC_PROOF);
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_fact_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_fact_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_FACT, INFIX_PREC_PROOF);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_ref_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_ref_expr: ahead cannot be NULL");
-  struct tau_node *node = NULL;
-  struct tau_node *root = NULL;
+node_id_t parse_ref_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_ref_expr: parser cannot be NULL");
+  node_id_t node = NODE_NULL;
+  node_id_t root = NODE_NULL;
   for (;;) {
-    struct tau_token unary_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_AMP, TAU_KEYWORD_NONE)) {
-      if (node == NULL) {
-        node = node_new_unary(TAU_NODE_U_REF_EXPR, unary_token, NULL);
+    token_id_t unary_token = parser->ahead;
+    if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_AMP, TAU_KEYWORD_NONE)) {
+      if (node == NODE_NULL) {
+        node = node_new_unary(parser, TAU_NODE_U_REF_EXPR, unary_token, NODE_NULL);
         root = node;
       } else {
-        node->left = node_new_unary(TAU_NODE_U_REF_EXPR, unary_token, NULL);
-        node = node->left;
+        node_at(parser, node)->left = node_new_unary(parser, TAU_NODE_U_REF_EXPR, unary_token, NODE_NULL);
+        node = node_at(parser, node)->left;
       }
 
       continue;
@@ -365,94 +392,71 @@ struct tau_node *parse_ref_expr(struct tau_token *ahead) {
     break;
   }
 
-  if (root == NULL) {
-    return parse_proof_expr(ahead);
+  if (root == NODE_NULL) {
+    return parse_proof_expr(parser);
   }
 
-  node->left = parse_proof_expr(ahead);
+  node_at(parser, node)->left = parse_proof_expr(parser);
   return root;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_proof_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_proof_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_unary_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COLON, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_unary_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_PROOF_EXPR, infix_token, left, right);
-      continue;
-    }
-
-    break;
-  }
-
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+node_id_t parse_proof_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_proof_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_PROOF, INFIX_PREC_PROOF);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_unary_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_unary_expr: ahead cannot be NULL");
-  struct tau_node *node = NULL;
-  struct tau_node *root = NULL;
-  enum tau_punct matching_punct[] = {TAU_PUNCT_PLUS, TAU_PUNCT_HYPHEN, TAU_PUNCT_BANG, TAU_PUNCT_TILDE, TAU_PUNCT_NONE};
-  enum tau_node_type producing_types[] = {TAU_NODE_U_POS_EXPR, TAU_NODE_U_NEG_EXPR, TAU_NODE_U_LOG_NOT_EXPR,
-                                          TAU_NODE_U_BIT_NOT_EXPR, TAU_NODE_NONE};
+node_id_t parse_unary_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_unary_expr: parser cannot be NULL");
+  node_id_t node = NODE_NULL;
+  node_id_t root = NODE_NULL;
   for (;;) {
-    bool should_continue = false;
-    for (int i = 0; matching_punct[i] != TAU_PUNCT_NONE; i++) {
-      struct tau_token unary_token = *ahead;
-      if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, matching_punct[i], TAU_KEYWORD_NONE)) {
-        if (node == NULL) {
-          node = node_new_unary(producing_types[i], unary_token, NULL);
-          root = node;
-        } else {
-          node->left = node_new_unary(producing_types[i], unary_token, NULL);
-          node = node->left;
-        }
-
-        should_continue = true;
-        break;
-      }
+    token_id_t unary_token = parser->ahead;
+    if (parser->tokens.types[unary_token] != TAU_TOKEN_TYPE_PUNCT) {
+      break;
     }
 
-    if (!should_continue) {
+    enum tau_node_type type = unary_node_type_table[parser->tokens.codes[unary_token]];
+    if (type == TAU_NODE_NONE) {
       break;
     }
+
+    consume(parser);
+    if (node == NODE_NULL) {
+      node = node_new_unary(parser, type, unary_token, NODE_NULL);
+      root = node;
+    } else {
+      node_at(parser, node)->left = node_new_unary(parser, type, unary_token, NODE_NULL);
+      node = node_at(parser, node)->left;
+    }
   }
 
-  if (root == NULL) {
-    return parse_subscription_expr(ahead);
+  if (root == NODE_NULL) {
+    return parse_subscription_expr(parser);
   }
 
-  node->left = parse_subscription_expr(ahead);
+  node_at(parser, node)->left = parse_subscription_expr(parser);
   return root;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_subscription_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_subscription_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_value_lookup_expr(ahead);
-  struct tau_node *right = NULL;
+node_id_t parse_subscription_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_subscription_expr: parser cannot be NULL");
+  node_id_t left = parse_value_lookup_expr(parser);
+  node_id_t right = NODE_NULL;
 
   for (;;) {
-    struct tau_token subscription_token = *ahead;
-    right = parse_calling_args(ahead);
-    if (right != NULL) {
-      left = node_new_binary(TAU_NODE_SUBSCRIPTION_EXPR, subscription_token, left, right);
+    token_id_t subscription_token = parser->ahead;
+    right = parse_calling_args(parser);
+    if (right != NODE_NULL) {
+      left = node_new_binary(parser, TAU_NODE_SUBSCRIPTION_EXPR, subscription_token, left, right);
       continue;
     }
 
-    right = parse_indexing_args(ahead);
-    if (right != NULL) {
-      left = node_new_binary(TAU_NODE_SUBSCRIPTION_EXPR, subscription_token, left, right);
+    right = parse_indexing_args(parser);
+    if (right != NODE_NULL) {
+      left = node_new_binary(parser, TAU_NODE_SUBSCRIPTION_EXPR, subscription_token, left, right);
       continue;
     }
 
@@ -463,283 +467,232 @@ struct tau_node *parse_subscription_expr(struct tau_token *ahead) {
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_value_lookup_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_value_lookup_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_static_lookup_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_DOT, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_static_lookup_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_VALUE_LOOKUP_EXPR, infix_token, left, right);
-      continue;
-    }
-
-    break;
-  }
-
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+node_id_t parse_value_lookup_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_value_lookup_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_VALUE_LOOKUP, INFIX_PREC_STATIC_LOOKUP);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_static_lookup_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_static_lookup_expr: ahead cannot be NULL");
-  struct tau_node *left = parse_primary_expr(ahead);
-  for (;;) {
-    struct tau_token infix_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_D_COLON, TAU_KEYWORD_NONE)) {
-      struct tau_node *right = parse_primary_expr(ahead);
-      MUST_OR_FAIL(right, ahead, "<expression>");
-      left = node_new_binary(TAU_NODE_STATIC_LOOKUP_EXPR, infix_token, left, right);
-      continue;
-    }
-
-    break;
-  }
-
-  return left;
-handle_fail:
-  if (left != NULL) {
-    node_free(left);
-  }
-  return NULL;
+node_id_t parse_static_lookup_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_static_lookup_expr: parser cannot be NULL");
+  return parse_infix_expr(parser, INFIX_PREC_STATIC_LOOKUP, INFIX_PREC_STATIC_LOOKUP);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_primary_expr(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_primary_expr: ahead cannot be NULL");
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
-    struct tau_node *node = parse_expr(ahead);
-    MUST_OR_RETURN_NULL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), ahead,
+node_id_t parse_primary_expr(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_primary_expr: parser cannot be NULL");
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
+    node_id_t node = parse_expr(parser);
+    MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), parser,
                         "<closing `)`>");
     return node;
   }
 
-  return parse_atom(ahead);
+  return parse_atom(parser);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_atom(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_atom: ahead cannot be NULL");
+node_id_t parse_atom(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_atom: parser cannot be NULL");
   enum tau_token_type matching_types[] = {TAU_TOKEN_TYPE_IDENTIFIER, TAU_TOKEN_TYPE_UNI_LIT, TAU_TOKEN_TYPE_NIL_LIT,
                                           TAU_TOKEN_TYPE_BOL_LIT,    TAU_TOKEN_TYPE_INT_LIT, TAU_TOKEN_TYPE_FLT_LIT,
                                           TAU_TOKEN_TYPE_STR_LIT,    TAU_TOKEN_TYPE_NONE};
   for (int i = 0; matching_types[i] != TAU_TOKEN_TYPE_NONE; i++) {
-    struct tau_token atom_token = *ahead;
-    if (match_and_consume(ahead, matching_types[i], TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
-      return node_new_empty(TAU_NODE_ATOM, atom_token);
+    token_id_t atom_token = parser->ahead;
+    if (match_and_consume(parser, matching_types[i], TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
+      return node_new_empty(parser, TAU_NODE_ATOM, atom_token);
     }
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_calling_args(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_calling_args: ahead cannot be NULL");
-  struct tau_node *root = NULL;
-  struct tau_node *node = NULL;
-  struct tau_token call_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
-    root = node_new_empty(TAU_NODE_CALLING_ARGS, *ahead);
+node_id_t parse_calling_args(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_calling_args: parser cannot be NULL");
+  node_id_t root = NODE_NULL;
+  node_id_t node = NODE_NULL;
+  token_id_t call_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
+    root = node_new_empty(parser, TAU_NODE_CALLING_ARGS, parser->ahead);
     for (;;) {
-      struct tau_token arg_token = *ahead;
-      struct tau_node *arg = parse_expr(ahead);
-      if (arg != NULL) {
-        if (node == NULL) {
-          node = node_new_unary(TAU_NODE_CALLING_ARG, call_token, arg);
-          root->left = node;
+      token_id_t arg_token = parser->ahead;
+      node_id_t arg = parse_expr(parser);
+      if (arg != NODE_NULL) {
+        if (node == NODE_NULL) {
+          node = node_new_unary(parser, TAU_NODE_CALLING_ARG, call_token, arg);
+          node_at(parser, root)->left = node;
         } else {
-          node->right = node_new_unary(TAU_NODE_CALLING_ARG, arg_token, arg);
-          node = node->right;
+          node_at(parser, node)->right = node_new_unary(parser, TAU_NODE_CALLING_ARG, arg_token, arg);
+          node = node_at(parser, node)->right;
         }
 
-        if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
+        if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
           continue;
         }
       }
 
       break;
     }
-    MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), ahead,
-                 "<closing `)`>");
+    MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), parser,
+                        "<closing `)`>");
     return root;
   }
 
-handle_fail:
-  if (root != NULL) {
-    node_free(root);
-  }
-
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_indexing_args(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_indexing_args: ahead cannot be NULL");
-  struct tau_node *root = NULL;
-  struct tau_node *node = NULL;
-  struct tau_token index_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LSBR, TAU_KEYWORD_NONE)) {
-    root = node_new_empty(TAU_NODE_INDEXING_ARGS, *ahead);
+node_id_t parse_indexing_args(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_indexing_args: parser cannot be NULL");
+  node_id_t root = NODE_NULL;
+  node_id_t node = NODE_NULL;
+  token_id_t index_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LSBR, TAU_KEYWORD_NONE)) {
+    root = node_new_empty(parser, TAU_NODE_INDEXING_ARGS, parser->ahead);
     for (;;) {
-      struct tau_token arg_token = *ahead;
-      struct tau_node *arg = parse_expr(ahead);
-      if (arg != NULL) {
-        if (node == NULL) {
-          node = node_new_unary(TAU_NODE_INDEXING_ARG, index_token, arg);
-          root->left = node;
+      token_id_t arg_token = parser->ahead;
+      node_id_t arg = parse_expr(parser);
+      if (arg != NODE_NULL) {
+        if (node == NODE_NULL) {
+          node = node_new_unary(parser, TAU_NODE_INDEXING_ARG, index_token, arg);
+          node_at(parser, root)->left = node;
         } else {
-          node->right = node_new_unary(TAU_NODE_INDEXING_ARG, arg_token, arg);
-          node = node->right;
+          node_at(parser, node)->right = node_new_unary(parser, TAU_NODE_INDEXING_ARG, arg_token, arg);
+          node = node_at(parser, node)->right;
         }
 
-        if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
+        if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
           continue;
         }
       }
 
       break;
     }
-    MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RSBR, TAU_KEYWORD_NONE), ahead,
-                 "<closing `]`>");
+    MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RSBR, TAU_KEYWORD_NONE), parser,
+                        "<closing `]`>");
     return root;
   }
 
-handle_fail:
-  if (root != NULL) {
-    node_free(root);
-  }
-
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_return_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_return_stmt: ahead cannot be NULL");
-  struct tau_token stmt_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_RETURN)) {
-    struct tau_node *stmt_node = node_new_empty(TAU_NODE_RETURN_STMT, stmt_token);
-    stmt_node->left = parse_expr(ahead);
+node_id_t parse_return_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_return_stmt: parser cannot be NULL");
+  token_id_t stmt_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_RETURN)) {
+    node_id_t stmt_node = node_new_empty(parser, TAU_NODE_RETURN_STMT, stmt_token);
+    node_at(parser, stmt_node)->left = parse_expr(parser);
     return stmt_node;
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_continue_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_continue_stmt: ahead cannot be NULL");
-  struct tau_token stmt_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_CONTINUE)) {
-    return node_new_empty(TAU_NODE_CONTINUE_STMT, stmt_token);
+node_id_t parse_continue_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_continue_stmt: parser cannot be NULL");
+  token_id_t stmt_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_CONTINUE)) {
+    return node_new_empty(parser, TAU_NODE_CONTINUE_STMT, stmt_token);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_break_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_break_stmt: ahead cannot be NULL");
-  struct tau_token stmt_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_BREAK)) {
-    return node_new_empty(TAU_NODE_BREAK_STMT, stmt_token);
+node_id_t parse_break_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_break_stmt: parser cannot be NULL");
+  token_id_t stmt_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_BREAK)) {
+    return node_new_empty(parser, TAU_NODE_BREAK_STMT, stmt_token);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_if_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_if_stmt: ahead cannot be NULL");
-  struct tau_node *main_branch = NULL;
-  struct tau_token if_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_IF)) {
-    main_branch = parse_main_branch(ahead);
-    MUST_OR_FAIL(main_branch, ahead, "<main branch>");
-
-    struct tau_node *attach_to = main_branch;
+node_id_t parse_if_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_if_stmt: parser cannot be NULL");
+  node_id_t main_branch = NODE_NULL;
+  token_id_t if_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_IF)) {
+    main_branch = parse_main_branch(parser);
+    MUST_OR_RETURN_NULL(main_branch, parser, "<main branch>");
+
+    node_id_t attach_to = main_branch;
     for (;;) {
-      struct tau_node *elif_branch = parse_elif_branch(ahead);
-      if (elif_branch != NULL) {
-        attach_to->right = elif_branch;
-        attach_to = attach_to->right;
+      node_id_t elif_branch = parse_elif_branch(parser);
+      if (elif_branch != NODE_NULL) {
+        node_at(parser, attach_to)->right = elif_branch;
+        attach_to = node_at(parser, attach_to)->right;
         continue;
       }
 
       break;
     }
 
-    struct tau_node *if_stmt = node_new_unary(TAU_NODE_IF_STMT, if_token, main_branch);
-    struct tau_node *else_branch = parse_else_branch(ahead);
-    if (else_branch != NULL) {
-      if_stmt->right = else_branch;
+    node_id_t if_stmt = node_new_unary(parser, TAU_NODE_IF_STMT, if_token, main_branch);
+    node_id_t else_branch = parse_else_branch(parser);
+    if (else_branch != NODE_NULL) {
+      node_at(parser, if_stmt)->right = else_branch;
     }
 
     return if_stmt;
   }
 
-handle_fail:
-  if (main_branch != NULL) {
-    node_free(main_branch);
-  }
-
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_main_branch(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_main_branch: ahead cannot be NULL");
-  return node_new_unary(TAU_NODE_MAIN_BRANCH, *ahead, parse_expr_with_block(ahead));
+node_id_t parse_main_branch(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_main_branch: parser cannot be NULL");
+  return node_new_unary(parser, TAU_NODE_MAIN_BRANCH, parser->ahead, parse_expr_with_block(parser));
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_elif_branch(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_elif_branch: ahead cannot be NULL");
-  struct tau_token elif_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_ELIF)) {
-    struct tau_node *expr_branch = parse_expr_with_block(ahead);
-    MUST_OR_RETURN_NULL(expr_branch, ahead, "<elif branch>");
-    return node_new_unary(TAU_NODE_ELIF_BRANCH, elif_token, expr_branch);
+node_id_t parse_elif_branch(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_elif_branch: parser cannot be NULL");
+  token_id_t elif_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_ELIF)) {
+    node_id_t expr_branch = parse_expr_with_block(parser);
+    MUST_OR_RETURN_NULL(expr_branch, parser, "<elif branch>");
+    return node_new_unary(parser, TAU_NODE_ELIF_BRANCH, elif_token, expr_branch);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_else_branch(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_else_branch: ahead cannot be NULL");
-  struct tau_token else_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_ELSE)) {
-    struct tau_node *block = parse_block(ahead);
-    MUST_OR_RETURN_NULL(block, ahead, "<else branch>");
-    return node_new_unary(TAU_NODE_ELSE_BRANCH, else_token, block);
+node_id_t parse_else_branch(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_else_branch: parser cannot be NULL");
+  token_id_t else_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_ELSE)) {
+    node_id_t block = parse_block(parser);
+    MUST_OR_RETURN_NULL(block, parser, "<else branch>");
+    return node_new_unary(parser, TAU_NODE_ELSE_BRANCH, else_token, block);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_while_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_while_stmt: ahead cannot be NULL");
-  struct tau_token while_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_WHILE)) {
-    struct tau_node *expr_with_block = parse_expr_with_block(ahead);
-    MUST_OR_RETURN_NULL(expr_with_block, ahead, "<while branch>");
-    return node_new_unary(TAU_NODE_WHILE_STMT, while_token, expr_with_block);
+node_id_t parse_while_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_while_stmt: parser cannot be NULL");
+  token_id_t while_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_WHILE)) {
+    node_id_t expr_with_block = parse_expr_with_block(parser);
+    MUST_OR_RETURN_NULL(expr_with_block, parser, "<while branch>");
+    return node_new_unary(parser, TAU_NODE_WHILE_STMT, while_token, expr_with_block);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
-struct tau_node *parse_assign_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_assign_stmt: ahead cannot be NULL");
-  struct tau_node *node = parse_subscription_stmt(ahead);
+node_id_t parse_assign_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_assign_stmt: parser cannot be NULL");
+  node_id_t node = parse_subscription_stmt(parser);
   enum tau_punct matching_puncts[] = {TAU_PUNCT_EQ,       TAU_PUNCT_PLUS_EQ, TAU_PUNCT_HYPHEN_EQ, TAU_PUNCT_AST_EQ,
                                       TAU_PUNCT_SLASH_EQ, TAU_PUNCT_PCT_EQ,  TAU_PUNCT_AMP_EQ,    TAU_PUNCT_PIPE_EQ,
                                       TAU_PUNCT_CIRC_EQ,  TAU_PUNCT_D_GT_EQ, TAU_PUNCT_D_LT_EQ,   TAU_PUNCT_NONE};
@@ -749,514 +702,438 @@ struct tau_node *parse_assign_stmt(struct tau_token *ahead) {
       TAU_NODE_ACCUM_BIT_XOR_STMT, TAU_NODE_ACCUM_RSH_STMT, TAU_NODE_ACCUM_LSH_STMT,     TAU_NODE_NONE};
 
   for (int i = 0; matching_puncts[i] != TAU_PUNCT_NONE; i++) {
-    struct tau_token assign_token = *ahead;
-    if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, matching_puncts[i], TAU_KEYWORD_NONE)) {
-      struct tau_node *expr = parse_expr(ahead);
-      MUST_OR_FAIL(expr, ahead, "<expression>");
-      return node_new_binary(producing_types[i], assign_token, node, expr);
+    token_id_t assign_token = parser->ahead;
+    if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, matching_puncts[i], TAU_KEYWORD_NONE)) {
+      node_id_t expr = parse_expr(parser);
+      MUST_OR_RETURN_NULL(expr, parser, "<expression>");
+      return node_new_binary(parser, producing_types[i], assign_token, node, expr);
     }
   }
 
   return node;
-handle_fail:
-  if (node != NULL) {
-    node_free(node);
-  }
-
-  return NULL;
 }
 
-struct tau_node *parse_subscription_stmt(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_subscription_stmt: ahead cannot be NULL");
-  struct tau_node *subscription_expr = parse_subscription_expr(ahead);
-  if (subscription_expr != NULL) {
+node_id_t parse_subscription_stmt(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_subscription_stmt: parser cannot be NULL");
+  node_id_t subscription_expr = parse_subscription_expr(parser);
+  if (subscription_expr != NODE_NULL) {
     return subscription_expr;
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_statement_or_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_statement_or_decl: ahead cannot be NULL");
-  struct tau_node *node = NULL;
+node_id_t parse_statement_or_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_statement_or_decl: parser cannot be NULL");
+  node_id_t node = NODE_NULL;
   static const parser_func_t try_parsers[] = {
       parse_return_stmt, parse_continue_stmt, parse_break_stmt, parse_if_stmt,   parse_while_stmt,
       parse_assign_stmt, parse_let_decl,      parse_proc_decl,  parse_type_decl, NULL};
 
-  for (int i = 0; try_parsers[i] != NULL; i++) {
-    node = try_parsers[i](ahead);
-    if (node != NULL) {
-      return node_new_unary(TAU_NODE_STATEMENT_OR_DECL, node->token, node);
+  // a parser that reported an error may have consumed tokens, the next ones would start mid-statement
+  for (int i = 0; try_parsers[i] != NULL && !parser->panicking; i++) {
+    node = try_parsers[i](parser);
+    if (node != NODE_NULL) {
+      return node_new_like(parser, TAU_NODE_STATEMENT_OR_DECL, node, node, NODE_NULL);
     }
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_block(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_block: ahead cannot be NULL");
-  struct tau_token block_token = *ahead;
-  struct tau_node *root = NULL;
-  struct tau_node *attach_to = NULL;
-
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LCBR, TAU_KEYWORD_NONE)) {
-    root = node_new_empty(TAU_NODE_BLOCK, block_token);
-    for (;;) {
-      struct tau_node *statement_or_decl = parse_statement_or_decl(ahead);
-      if (statement_or_decl != NULL) {
-        if (attach_to == NULL) {
-          root->left = statement_or_decl;
-          attach_to = root->left;
-        } else {
-          attach_to->right = statement_or_decl;
-          attach_to = attach_to->right;
+node_id_t parse_block(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_block: parser cannot be NULL");
+  token_id_t block_token = parser->ahead;
+  node_id_t root = NODE_NULL;
+  node_id_t attach_to = NODE_NULL;
+
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LCBR, TAU_KEYWORD_NONE)) {
+    root = node_new_empty(parser, TAU_NODE_BLOCK, block_token);
+    while (!match(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RCBR, TAU_KEYWORD_NONE) &&
+           !match(parser, TAU_TOKEN_TYPE_EOF, TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
+      token_id_t statement_token = parser->ahead;
+      node_id_t statement_or_decl = parse_statement_or_decl(parser);
+      if (statement_or_decl != NODE_NULL) {
+        node_append(parser, root, &attach_to, statement_or_decl);
+        if (match_and_consume(parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
+          parser->panicking = false;
+          continue;
         }
 
-        MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE), ahead,
-                     "<end of line>");
-        continue;
+        parser_report_unexpected(parser, "<end of line>");
+        statement_token = parser->ahead;
+      } else {
+        parser_report_unexpected(parser, "<statement or closing `}`>");
       }
 
-      break;
+      node_id_t error = parser_recover(parser, statement_token, PARSER_SYNC_BLOCK);
+      node_append(parser, root, &attach_to, node_new_like(parser, TAU_NODE_STATEMENT_OR_DECL, error, error, NODE_NULL));
     }
 
-    MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RCBR, TAU_KEYWORD_NONE), ahead,
-                 "<closing `}`>");
+    // an unclosed block keeps its statements, the error is reported at the end of the file
+    if (!match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RCBR, TAU_KEYWORD_NONE)) {
+      parser_report_unexpected(parser, "<closing `}`>");
+    }
   }
 
   return root;
-
-handle_fail:
-  if (root != NULL) {
-    node_free(root);
-  }
-
-  return NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_expr_with_block(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_expr_with_block: ahead cannot be NULL");
-  struct tau_node *expr = parse_expr(ahead);
-  MUST_OR_RETURN_NULL(expr, ahead, "<expression>");
-
-  struct tau_node *block = parse_block(ahead);
-  MUST_OR_RETURN_NULL(block, ahead, "<block>");
-  return node_new_binary(TAU_NODE_EXPR_WITH_BLOCK, expr->token, expr, block);
+node_id_t parse_expr_with_block(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_expr_with_block: parser cannot be NULL");
+  node_id_t expr = parse_expr(parser);
+  MUST_OR_RETURN_NULL(expr, parser, "<expression>");
+
+  node_id_t block = parse_block(parser);
+  MUST_OR_RETURN_NULL(block, parser, "<block>");
+  return node_new_like(parser, TAU_NODE_EXPR_WITH_BLOCK, expr, expr, block);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_type_bind(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_type_bind: ahead cannot be NULL");
-  struct tau_token bind_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COLON, TAU_KEYWORD_NONE)) {
-    struct tau_node *expr = parse_expr(ahead);
-    return node_new_unary(TAU_NODE_TYPE_BIND, bind_token, expr);
+node_id_t parse_type_bind(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_type_bind: parser cannot be NULL");
+  token_id_t bind_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COLON, TAU_KEYWORD_NONE)) {
+    node_id_t expr = parse_expr(parser);
+    return node_new_unary(parser, TAU_NODE_TYPE_BIND, bind_token, expr);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_data_bind(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_data_bind: ahead cannot be NULL");
-  struct tau_token bind_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_EQ, TAU_KEYWORD_NONE)) {
-    struct tau_node *expr = parse_expr(ahead);
-    return node_new_unary(TAU_NODE_DATA_BIND, bind_token, expr);
+node_id_t parse_data_bind(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_data_bind: parser cannot be NULL");
+  token_id_t bind_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_EQ, TAU_KEYWORD_NONE)) {
+    node_id_t expr = parse_expr(parser);
+    return node_new_unary(parser, TAU_NODE_DATA_BIND, bind_token, expr);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_let_deconstruction(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_let_deconstruction: ahead cannot be NULL");
-  struct tau_node *identifier = NULL;
-  struct tau_node *type_bind = NULL;
-
-  struct tau_token decons_token = *ahead;
-  identifier = parse_atom(ahead);
-  MUST_OR_FAIL(identifier, ahead, "<identifier>");
-  MUST_OR_FAIL(identifier->token.type == TAU_TOKEN_TYPE_IDENTIFIER, ahead, "<identifier>");
-
-  type_bind = parse_type_bind(ahead);
-  MUST_OR_FAIL(type_bind, ahead, "<type bind>");
-
-  return node_new_binary(TAU_NODE_LET_DECONSTRUCTION, decons_token, identifier, type_bind);
-handle_fail:
-  if (identifier != NULL) {
-    node_free(identifier);
-  }
+node_id_t parse_let_deconstruction(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_let_deconstruction: parser cannot be NULL");
+  node_id_t identifier = NODE_NULL;
+  node_id_t type_bind = NODE_NULL;
 
-  if (type_bind != NULL) {
-    node_free(type_bind);
-  }
-  return NULL;
+  token_id_t decons_token = parser->ahead;
+  identifier = parse_atom(parser);
+  MUST_OR_RETURN_NULL(identifier, parser, "<identifier>");
+  MUST_OR_RETURN_NULL(node_at(parser, identifier)->token_type == TAU_TOKEN_TYPE_IDENTIFIER, parser, "<identifier>");
+
+  type_bind = parse_type_bind(parser);
+  MUST_OR_RETURN_NULL(type_bind, parser, "<type bind>");
+
+  return node_new_binary(parser, TAU_NODE_LET_DECONSTRUCTION, decons_token, identifier, type_bind);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_proc_signature(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_proc_signature: ahead cannot be NULL");
-
-  struct tau_node *formal_args = NULL;
-  struct tau_node *type_bind = NULL;
+node_id_t parse_proc_signature(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_proc_signature: parser cannot be NULL");
 
-  struct tau_token signature_token = *ahead;
-  formal_args = parse_formal_args(ahead);
-  MUST_OR_FAIL(formal_args, ahead, "<formal args>");
+  node_id_t formal_args = NODE_NULL;
+  node_id_t type_bind = NODE_NULL;
 
-  type_bind = parse_type_bind(ahead);
-  MUST_OR_FAIL(type_bind, ahead, "<type bind>");
+  token_id_t signature_token = parser->ahead;
+  formal_args = parse_formal_args(parser);
+  MUST_OR_RETURN_NULL(formal_args, parser, "<formal args>");
 
-  return node_new_binary(TAU_NODE_PROC_SIGNATURE, signature_token, formal_args, type_bind);
-handle_fail:
-  if (formal_args != NULL) {
-    node_free(formal_args);
-  }
+  type_bind = parse_type_bind(parser);
+  MUST_OR_RETURN_NULL(type_bind, parser, "<type bind>");
 
-  if (type_bind != NULL) {
-    node_free(type_bind);
-  }
-  return NULL;
+  return node_new_binary(parser, TAU_NODE_PROC_SIGNATURE, signature_token, formal_args, type_bind);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_formal_args(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_formal_args: ahead cannot be NULL");
-  struct tau_node *initial = NULL;
-  struct tau_node *attach_to = NULL;
-  struct tau_token formal_args_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
+node_id_t parse_formal_args(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_formal_args: parser cannot be NULL");
+  node_id_t initial = NODE_NULL;
+  node_id_t attach_to = NODE_NULL;
+  token_id_t formal_args_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
     for (;;) {
-      struct tau_node *arg = parse_formal_arg(ahead);
-      if (arg != NULL) {
-        if (initial == NULL) {
+      node_id_t arg = parse_formal_arg(parser);
+      if (arg != NODE_NULL) {
+        if (initial == NODE_NULL) {
           initial = arg;
           attach_to = arg;
         } else {
-          attach_to->right = arg;
-          attach_to = attach_to->right;
+          node_at(parser, attach_to)->right = arg;
+          attach_to = node_at(parser, attach_to)->right;
         }
 
-        if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
+        if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_COMMA, TAU_KEYWORD_NONE)) {
           continue;
         }
       }
 
       break;
     }
-    MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), ahead,
-                 "<closing `)`>");
-
-    return node_new_unary(TAU_NODE_FORMAL_ARGS, formal_args_token, initial);
-  }
+    MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), parser,
+                        "<closing `)`>");
 
-handle_fail:
-  if (initial != NULL) {
-    node_free(initial);
+    return node_new_unary(parser, TAU_NODE_FORMAL_ARGS, formal_args_token, initial);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_formal_arg(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_formal_arg: ahead cannot be NULL");
-  return node_new_unary(TAU_NODE_FORMAL_ARG, *ahead, parse_arg_bind(ahead));
+node_id_t parse_formal_arg(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_formal_arg: parser cannot be NULL");
+  return node_new_unary(parser, TAU_NODE_FORMAL_ARG, parser->ahead, parse_arg_bind(parser));
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_arg_bind(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_arg_bind: ahead cannot be NULL");
-  struct tau_node *identifier = NULL;
-  struct tau_node *type_bind = NULL;
+node_id_t parse_arg_bind(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_arg_bind: parser cannot be NULL");
+  node_id_t identifier = NODE_NULL;
+  node_id_t type_bind = NODE_NULL;
 
-  struct tau_token formal_arg_token = *ahead;
-  identifier = parse_atom(ahead);
+  token_id_t formal_arg_token = parser->ahead;
+  identifier = parse_atom(parser);
   if (identifier) {
-    type_bind = parse_type_bind(ahead);
-    MUST_OR_FAIL(type_bind, ahead, "<type bind>");
-
-    return node_new_binary(TAU_NODE_ARG_BIND, formal_arg_token, identifier, type_bind);
-  }
+    type_bind = parse_type_bind(parser);
+    MUST_OR_RETURN_NULL(type_bind, parser, "<type bind>");
 
-  return NULL;
-handle_fail:
-  if (identifier != NULL) {
-    node_free(identifier);
+    return node_new_binary(parser, TAU_NODE_ARG_BIND, formal_arg_token, identifier, type_bind);
   }
 
-  if (type_bind != NULL) {
-    node_free(type_bind);
-  }
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_proc_deconstruction(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_proc_deconstruction: ahead cannot be NULL");
-  struct tau_node *identifier = NULL;
-  struct tau_node *signature = NULL;
-
-  struct tau_token decons_token = *ahead;
-  identifier = parse_atom(ahead);
-  MUST_OR_FAIL(identifier, ahead, "<identifier>");
-  MUST_OR_FAIL(identifier->token.type == TAU_TOKEN_TYPE_IDENTIFIER, ahead, "<identifier>");
-
-  signature = parse_proc_signature(ahead);
-  MUST_OR_FAIL(signature, ahead, "<proc signature>");
-
-  return node_new_binary(TAU_NODE_PROC_DECONSTRUCTION, decons_token, identifier, signature);
-handle_fail:
-  if (identifier != NULL) {
-    node_free(identifier);
-  }
+node_id_t parse_proc_deconstruction(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_proc_deconstruction: parser cannot be NULL");
+  node_id_t identifier = NODE_NULL;
+  node_id_t signature = NODE_NULL;
 
-  if (signature != NULL) {
-    node_free(signature);
-  }
-  return NULL;
+  token_id_t decons_token = parser->ahead;
+  identifier = parse_atom(parser);
+  MUST_OR_RETURN_NULL(identifier, parser, "<identifier>");
+  MUST_OR_RETURN_NULL(node_at(parser, identifier)->token_type == TAU_TOKEN_TYPE_IDENTIFIER, parser, "<identifier>");
+
+  signature = parse_proc_signature(parser);
+  MUST_OR_RETURN_NULL(signature, parser, "<proc signature>");
+
+  return node_new_binary(parser, TAU_NODE_PROC_DECONSTRUCTION, decons_token, identifier, signature);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_type_deconstruction(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_type_deconstruction: ahead cannot be NULL");
-  struct tau_node *identifier = NULL;
+node_id_t parse_type_deconstruction(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_type_deconstruction: parser cannot be NULL");
+  node_id_t identifier = NODE_NULL;
 
-  struct tau_token decons_token = *ahead;
-  identifier = parse_atom(ahead);
-  MUST_OR_RETURN_NULL(identifier, ahead, "<identifier>");
-  MUST_OR_RETURN_NULL(identifier->token.type == TAU_TOKEN_TYPE_IDENTIFIER, ahead, "<identifier>");
+  token_id_t decons_token = parser->ahead;
+  identifier = parse_atom(parser);
+  MUST_OR_RETURN_NULL(identifier, parser, "<identifier>");
+  MUST_OR_RETURN_NULL(node_at(parser, identifier)->token_type == TAU_TOKEN_TYPE_IDENTIFIER, parser, "<identifier>");
 
-  return node_new_unary(TAU_NODE_TYPE_DECONSTRUCTION, decons_token, identifier);
+  return node_new_unary(parser, TAU_NODE_TYPE_DECONSTRUCTION, decons_token, identifier);
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_module_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_module_decl: ahead cannot be NULL");
-  struct tau_token module_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_MODULE)) {
-    struct tau_node *static_lookup_expr = parse_static_lookup_expr(ahead);
-    MUST_OR_RETURN_NULL(static_lookup_expr, ahead, "<static lookup>");
-    return node_new_unary(TAU_NODE_MODULE_DECL, module_token, static_lookup_expr);
+node_id_t parse_module_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_module_decl: parser cannot be NULL");
+  token_id_t module_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_MODULE)) {
+    node_id_t static_lookup_expr = parse_static_lookup_expr(parser);
+    MUST_OR_RETURN_NULL(static_lookup_expr, parser, "<static lookup>");
+    return node_new_unary(parser, TAU_NODE_MODULE_DECL, module_token, static_lookup_expr);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_prototype_suffix(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_module_decl: ahead cannot be NULL");
-  struct tau_token prototype_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_PROTOTYPE)) {
-    return node_new_empty(TAU_NODE_PROTOTYPE_SUFFIX, prototype_token);
+node_id_t parse_prototype_suffix(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_module_decl: parser cannot be NULL");
+  token_id_t prototype_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_PROTOTYPE)) {
+    return node_new_empty(parser, TAU_NODE_PROTOTYPE_SUFFIX, prototype_token);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_let_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_let_decl: ahead cannot be NULL");
-  struct tau_node *deconstruction = NULL;
-  struct tau_node *data_bind = NULL;
-
-  struct tau_token let_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_LET)) {
-    deconstruction = parse_let_deconstruction(ahead);
-    data_bind = parse_prototype_suffix(ahead);
-    if (data_bind == NULL) {
-      data_bind = parse_data_bind(ahead);
+node_id_t parse_let_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_let_decl: parser cannot be NULL");
+  node_id_t deconstruction = NODE_NULL;
+  node_id_t data_bind = NODE_NULL;
+
+  token_id_t let_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_LET)) {
+    deconstruction = parse_let_deconstruction(parser);
+    data_bind = parse_prototype_suffix(parser);
+    if (data_bind == NODE_NULL) {
+      data_bind = parse_data_bind(parser);
     }
-    MUST_OR_FAIL(data_bind, ahead, "<prototype or data bind>");
-
-    return node_new_binary(TAU_NODE_LET_DECL, let_token, deconstruction, data_bind);
-  }
+    MUST_OR_RETURN_NULL(data_bind, parser, "<prototype or data bind>");
 
-  return NULL;
-handle_fail:
-  if (deconstruction != NULL) {
-    node_free(deconstruction);
+    return node_new_binary(parser, TAU_NODE_LET_DECL, let_token, deconstruction, data_bind);
   }
 
-  if (data_bind != NULL) {
-    node_free(data_bind);
-  }
-
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_proc_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_proc_decl: ahead cannot be NULL");
-  struct tau_node *deconstruction = NULL;
-  struct tau_node *data_bind_or_block = NULL;
-
-  struct tau_token proc_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_PROC)) {
-    deconstruction = parse_proc_deconstruction(ahead);
-    data_bind_or_block = parse_prototype_suffix(ahead);
-    if (data_bind_or_block == NULL) {
-      data_bind_or_block = parse_data_bind(ahead);
+node_id_t parse_proc_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_proc_decl: parser cannot be NULL");
+  node_id_t deconstruction = NODE_NULL;
+  node_id_t data_bind_or_block = NODE_NULL;
+
+  token_id_t proc_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_PROC)) {
+    deconstruction = parse_proc_deconstruction(parser);
+    data_bind_or_block = parse_prototype_suffix(parser);
+    if (data_bind_or_block == NODE_NULL) {
+      data_bind_or_block = parse_data_bind(parser);
     }
 
-    if (data_bind_or_block == NULL) {
-      data_bind_or_block = parse_block(ahead);
+    if (data_bind_or_block == NODE_NULL) {
+      data_bind_or_block = parse_block(parser);
     }
 
-    MUST_OR_FAIL(data_bind_or_block, ahead, "<prototype, block or data bind>");
-
-    return node_new_binary(TAU_NODE_PROC_DECL, proc_token, deconstruction, data_bind_or_block);
-  }
+    MUST_OR_RETURN_NULL(data_bind_or_block, parser, "<prototype, block or data bind>");
 
-  return NULL;
-handle_fail:
-  if (deconstruction != NULL) {
-    node_free(deconstruction);
+    return node_new_binary(parser, TAU_NODE_PROC_DECL, proc_token, deconstruction, data_bind_or_block);
   }
 
-  if (data_bind_or_block != NULL) {
-    node_free(data_bind_or_block);
-  }
-
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_type_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_type_decl: ahead cannot be NULL");
-  struct tau_node *deconstruction = NULL;
-  struct tau_node *data_bind = NULL;
-
-  struct tau_token type_token = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_TYPE)) {
-    deconstruction = parse_type_deconstruction(ahead);
-    data_bind = parse_prototype_suffix(ahead);
-    if (data_bind == NULL) {
-      data_bind = parse_data_bind(ahead);
+node_id_t parse_type_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_type_decl: parser cannot be NULL");
+  node_id_t deconstruction = NODE_NULL;
+  node_id_t data_bind = NODE_NULL;
+
+  token_id_t type_token = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_TYPE)) {
+    deconstruction = parse_type_deconstruction(parser);
+    data_bind = parse_prototype_suffix(parser);
+    if (data_bind == NODE_NULL) {
+      data_bind = parse_data_bind(parser);
     }
-    MUST_OR_FAIL(data_bind, ahead, "<prototype or data bind>");
-
-    return node_new_binary(TAU_NODE_TYPE_DECL, type_token, deconstruction, data_bind);
-  }
-
-  return NULL;
-handle_fail:
-  if (deconstruction != NULL) {
-    node_free(deconstruction);
-  }
+    MUST_OR_RETURN_NULL(data_bind, parser, "<prototype or data bind>");
 
-  if (data_bind != NULL) {
-    node_free(data_bind);
+    return node_new_binary(parser, TAU_NODE_TYPE_DECL, type_token, deconstruction, data_bind);
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_extern_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_extern_decl: ahead cannot be NULL");
-  struct tau_token extern_token = *ahead;
-  struct tau_node *decl = NULL;
-
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_EXTERN)) {
-    decl = parse_let_decl(ahead);
-    if (decl != NULL) {
-      return node_new_unary(TAU_NODE_EXTERN_DECL, extern_token, decl);
+node_id_t parse_extern_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_extern_decl: parser cannot be NULL");
+  token_id_t extern_token = parser->ahead;
+  node_id_t decl = NODE_NULL;
+
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_KEYWORD, TAU_PUNCT_NONE, TAU_KEYWORD_EXTERN)) {
+    decl = parse_let_decl(parser);
+    if (decl != NODE_NULL) {
+      return node_new_unary(parser, TAU_NODE_EXTERN_DECL, extern_token, decl);
     }
 
-    decl = parse_proc_decl(ahead);
-    if (decl != NULL) {
-      return node_new_unary(TAU_NODE_EXTERN_DECL, extern_token, decl);
+    decl = parse_proc_decl(parser);
+    if (decl != NODE_NULL) {
+      return node_new_unary(parser, TAU_NODE_EXTERN_DECL, extern_token, decl);
     }
 
-    decl = parse_type_decl(ahead);
-    if (decl != NULL) {
-      return node_new_unary(TAU_NODE_EXTERN_DECL, extern_token, decl);
+    decl = parse_type_decl(parser);
+    if (decl != NODE_NULL) {
+      return node_new_unary(parser, TAU_NODE_EXTERN_DECL, extern_token, decl);
     }
 
-    MUST_OR_RETURN_NULL(decl, ahead, "<let, proc or type decl>");
+    MUST_OR_RETURN_NULL(decl, parser, "<let, proc or type decl>");
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_decl(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_decl: ahead cannot be NULL");
-  struct tau_node *node = NULL;
+node_id_t parse_decl(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_decl: parser cannot be NULL");
+  node_id_t node = NODE_NULL;
   static const parser_func_t try_parsers[] = {parse_let_decl, parse_proc_decl, parse_type_decl, parse_extern_decl,
                                               NULL};
 
-  for (int i = 0; try_parsers[i] != NULL; i++) {
-    node = try_parsers[i](ahead);
-    if (node != NULL) {
-      return node_new_unary(TAU_NODE_DECL, node->token, node);
+  for (int i = 0; try_parsers[i] != NULL && !parser->panicking; i++) {
+    node = try_parsers[i](parser);
+    if (node != NODE_NULL) {
+      return node_new_like(parser, TAU_NODE_DECL, node, node, NODE_NULL);
     }
   }
 
-  return NULL;
+  return NODE_NULL;
 }
 
-// NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_decls(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_decls: ahead cannot be NULL");
-  struct tau_token start_token = *ahead;
-  struct tau_node *root = NULL;
-  struct tau_node *attach_to = NULL;
+// Offsets of the nodes created from now on count from token
+static void begin_top_level_decl(struct tau_parser *parser, token_id_t token) {
+  parser->origin = parser->tokens.offsets[token];
+  ast_begin_segment(&parser->ast, parser->origin);
+}
 
-  root = node_new_empty(TAU_NODE_DECLS, start_token);
-  for (;;) {
-    struct tau_node *decl = parse_decl(ahead);
-    if (decl != NULL) {
-      if (attach_to == NULL) {
-        root->left = decl;
-        attach_to = root->left;
-      } else {
-        attach_to->right = decl;
-        attach_to = attach_to->right;
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_decl_run(struct tau_parser *parser, token_id_t stop, node_id_t *tail) {
+  assert(parser != NULL && "parse_decl_run: parser cannot be NULL");
+  assert(tail != NULL && "parse_decl_run: tail cannot be NULL");
+  node_id_t head = NODE_NULL;
+  *tail = NODE_NULL;
+
+  // every declaration that fails to parse leaves an error in its place, the run always reaches stop or the end
+  while (parser->ahead < stop && !match(parser, TAU_TOKEN_TYPE_EOF, TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
+    token_id_t decl_token = parser->ahead;
+    begin_top_level_decl(parser, decl_token);
+    node_id_t decl = parse_decl(parser);
+    if (decl != NODE_NULL) {
+      node_append_run(parser, &head, tail, decl);
+      if (match_and_consume(parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE)) {
+        parser->panicking = false;
+        continue;
       }
 
-      MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE), ahead,
-                   "<end of line>");
-      continue;
+      parser_report_unexpected(parser, "<end of line>");
+      decl_token = parser->ahead;
+      begin_top_level_decl(parser, decl_token);
+    } else {
+      parser_report_unexpected(parser, "<declaration>");
     }
 
-    break;
-  }
-
-  return root;
-handle_fail:
-  if (root != NULL) {
-    node_free(root);
+    node_id_t error = parser_recover(parser, decl_token, PARSER_SYNC_DECL);
+    node_append_run(parser, &head, tail, node_new_like(parser, TAU_NODE_DECL, error, error, NODE_NULL));
   }
 
-  return NULL;
+  // whatever follows belongs to the unit again
+  parser->origin = 0;
+  ast_begin_segment(&parser->ast, 0);
+  return head;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-struct tau_node *parse_compilation_unit(struct tau_token *ahead) {
-  assert(ahead != NULL && "parse_compilation_unit: ahead cannot be NULL");
-  struct tau_node *module_decl = NULL;
-  struct tau_node *decls = NULL;
-
-  struct tau_token start_token = *ahead;
-  module_decl = parse_module_decl(ahead);
-  MUST_OR_FAIL(module_decl, ahead, "<module decl>");
-  MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE), ahead, "<end of line>");
-  decls = parse_decls(ahead);
-  return node_new_binary(TAU_NODE_COMPILATION_UNIT, start_token, module_decl, decls);
-handle_fail:
-  if (module_decl != NULL) {
-    node_free(module_decl);
-  }
-
-  if (decls != NULL) {
-    node_free(decls);
-  }
+node_id_t parse_decls(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_decls: parser cannot be NULL");
+  node_id_t root = node_new_empty(parser, TAU_NODE_DECLS, parser->ahead);
+  node_id_t tail = NODE_NULL;
+  node_at(parser, root)->left = parse_decl_run(parser, parser->tokens.count, &tail);
+  return root;
+}
 
-  return NULL;
+// NOLINTNEXTLINE(misc-no-recursion)
+node_id_t parse_compilation_unit(struct tau_parser *parser) {
+  assert(parser != NULL && "parse_compilation_unit: parser cannot be NULL");
+  token_id_t start_token = parser->ahead;
+  node_id_t module_decl = parse_module_decl(parser);
+  MUST_OR_RETURN_NULL(module_decl, parser, "<module decl>");
+  MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE), parser,
+                      "<end of line>");
+  node_id_t decls = parse_decls(parser);
+  return node_new_binary(parser, TAU_NODE_COMPILATION_UNIT, start_token, module_decl, decls);
 }
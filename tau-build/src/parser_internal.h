@@ -5,160 +5,133 @@
 #ifndef TAU_PARSER_INTERNAL_H
 #define TAU_PARSER_INTERNAL_H
 
+#include <stdbool.h>
+
+#include "ast.h"
+#include "diag.h"
 #include "lexer.h"
 
-enum tau_node_type {
-  TAU_NODE_NONE,
-  TAU_NODE_CALLING_ARGS,
-  TAU_NODE_CALLING_ARG,
-  TAU_NODE_INDEXING_ARGS,
-  TAU_NODE_INDEXING_ARG,
-  TAU_NODE_CAST_EXPR,
-  TAU_NODE_LOG_OR_EXPR,
-  TAU_NODE_LOG_AND_EXPR,
-  TAU_NODE_EQ_EXPR,
-  TAU_NODE_NE_EXPR,
-  TAU_NODE_LT_EXPR,
-  TAU_NODE_LE_EXPR,
-  TAU_NODE_GT_EXPR,
-  TAU_NODE_GE_EXPR,
-  TAU_NODE_BIT_OR_EXPR,
-  TAU_NODE_BIT_XOR_EXPR,
-  TAU_NODE_BIT_AND_EXPR,
-  TAU_NODE_LSH_EXPR,
-  TAU_NODE_RSH_EXPR,
-  TAU_NODE_ADD_EXPR,
-  TAU_NODE_SUB_EXPR,
-  TAU_NODE_MUL_EXPR,
-  TAU_NODE_DIV_EXPR,
-  TAU_NODE_REM_EXPR,
-  TAU_NODE_U_REF_EXPR,
-  TAU_NODE_PROOF_EXPR,
-  TAU_NODE_STATIC_LOOKUP_EXPR,
-  TAU_NODE_VALUE_LOOKUP_EXPR,
-  TAU_NODE_U_POS_EXPR,
-  TAU_NODE_U_NEG_EXPR,
-  TAU_NODE_U_LOG_NOT_EXPR,
-  TAU_NODE_U_BIT_NOT_EXPR,
-  TAU_NODE_SUBSCRIPTION_EXPR,
-  TAU_NODE_ATOM,
-  TAU_NODE_RETURN_STMT,
-  TAU_NODE_CONTINUE_STMT,
-  TAU_NODE_BREAK_STMT,
-  TAU_NODE_IF_STMT,
-  TAU_NODE_MAIN_BRANCH,
-  TAU_NODE_ELIF_BRANCH,
-  TAU_NODE_ELSE_BRANCH,
-  TAU_NODE_WHILE_STMT,
-  TAU_NODE_ASSIGN_STMT,
-  TAU_NODE_ACCUM_ADD_STMT,
-  TAU_NODE_ACCUM_SUB_STMT,
-  TAU_NODE_ACCUM_MUL_STMT,
-  TAU_NODE_ACCUM_DIV_STMT,
-  TAU_NODE_ACCUM_REM_STMT,
-  TAU_NODE_ACCUM_BIT_AND_STMT,
-  TAU_NODE_ACCUM_BIT_OR_STMT,
-  TAU_NODE_ACCUM_BIT_XOR_STMT,
-  TAU_NODE_ACCUM_RSH_STMT,
-  TAU_NODE_ACCUM_LSH_STMT,
-  TAU_NODE_STATEMENT_OR_DECL,
-  TAU_NODE_BLOCK,
-  TAU_NODE_EXPR_WITH_BLOCK,
-  TAU_NODE_TYPE_BIND,
-  TAU_NODE_DATA_BIND,
-  TAU_NODE_LET_DECONSTRUCTION,
-  TAU_NODE_PROC_SIGNATURE,
-  TAU_NODE_FORMAL_ARGS,
-  TAU_NODE_FORMAL_ARG,
-  TAU_NODE_ARG_BIND,
-  TAU_NODE_PROC_DECONSTRUCTION,
-  TAU_NODE_TYPE_DECONSTRUCTION,
-  TAU_NODE_MODULE_DECL,
-  TAU_NODE_PROTOTYPE_SUFFIX,
-  TAU_NODE_LET_DECL,
-  TAU_NODE_PROC_DECL,
-  TAU_NODE_TYPE_DECL,
-  TAU_NODE_EXTERN_DECL,
-  TAU_NODE_DECL,
-  TAU_NODE_DECLS,
-  TAU_NODE_COMPILATION_UNIT,
-  TAU_NODE_COUNT,
+// Parsing state of a single compilation unit. The buffer is tokenized up front and the parser walks the token table by
+// index, every node built through it lives in its ast and is released at once by parser_free. Identifier and string
+// literal symbols go to the interner it was given, or to a private one owned by the parser.
+struct tau_parser {
+  struct tau_token_table tokens;
+  token_id_t ahead;
+  uint32_t origin;  // offset of the first token of the top level declaration being parsed, 0 outside of them
+  struct tau_ast ast;
+  struct tau_diag_list diags;
+  struct tau_interner *interner;
+  bool owns_interner;
+  bool panicking;  // an error was reported and the parser has not reached a synchronization point since
 };
 
-struct tau_node {
-  struct tau_token token;
-  struct tau_node *left;
-  struct tau_node *right;
-  enum tau_node_type type;
+// Where parser_recover stops skipping tokens. Both stop before a `let`, `proc`, `type` or `extern` keyword outside of
+// the braces skipped so far, and at the end of the file.
+enum parser_sync {
+  PARSER_SYNC_DECL,   // between top level declarations
+  PARSER_SYNC_BLOCK,  // between statements, also right after an end of line or before the `}` closing the block
 };
 
-typedef struct tau_node *(*parser_func_t)(struct tau_token *);
-
-void node_free(struct tau_node *node);
-struct tau_node *node_new_empty(enum tau_node_type type, struct tau_token token);
-struct tau_node *node_new_unary(enum tau_node_type type, struct tau_token token, struct tau_node *operand);
-struct tau_node *node_new_binary(enum tau_node_type type, struct tau_token token, struct tau_node *left,
-                                 struct tau_node *right);
-
-struct tau_node *parse_expr(struct tau_token *ahead);
-struct tau_node *parse_cast_expr(struct tau_token *ahead);
-struct tau_node *parse_log_or_expr(struct tau_token *ahead);
-struct tau_node *parse_log_and_expr(struct tau_token *ahead);
-struct tau_node *parse_rel_expr(struct tau_token *ahead);
-struct tau_node *parse_cmp_expr(struct tau_token *ahead);
-struct tau_node *parse_bit_or_expr(struct tau_token *ahead);
-struct tau_node *parse_bit_and_expr(struct tau_token *ahead);
-struct tau_node *parse_bit_shift_expr(struct tau_token *ahead);
-struct tau_node *parse_term_expr(struct tau_token *ahead);
-struct tau_node *parse_fact_expr(struct tau_token *ahead);
-struct tau_node *parse_ref_expr(struct tau_token *ahead);
-struct tau_node *parse_proof_expr(struct tau_token *ahead);
-struct tau_node *parse_unary_expr(struct tau_token *ahead);
-struct tau_node *parse_subscription_expr(struct tau_token *ahead);
-struct tau_node *parse_value_lookup_expr(struct tau_token *ahead);
-struct tau_node *parse_static_lookup_expr(struct tau_token *ahead);
-struct tau_node *parse_primary_expr(struct tau_token *ahead);
-struct tau_node *parse_atom(struct tau_token *ahead);
-
-struct tau_node *parse_calling_args(struct tau_token *ahead);
-struct tau_node *parse_indexing_args(struct tau_token *ahead);
-
-struct tau_node *parse_return_stmt(struct tau_token *ahead);
-struct tau_node *parse_continue_stmt(struct tau_token *ahead);
-struct tau_node *parse_break_stmt(struct tau_token *ahead);
-struct tau_node *parse_if_stmt(struct tau_token *ahead);
-struct tau_node *parse_main_branch(struct tau_token *ahead);
-struct tau_node *parse_elif_branch(struct tau_token *ahead);
-struct tau_node *parse_else_branch(struct tau_token *ahead);
-struct tau_node *parse_while_stmt(struct tau_token *ahead);
-struct tau_node *parse_assign_stmt(struct tau_token *ahead);
-struct tau_node *parse_subscription_stmt(struct tau_token *ahead);
-
-struct tau_node *parse_statement_or_decl(struct tau_token *ahead);
-struct tau_node *parse_block(struct tau_token *ahead);
-struct tau_node *parse_expr_with_block(struct tau_token *ahead);
-
-struct tau_node *parse_type_bind(struct tau_token *ahead);
-struct tau_node *parse_data_bind(struct tau_token *ahead);
-
-struct tau_node *parse_let_deconstruction(struct tau_token *ahead);
-struct tau_node *parse_proc_signature(struct tau_token *ahead);
-struct tau_node *parse_formal_args(struct tau_token *ahead);
-struct tau_node *parse_formal_arg(struct tau_token *ahead);
-struct tau_node *parse_arg_bind(struct tau_token *ahead);
-struct tau_node *parse_proc_deconstruction(struct tau_token *ahead);
-struct tau_node *parse_type_deconstruction(struct tau_token *ahead);
-
-struct tau_node *parse_module_decl(struct tau_token *ahead);
-
-struct tau_node *parse_prototype_suffix(struct tau_token *ahead);
-struct tau_node *parse_let_decl(struct tau_token *ahead);
-struct tau_node *parse_proc_decl(struct tau_token *ahead);
-struct tau_node *parse_type_decl(struct tau_token *ahead);
-struct tau_node *parse_extern_decl(struct tau_token *ahead);
-struct tau_node *parse_decl(struct tau_token *ahead);
-struct tau_node *parse_decls(struct tau_token *ahead);
-
-struct tau_node *parse_compilation_unit(struct tau_token *ahead);
+typedef node_id_t (*parser_func_t)(struct tau_parser *);
+
+void parser_init(struct tau_parser *parser, const char *buf_name, const char *buf_data, size_t buf_size);
+// policy may be NULL to keep every diagnostic
+void parser_init_shared(struct tau_parser *parser, struct tau_interner *interner, const struct tau_diag_policy *policy,
+                        const char *buf_name, const char *buf_data, size_t buf_size);
+// Same as parser_init_shared with an empty token table, for an ast that is filled without parsing
+void parser_init_untokenized(struct tau_parser *parser, struct tau_interner *interner,
+                             const struct tau_diag_policy *policy, const char *buf_name, const char *buf_data,
+                             size_t buf_size);
+void parser_free(struct tau_parser *parser);
+
+static inline struct tau_node *node_at(struct tau_parser *parser, node_id_t id) { return ast_node(&parser->ast, id); }
+
+struct tau_loc parser_token_loc(struct tau_parser *parser, token_id_t token);
+const char *parser_token_text(const struct tau_parser *parser, token_id_t token, size_t *len);
+
+// Reports the token ahead as unexpected. Reports made while panicking are dropped, they are almost always caused by
+// the error that started the panic.
+void parser_report_unexpected(struct tau_parser *parser, const char *expecting);
+// Skips what is left of a construct that failed to parse from token from, always moving past at least one token, up to
+// the next synchronization point. Ends the panic and returns a TAU_NODE_ERROR spanning the skipped tokens.
+node_id_t parser_recover(struct tau_parser *parser, token_id_t from, enum parser_sync sync);
+
+// Points an existing node at token, offset and length included
+void node_set_token(struct tau_parser *parser, node_id_t id, token_id_t token);
+node_id_t node_new_empty(struct tau_parser *parser, enum tau_node_type type, token_id_t token);
+node_id_t node_new_unary(struct tau_parser *parser, enum tau_node_type type, token_id_t token,
+                         node_id_t operand);
+node_id_t node_new_binary(struct tau_parser *parser, enum tau_node_type type, token_id_t token, node_id_t left,
+                          node_id_t right);
+node_id_t node_new_like(struct tau_parser *parser, enum tau_node_type type, node_id_t like, node_id_t left,
+                        node_id_t right);
+
+node_id_t parse_expr(struct tau_parser *parser);
+node_id_t parse_cast_expr(struct tau_parser *parser);
+node_id_t parse_log_or_expr(struct tau_parser *parser);
+node_id_t parse_log_and_expr(struct tau_parser *parser);
+node_id_t parse_rel_expr(struct tau_parser *parser);
+node_id_t parse_cmp_expr(struct tau_parser *parser);
+node_id_t parse_bit_or_expr(struct tau_parser *parser);
+node_id_t parse_bit_and_expr(struct tau_parser *parser);
+node_id_t parse_bit_shift_expr(struct tau_parser *parser);
+node_id_t parse_term_expr(struct tau_parser *parser);
+node_id_t parse_fact_expr(struct tau_parser *parser);
+node_id_t parse_ref_expr(struct tau_parser *parser);
+node_id_t parse_proof_expr(struct tau_parser *parser);
+node_id_t parse_unary_expr(struct tau_parser *parser);
+node_id_t parse_subscription_expr(struct tau_parser *parser);
+node_id_t parse_value_lookup_expr(struct tau_parser *parser);
+node_id_t parse_static_lookup_expr(struct tau_parser *parser);
+node_id_t parse_primary_expr(struct tau_parser *parser);
+node_id_t parse_atom(struct tau_parser *parser);
+
+node_id_t parse_calling_args(struct tau_parser *parser);
+node_id_t parse_indexing_args(struct tau_parser *parser);
+
+node_id_t parse_return_stmt(struct tau_parser *parser);
+node_id_t parse_continue_stmt(struct tau_parser *parser);
+node_id_t parse_break_stmt(struct tau_parser *parser);
+node_id_t parse_if_stmt(struct tau_parser *parser);
+node_id_t parse_main_branch(struct tau_parser *parser);
+node_id_t parse_elif_branch(struct tau_parser *parser);
+node_id_t parse_else_branch(struct tau_parser *parser);
+node_id_t parse_while_stmt(struct tau_parser *parser);
+node_id_t parse_assign_stmt(struct tau_parser *parser);
+node_id_t parse_subscription_stmt(struct tau_parser *parser);
+
+node_id_t parse_statement_or_decl(struct tau_parser *parser);
+node_id_t parse_block(struct tau_parser *parser);
+node_id_t parse_expr_with_block(struct tau_parser *parser);
+
+node_id_t parse_type_bind(struct tau_parser *parser);
+node_id_t parse_data_bind(struct tau_parser *parser);
+
+node_id_t parse_let_deconstruction(struct tau_parser *parser);
+node_id_t parse_proc_signature(struct tau_parser *parser);
+node_id_t parse_formal_args(struct tau_parser *parser);
+node_id_t parse_formal_arg(struct tau_parser *parser);
+node_id_t parse_arg_bind(struct tau_parser *parser);
+node_id_t parse_proc_deconstruction(struct tau_parser *parser);
+node_id_t parse_type_deconstruction(struct tau_parser *parser);
+
+node_id_t parse_module_decl(struct tau_parser *parser);
+
+node_id_t parse_prototype_suffix(struct tau_parser *parser);
+node_id_t parse_let_decl(struct tau_parser *parser);
+node_id_t parse_proc_decl(struct tau_parser *parser);
+node_id_t parse_type_decl(struct tau_parser *parser);
+node_id_t parse_extern_decl(struct tau_parser *parser);
+node_id_t parse_decl(struct tau_parser *parser);
+node_id_t parse_decls(struct tau_parser *parser);
+// Parses top level declarations, each in an ast segment of its own, up to the end of the file or up to token stop,
+// whichever comes first. Returns the first one and sets tail to the last, they are linked through right.
+node_id_t parse_decl_run(struct tau_parser *parser, token_id_t stop, node_id_t *tail);
+
+node_id_t parse_compilation_unit(struct tau_parser *parser);
+
+struct tau_parse_result;
+// Diagnostics of a result, for the driver to render along with its own
+const struct tau_diag_list *parse_result_diags(const struct tau_parse_result *result);
 
 #endif  // TAU_PARSER_INTERNAL_H
@@ -6,32 +6,39 @@
 
 #include <assert.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-bool match(struct tau_token *ahead, enum tau_token_type type, enum tau_punct punct, enum tau_keyword keyword) {
-  assert(ahead != NULL && "match: ahead cannot be null");
+bool match(struct tau_parser *parser, enum tau_token_type type, enum tau_punct punct, enum tau_keyword keyword) {
+  assert(parser != NULL && "match: parser cannot be null");
   assert(type != TAU_TOKEN_TYPE_NONE && "match: type cannot be TAU_TOKEN_TYPE_NONE");
   assert(type != TAU_TOKEN_TYPE_COUNT && "match: type cannot be TAU_TOKEN_TYPE_COUNT");
 
+  enum tau_token_type ahead_type = parser->tokens.types[parser->ahead];
+  uint8_t ahead_code = parser->tokens.codes[parser->ahead];
+
   if (type == TAU_TOKEN_TYPE_PUNCT) {
-    return ahead->type == type && (punct == TAU_PUNCT_NONE || ahead->punct == punct);
+    return ahead_type == type && (punct == TAU_PUNCT_NONE || ahead_code == punct);
   }
 
   if (type == TAU_TOKEN_TYPE_KEYWORD) {
-    return ahead->type == type && (keyword == TAU_KEYWORD_NONE || ahead->keyword == keyword);
+    return ahead_type == type && (keyword == TAU_KEYWORD_NONE || ahead_code == keyword);
   }
 
-  return ahead->type == type;
+  return ahead_type == type;
 }
 
-void consume(struct tau_token *ahead) {
-  assert(ahead != NULL && "match: ahead cannot be null");
-  *ahead = tau_token_next(*ahead);
+void consume(struct tau_parser *parser) {
+  assert(parser != NULL && "consume: parser cannot be null");
+  // the table always ends with EOF, which is never consumed so lookahead stays valid past the end
+  if (parser->ahead + 1 < parser->tokens.count) {
+    parser->ahead++;
+  }
 }
 
-bool match_and_consume(struct tau_token *ahead, enum tau_token_type type, enum tau_punct punct,
+bool match_and_consume(struct tau_parser *parser, enum tau_token_type type, enum tau_punct punct,
                        enum tau_keyword keyword) {
-  if (match(ahead, type, punct, keyword)) {
-    consume(ahead);
+  if (match(parser, type, punct, keyword)) {
+    consume(parser);
     return true;
   }
 
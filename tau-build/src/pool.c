@@ -0,0 +1,145 @@
+//
+// Created on 10/17/26.
+//
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "pool.h"
+
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <threads.h>
+#include <unistd.h>
+
+// Tasks never spawn more tasks, so a plain locked deque is enough: the lock is only contended while stealing, which
+// is rare compared to the cost of a task.
+struct pool_queue {
+  mtx_t lock;
+  size_t *tasks;
+  size_t head;
+  size_t tail;
+};
+
+struct pool_worker {
+  struct pool *pool;
+  size_t id;
+};
+
+struct pool {
+  struct pool_queue *queues;
+  size_t queue_count;
+  tau_pool_task_func_t func;
+  void *ctx;
+  atomic_size_t steal_count;
+};
+
+size_t tau_pool_hardware_threads(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (size_t)count : 1;
+}
+
+static bool queue_pop_front(struct pool_queue *queue, size_t *task) {
+  mtx_lock(&queue->lock);
+  bool found = queue->head < queue->tail;
+  if (found) {
+    *task = queue->tasks[queue->head++];
+  }
+
+  mtx_unlock(&queue->lock);
+  return found;
+}
+
+static bool queue_pop_back(struct pool_queue *queue, size_t *task) {
+  mtx_lock(&queue->lock);
+  bool found = queue->head < queue->tail;
+  if (found) {
+    *task = queue->tasks[--queue->tail];
+  }
+
+  mtx_unlock(&queue->lock);
+  return found;
+}
+
+static bool pool_steal(struct pool *pool, size_t thief, size_t *task) {
+  for (size_t i = 1; i < pool->queue_count; i++) {
+    if (queue_pop_back(&pool->queues[(thief + i) % pool->queue_count], task)) {
+      atomic_fetch_add_explicit(&pool->steal_count, 1, memory_order_relaxed);
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static int pool_worker_run(void *arg) {
+  struct pool_worker *worker = arg;
+  struct pool *pool = worker->pool;
+  size_t task = 0;
+  while (queue_pop_front(&pool->queues[worker->id], &task) || pool_steal(pool, worker->id, &task)) {
+    pool->func(pool->ctx, task, worker->id);
+  }
+
+  return 0;
+}
+
+void tau_pool_run(size_t thread_count, const size_t *order, size_t task_count, tau_pool_task_func_t func, void *ctx,
+                  struct tau_pool_stats *stats) {
+  assert((order != NULL || task_count == 0) && "tau_pool_run: order cannot be NULL");
+  assert(func != NULL && "tau_pool_run: func cannot be NULL");
+  if (thread_count == 0) {
+    thread_count = tau_pool_hardware_threads();
+  }
+
+  if (thread_count > task_count) {
+    thread_count = task_count > 0 ? task_count : 1;
+  }
+
+  struct pool pool = {.queue_count = thread_count, .func = func, .ctx = ctx};
+  atomic_init(&pool.steal_count, 0);
+  pool.queues = calloc(thread_count, sizeof(struct pool_queue));
+  struct pool_worker *workers = calloc(thread_count, sizeof(struct pool_worker));
+  thrd_t *threads = calloc(thread_count, sizeof(thrd_t));
+  assert(pool.queues != NULL && workers != NULL && threads != NULL && "tau_pool_run: out of memory");
+
+  for (size_t i = 0; i < thread_count; i++) {
+    struct pool_queue *queue = &pool.queues[i];
+    int res = mtx_init(&queue->lock, mtx_plain);
+    assert(res == thrd_success && "tau_pool_run: cannot create queue lock");
+    queue->tasks = malloc((task_count / thread_count + 1) * sizeof(size_t));
+    assert(queue->tasks != NULL && "tau_pool_run: out of memory");
+    workers[i] = (struct pool_worker){.pool = &pool, .id = i};
+  }
+
+  for (size_t i = 0; i < task_count; i++) {
+    struct pool_queue *queue = &pool.queues[i % thread_count];
+    queue->tasks[queue->tail++] = order[i];
+  }
+
+  for (size_t i = 1; i < thread_count; i++) {
+    int res = thrd_create(&threads[i], pool_worker_run, &workers[i]);
+    assert(res == thrd_success && "tau_pool_run: cannot create worker thread");
+  }
+
+  pool_worker_run(&workers[0]);
+  for (size_t i = 1; i < thread_count; i++) {
+    thrd_join(threads[i], NULL);
+  }
+
+  if (stats != NULL) {
+    *stats = (struct tau_pool_stats){
+        .thread_count = thread_count,
+        .steal_count = atomic_load(&pool.steal_count),
+    };
+  }
+
+  for (size_t i = 0; i < thread_count; i++) {
+    mtx_destroy(&pool.queues[i].lock);
+    free(pool.queues[i].tasks);
+  }
+
+  free(threads);
+  free(workers);
+  free(pool.queues);
+}
@@ -0,0 +1,27 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_POOL_H
+#define TAU_POOL_H
+
+#include <stddef.h>
+
+typedef void (*tau_pool_task_func_t)(void *ctx, size_t task, size_t worker);
+
+struct tau_pool_stats {
+  size_t thread_count;
+  size_t steal_count;
+};
+
+// Number of online cores, never less than one
+size_t tau_pool_hardware_threads(void);
+
+// Runs func once for every task in order[0..task_count) on thread_count workers (0 means one per core), the calling
+// thread being worker 0. Tasks are dealt round-robin so every worker starts with the front of order, each worker
+// drains its own queue from the front and steals from the back of the others once it runs dry. Returns when every
+// task has run; stats may be NULL.
+void tau_pool_run(size_t thread_count, const size_t *order, size_t task_count, tau_pool_task_func_t func, void *ctx,
+                  struct tau_pool_stats *stats);
+
+#endif  // TAU_POOL_H
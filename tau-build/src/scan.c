@@ -0,0 +1,397 @@
+//
+// Created on 10/17/26.
+//
+
+#include "scan.h"
+
+#include <assert.h>
+#include <stdint.h>
+
+#include "utf8.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SCAN_HAS_X86 1
+#else
+#define SCAN_HAS_X86 0
+#endif
+
+#define EXHAUSTIVE_SCAN_ISA_NAME_TABLE_COUNT 3
+
+typedef size_t (*scan_func_t)(const char *buf, size_t len);
+
+struct scan_impl {
+  scan_func_t spaces;
+  scan_func_t ident_body;
+  scan_func_t str_body;
+  scan_func_t utf8;
+};
+
+const char *scan_isa_name_table[] = {
+    [TAU_SCAN_ISA_SCALAR] = "scalar",
+    [TAU_SCAN_ISA_SSE2] = "sse2",
+    [TAU_SCAN_ISA_AVX2] = "avx2",
+};
+static_assert(TAU_SCAN_ISA_COUNT == EXHAUSTIVE_SCAN_ISA_NAME_TABLE_COUNT && "outdated exhaustive scan isa name table");
+
+// SCALAR
+static inline bool is_space_byte(uint8_t c) { return c == ' ' || c == '\t'; }
+
+static inline bool is_ident_body_byte(uint8_t c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$';
+}
+
+static inline bool is_str_body_byte(uint8_t c) { return c != '"' && c != '\\' && c != '\n' && c != '\r'; }
+
+static size_t scan_spaces_scalar(const char *buf, size_t len) {
+  size_t i = 0;
+  while (i < len && is_space_byte((uint8_t)buf[i])) {
+    i++;
+  }
+
+  return i;
+}
+
+static size_t scan_ident_body_scalar(const char *buf, size_t len) {
+  size_t i = 0;
+  while (i < len && is_ident_body_byte((uint8_t)buf[i])) {
+    i++;
+  }
+
+  return i;
+}
+
+static size_t scan_str_body_scalar(const char *buf, size_t len) {
+  size_t i = 0;
+  while (i < len && is_str_body_byte((uint8_t)buf[i])) {
+    i++;
+  }
+
+  return i;
+}
+
+static size_t scan_utf8_scalar(const char *buf, size_t len) {
+  size_t i = 0;
+  uint8_t seq_len;
+  while (i < len && (seq_len = tau_utf8_sequence_len(buf + i, len - i)) != 0) {
+    i += seq_len;
+  }
+
+  return i;
+}
+
+#if SCAN_HAS_X86
+// SSE2
+// Bytes are compared as signed, so every byte with the high bit set falls out of the ASCII ranges below.
+__attribute__((target("sse2"))) static inline __m128i in_range_sse2(__m128i v, char low, char high) {
+  return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8((char)(low - 1))),
+                       _mm_cmplt_epi8(v, _mm_set1_epi8((char)(high + 1))));
+}
+
+__attribute__((target("sse2"))) static size_t scan_spaces_sse2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+    __m128i hit = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')));
+    uint32_t miss = ~(uint32_t)_mm_movemask_epi8(hit) & 0xFFFFu;
+    if (miss != 0) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+
+  return i + scan_spaces_scalar(buf + i, len - i);
+}
+
+__attribute__((target("sse2"))) static size_t scan_ident_body_sse2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i hit = _mm_or_si128(in_range_sse2(lower, 'a', 'z'), in_range_sse2(v, '0', '9'));
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    hit = _mm_or_si128(hit, _mm_cmpeq_epi8(v, _mm_set1_epi8('$')));
+    uint32_t miss = ~(uint32_t)_mm_movemask_epi8(hit) & 0xFFFFu;
+    if (miss != 0) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+
+  return i + scan_ident_body_scalar(buf + i, len - i);
+}
+
+__attribute__((target("sse2"))) static size_t scan_str_body_sse2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m128i) <= len; i += sizeof(__m128i)) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(buf + i));
+    __m128i stop = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('\n')));
+    stop = _mm_or_si128(stop, _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')));
+    uint32_t hit = (uint32_t)_mm_movemask_epi8(stop);
+    if (hit != 0) {
+      return i + __builtin_ctz(hit);
+    }
+  }
+
+  return i + scan_str_body_scalar(buf + i, len - i);
+}
+
+// Whole blocks of ASCII are skipped, anything else is checked one sequence at a time
+__attribute__((target("sse2"))) static size_t scan_utf8_sse2(const char *buf, size_t len) {
+  size_t i = 0;
+  while (i < len) {
+    if (i + sizeof(__m128i) <= len && _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)(buf + i))) == 0) {
+      i += sizeof(__m128i);
+      continue;
+    }
+
+    uint8_t seq_len = tau_utf8_sequence_len(buf + i, len - i);
+    if (seq_len == 0) {
+      return i;
+    }
+
+    i += seq_len;
+  }
+
+  return i;
+}
+
+// AVX2
+__attribute__((target("avx2"))) static inline __m256i in_range_avx2(__m256i v, char low, char high) {
+  return _mm256_and_si256(_mm256_cmpgt_epi8(v, _mm256_set1_epi8((char)(low - 1))),
+                          _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(high + 1)), v));
+}
+
+__attribute__((target("avx2"))) static size_t scan_spaces_avx2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+    __m256i hit =
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t')));
+    uint32_t miss = ~(uint32_t)_mm256_movemask_epi8(hit);
+    if (miss != 0) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+
+  return i + scan_spaces_sse2(buf + i, len - i);
+}
+
+__attribute__((target("avx2"))) static size_t scan_ident_body_avx2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+    __m256i lower = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+    __m256i hit = _mm256_or_si256(in_range_avx2(lower, 'a', 'z'), in_range_avx2(v, '0', '9'));
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('_')));
+    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('$')));
+    uint32_t miss = ~(uint32_t)_mm256_movemask_epi8(hit);
+    if (miss != 0) {
+      return i + __builtin_ctz(miss);
+    }
+  }
+
+  return i + scan_ident_body_sse2(buf + i, len - i);
+}
+
+__attribute__((target("avx2"))) static size_t scan_str_body_avx2(const char *buf, size_t len) {
+  size_t i = 0;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i v = _mm256_loadu_si256((const __m256i *)(buf + i));
+    __m256i stop =
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+    stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')));
+    stop = _mm256_or_si256(stop, _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')));
+    uint32_t hit = (uint32_t)_mm256_movemask_epi8(stop);
+    if (hit != 0) {
+      return i + __builtin_ctz(hit);
+    }
+  }
+
+  return i + scan_str_body_sse2(buf + i, len - i);
+}
+
+// UTF-8 validation by table lookups, after Keiser and Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte".
+// Every byte is classified together with the one before it by three 16 entry tables indexed by nibbles: each entry is
+// the set of errors the nibble is compatible with, so only the errors all three nibbles agree on survive the AND.
+#define UTF8_TOO_SHORT 0x01       // a lead not followed by enough continuations
+#define UTF8_TOO_LONG 0x02        // a continuation after ASCII
+#define UTF8_OVERLONG_3 0x04      // E0 80..9F
+#define UTF8_TOO_LARGE 0x08       // F4 90..BF and F5..FF 90..BF
+#define UTF8_SURROGATE 0x10       // ED A0..BF
+#define UTF8_OVERLONG_2 0x20      // C0 and C1
+#define UTF8_OVERLONG_4 0x40      // F0 80..8F
+#define UTF8_TOO_LARGE_1000 0x40  // F5..FF 80..8F, which OVERLONG_4 does not cover
+#define UTF8_TWO_CONTS 0x80       // a continuation after a continuation, only fine in 3 and 4 byte sequences
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+// input shifted by n bytes, taking the missing ones from the end of the previous block
+#define UTF8_PREV_AVX2(input, prev_input, n) \
+  _mm256_alignr_epi8(input, _mm256_permute2x128_si256(prev_input, input, 0x21), 16 - (n))
+
+// Indexed by the high nibble of the previous byte
+static const uint8_t utf8_byte_1_high[16] = {
+    // 0_______: ASCII
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG,
+    // 10______: continuation
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    // 1100____, 1101____: two byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2, UTF8_TOO_SHORT,
+    // 1110____: three byte lead
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    // 1111____: four byte lead or worse
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+// Indexed by the low nibble of the previous byte
+static const uint8_t utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,    // ____0000
+    UTF8_CARRY | UTF8_OVERLONG_2,                                        // ____0001
+    UTF8_CARRY,                                                          // ____0010
+    UTF8_CARRY,                                                          // ____0011
+    UTF8_CARRY | UTF8_TOO_LARGE,                                         // ____0100
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____0101
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____0110
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____0111
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1000
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1001
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1010
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1011
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1100
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,  // ____1101
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1110
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,                   // ____1111
+};
+
+// Indexed by the high nibble of the byte itself
+static const uint8_t utf8_byte_2_high[16] = {
+    // 0_______: ASCII
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT,
+    // 1000____, 1001____, 101_____: continuation
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3 | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE | UTF8_TOO_LARGE,
+    // 11______: lead
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+__attribute__((target("avx2"))) static inline __m256i utf8_lookup_avx2(const uint8_t table[16], __m256i index) {
+  __m256i entries = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i *)table));
+  return _mm256_shuffle_epi8(entries, _mm256_and_si256(index, _mm256_set1_epi8(0x0F)));
+}
+
+// Non zero bytes wherever input, read after prev_input, is not UTF-8. Sequences cut by the end of input are not
+// reported, the next block does that.
+__attribute__((target("avx2"))) static __m256i utf8_errors_avx2(__m256i input, __m256i prev_input) {
+  __m256i prev1 = UTF8_PREV_AVX2(input, prev_input, 1);
+  __m256i byte_1_high = utf8_lookup_avx2(utf8_byte_1_high, _mm256_srli_epi16(prev1, 4));
+  __m256i byte_1_low = utf8_lookup_avx2(utf8_byte_1_low, prev1);
+  __m256i byte_2_high = utf8_lookup_avx2(utf8_byte_2_high, _mm256_srli_epi16(input, 4));
+  __m256i special = _mm256_and_si256(_mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+  // the third and fourth bytes of a sequence must be continuations, which is when TWO_CONTS is expected
+  __m256i third = _mm256_subs_epu8(UTF8_PREV_AVX2(input, prev_input, 2), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+  __m256i fourth = _mm256_subs_epu8(UTF8_PREV_AVX2(input, prev_input, 3), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+  __m256i must_be_cont = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+  return _mm256_xor_si256(must_be_cont, special);
+}
+
+__attribute__((target("avx2"))) static size_t scan_utf8_avx2(const char *buf, size_t len) {
+  size_t i = 0;
+  __m256i prev_input = _mm256_setzero_si256();
+  bool prev_ascii = true;
+  for (; i + sizeof(__m256i) <= len; i += sizeof(__m256i)) {
+    __m256i input = _mm256_loadu_si256((const __m256i *)(buf + i));
+    bool ascii = _mm256_movemask_epi8(input) == 0;
+    if (!ascii || !prev_ascii) {
+      __m256i errors = utf8_errors_avx2(input, prev_input);
+      if (!_mm256_testz_si256(errors, errors)) {
+        break;
+      }
+    }
+
+    prev_input = input;
+    prev_ascii = ascii;
+  }
+
+  // Everything before i checked out, except for a sequence that starts in its last 3 bytes and may be cut by i. The
+  // rest, and the exact offset of an error, is left to the sequence at a time scanner.
+  size_t start = i >= 3 ? i - 3 : 0;
+  while (start < i && (uint8_t)buf[start] < 0xC0) {
+    start++;
+  }
+
+  return start + scan_utf8_sse2(buf + start, len - start);
+}
+#endif
+
+// DISPATCH
+static const struct scan_impl scan_impl_table[] = {
+    [TAU_SCAN_ISA_SCALAR] = {scan_spaces_scalar, scan_ident_body_scalar, scan_str_body_scalar, scan_utf8_scalar},
+#if SCAN_HAS_X86
+    [TAU_SCAN_ISA_SSE2] = {scan_spaces_sse2, scan_ident_body_sse2, scan_str_body_sse2, scan_utf8_sse2},
+    [TAU_SCAN_ISA_AVX2] = {scan_spaces_avx2, scan_ident_body_avx2, scan_str_body_avx2, scan_utf8_avx2},
+#endif
+};
+
+static struct scan_impl scan_impl = {scan_spaces_scalar, scan_ident_body_scalar, scan_str_body_scalar,
+                                     scan_utf8_scalar};
+static enum tau_scan_isa scan_isa = TAU_SCAN_ISA_SCALAR;
+
+static bool scan_isa_supported(enum tau_scan_isa isa) {
+  switch (isa) {
+    case TAU_SCAN_ISA_SCALAR:
+      return true;
+#if SCAN_HAS_X86
+    case TAU_SCAN_ISA_SSE2:
+      return __builtin_cpu_supports("sse2");
+    case TAU_SCAN_ISA_AVX2:
+      return __builtin_cpu_supports("avx2");
+#endif
+    default:
+      return false;
+  }
+}
+
+bool tau_scan_select(enum tau_scan_isa isa) {
+  assert(isa < TAU_SCAN_ISA_COUNT && "tau_scan_select: invalid isa");
+  if (!scan_isa_supported(isa)) {
+    return false;
+  }
+
+  scan_impl = scan_impl_table[isa];
+  scan_isa = isa;
+  return true;
+}
+
+enum tau_scan_isa tau_scan_selected(void) { return scan_isa; }
+
+const char *tau_scan_get_isa_name(enum tau_scan_isa isa) {
+  if (isa < TAU_SCAN_ISA_COUNT) {
+    return scan_isa_name_table[isa];
+  }
+
+  return "(invalid)";
+}
+
+// Picks the widest supported implementation before main runs, so the hot path never has to check for it
+__attribute__((constructor)) static void scan_select_best(void) {
+#if SCAN_HAS_X86
+  __builtin_cpu_init();
+#endif
+  for (int isa = TAU_SCAN_ISA_COUNT - 1; isa > TAU_SCAN_ISA_SCALAR; isa--) {
+    if (tau_scan_select(isa)) {
+      return;
+    }
+  }
+}
+
+size_t tau_scan_spaces(const char *buf, size_t len) { return scan_impl.spaces(buf, len); }
+
+size_t tau_scan_ident_body(const char *buf, size_t len) { return scan_impl.ident_body(buf, len); }
+
+size_t tau_scan_str_body(const char *buf, size_t len) { return scan_impl.str_body(buf, len); }
+
+size_t tau_scan_utf8(const char *buf, size_t len) { return scan_impl.utf8(buf, len); }
@@ -0,0 +1,33 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_SCAN_H
+#define TAU_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Byte run scanners used by the lexer hot loops. Every scanner returns how many bytes from the start of buf belong to
+// the run, never reading past len. The implementation is picked at startup from what the CPU supports.
+enum tau_scan_isa {
+  TAU_SCAN_ISA_SCALAR,
+  TAU_SCAN_ISA_SSE2,
+  TAU_SCAN_ISA_AVX2,
+  TAU_SCAN_ISA_COUNT,
+};
+
+bool tau_scan_select(enum tau_scan_isa isa);
+enum tau_scan_isa tau_scan_selected(void);
+const char *tau_scan_get_isa_name(enum tau_scan_isa isa);
+
+// spaces and tabs
+size_t tau_scan_spaces(const char *buf, size_t len);
+// [A-Za-z0-9_$]
+size_t tau_scan_ident_body(const char *buf, size_t len);
+// anything but `"`, `\`, line feed and carriage return
+size_t tau_scan_str_body(const char *buf, size_t len);
+// whole well formed UTF-8 sequences, so the run stops at the first byte of the first malformed or truncated one
+size_t tau_scan_utf8(const char *buf, size_t len);
+
+#endif  // TAU_SCAN_H
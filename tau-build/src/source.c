@@ -0,0 +1,123 @@
+//
+// Created on 10/17/26.
+//
+
+#define _DEFAULT_SOURCE
+
+#include "source.h"
+
+#include <assert.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define SOURCE_READ_MIN_CAPACITY 4096
+
+// Mapping a file whose size is a multiple of the page size leaves no byte after it, so the file is mapped over an
+// anonymous reservation one page longer than needed: the tail of the last file page and the spare page read as zeros.
+static int source_map(struct tau_source *source, int fd, size_t size) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  size_t map_size = (size / page + 1) * page;
+  void *base = mmap(NULL, map_size, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    return errno;
+  }
+
+  if (mmap(base, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+    int err = errno;
+    munmap(base, map_size);
+    return err;
+  }
+
+  madvise(base, size, MADV_SEQUENTIAL);
+  source->data = base;
+  source->size = size;
+  source->map_size = map_size;
+  source->kind = TAU_SOURCE_MAPPED;
+  return 0;
+}
+
+static int source_read(struct tau_source *source, int fd) {
+  size_t capacity = SOURCE_READ_MIN_CAPACITY;
+  size_t len = 0;
+  char *buf = malloc(capacity);
+  assert(buf != NULL && "source_read: out of memory");
+  for (;;) {
+    if (len + 1 == capacity) {
+      capacity *= 2;
+      buf = realloc(buf, capacity);
+      assert(buf != NULL && "source_read: out of memory");
+    }
+
+    ssize_t got = read(fd, buf + len, capacity - len - 1);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+
+    if (got < 0) {
+      int err = errno;
+      free(buf);
+      return err;
+    }
+
+    if (got == 0) {
+      break;
+    }
+
+    len += (size_t)got;
+  }
+
+  buf[len] = '\0';
+  source->data = buf;
+  source->size = len;
+  source->kind = TAU_SOURCE_HEAP;
+  return 0;
+}
+
+int tau_source_open(struct tau_source *source, const char *path) {
+  assert(source != NULL && "tau_source_open: source cannot be NULL");
+  assert(path != NULL && "tau_source_open: path cannot be NULL");
+  *source = (struct tau_source){.path = path, .data = "", .kind = TAU_SOURCE_EMPTY};
+
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return errno;
+  }
+
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    return err;
+  }
+
+  int err = 0;
+  if (S_ISDIR(st.st_mode)) {
+    err = EISDIR;
+  } else if (!S_ISREG(st.st_mode) || st.st_size == 0 || source_map(source, fd, (size_t)st.st_size) != 0) {
+    // procfs and friends report a size of 0 for files that do have content, so those are read as well
+    err = source_read(source, fd);
+  }
+
+  close(fd);
+  return err;
+}
+
+void tau_source_close(struct tau_source *source) {
+  assert(source != NULL && "tau_source_close: source cannot be NULL");
+  switch (source->kind) {
+    case TAU_SOURCE_MAPPED:
+      munmap((void *)source->data, source->map_size);
+      break;
+    case TAU_SOURCE_HEAP:
+      free((void *)source->data);
+      break;
+    case TAU_SOURCE_EMPTY:
+      break;
+  }
+
+  *source = (struct tau_source){.data = "", .kind = TAU_SOURCE_EMPTY};
+}
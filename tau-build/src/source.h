@@ -0,0 +1,31 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_SOURCE_H
+#define TAU_SOURCE_H
+
+#include <stddef.h>
+
+enum tau_source_kind {
+  TAU_SOURCE_EMPTY,
+  TAU_SOURCE_MAPPED,
+  TAU_SOURCE_HEAP,
+};
+
+// A source file loaded for lexing. Regular files are mapped read-only and lexed in place; anything that cannot be
+// mapped (pipes, procfs) is read into the heap instead. Either way data is followed by at least one NUL byte, which
+// the lexer relies on to peek past the end.
+struct tau_source {
+  const char *path;
+  const char *data;
+  size_t size;
+  size_t map_size;
+  enum tau_source_kind kind;
+};
+
+// Returns 0 on success or the errno value of the failing call
+int tau_source_open(struct tau_source *source, const char *path);
+void tau_source_close(struct tau_source *source);
+
+#endif  // TAU_SOURCE_H
@@ -0,0 +1,119 @@
+//
+// Created on 10/18/26.
+//
+
+#include "str_pool.h"
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash.h"
+
+#define STR_POOL_MIN_CAPACITY 256
+#define STR_POOL_MIN_ENTRIES 64
+
+void tau_str_pool_init(struct tau_str_pool *pool) {
+  assert(pool != NULL && "tau_str_pool_init: pool cannot be NULL");
+  *pool = (struct tau_str_pool){0};
+}
+
+void tau_str_pool_free(struct tau_str_pool *pool) {
+  assert(pool != NULL && "tau_str_pool_free: pool cannot be NULL");
+  free(pool->data);
+  free(pool->entries);
+  free(pool->slots);
+  *pool = (struct tau_str_pool){0};
+}
+
+void tau_str_pool_clear(struct tau_str_pool *pool) {
+  assert(pool != NULL && "tau_str_pool_clear: pool cannot be NULL");
+  pool->size = 0;
+  pool->count = 0;
+  if (pool->slots != NULL) {
+    memset(pool->slots, 0, pool->slot_count * sizeof(uint32_t));
+  }
+}
+
+static uint32_t entry_slot(const struct tau_str_pool *pool, const char *text, size_t len) {
+  return (uint32_t)tau_hash64(text, len, 0) & (pool->slot_count - 1);
+}
+
+static void slots_rehash(struct tau_str_pool *pool, uint32_t slot_count) {
+  free(pool->slots);
+  pool->slots = calloc(slot_count, sizeof(uint32_t));
+  assert(pool->slots != NULL && "slots_rehash: out of memory");
+  pool->slot_count = slot_count;
+  for (uint32_t index = 0; index < pool->count; index++) {
+    const struct tau_str_pool_entry *entry = &pool->entries[index];
+    uint32_t i = entry_slot(pool, pool->data + entry->offset, entry->len);
+    while (pool->slots[i] != 0) {
+      i = (i + 1) & (slot_count - 1);
+    }
+
+    pool->slots[i] = index + 1;
+  }
+}
+
+char *tau_str_pool_reserve(struct tau_str_pool *pool, size_t len) {
+  assert(pool != NULL && "tau_str_pool_reserve: pool cannot be NULL");
+  // the NUL after it included
+  assert(len < UINT32_MAX - pool->size && "tau_str_pool_reserve: pool too big for 32-bit offsets");
+  size_t needed = pool->size + len + 1;
+  if (pool->capacity < needed) {
+    size_t capacity = pool->capacity < STR_POOL_MIN_CAPACITY ? STR_POOL_MIN_CAPACITY : pool->capacity;
+    while (capacity < needed) {
+      capacity *= 2;
+    }
+
+    pool->capacity = capacity < UINT32_MAX ? (uint32_t)capacity : UINT32_MAX;
+    pool->data = realloc(pool->data, pool->capacity);
+    assert(pool->data != NULL && "tau_str_pool_reserve: out of memory");
+  }
+
+  return pool->data + pool->size;
+}
+
+uint32_t tau_str_pool_commit(struct tau_str_pool *pool, size_t len) {
+  assert(pool != NULL && "tau_str_pool_commit: pool cannot be NULL");
+  assert(pool->size + len < pool->capacity && "tau_str_pool_commit: len was never reserved");
+
+  // kept at most half full
+  if (pool->count * 2 >= pool->slot_count) {
+    slots_rehash(pool, pool->slot_count == 0 ? STR_POOL_MIN_ENTRIES * 2 : pool->slot_count * 2);
+  }
+
+  const char *text = pool->data + pool->size;
+  uint32_t mask = pool->slot_count - 1;
+  uint32_t i = entry_slot(pool, text, len);
+  for (; pool->slots[i] != 0; i = (i + 1) & mask) {
+    const struct tau_str_pool_entry *entry = &pool->entries[pool->slots[i] - 1];
+    if (entry->len == len && memcmp(pool->data + entry->offset, text, len) == 0) {
+      return entry->offset;
+    }
+  }
+
+  if (pool->count == pool->entry_capacity) {
+    pool->entry_capacity = pool->entry_capacity == 0 ? STR_POOL_MIN_ENTRIES : pool->entry_capacity * 2;
+    pool->entries = realloc(pool->entries, pool->entry_capacity * sizeof(struct tau_str_pool_entry));
+    assert(pool->entries != NULL && "tau_str_pool_commit: out of memory");
+  }
+
+  uint32_t offset = pool->size;
+  pool->data[offset + len] = '\0';
+  pool->entries[pool->count] = (struct tau_str_pool_entry){.offset = offset, .len = (uint32_t)len};
+  pool->slots[i] = ++pool->count;
+  pool->size += (uint32_t)len + 1;
+  return offset;
+}
+
+uint32_t tau_str_pool_intern(struct tau_str_pool *pool, const char *text, size_t len) {
+  assert(pool != NULL && "tau_str_pool_intern: pool cannot be NULL");
+  assert((text != NULL || len == 0) && "tau_str_pool_intern: text cannot be NULL");
+  char *dest = tau_str_pool_reserve(pool, len);
+  if (len > 0) {
+    memcpy(dest, text, len);
+  }
+
+  return tau_str_pool_commit(pool, len);
+}
@@ -0,0 +1,42 @@
+//
+// Created on 10/18/26.
+//
+
+#ifndef TAU_STR_POOL_H
+#define TAU_STR_POOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct tau_str_pool_entry {
+  uint32_t offset;  // into data
+  uint32_t len;     // without the NUL after it
+};
+
+// Decoded string literals of a module, every distinct string stored once. Strings are packed into data one after the
+// other, each followed by a NUL, so data can be emitted as a read-only section as it is and literals referenced by
+// offset into it. A zeroed pool is an empty one.
+struct tau_str_pool {
+  char *data;
+  uint32_t size;
+  uint32_t capacity;
+  struct tau_str_pool_entry *entries;  // in the order they were added
+  uint32_t count;
+  uint32_t entry_capacity;
+  uint32_t *slots;  // open addressing over entries, index + 1 so 0 marks an empty slot
+  uint32_t slot_count;
+};
+
+void tau_str_pool_init(struct tau_str_pool *pool);
+void tau_str_pool_free(struct tau_str_pool *pool);
+// Forgets every string but keeps the memory for the next ones
+void tau_str_pool_clear(struct tau_str_pool *pool);
+// Room for a string of up to len bytes at the end of data, to decode it in place before tau_str_pool_commit. Only
+// valid until the next call on the pool.
+char *tau_str_pool_reserve(struct tau_str_pool *pool, size_t len);
+// Adds the len bytes written at tau_str_pool_reserve unless an equal string is already there, and returns the offset
+// of the one kept either way
+uint32_t tau_str_pool_commit(struct tau_str_pool *pool, size_t len);
+uint32_t tau_str_pool_intern(struct tau_str_pool *pool, const char *text, size_t len);
+
+#endif  // TAU_STR_POOL_H
@@ -0,0 +1,267 @@
+//
+// Created on 10/17/26.
+//
+
+#include "token_stream.h"
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "line_index.h"
+#include "utf8.h"
+
+// Bytes the lexer may look at past the end of a token: the `+` or `-` and digit of an exponent, the rest of a
+// multi-byte punctuation or the bytes of a truncated UTF-8 sequence. Anything closer to the end of the window is
+// lexed again once more of the input is in.
+#define STREAM_LOOKAHEAD 8
+
+void tau_token_stream_init(struct tau_token_stream *stream, const char *name, size_t chunk_size,
+                           tau_token_read_func_t *read, void *ctx) {
+  assert(stream != NULL && "tau_token_stream_init: stream cannot be NULL");
+  assert(read != NULL && "tau_token_stream_init: read cannot be NULL");
+  assert(chunk_size > 0 && "tau_token_stream_init: chunk_size cannot be 0");
+
+  *stream = (struct tau_token_stream){
+      .name = name,
+      .read = read,
+      .ctx = ctx,
+      .window_capacity = 2 * chunk_size + 1,
+      .chunk_size = chunk_size,
+  };
+
+  stream->window = malloc(stream->window_capacity);
+  assert(stream->window != NULL && "tau_token_stream_init: out of memory");
+  stream->window[0] = '\0';
+  stream->last = tau_token_start(name, stream->window, 0);
+  tau_diag_list_init(&stream->scratch);
+  tau_diag_list_init(&stream->pending);
+}
+
+void tau_token_stream_free(struct tau_token_stream *stream) {
+  assert(stream != NULL && "tau_token_stream_free: stream cannot be NULL");
+  free(stream->window);
+  tau_diag_list_free(&stream->scratch);
+  tau_diag_list_free(&stream->pending);
+  *stream = (struct tau_token_stream){0};
+}
+
+// Moves a location in the window to the input
+static struct tau_loc stream_loc(const struct tau_token_stream *stream, struct tau_loc loc) {
+  // only the first row of the window starts past column 0
+  if (loc.row == 0) {
+    loc.col += stream->col_base;
+  }
+
+  loc.row += stream->row_base;
+  loc.offset += stream->window_offset;
+  return loc;
+}
+
+static void reset_diags(struct tau_diag_list *list) {
+  if (list->count > 0) {
+    tau_diag_list_free(list);
+    tau_diag_list_init(list);
+  }
+}
+
+static void report_at(struct tau_diag_list *list, const struct tau_diag *diag, struct tau_loc loc) {
+  struct tau_diag_arg args[TAU_DIAG_MAX_ARGS] = {0};
+  for (size_t arg = 0; arg < TAU_DIAG_MAX_ARGS && diag->args[arg] != NULL; arg++) {
+    args[arg] = (struct tau_diag_arg){.text = diag->args[arg], .len = strlen(diag->args[arg])};
+  }
+
+  tau_diag_report(list, diag->code, loc, diag->len, args);
+}
+
+// The comment the window starts in is over, the errors of its dropped part are done waiting
+static void flush_pending(struct tau_token_stream *stream) {
+  for (size_t i = 0; i < stream->pending.count; i++) {
+    report_at(stream->diags, &stream->pending.items[i], stream->pending.items[i].loc);
+  }
+
+  reset_diags(&stream->pending);
+  stream->comment_open = false;
+}
+
+// Reports the errors of a token handed out, with their locations moved from the window to the input
+static void flush_diags(struct tau_token_stream *stream) {
+  size_t first = 0;
+  if (stream->comment_open) {
+    // a comment that never closes is reported ahead of the errors in its body, from where it really opens
+    const struct tau_diag *unclosed = &stream->scratch.items[0];
+    if (stream->scratch.count > 0 && unclosed->code == TAU_DIAG_UNCLOSED_COMMENT && unclosed->loc.offset == 0) {
+      struct tau_diag diag = *unclosed;
+      diag.len = stream->window_offset + unclosed->len - stream->comment_loc.offset;
+      report_at(stream->diags, &diag, stream->comment_loc);
+      first = 1;
+    }
+
+    flush_pending(stream);
+  }
+
+  for (size_t i = first; i < stream->scratch.count; i++) {
+    report_at(stream->diags, &stream->scratch.items[i], stream_loc(stream, stream->scratch.items[i].loc));
+  }
+
+  reset_diags(&stream->scratch);
+}
+
+static void advance_base(struct tau_token_stream *stream, const char *line, const char *end) {
+  const char *newline;
+  while ((newline = memchr(line, '\n', end - line)) != NULL) {
+    stream->row_base++;
+    stream->col_base = 0;
+    line = newline + 1;
+  }
+
+  stream->col_base += tau_utf8_count_codepoints(line, end - line);
+}
+
+// Drops the first done bytes of the window, keeping track of where the rest is in the input
+static void advance_window(struct tau_token_stream *stream, size_t done) {
+  const char *end = stream->window + done;
+  advance_base(stream, stream->window, end);
+  stream->window_len -= done;
+  stream->window_offset += done;
+  memmove(stream->window, end, stream->window_len);
+}
+
+// Everything before the last token is done with. What is left moves to the front and the window doubles when it is
+// still more than half full, then it is filled up again.
+static void refill(struct tau_token_stream *stream) {
+  if (stream->last_start > 0) {
+    advance_window(stream, stream->last_start);
+    stream->last_start = 0;
+  }
+
+  if (stream->window_len > (stream->window_capacity - 1) / 2) {
+    stream->window_capacity = 2 * (stream->window_capacity - 1) + 1;
+    stream->window = realloc(stream->window, stream->window_capacity);
+    assert(stream->window != NULL && "refill: out of memory");
+  }
+
+  while (!stream->eof && stream->window_capacity - 1 - stream->window_len >= stream->chunk_size) {
+    size_t n = stream->read(stream->ctx, stream->window + stream->window_len, stream->chunk_size);
+    assert(n <= stream->chunk_size && "refill: read more than asked for");
+    stream->eof = n == 0;
+    stream->window_len += n;
+  }
+
+  stream->window[stream->window_len] = '\0';
+}
+
+// Drops the spaces and comments after prev, which was lexed from the window, up to where lexing can start over without
+// them. A long run of them, such as a commented out file, never has to fit in the window then. The stand in written
+// before that point puts the lexer back where it was. Errors reported up to there are final, except the ones in the
+// body of a block comment not closed yet, which wait in pending until it is known whether its own error goes first.
+static void drop_trivia(struct tau_token_stream *stream, struct tau_token prev) {
+  const char *window = stream->window;
+  size_t start = stream->last_start + stream->last.len;
+  if (stream->window_len < start + STREAM_LOOKAHEAD) {
+    return;
+  }
+
+  struct tau_trivia_cut trivia = tau_token_trivia_cut(prev, window + stream->window_len - STREAM_LOOKAHEAD);
+  size_t cut = (size_t)(trivia.at - window);
+  size_t stand_in_len = strlen(trivia.stand_in);
+  if (cut <= start || cut < stand_in_len) {
+    return;
+  }
+
+  bool open = trivia.comment != NULL && !trivia.comment_closed;
+  size_t comment = open ? (size_t)(trivia.comment - window) : cut;
+  bool resumed = stream->comment_open && open && comment == 0;
+  if (stream->comment_open && !resumed) {
+    flush_pending(stream);
+  }
+
+  for (size_t i = 0; i < stream->scratch.count && stream->scratch.items[i].loc.offset < cut; i++) {
+    const struct tau_diag *diag = &stream->scratch.items[i];
+    if (diag->loc.offset < comment) {
+      report_at(stream->diags, diag, stream_loc(stream, diag->loc));
+    } else if (diag->code != TAU_DIAG_UNCLOSED_COMMENT || diag->loc.offset != comment) {
+      report_at(&stream->pending, diag, stream_loc(stream, diag->loc));
+    }
+  }
+
+  if (open && !resumed) {
+    stream->comment_open = true;
+    stream->comment_loc = stream_loc(stream, tau_line_index_scan_loc(stream->name, window, comment));
+  }
+
+  // the stand in takes the place of input bytes without a newline, so its code points are taken off the column
+  advance_window(stream, cut - stand_in_len);
+  advance_base(stream, stream->window, stream->window + stand_in_len);
+  stream->col_base -= stand_in_len;
+  memcpy(stream->window, trivia.stand_in, stand_in_len);
+  stream->last_start = 0;
+  stream->last.len = 0;
+  stream->last.type = trivia.type;
+}
+
+// A block comment opened right after a token and not closed in the window yet. An end of line swallows the comments
+// after it only when they are closed, so it can only be handed out once this one is.
+static bool open_comment_at(const struct tau_token_stream *stream, size_t offset) {
+  const char *buf = stream->window + offset;
+  size_t rem = stream->window_len - offset;
+  if (rem < 2 || buf[0] != '/' || buf[1] != '*') {
+    return false;
+  }
+
+  for (const char *star = buf + 2; (star = memchr(star, '*', buf + rem - star)) != NULL; star++) {
+    if (star + 1 < buf + rem && star[1] == '/') {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+struct tau_token tau_token_stream_next(struct tau_token_stream *stream) {
+  assert(stream != NULL && "tau_token_stream_next: stream cannot be NULL");
+
+  for (;;) {
+    struct tau_token prev = stream->last;
+    prev.buf = stream->window + stream->last_start;
+    prev.rem = stream->window_len - stream->last_start - prev.len;
+    prev.buf_data = stream->window;
+    prev.diags = &stream->scratch;
+    prev.lines = NULL;
+    prev.strings = stream->strings;
+    prev.keep_docs = stream->keep_docs;
+
+    struct tau_token token = tau_token_next(prev);
+    size_t end = (size_t)(token.buf - stream->window) + token.len;
+    if (stream->eof || (end + STREAM_LOOKAHEAD <= stream->window_len && !open_comment_at(stream, end))) {
+      flush_diags(stream);
+      stream->last = token;
+      stream->last_start = (size_t)(token.buf - stream->window);
+      token.diags = stream->diags;
+      return token;
+    }
+
+    drop_trivia(stream, prev);
+    reset_diags(&stream->scratch);
+    refill(stream);
+  }
+}
+
+size_t tau_token_stream_offset(const struct tau_token_stream *stream, const struct tau_token *token) {
+  assert(stream != NULL && "tau_token_stream_offset: stream cannot be NULL");
+  assert(token != NULL && "tau_token_stream_offset: token cannot be NULL");
+  return stream->window_offset + (size_t)(token->buf - stream->window);
+}
+
+struct tau_loc tau_token_stream_loc(const struct tau_token_stream *stream, const struct tau_token *token) {
+  assert(stream != NULL && "tau_token_stream_loc: stream cannot be NULL");
+  assert(token != NULL && "tau_token_stream_loc: token cannot be NULL");
+  size_t offset = (size_t)(token->buf - stream->window);
+  return stream_loc(stream, tau_line_index_scan_loc(stream->name, stream->window, offset));
+}
+
+size_t tau_token_read_file(void *ctx, char *dest, size_t cap) {
+  assert(ctx != NULL && "tau_token_read_file: ctx cannot be NULL");
+  return fread(dest, 1, cap, ctx);
+}
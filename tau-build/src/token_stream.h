@@ -0,0 +1,61 @@
+//
+// Created on 10/17/26.
+//
+
+#ifndef TAU_TOKEN_STREAM_H
+#define TAU_TOKEN_STREAM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "diag.h"
+#include "lexer.h"
+
+// Reads at most cap bytes into dest and returns how many were read, 0 only once the input is exhausted
+typedef size_t(tau_token_read_func_t)(void *ctx, char *dest, size_t cap);
+
+// Lexes input that is never whole in memory, such as stdin or a pipe, into the same tokens tau_token_next gives over
+// the whole buffer. Input is read in chunks into a window holding the previous token and whatever follows it, a token
+// is only handed out once enough bytes follow it that no later chunk can change it, otherwise the window is compacted,
+// refilled and the token lexed again. Spaces and comments between tokens are dropped once skipped rather than kept
+// for lexing again, so the window stays around two chunks plus the longest token and a token longer than that doubles
+// it, which makes rereading the token cost linear time overall. Doc comments still waiting for their token are kept
+// like one, and the blank lines and comments an end of line token takes in are part of that token.
+struct tau_token_stream {
+  const char *name;
+  tau_token_read_func_t *read;
+  void *ctx;
+  char *window;  // NUL terminated at window_len
+  size_t window_len;
+  size_t window_capacity;
+  size_t window_offset;  // from the start of the input to window[0]
+  size_t chunk_size;
+  size_t row_base;  // location of window[0] in the input
+  size_t col_base;       // wraps below 0 while the window starts with the stand in for dropped trivia, see drop_trivia
+  bool eof;
+  struct tau_token last;  // its buf is only valid until the window moves, last_start is what locates it
+  size_t last_start;
+  struct tau_diag_list scratch;  // errors of a token that may still be lexed again
+  struct tau_diag_list pending;  // errors in the dropped part of comment_open, behind its own one if it never closes
+  bool comment_open;             // the window starts inside a block comment whose opening was dropped
+  struct tau_loc comment_loc;    // where that comment opens in the input
+  struct tau_diag_list *diags;   // where lexing errors go once their token is handed out, logged right away when NULL
+  struct tau_str_pool *strings;  // see tau_token_next, a token lexed again only adds the same string again
+  bool keep_docs;                // see tau_token_next, set before the first token
+};
+
+void tau_token_stream_init(struct tau_token_stream *stream, const char *name, size_t chunk_size,
+                           tau_token_read_func_t *read, void *ctx);
+void tau_token_stream_free(struct tau_token_stream *stream);
+// The token after the previous one, TAU_TOKEN_TYPE_EOF for ever once the input is exhausted. Its buf and doc point
+// into the window and stay valid until the next call.
+struct tau_token tau_token_stream_next(struct tau_token_stream *stream);
+// From the start of the input to a token handed out by the stream
+size_t tau_token_stream_offset(const struct tau_token_stream *stream, const struct tau_token *token);
+struct tau_loc tau_token_stream_loc(const struct tau_token_stream *stream, const struct tau_token *token);
+
+// A tau_token_read_func_t over a FILE *, such as stdin. A read error ends the input like end of file does, ferror tells
+// them apart.
+size_t tau_token_read_file(void *ctx, char *dest, size_t cap);
+
+#endif  // TAU_TOKEN_STREAM_H
@@ -29,4 +29,10 @@
 
 #define UC_QUOTATION_MARK 0x0022
 
+#define UC_DELETE 0x007F
+
+#define UC_SURROGATE_FIRST 0xD800
+#define UC_SURROGATE_LAST 0xDFFF
+#define UC_MAX 0x10FFFF
+
 #endif  // TAU_UC_NAMES_H
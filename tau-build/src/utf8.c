@@ -4,6 +4,19 @@
 
 #include "utf8.h"
 
+#include <assert.h>
+#include <string.h>
+
+#include "scan.h"
+
+#define UTF8_HIGH_BITS 0x8080808080808080ull
+
+static inline uint64_t read_word(const char *p) {
+  uint64_t word;
+  memcpy(&word, p, sizeof(word));
+  return word;
+}
+
 uint8_t tau_enc_cp_to_bytes(uint32_t codepoint, char *dest) {
   if (codepoint < 0x80) {
     dest[0] = (char)codepoint;
@@ -35,54 +48,117 @@ uint8_t tau_enc_cp_to_bytes(uint32_t codepoint, char *dest) {
 }
 
 uint8_t tau_dec_bytes_to_cp(const char src[4], uint32_t *codepoint) {
+  // a NUL is never a continuation, so sequences cut short by the terminator are rejected before reading past it
+  uint8_t len = src[0] != '\0' ? tau_utf8_sequence_len(src, 4) : 0;
+  if (len == 0) {
+    *codepoint = UNICODE_REPLACEMENT_CHARACTER;
+    return 1;
+  }
+
   uint8_t lead = (uint8_t)src[0];
-  uint32_t err = UNICODE_REPLACEMENT_CHARACTER;
+  *codepoint = len == 1 ? lead : lead & (0x7F >> len);
+  for (uint8_t i = 1; i < len; i++) {
+    *codepoint = (*codepoint << 6) | ((uint8_t)src[i] & 0x3F);
+  }
 
-  if (lead == 0x00) {
-    *codepoint = err;
+  return len;
+}
+
+uint8_t tau_utf8_sequence_len(const char *buf, size_t len) {
+  assert(buf != NULL && "tau_utf8_sequence_len: buf cannot be NULL");
+  if (len == 0) {
+    return 0;
+  }
+
+  const uint8_t *p = (const uint8_t *)buf;
+  if (p[0] < 0x80) {
     return 1;
-  } else if ((~lead & 0x80) == 0x80 && src[0]) {
-    *codepoint = (uint32_t)src[0];
-    if (*codepoint >= 0x000007F) {
-      *codepoint = err;
+  }
+
+  // the lead byte decides the length and narrows the range of the second byte, later bytes are plain continuations
+  uint8_t seq_len;
+  uint8_t low = 0x80;
+  uint8_t high = 0xBF;
+  if (p[0] >= 0xC2 && p[0] <= 0xDF) {
+    seq_len = 2;
+  } else if (p[0] >= 0xE0 && p[0] <= 0xEF) {
+    seq_len = 3;
+    low = p[0] == 0xE0 ? 0xA0 : low;   // overlong
+    high = p[0] == 0xED ? 0x9F : high;  // surrogates
+  } else if (p[0] >= 0xF0 && p[0] <= 0xF4) {
+    seq_len = 4;
+    low = p[0] == 0xF0 ? 0x90 : low;    // overlong
+    high = p[0] == 0xF4 ? 0x8F : high;  // past U+10FFFF
+  } else {
+    return 0;
+  }
+
+  if (len < 2 || p[1] < low || p[1] > high) {
+    return 0;
+  }
+
+  for (uint8_t i = 2; i < seq_len; i++) {
+    if (i >= len || (p[i] & 0xC0) != 0x80) {
+      return 0;
     }
+  }
 
-    return 1;
-  } else if ((~lead & 0x20) == 0x20 && src[0] && src[1]) {
-    *codepoint = (uint32_t)(src[0] & 0x1F) << 6;
-    *codepoint |= (uint32_t)(src[1] & 0x3F);
-    if (*codepoint <= 0x00000080 || *codepoint >= 0x000007FF) {
-      *codepoint = err;
+  return seq_len;
+}
+
+size_t tau_utf8_validate(const char *buf, size_t len) {
+  assert((buf != NULL || len == 0) && "tau_utf8_validate: buf cannot be NULL");
+  return tau_scan_utf8(buf, len);
+}
+
+size_t tau_utf8_count_codepoints(const char *buf, size_t len) {
+  assert((buf != NULL || len == 0) && "tau_utf8_count_codepoints: buf cannot be NULL");
+  size_t count = 0;
+  size_t i = 0;
+  // eight bytes at a time, a continuation has its top bit set and the next one clear
+  for (; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t)) {
+    uint64_t word = read_word(buf + i);
+    uint64_t continuations = word & ~(word << 1) & UTF8_HIGH_BITS;
+    count += sizeof(uint64_t) - (size_t)__builtin_popcountll(continuations);
+  }
+
+  for (; i < len; i++) {
+    count += ((uint8_t)buf[i] & 0xC0) != 0x80;
+  }
+
+  return count;
+}
+
+size_t tau_utf8_decode(const char *buf, size_t len, uint32_t *out) {
+  assert((buf != NULL || len == 0) && "tau_utf8_decode: buf cannot be NULL");
+  assert((out != NULL || len == 0) && "tau_utf8_decode: out cannot be NULL");
+  size_t count = 0;
+  size_t i = 0;
+  while (i < len) {
+    if (i + sizeof(uint64_t) <= len && (read_word(buf + i) & UTF8_HIGH_BITS) == 0) {
+      for (size_t j = 0; j < sizeof(uint64_t); j++) {
+        out[count++] = (uint8_t)buf[i + j];
+      }
+
+      i += sizeof(uint64_t);
+      continue;
     }
 
-    return 2;
-  } else if ((~lead & 0x10) == 0x10 && src[0] && src[1] && src[2]) {
-    *codepoint = (uint32_t)(src[0] & 0x0F) << 12;
-    *codepoint |= (uint32_t)(src[1] & 0x3F) << 6;
-    *codepoint |= (uint32_t)(src[2] & 0x3F);
-    if (*codepoint <= 0x00000800 || *codepoint >= 0x0000FFFF) {
-      *codepoint = err;
+    uint8_t seq_len = tau_utf8_sequence_len(buf + i, len - i);
+    if (seq_len == 0) {
+      out[count++] = UNICODE_REPLACEMENT_CHARACTER;
+      i++;
+      continue;
     }
 
-    return 3;
-  } else if ((~lead & 0x08) == 0x08 && src[0] && src[1] && src[2] && src[3]) {
-    *codepoint = (uint32_t)(src[0] & 0x0F) << 18;
-    *codepoint |= (uint32_t)(src[1] & 0x3F) << 12;
-    *codepoint |= (uint32_t)(src[2] & 0x3F) << 6;
-    *codepoint |= (uint32_t)(src[3] & 0x3F);
-    if (*codepoint <= 0x00010000 || *codepoint >= 0x0010FFFF) {
-      *codepoint = err;
+    uint32_t codepoint = seq_len == 1 ? (uint8_t)buf[i] : (uint8_t)buf[i] & (0x7F >> seq_len);
+    for (uint8_t j = 1; j < seq_len; j++) {
+      codepoint = (codepoint << 6) | ((uint8_t)buf[i + j] & 0x3F);
     }
 
-    return 4;
-  } else if ((~lead & 0x04) == 0x04) {
-    *codepoint = err;
-    return 5;
-  } else if ((~lead & 0x02) == 0x02) {
-    *codepoint = err;
-    return 6;
+    out[count++] = codepoint;
+    i += seq_len;
   }
 
-  *codepoint = err;
-  return 1;
-}
\ No newline at end of file
+  return count;
+}
@@ -11,6 +11,21 @@
 #define UNICODE_REPLACEMENT_CHARACTER 0xFFFD
 
 uint8_t tau_enc_cp_to_bytes(uint32_t codepoint, char *dest);
+// Decodes the sequence at src, which must be followed by a NUL byte if shorter than 4 bytes. NUL and anything that is
+// not a well formed sequence give UNICODE_REPLACEMENT_CHARACTER and a length of 1, so callers always make progress.
 uint8_t tau_dec_bytes_to_cp(const char src[4], uint32_t *codepoint);
 
+// Length of the well formed sequence at the start of buf as laid out in table 3-7 of the Unicode standard: no
+// overlongs, no surrogates, nothing past U+10FFFF. Returns 0 when there is none within len bytes.
+uint8_t tau_utf8_sequence_len(const char *buf, size_t len);
+// Offset of the first byte that does not start a well formed sequence, len when the whole buffer is well formed.
+// Meant for long runs the lexer does not classify, such as string bodies and comments, it goes through the vector
+// scanners and skips ASCII a block at a time.
+size_t tau_utf8_validate(const char *buf, size_t len);
+// Code points in a buffer that passed tau_utf8_validate, which is a count of the bytes that are not continuations
+size_t tau_utf8_count_codepoints(const char *buf, size_t len);
+// Decodes buf to UTF-32 into out, which has room for len code points. Bytes that do not start a well formed sequence
+// are decoded as UNICODE_REPLACEMENT_CHARACTER one at a time. Returns how many code points were written.
+size_t tau_utf8_decode(const char *buf, size_t len, uint32_t *out);
+
 #endif  // TAU_UTF8_H
@@ -0,0 +1,94 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include "../src/arena.h"
+
+#include <stdalign.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/common.h"
+
+static void test_arena_alloc(void **state) {
+  UNUSED(state);
+  struct tau_arena arena;
+  tau_arena_init(&arena);
+
+  char *first = tau_arena_alloc(&arena, 3);
+  char *second = tau_arena_alloc(&arena, 40);
+  assert_non_null(first);
+  assert_non_null(second);
+  assert_true(second >= first + 3);
+  assert_int_equal((uintptr_t)first % alignof(max_align_t), 0);
+  assert_int_equal((uintptr_t)second % alignof(max_align_t), 0);
+
+  memset(first, 0xAA, 3);
+  memset(second, 0xBB, 40);
+  assert_int_equal((uint8_t)first[2], 0xAA);
+  assert_int_equal(arena.stats.allocs, 2);
+  assert_true(arena.stats.used >= 43);
+  assert_true(arena.stats.reserved >= arena.stats.used);
+
+  tau_arena_free(&arena);
+  assert_int_equal(arena.stats.used, 0);
+  assert_int_equal(arena.stats.reserved, 0);
+}
+
+static void test_arena_big_alloc(void **state) {
+  UNUSED(state);
+  struct tau_arena arena;
+  tau_arena_init(&arena);
+
+  size_t big = (size_t)32 * 1024 * 1024;
+  char *ptr = tau_arena_alloc(&arena, big);
+  assert_non_null(ptr);
+  ptr[0] = 1;
+  ptr[big - 1] = 1;
+  assert_true(arena.stats.reserved >= big);
+
+  tau_arena_free(&arena);
+}
+
+static void test_arena_reset_keeps_peak(void **state) {
+  UNUSED(state);
+  struct tau_arena arena;
+  tau_arena_init(&arena);
+
+  for (int i = 0; i < 100000; i++) {
+    tau_arena_alloc(&arena, 32);
+  }
+
+  size_t peak = arena.stats.peak;
+  assert_int_equal(peak, arena.stats.used);
+  assert_int_equal(arena.stats.allocs, 100000);
+
+  tau_arena_reset(&arena);
+  assert_int_equal(arena.stats.used, 0);
+  assert_int_equal(arena.stats.allocs, 0);
+  assert_int_equal(arena.stats.peak, peak);
+  assert_true(arena.stats.reserved > 0);
+
+  tau_arena_alloc(&arena, 32);
+  assert_int_equal(arena.stats.peak, peak);
+  tau_arena_free(&arena);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_arena_alloc),
+      cmocka_unit_test(test_arena_big_alloc),
+      cmocka_unit_test(test_arena_reset_keeps_peak),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,182 @@
+//
+// Created on 10/17/26.
+//
+#define _POSIX_C_SOURCE 200809L
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <pthread.h>
+#include <string.h>
+
+#include "../src/ast.h"
+#include "../src/common.h"
+
+#define AST_TEST_CHAIN_LEN 1000000
+#define AST_TEST_SMALL_STACK ((size_t)64 * 1024)
+
+struct trace {
+  char events[64];
+  size_t len;
+  node_id_t skip;
+  node_id_t stop;
+};
+
+static enum ast_visit_action trace_enter(const struct tau_ast *ast, node_id_t id, void *ctx) {
+  UNUSED(ast);
+  struct trace *trace = ctx;
+  trace->events[trace->len++] = (char)('0' + id);
+  return id == trace->stop ? AST_VISIT_STOP : id == trace->skip ? AST_VISIT_SKIP : AST_VISIT_CONTINUE;
+}
+
+static enum ast_visit_action trace_leave(const struct tau_ast *ast, node_id_t id, void *ctx) {
+  UNUSED(ast);
+  struct trace *trace = ctx;
+  trace->events[trace->len++] = (char)('a' + id - 1);
+  return AST_VISIT_CONTINUE;
+}
+
+// (1 (2 3 4) 5), enter events are the node ids and leave events the matching letters (1 is `a`)
+static void build_small_tree(struct tau_ast *ast) {
+  ast_init(ast, __func__, "", 0);
+  node_id_t one = ast_node_new(ast, TAU_NODE_ADD_EXPR, NODE_NULL, NODE_NULL);
+  node_id_t two = ast_node_new(ast, TAU_NODE_MUL_EXPR, NODE_NULL, NODE_NULL);
+  node_id_t three = ast_node_new(ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  node_id_t four = ast_node_new(ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  node_id_t five = ast_node_new(ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  ast_node(ast, one)->left = two;
+  ast_node(ast, one)->right = five;
+  ast_node(ast, two)->left = three;
+  ast_node(ast, two)->right = four;
+}
+
+static void test_ast_visit_order(void **state) {
+  UNUSED(state);
+  struct tau_ast ast;
+  build_small_tree(&ast);
+
+  struct trace trace = {0};
+  struct ast_visitor visitor = {.enter = trace_enter, .leave = trace_leave, .ctx = &trace};
+  assert_true(ast_visit(&ast, 1, &visitor));
+  assert_string_equal(trace.events, "123c4db5ea");
+
+  trace = (struct trace){0};
+  visitor.leave = NULL;
+  assert_true(ast_visit(&ast, 1, &visitor));
+  assert_string_equal(trace.events, "12345");
+
+  trace = (struct trace){0};
+  visitor = (struct ast_visitor){.leave = trace_leave, .ctx = &trace};
+  assert_true(ast_visit(&ast, 1, &visitor));
+  assert_string_equal(trace.events, "cdbea");
+  assert_true(ast_visit(&ast, NODE_NULL, &visitor));
+  ast_free(&ast);
+}
+
+static void test_ast_visit_skip_stop(void **state) {
+  UNUSED(state);
+  struct tau_ast ast;
+  build_small_tree(&ast);
+
+  struct trace trace = {.skip = 2};
+  struct ast_visitor visitor = {.enter = trace_enter, .leave = trace_leave, .ctx = &trace};
+  assert_true(ast_visit(&ast, 1, &visitor));
+  assert_string_equal(trace.events, "12b5ea");
+
+  trace = (struct trace){.stop = 4};
+  assert_false(ast_visit(&ast, 1, &visitor));
+  assert_string_equal(trace.events, "123c4");
+  ast_free(&ast);
+}
+
+static enum ast_visit_action count_node(const struct tau_ast *ast, node_id_t id, void *ctx) {
+  UNUSED(ast);
+  UNUSED(id);
+  (*(size_t *)ctx)++;
+  return AST_VISIT_CONTINUE;
+}
+
+static void *visit_long_chain(void *arg) {
+  struct tau_ast *ast = arg;
+  size_t entered = 0;
+  size_t left = 0;
+  struct ast_visitor visitor = {.enter = count_node, .ctx = &entered};
+  bool completed = ast_visit(ast, 1, &visitor);
+  visitor = (struct ast_visitor){.leave = count_node, .ctx = &left};
+  completed = completed && ast_visit(ast, 1, &visitor);
+  return completed && entered == AST_TEST_CHAIN_LEN && left == AST_TEST_CHAIN_LEN ? arg : NULL;
+}
+
+// A decl list a million entries long, walked from a thread whose stack could not hold that many frames
+static void test_ast_visit_long_chain(void **state) {
+  UNUSED(state);
+  struct tau_ast ast;
+  ast_init(&ast, __func__, "", 0);
+  node_id_t prev = NODE_NULL;
+  for (size_t i = 0; i < AST_TEST_CHAIN_LEN; i++) {
+    node_id_t id = ast_node_new(&ast, TAU_NODE_DECL, NODE_NULL, NODE_NULL);
+    if (prev != NODE_NULL) {
+      ast_node(&ast, prev)->right = id;
+    }
+
+    prev = id;
+  }
+
+  pthread_attr_t attr;
+  pthread_attr_init(&attr);
+  pthread_attr_setstacksize(&attr, AST_TEST_SMALL_STACK);
+  pthread_t thread;
+  assert_int_equal(pthread_create(&thread, &attr, visit_long_chain, &ast), 0);
+  void *res = NULL;
+  pthread_join(thread, &res);
+  pthread_attr_destroy(&attr);
+  assert_ptr_equal(res, &ast);
+  ast_free(&ast);
+}
+
+// Moving the base of a segment moves every node in it and none of the others
+static void test_ast_segments(void **state) {
+  UNUSED(state);
+  struct tau_ast ast;
+  ast_init(&ast, __func__, "", 0);
+  node_id_t unit = ast_node_new(&ast, TAU_NODE_DECLS, NODE_NULL, NODE_NULL);
+  ast_node(&ast, unit)->offset = 4;
+  ast_begin_segment(&ast, 100);
+  uint32_t segment = ast_begin_segment(&ast, 10);
+  node_id_t decl = ast_node_new(&ast, TAU_NODE_DECL, NODE_NULL, NODE_NULL);
+  node_id_t atom = ast_node_new(&ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  ast_node(&ast, atom)->offset = 6;
+  ast_begin_segment(&ast, 0);
+  node_id_t after = ast_node_new(&ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  ast_node(&ast, after)->offset = 30;
+
+  // the segment opened at 100 held no node and was taken over
+  assert_int_equal(ast_node_segment(&ast, unit), 0);
+  assert_int_equal(ast_node_segment(&ast, decl), segment);
+  assert_int_equal(ast_node_segment(&ast, atom), segment);
+  assert_int_equal(ast_node_segment(&ast, after), segment + 1);
+  assert_int_equal(ast_node_offset(&ast, decl), 10);
+  assert_int_equal(ast_node_offset(&ast, atom), 16);
+  ast.segments[segment].base += 5;
+  assert_int_equal(ast_node_offset(&ast, unit), 4);
+  assert_int_equal(ast_node_offset(&ast, atom), 21);
+  assert_int_equal(ast_node_offset(&ast, after), 30);
+  ast_free(&ast);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_ast_visit_order),       // enter before children, leave after them
+      cmocka_unit_test(test_ast_visit_skip_stop),   // callbacks can prune or end the walk
+      cmocka_unit_test(test_ast_visit_long_chain),  // depth is bounded by memory, not the stack
+      cmocka_unit_test(test_ast_segments),          // offsets count from the base of their segment
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,227 @@
+//
+// Created on 10/17/26.
+//
+#define _DEFAULT_SOURCE
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tau/parser.h>
+#include <unistd.h>
+
+#include "../src/ast.h"
+#include "../src/cache.h"
+#include "../src/common.h"
+#include "../src/hash.h"
+
+#define CACHE_TEST_SOURCE                   \
+  "module cache::test\n"                    \
+  "let greeting: Str = \"h\\x69\"\n"         \
+  "let answer: U32 = 0x2A\n"                \
+  "proc add(a: U32, b: U32): U32 = a + b\n" \
+  "type T prototype\n"
+
+static char cache_dir[PATH_MAX];
+
+static int setup_cache_dir(void **state) {
+  UNUSED(state);
+  strcpy(cache_dir, "/tmp/tau_cache_test_XXXXXX");
+  return mkdtemp(cache_dir) != NULL ? 0 : -1;
+}
+
+static int teardown_cache_dir(void **state) {
+  UNUSED(state);
+  DIR *dir = opendir(cache_dir);
+  struct dirent *entry;
+  while (dir != NULL && (entry = readdir(dir)) != NULL) {
+    char path[PATH_MAX * 2];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+    unlink(path);
+  }
+
+  if (dir != NULL) {
+    closedir(dir);
+  }
+
+  return rmdir(cache_dir);
+}
+
+static size_t count_images(void) {
+  size_t count = 0;
+  DIR *dir = opendir(cache_dir);
+  assert_non_null(dir);
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    count += entry->d_name[0] != '.';
+  }
+
+  closedir(dir);
+  return count;
+}
+
+static struct tau_parse_result *parse_cached(const char *buf) {
+  struct tau_parse_options options = {.cache_dir = cache_dir};
+  return tau_parse_buffer_with_options(__func__, buf, strlen(buf), &options);
+}
+
+static void test_hash64(void **state) {
+  UNUSED(state);
+  const char *long_text = "Nobody inspects the spammish repetition";
+  assert_int_equal(tau_hash64("", 0, 0), 0xEF46DB3751D8E999ull);
+  assert_int_equal(tau_hash64("a", 1, 0), 0xD24EC4F1A98C6E5Bull);
+  assert_int_equal(tau_hash64("abc", 3, 0), 0x44BC2CF5AD770999ull);
+  assert_int_equal(tau_hash64(long_text, strlen(long_text), 0), 0xFBCEA83C8A378BF1ull);
+  assert_int_not_equal(tau_hash64("abc", 3, 1), tau_hash64("abc", 3, 0));
+}
+
+static void test_cache_round_trip(void **state) {
+  UNUSED(state);
+  struct tau_parse_result *parsed = parse_cached(CACHE_TEST_SOURCE);
+  assert_true(tau_parse_result_ok(parsed));
+  assert_false(tau_parse_result_stats(parsed).cached);
+  assert_int_equal(count_images(), 1);
+
+  // loaded into a private interner of its own, so symbols differ while their texts match
+  struct tau_parse_result *loaded = parse_cached(CACHE_TEST_SOURCE);
+  assert_true(tau_parse_result_ok(loaded));
+  assert_true(tau_parse_result_stats(loaded).cached);
+  assert_int_equal(tau_parse_result_stats(loaded).token_count, 0);
+  assert_int_equal(tau_parse_result_root(loaded), tau_parse_result_root(parsed));
+
+  const struct tau_ast *want = tau_parse_result_ast(parsed);
+  const struct tau_ast *got = tau_parse_result_ast(loaded);
+  assert_int_equal(ast_size(got), ast_size(want));
+  for (node_id_t id = 1; id <= ast_size(want); id++) {
+    const struct tau_node *a = ast_node(want, id);
+    const struct tau_node *b = ast_node(got, id);
+    assert_int_equal(a->type, b->type);
+    assert_int_equal(ast_node_offset(want, id), ast_node_offset(got, id));
+    assert_int_equal(a->len, b->len);
+    assert_int_equal(a->left, b->left);
+    assert_int_equal(a->right, b->right);
+    assert_int_equal(a->token_type, b->token_type);
+    assert_int_equal(a->token_code, b->token_code);
+    if (a->symbol == TAU_SYMBOL_NONE) {
+      assert_int_equal(b->symbol, TAU_SYMBOL_NONE);
+    } else {
+      assert_string_equal(tau_interner_text(tau_parse_result_interner(parsed), a->symbol, NULL),
+                          tau_interner_text(tau_parse_result_interner(loaded), b->symbol, NULL));
+    }
+  }
+
+  // loaded trees have no tokens, literal values come from the source text
+  size_t literal_count = 0;
+  size_t string_count = 0;
+  for (node_id_t id = 1; id <= ast_size(got); id++) {
+    uint64_t value = 0;
+    size_t text_len = 0;
+    if (ast_node_token_type(got, id) == TAU_TOKEN_TYPE_INT_LIT) {
+      assert_true(tau_parse_result_node_int(loaded, id, &value));
+      assert_int_equal(value, 0x2A);
+      literal_count++;
+    } else if (ast_node_token_type(got, id) == TAU_TOKEN_TYPE_STR_LIT) {
+      assert_string_equal(tau_parse_result_node_string(loaded, id, &text_len), "hi");
+      assert_int_equal(text_len, 2);
+      string_count++;
+    }
+  }
+
+  assert_true(literal_count > 0);
+  assert_true(string_count > 0);
+  size_t want_size;
+  size_t got_size;
+  const char *want_strings = tau_parse_result_strings(parsed, &want_size);
+  const char *got_strings = tau_parse_result_strings(loaded, &got_size);
+  assert_int_equal(got_size, want_size);
+  assert_memory_equal(got_strings, want_strings, want_size);
+
+  // the first reparse of a loaded tree is a full one
+  size_t len = strlen(CACHE_TEST_SOURCE);
+  assert_false(tau_parse_result_reparse(loaded, CACHE_TEST_SOURCE, len, (struct tau_parse_edit){.offset = len}));
+  assert_true(tau_parse_result_ok(loaded));
+  assert_false(tau_parse_result_stats(loaded).cached);
+
+  tau_parse_result_free(parsed);
+  tau_parse_result_free(loaded);
+}
+
+static void test_cache_misses(void **state) {
+  UNUSED(state);
+  size_t images = count_images();
+
+  // trees with diagnostics are never stored
+  struct tau_parse_result *result = parse_cached("module m\nlet = = 1\n");
+  assert_false(tau_parse_result_ok(result));
+  tau_parse_result_free(result);
+  assert_int_equal(count_images(), images);
+
+  // any change to the bytes is a different key
+  result = parse_cached("module m\nlet a: U32 = 1\n");
+  assert_false(tau_parse_result_stats(result).cached);
+  tau_parse_result_free(result);
+  result = parse_cached("module m\nlet a: U32 = 2\n");
+  assert_false(tau_parse_result_stats(result).cached);
+  tau_parse_result_free(result);
+  assert_int_equal(count_images(), images + 2);
+
+  // images that fail validation are misses, and parsing writes a sound one over them
+  const char *buf = "module m\nlet b: U32 = 1\n";
+  tau_parse_result_free(parse_cached(buf));
+  char path[PATH_MAX * 2];
+  snprintf(path, sizeof(path), "%s/%016llx.tast", cache_dir, (unsigned long long)tau_hash64(buf, strlen(buf), 0));
+  int fd = open(path, O_WRONLY);
+  assert_true(fd >= 0);
+  uint32_t version = TAU_CACHE_VERSION + 1;
+  assert_int_equal(pwrite(fd, &version, sizeof(version), offsetof(struct tau_cache_header, version)),
+                   sizeof(version));
+  close(fd);
+
+  struct tau_cache_image image;
+  assert_false(tau_cache_map(&image, cache_dir, tau_hash64(buf, strlen(buf), 0), strlen(buf)));
+  result = parse_cached(buf);
+  assert_false(tau_parse_result_stats(result).cached);
+  tau_parse_result_free(result);
+  assert_true(tau_cache_map(&image, cache_dir, tau_hash64(buf, strlen(buf), 0), strlen(buf)));
+  assert_int_equal(image.header->content_size, strlen(buf));
+  tau_cache_unmap(&image);
+  assert_false(tau_cache_map(&image, cache_dir, tau_hash64(buf, strlen(buf), 0), strlen(buf) + 1));
+
+  // so are links that loop back, which would never end a walk of the tree
+  struct tau_cache_header header;
+  fd = open(path, O_RDWR);
+  assert_true(fd >= 0);
+  assert_int_equal(pread(fd, &header, sizeof(header), 0), sizeof(header));
+  off_t left = (off_t)(header.nodes_offset + 2 * sizeof(struct tau_node) + offsetof(struct tau_node, left));
+  assert_int_equal(pwrite(fd, &header.root, sizeof(header.root), left), sizeof(header.root));
+  close(fd);
+  assert_false(tau_cache_map(&image, cache_dir, tau_hash64(buf, strlen(buf), 0), strlen(buf)));
+  result = parse_cached(buf);
+  assert_false(tau_parse_result_stats(result).cached);
+  tau_parse_result_node_hash(result, tau_parse_result_root(result));
+  tau_parse_result_free(result);
+
+  assert_true(truncate(path, sizeof(struct tau_cache_header) + 1) == 0);
+  assert_false(tau_cache_map(&image, cache_dir, tau_hash64(buf, strlen(buf), 0), strlen(buf)));
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_hash64),            // known XXH64 values
+      cmocka_unit_test(test_cache_round_trip),  // a cached tree loads back node for node
+      cmocka_unit_test(test_cache_misses),      // errors, edits and damaged images all parse again
+  };
+
+  return cmocka_run_group_tests(tests, setup_cache_dir, teardown_cache_dir);
+}
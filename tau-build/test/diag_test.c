@@ -0,0 +1,155 @@
+//
+// Created on 10/17/26.
+//
+#define _POSIX_C_SOURCE 200809L
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include "../src/diag.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/common.h"
+
+#define DIAG_TEST_REPEATS 100000
+
+static void report_unexpected(struct tau_diag_list *list, size_t row, const char *token, const char *expecting) {
+  struct tau_loc loc = {.buf_name = "a.tau", .row = row, .col = 4};
+  tau_diag_report(list, TAU_DIAG_UNEXPECTED_TOKEN, loc, strlen(token),
+                  (struct tau_diag_arg[]){{token, strlen(token)}, {expecting, strlen(expecting)}});
+}
+
+// Renders list with a writer and returns what reached the stream, to be freed by the caller
+static char *render(const struct tau_diag_list *list, enum tau_diag_format format) {
+  char *buf = NULL;
+  size_t len = 0;
+  FILE *target = open_memstream(&buf, &len);
+  struct tau_diag_writer writer;
+  tau_diag_writer_init(&writer, format, target);
+  tau_diag_writer_add_list(&writer, list);
+  tau_diag_writer_finish(&writer);
+  fclose(target);
+  return buf;
+}
+
+static void test_diag_report(void **state) {
+  UNUSED(state);
+  struct tau_diag_list list;
+  tau_diag_list_init(&list);
+
+  // arguments are copied, they only need to live through the call
+  char token[] = "))";
+  report_unexpected(&list, 2, token, "<expression>");
+  token[0] = '\0';
+  tau_diag_report(&list, TAU_DIAG_UNCLOSED_STRING, (struct tau_loc){.buf_name = "a.tau", .row = 3}, 5, NULL);
+
+  assert_int_equal(list.count, 2);
+  assert_int_equal(list.error_count, 2);
+  const struct tau_diag *diag = &list.items[0];
+  assert_int_equal(diag->level, TAU_LOG_ERROR);
+  assert_int_equal(diag->code, TAU_DIAG_UNEXPECTED_TOKEN);
+  assert_int_equal(diag->loc.row, 2);
+  assert_int_equal(diag->len, 2);
+  assert_string_equal(diag->args[0], "))");
+  assert_string_equal(diag->args[1], "<expression>");
+  assert_string_equal(diag->message, "unexpected `))`, was expecting <expression>");
+  assert_string_equal(tau_diag_get_code_name(diag->code), "E0003");
+  assert_non_null(strstr(list.items[1].message, "unclosed string literal"));
+  tau_diag_list_free(&list);
+}
+
+static void test_diag_policy(void **state) {
+  UNUSED(state);
+  struct tau_diag_list list;
+  tau_diag_list_init(&list);
+  tau_diag_list_set_policy(&list, (struct tau_diag_policy){.limit = 2, .fold = true});
+
+  // the same mistake at every line of a generated file keeps a single diagnostic
+  for (size_t row = 0; row < DIAG_TEST_REPEATS; row++) {
+    report_unexpected(&list, row, ")", "<expression>");
+  }
+
+  report_unexpected(&list, 0, ")", "<end of line>");
+  report_unexpected(&list, 0, "]", "<expression>");
+  report_unexpected(&list, 0, ")", "<end of line>");
+  assert_int_equal(list.count, 2);
+  assert_int_equal(list.items[0].repeat_count, DIAG_TEST_REPEATS - 1);
+  assert_int_equal(list.items[0].loc.row, 0);
+  assert_int_equal(list.items[1].repeat_count, 1);
+  assert_int_equal(list.dropped_count, 1);
+  assert_int_equal(list.error_count, DIAG_TEST_REPEATS + 3);
+  tau_diag_list_free(&list);
+
+  // without folding the limit alone applies
+  tau_diag_list_init(&list);
+  tau_diag_list_set_policy(&list, (struct tau_diag_policy){.limit = 1});
+  report_unexpected(&list, 0, ")", "<expression>");
+  report_unexpected(&list, 1, ")", "<expression>");
+  assert_int_equal(list.count, 1);
+  assert_int_equal(list.items[0].repeat_count, 0);
+  assert_int_equal(list.dropped_count, 1);
+  tau_diag_list_free(&list);
+}
+
+static void test_diag_writer(void **state) {
+  UNUSED(state);
+  struct tau_diag_list list;
+  tau_diag_list_init(&list);
+  tau_diag_list_set_policy(&list, (struct tau_diag_policy){.limit = 1, .fold = true});
+  report_unexpected(&list, 1, "\"", "<expression>");
+  report_unexpected(&list, 5, "\"", "<expression>");
+  report_unexpected(&list, 6, "]", "<expression>");
+
+  char *text = render(&list, TAU_DIAG_FORMAT_TEXT);
+  assert_string_equal(text,
+                      "a.tau:1:4 error[E0003]: unexpected `\"`, was expecting <expression> (repeated 1 more times)\n"
+                      "note: 1 more diagnostics were dropped\n");
+  free(text);
+
+  char *json = render(&list, TAU_DIAG_FORMAT_JSON);
+  assert_string_equal(json,
+                      "{\"diagnostics\": [\n"
+                      "  {\"file\": \"a.tau\", \"row\": 1, \"col\": 4, \"len\": 1, \"severity\": \"error\", "
+                      "\"code\": \"E0003\", \"message\": \"unexpected `\\\"`, was expecting <expression>\", "
+                      "\"args\": [\"\\\"\", \"<expression>\"], \"repeats\": 1}\n"
+                      "], \"dropped\": 1}\n");
+  free(json);
+  tau_diag_list_free(&list);
+
+  // malformed bytes out of the source become U+FFFD, well formed sequences are kept as they are
+  tau_diag_list_init(&list);
+  report_unexpected(&list, 0, "\xff\xc3\xa9\xC0\xAF\xe2\x82", "<expression>");
+  json = render(&list, TAU_DIAG_FORMAT_JSON);
+  assert_non_null(strstr(json, "\"args\": [\"\\ufffd\xc3\xa9\\ufffd\\ufffd\\ufffd\\ufffd\", \"<expression>\"]"));
+  assert_non_null(strstr(json, "\"message\": \"unexpected `\\ufffd\xc3\xa9\\ufffd\\ufffd\\ufffd\\ufffd`"));
+  free(json);
+  tau_diag_list_free(&list);
+
+  tau_diag_list_init(&list);
+  json = render(&list, TAU_DIAG_FORMAT_JSON);
+  assert_string_equal(json, "{\"diagnostics\": [], \"dropped\": 0}\n");
+  free(json);
+  text = render(&list, TAU_DIAG_FORMAT_TEXT);
+  assert_string_equal(text, "");
+  free(text);
+  tau_diag_list_free(&list);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_diag_report),  // code, arguments, span and message
+      cmocka_unit_test(test_diag_policy),  // repeats are folded and the list is capped
+      cmocka_unit_test(test_diag_writer),  // text and json renderings
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,246 @@
+//
+// Created on 10/17/26.
+//
+#define _POSIX_C_SOURCE 200809L
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <dirent.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tau/driver.h>
+#include <unistd.h>
+
+#include "../src/ast.h"
+#include "../src/common.h"
+#include "../src/pool.h"
+
+#define DRIVER_TEST_FILES 12
+#define DRIVER_TEST_PATH_MAX 64
+#define POOL_TEST_TASKS 1000
+
+static char paths[DRIVER_TEST_FILES][DRIVER_TEST_PATH_MAX];
+
+static void write_file(char *path, const char *content) {
+  strcpy(path, "/tmp/tau_driver_test_XXXXXX");
+  int fd = mkstemp(path);
+  assert_true(fd >= 0);
+  size_t len = strlen(content);
+  assert_int_equal(write(fd, content, len), (ssize_t)len);
+  close(fd);
+}
+
+// Files grow with their index, so the pool sees them in reverse order
+static int setup_files(void **state) {
+  UNUSED(state);
+  for (int i = 0; i < DRIVER_TEST_FILES; i++) {
+    char content[1024];
+    int len = snprintf(content, sizeof(content), "module m%d\n", i);
+    for (int j = 0; j <= i; j++) {
+      len += snprintf(content + len, sizeof(content) - (size_t)len, "let v%d: U32 = %d + %d\n", j, i, j);
+    }
+
+    write_file(paths[i], content);
+  }
+
+  return 0;
+}
+
+static int teardown_files(void **state) {
+  UNUSED(state);
+  for (int i = 0; i < DRIVER_TEST_FILES; i++) {
+    unlink(paths[i]);
+  }
+
+  return 0;
+}
+
+static bool has_symbol(const struct tau_ast *ast, tau_symbol_t symbol) {
+  for (node_id_t id = 1; id <= ast_size(ast); id++) {
+    if (ast_node_symbol(ast, id) == symbol) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static void test_driver_parse_files(void **state) {
+  UNUSED(state);
+  const char *files[DRIVER_TEST_FILES];
+  for (int i = 0; i < DRIVER_TEST_FILES; i++) {
+    files[i] = paths[i];
+  }
+
+  struct tau_driver_options options = {.thread_count = 4};
+  struct tau_driver_result *result = tau_driver_parse_files(files, DRIVER_TEST_FILES, &options);
+  assert_true(tau_driver_result_ok(result));
+  assert_int_equal(tau_driver_result_module_count(result), DRIVER_TEST_FILES);
+  assert_int_equal(tau_driver_result_diagnostic_count(result), 0);
+
+  size_t node_count = 0;
+  for (int i = 0; i < DRIVER_TEST_FILES; i++) {
+    assert_string_equal(tau_driver_result_module_path(result, i), paths[i]);
+    const struct tau_parse_result *module = tau_driver_result_module(result, i);
+    assert_non_null(module);
+    const struct tau_ast *ast = tau_parse_result_ast(module);
+    node_id_t root = tau_parse_result_root(module);
+    assert_int_equal(ast_node_type(ast, root), TAU_NODE_COMPILATION_UNIT);
+
+    size_t len = 0;
+    const char *name = ast_node_text(ast, ast_node_left(ast, ast_node_left(ast, root)), &len);
+    char expected[16];
+    snprintf(expected, sizeof(expected), "m%d", i);
+    assert_int_equal(len, strlen(expected));
+    assert_memory_equal(name, expected, len);
+    node_count += tau_parse_result_stats(module).node_count;
+  }
+
+  // every module names `v0`, and all of them resolve to the same symbol
+  const struct tau_parse_result *first = tau_driver_result_module(result, 0);
+  const struct tau_parse_result *last = tau_driver_result_module(result, DRIVER_TEST_FILES - 1);
+  tau_symbol_t v0 = tau_interner_intern(tau_driver_result_interner(result), "v0", 2);
+  assert_ptr_equal(tau_parse_result_interner(first), tau_driver_result_interner(result));
+  assert_ptr_equal(tau_parse_result_interner(last), tau_driver_result_interner(result));
+  assert_true(has_symbol(tau_parse_result_ast(first), v0));
+  assert_true(has_symbol(tau_parse_result_ast(last), v0));
+
+  struct tau_driver_stats stats = tau_driver_result_stats(result);
+  assert_int_equal(stats.thread_count, 4);
+  assert_int_equal(stats.node_count, node_count);
+  assert_int_equal(stats.error_count, 0);
+  tau_driver_result_free(result);
+}
+
+static void test_driver_diagnostics(void **state) {
+  UNUSED(state);
+  char bad[DRIVER_TEST_PATH_MAX];
+  write_file(bad, "module bad\nlet a: A = \"b\n");
+  const char *files[] = {paths[0], "/tmp/tau_driver_test_missing", bad, paths[1]};
+
+  struct tau_driver_result *result = tau_driver_parse_files(files, 4, NULL);
+  unlink(bad);
+  assert_false(tau_driver_result_ok(result));
+  assert_null(tau_driver_result_module(result, 1));
+  assert_non_null(tau_driver_result_module(result, 2));
+  assert_true(tau_driver_result_diagnostic_count(result) >= 2);
+
+  struct tau_driver_diagnostic missing = tau_driver_result_diagnostic(result, 0);
+  assert_string_equal(missing.path, files[1]);
+  assert_int_equal(missing.diagnostic.severity, TAU_PARSE_SEVERITY_ERROR);
+  assert_non_null(strstr(missing.diagnostic.message, "cannot read file"));
+  assert_string_equal(missing.diagnostic.code, "E0004");
+
+  struct tau_driver_diagnostic unclosed = tau_driver_result_diagnostic(result, 1);
+  assert_string_equal(unclosed.path, bad);
+  assert_int_equal(unclosed.diagnostic.row, 1);
+  assert_non_null(strstr(unclosed.diagnostic.message, "unclosed string literal"));
+
+  size_t last = tau_driver_result_diagnostic_count(result) - 1;
+  assert_string_equal(tau_driver_result_diagnostic(result, last).path, bad);
+  assert_int_equal(tau_driver_result_stats(result).error_count, tau_driver_result_diagnostic_count(result));
+
+  // every module's diagnostics end up in one document, in module order
+  char *json = NULL;
+  size_t json_len = 0;
+  FILE *out = open_memstream(&json, &json_len);
+  tau_driver_result_write_diagnostics(result, TAU_PARSE_FORMAT_JSON, out);
+  fclose(out);
+  const char *missing_json = strstr(json, "\"code\": \"E0004\"");
+  const char *unclosed_json = strstr(json, "\"code\": \"E0002\"");
+  assert_non_null(missing_json);
+  assert_non_null(unclosed_json);
+  assert_true(missing_json < unclosed_json);
+  assert_non_null(strstr(json, "\"dropped\": 0}"));
+  free(json);
+  tau_driver_result_free(result);
+}
+
+static void test_driver_parse_cache(void **state) {
+  UNUSED(state);
+  char cache_dir[DRIVER_TEST_PATH_MAX] = "/tmp/tau_driver_cache_XXXXXX";
+  assert_non_null(mkdtemp(cache_dir));
+  const char *files[DRIVER_TEST_FILES];
+  for (int i = 0; i < DRIVER_TEST_FILES; i++) {
+    files[i] = paths[i];
+  }
+
+  struct tau_driver_options options = {.thread_count = 4, .cache_dir = cache_dir};
+  struct tau_driver_result *result = tau_driver_parse_files(files, DRIVER_TEST_FILES, &options);
+  assert_true(tau_driver_result_ok(result));
+  assert_int_equal(tau_driver_result_stats(result).cache_hit_count, 0);
+  size_t node_count = tau_driver_result_stats(result).node_count;
+  tau_driver_result_free(result);
+
+  // the second build loads every module, and cached symbols still go through the shared interner
+  result = tau_driver_parse_files(files, DRIVER_TEST_FILES, &options);
+  assert_true(tau_driver_result_ok(result));
+  struct tau_driver_stats stats = tau_driver_result_stats(result);
+  assert_int_equal(stats.cache_hit_count, DRIVER_TEST_FILES);
+  assert_int_equal(stats.token_count, 0);
+  assert_int_equal(stats.node_count, node_count);
+  tau_symbol_t v0 = tau_interner_intern(tau_driver_result_interner(result), "v0", 2);
+  assert_true(has_symbol(tau_parse_result_ast(tau_driver_result_module(result, DRIVER_TEST_FILES - 1)), v0));
+  tau_driver_result_free(result);
+
+  DIR *dir = opendir(cache_dir);
+  assert_non_null(dir);
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    char path[DRIVER_TEST_PATH_MAX + sizeof(entry->d_name)];
+    snprintf(path, sizeof(path), "%s/%s", cache_dir, entry->d_name);
+    unlink(path);
+  }
+
+  closedir(dir);
+  assert_int_equal(rmdir(cache_dir), 0);
+}
+
+static void count_task(void *ctx, size_t task, size_t worker) {
+  UNUSED(worker);
+  atomic_fetch_add(&((atomic_int *)ctx)[task], 1);
+}
+
+static void test_pool_run(void **state) {
+  UNUSED(state);
+  static atomic_int counts[POOL_TEST_TASKS];
+  size_t order[POOL_TEST_TASKS];
+  for (size_t i = 0; i < POOL_TEST_TASKS; i++) {
+    atomic_init(&counts[i], 0);
+    order[i] = POOL_TEST_TASKS - 1 - i;
+  }
+
+  struct tau_pool_stats stats = {0};
+  tau_pool_run(3, order, POOL_TEST_TASKS, count_task, counts, &stats);
+  assert_int_equal(stats.thread_count, 3);
+  for (size_t i = 0; i < POOL_TEST_TASKS; i++) {
+    assert_int_equal(atomic_load(&counts[i]), 1);
+  }
+
+  // never more workers than tasks, and no work at all is fine
+  tau_pool_run(8, order, 2, count_task, counts, &stats);
+  assert_int_equal(stats.thread_count, 2);
+  tau_pool_run(8, order, 0, count_task, counts, &stats);
+  assert_int_equal(stats.thread_count, 1);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_driver_parse_files),  // one ast per file, in the order given
+      cmocka_unit_test(test_driver_diagnostics),  // read and parse errors grouped by file
+      cmocka_unit_test(test_driver_parse_cache),  // unchanged files are loaded instead of parsed
+      cmocka_unit_test(test_pool_run),            // every task runs exactly once
+  };
+
+  return cmocka_run_group_tests(tests, setup_files, teardown_files);
+}
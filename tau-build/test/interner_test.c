@@ -0,0 +1,129 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <stdio.h>
+#include <string.h>
+#include <tau/interner.h>
+#include <threads.h>
+
+#include "../src/common.h"
+#include "../src/lexer.h"
+
+#define INTERNER_TEST_THREADS 4
+#define INTERNER_TEST_NAMES 20000
+
+static void test_interner_intern(void **state) {
+  UNUSED(state);
+  struct tau_interner *interner = tau_interner_new();
+  tau_symbol_t a = tau_interner_intern(interner, "alpha", 5);
+  tau_symbol_t b = tau_interner_intern(interner, "alphabet", 8);
+  assert_int_not_equal(a, TAU_SYMBOL_NONE);
+  assert_int_not_equal(a, b);
+  assert_int_equal(tau_interner_intern(interner, "alphabet", 5), a);
+  assert_int_equal(tau_interner_intern(interner, "", 0), tau_interner_intern(interner, "", 0));
+  assert_int_equal(tau_interner_count(interner), 3);
+
+  size_t len = 0;
+  assert_string_equal(tau_interner_text(interner, b, &len), "alphabet");
+  assert_int_equal(len, 8);
+  tau_interner_free(interner);
+}
+
+// Enough names to grow every shard table and fill more than one entry chunk
+static void test_interner_grow(void **state) {
+  UNUSED(state);
+  struct tau_interner *interner = tau_interner_new();
+  char name[32];
+  for (int i = 0; i < INTERNER_TEST_NAMES; i++) {
+    int len = snprintf(name, sizeof(name), "name_%d", i);
+    tau_interner_intern(interner, name, (size_t)len);
+  }
+
+  assert_int_equal(tau_interner_count(interner), INTERNER_TEST_NAMES);
+  for (int i = 0; i < INTERNER_TEST_NAMES; i++) {
+    int len = snprintf(name, sizeof(name), "name_%d", i);
+    tau_symbol_t symbol = tau_interner_intern(interner, name, (size_t)len);
+    assert_string_equal(tau_interner_text(interner, symbol, NULL), name);
+  }
+
+  assert_int_equal(tau_interner_count(interner), INTERNER_TEST_NAMES);
+  tau_interner_free(interner);
+}
+
+struct intern_job {
+  struct tau_interner *interner;
+  tau_symbol_t symbols[INTERNER_TEST_NAMES / 10];
+};
+
+static int intern_many(void *arg) {
+  struct intern_job *job = arg;
+  char name[32];
+  for (int i = 0; i < INTERNER_TEST_NAMES / 10; i++) {
+    int len = snprintf(name, sizeof(name), "shared_%d", i);
+    job->symbols[i] = tau_interner_intern(job->interner, name, (size_t)len);
+  }
+
+  return 0;
+}
+
+static void test_interner_threads(void **state) {
+  UNUSED(state);
+  static struct intern_job jobs[INTERNER_TEST_THREADS];
+  struct tau_interner *interner = tau_interner_new();
+  thrd_t threads[INTERNER_TEST_THREADS];
+  for (int i = 0; i < INTERNER_TEST_THREADS; i++) {
+    jobs[i].interner = interner;
+    assert_int_equal(thrd_create(&threads[i], intern_many, &jobs[i]), thrd_success);
+  }
+
+  for (int i = 0; i < INTERNER_TEST_THREADS; i++) {
+    assert_int_equal(thrd_join(threads[i], NULL), thrd_success);
+    assert_memory_equal(jobs[i].symbols, jobs[0].symbols, sizeof(jobs[0].symbols));
+  }
+
+  assert_int_equal(tau_interner_count(interner), INTERNER_TEST_NAMES / 10);
+  tau_interner_free(interner);
+}
+
+static void test_interner_token_table(void **state) {
+  UNUSED(state);
+  const char *test = "let a = b + a(\"a\")";
+  struct tau_interner *interner = tau_interner_new();
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  table.interner = interner;
+  tau_token_table_lex(&table, NULL, __func__, test, strlen(test));
+
+  // let a = b + a ( "a" ) EOF
+  assert_int_equal(table.count, 10);
+  assert_int_equal(table.symbols[0], TAU_SYMBOL_NONE);
+  assert_int_not_equal(table.symbols[1], TAU_SYMBOL_NONE);
+  assert_int_equal(table.symbols[2], TAU_SYMBOL_NONE);
+  assert_int_not_equal(table.symbols[3], table.symbols[1]);
+  assert_int_equal(table.symbols[5], table.symbols[1]);
+  assert_int_not_equal(table.symbols[7], table.symbols[1]);
+  assert_string_equal(tau_interner_text(interner, table.symbols[7], NULL), "\"a\"");
+  tau_token_table_free(&table);
+  tau_interner_free(interner);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_interner_intern),       // equal strings, equal symbols
+      cmocka_unit_test(test_interner_grow),         // symbols survive table and chunk growth
+      cmocka_unit_test(test_interner_threads),      // concurrent interning agrees on symbols
+      cmocka_unit_test(test_interner_token_table),  // the lexer fills the symbols column
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -20,8 +20,8 @@ static void test_tokenize_spaces(void **state) {
   struct tau_token token = tau_token_start(buf_name, buf_data, buf_len);
 
   token = tau_token_next(token);
-  assert_int_equal(token.loc.col, 4);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 4);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_tabs(void **state) {
@@ -32,8 +32,8 @@ static void test_tokenize_tabs(void **state) {
   struct tau_token token = tau_token_start(buf_name, buf_data, buf_len);
 
   token = tau_token_next(token);
-  assert_int_equal(token.loc.col, 4);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 4);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_eol(void **state) {
@@ -47,8 +47,12 @@ static void test_tokenize_eol(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_EOL);
   assert_int_equal(token.len, 1);
   assert_memory_equal("\n", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 1);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
+
+  token = tau_token_next(token);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 1);
 }
 
 static void test_tokenize_dec_int_lit(void **state) {
@@ -63,8 +67,8 @@ static void test_tokenize_dec_int_lit(void **state) {
   assert_int_equal(token.len, 3);
   assert_memory_equal("123", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_DEC);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_bin_int_lit(void **state) {
@@ -79,8 +83,8 @@ static void test_tokenize_bin_int_lit(void **state) {
   assert_int_equal(token.len, 6);
   assert_memory_equal("0b1010", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_BIN);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_oct_int_lit(void **state) {
@@ -95,8 +99,8 @@ static void test_tokenize_oct_int_lit(void **state) {
   assert_int_equal(token.len, 6);
   assert_memory_equal("0o7070", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_OCT);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_hex_int_lit(void **state) {
@@ -111,8 +115,8 @@ static void test_tokenize_hex_int_lit(void **state) {
   assert_int_equal(token.len, 6);
   assert_memory_equal("0xFAFA", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_HEX);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_flt_lit(void **state) {
@@ -127,8 +131,8 @@ static void test_tokenize_flt_lit(void **state) {
   assert_int_equal(token.len, 4);
   assert_memory_equal("0.12", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_DEC);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_flt_with_exp_lit(void **state) {
@@ -143,8 +147,8 @@ static void test_tokenize_flt_with_exp_lit(void **state) {
   assert_int_equal(token.len, 8);
   assert_memory_equal("0.12e+10", token.buf, token.len);
   assert_int_equal(token.num_base, TAU_NUM_BASE_DEC);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_str_lit(void **state) {
@@ -158,8 +162,8 @@ static void test_tokenize_str_lit(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_STR_LIT);
   assert_int_equal(token.len, 5);
   assert_memory_equal("\"abc\"", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_str_with_esc_lit(void **state) {
@@ -173,8 +177,21 @@ static void test_tokenize_str_with_esc_lit(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_STR_LIT);
   assert_int_equal(token.len, 8);
   assert_memory_equal("\"\\n\\xFA\"", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
+
+  // the closing quote right after an escape sequence must end the literal
+  buf_data = "\"\\n\" \"\\\"\"";
+  token = tau_token_start(buf_name, buf_data, strlen(buf_data));
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_STR_LIT);
+  assert_int_equal(token.len, 4);
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_STR_LIT);
+  assert_int_equal(token.len, 4);
+  assert_int_equal(tau_token_loc(&token).col, 5);
 }
 
 static void test_tokenize_punct_single(void **state) {
@@ -189,8 +206,8 @@ static void test_tokenize_punct_single(void **state) {
   assert_int_equal(token.len, 1);
   assert_memory_equal("+", token.buf, token.len);
   assert_int_equal(token.punct, TAU_PUNCT_PLUS);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_punct_multiple(void **state) {
@@ -205,8 +222,8 @@ static void test_tokenize_punct_multiple(void **state) {
   assert_int_equal(token.len, 3);
   assert_memory_equal(">>=", token.buf, token.len);
   assert_int_equal(token.punct, TAU_PUNCT_D_GT_EQ);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_punct_lumped(void **state) {
@@ -221,16 +238,36 @@ static void test_tokenize_punct_lumped(void **state) {
   assert_int_equal(token.len, 2);
   assert_memory_equal("+=", token.buf, token.len);
   assert_int_equal(token.punct, TAU_PUNCT_PLUS_EQ);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_PUNCT);
   assert_int_equal(token.len, 1);
   assert_memory_equal("=", token.buf, token.len);
   assert_int_equal(token.punct, TAU_PUNCT_EQ);
-  assert_int_equal(token.loc.col, 2);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 2);
+  assert_int_equal(tau_token_loc(&token).row, 0);
+}
+
+static void test_tokenize_punct_all(void **state) {
+  UNUSED(state);
+  const char *buf_name = __func__;
+  struct tau_token token;
+
+  // every punct must be recognized on its own
+  for (enum tau_punct i = TAU_PUNCT_NONE + 1; i < TAU_PUNCT_COUNT; i++) {
+    const char *punct = tau_token_get_punct_name(i);
+    token = tau_token_next(tau_token_start(buf_name, punct, strlen(punct)));
+    assert_int_equal(token.type, TAU_TOKEN_TYPE_PUNCT);
+    assert_int_equal(token.punct, i);
+    assert_int_equal(token.len, strlen(punct));
+  }
+
+  // longest match must not read past the end of the buffer
+  token = tau_token_next(tau_token_start(buf_name, ">>=", 2));
+  assert_int_equal(token.punct, TAU_PUNCT_D_GT);
+  assert_int_equal(token.len, 2);
 }
 
 static void test_tokenize_identifier(void **state) {
@@ -244,29 +281,29 @@ static void test_tokenize_identifier(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
   assert_int_equal(token.len, 1);
   assert_memory_equal("a", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
   assert_int_equal(token.len, 2);
   assert_memory_equal("a1", token.buf, token.len);
-  assert_int_equal(token.loc.col, 2);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 2);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
   assert_int_equal(token.len, 3);
   assert_memory_equal("a_2", token.buf, token.len);
-  assert_int_equal(token.loc.col, 5);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 5);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
   assert_int_equal(token.len, 3);
   assert_memory_equal("a$3", token.buf, token.len);
-  assert_int_equal(token.loc.col, 9);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 9);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_bol_lit(void **state) {
@@ -280,15 +317,15 @@ static void test_tokenize_bol_lit(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_BOL_LIT);
   assert_int_equal(token.len, 4);
   assert_memory_equal("true", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_BOL_LIT);
   assert_int_equal(token.len, 5);
   assert_memory_equal("false", token.buf, token.len);
-  assert_int_equal(token.loc.col, 5);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 5);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_nil_unit_lit(void **state) {
@@ -302,15 +339,15 @@ static void test_tokenize_nil_unit_lit(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_UNI_LIT);
   assert_int_equal(token.len, 4);
   assert_memory_equal("unit", token.buf, token.len);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 
   token = tau_token_next(token);
   assert_int_equal(token.type, TAU_TOKEN_TYPE_NIL_LIT);
   assert_int_equal(token.len, 3);
   assert_memory_equal("nil", token.buf, token.len);
-  assert_int_equal(token.loc.col, 5);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 5);
+  assert_int_equal(tau_token_loc(&token).row, 0);
 }
 
 static void test_tokenize_keyword(void **state) {
@@ -325,8 +362,41 @@ static void test_tokenize_keyword(void **state) {
   assert_int_equal(token.len, 6);
   assert_memory_equal("module", token.buf, token.len);
   assert_int_equal(token.keyword, TAU_KEYWORD_MODULE);
-  assert_int_equal(token.loc.col, 0);
-  assert_int_equal(token.loc.row, 0);
+  assert_int_equal(tau_token_loc(&token).col, 0);
+  assert_int_equal(tau_token_loc(&token).row, 0);
+}
+
+static void test_tokenize_keyword_exact(void **state) {
+  UNUSED(state);
+  const char *buf_data = "letter iffy types as";
+  const char *buf_name = __func__;
+  size_t buf_len = strlen(buf_data);
+  struct tau_token token = tau_token_start(buf_name, buf_data, buf_len);
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
+  assert_int_equal(token.len, 6);
+  assert_int_equal(token.keyword, TAU_KEYWORD_NONE);
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
+  assert_int_equal(token.len, 4);
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_IDENTIFIER);
+  assert_int_equal(token.len, 5);
+
+  token = tau_token_next(token);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_KEYWORD);
+  assert_int_equal(token.keyword, TAU_KEYWORD_AS);
+
+  // every keyword must be recognized on its own
+  for (enum tau_keyword i = TAU_KEYWORD_NONE + 1; i < TAU_KEYWORD_COUNT; i++) {
+    const char *keyword = tau_token_get_keyword_name(i);
+    token = tau_token_next(tau_token_start(buf_name, keyword, strlen(keyword)));
+    assert_int_equal(token.keyword, i);
+    assert_int_equal(token.len, strlen(keyword));
+  }
 }
 
 static void test_bracket_balance(void **state) {
@@ -404,6 +474,313 @@ static void test_non_eol_elision(void **state) {
   assert_int_equal(token.type, TAU_TOKEN_TYPE_EOL);
 }
 
+static void test_token_table(void **state) {
+  UNUSED(state);
+
+  const char *buf_data = "let a = 0x1f;";
+  const char *buf_name = __func__;
+  size_t buf_len = strlen(buf_data);
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, NULL, buf_name, buf_data, buf_len);
+
+  assert_int_equal(table.count, 6);
+  assert_int_equal(table.types[0], TAU_TOKEN_TYPE_KEYWORD);
+  assert_int_equal(table.codes[0], TAU_KEYWORD_LET);
+  assert_int_equal(table.types[1], TAU_TOKEN_TYPE_IDENTIFIER);
+  assert_int_equal(table.offsets[1], 4);
+  assert_int_equal(table.lens[1], 1);
+  assert_int_equal(table.types[2], TAU_TOKEN_TYPE_PUNCT);
+  assert_int_equal(table.codes[2], TAU_PUNCT_EQ);
+  assert_int_equal(table.types[3], TAU_TOKEN_TYPE_INT_LIT);
+  assert_int_equal(table.codes[3], TAU_NUM_BASE_HEX);
+  assert_int_equal(table.offsets[3], 8);
+  assert_int_equal(table.lens[3], 4);
+  assert_int_equal(table.types[4], TAU_TOKEN_TYPE_EOL);
+  assert_int_equal(table.types[5], TAU_TOKEN_TYPE_EOF);
+  assert_int_equal(table.offsets[5], buf_len);
+
+  // lexing errors are collected instead of logged when a diagnostics list is given
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+  buf_data = "a \"b";
+  tau_token_table_lex(&table, &diags, buf_name, buf_data, strlen(buf_data));
+  assert_int_equal(table.count, 3);
+  assert_int_equal(table.types[1], TAU_TOKEN_TYPE_NONE);
+  assert_int_equal(diags.count, 1);
+  assert_int_equal(diags.error_count, 1);
+  assert_int_equal(diags.items[0].loc.col, 2);
+
+  tau_diag_list_free(&diags);
+  tau_token_table_free(&table);
+}
+
+static void test_literal_values(void **state) {
+  UNUSED(state);
+  const char *buf_data = "a = 0x1f + 1.5e+3 * 18446744073709551616 / 0xg\nb = 0b11";
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, &diags, __func__, buf_data, strlen(buf_data));
+
+  // a = 0x1f + 1.5e+3 * 18446744073709551616 / 0xg EOL b = 0b11 EOF
+  union tau_literal literal;
+  assert_int_equal(table.literal_count, 5);
+  assert_true(tau_token_table_literal(&table, 2, &literal));
+  assert_int_equal(literal.int_value, 0x1f);
+  assert_true(tau_token_table_literal(&table, 4, &literal));
+  assert_true(literal.flt_value == 1.5e+3);
+  assert_true(tau_token_table_literal(&table, 6, &literal));
+  assert_int_equal(literal.int_value, UINT64_MAX);
+  assert_true(tau_token_table_literal(&table, 8, &literal));
+  assert_int_equal(literal.int_value, 0);
+  assert_true(tau_token_table_literal(&table, 12, &literal));
+  assert_int_equal(literal.int_value, 3);
+  assert_false(tau_token_table_literal(&table, 0, &literal));
+  assert_false(tau_token_table_literal(&table, 13, &literal));
+
+  assert_int_equal(diags.count, 2);
+  assert_int_equal(diags.items[0].code, TAU_DIAG_NUM_LIT_OUT_OF_RANGE);
+  assert_int_equal(diags.items[0].loc.col, 20);
+  assert_string_equal(diags.items[0].args[0], "18446744073709551616");
+  assert_int_equal(diags.items[1].code, TAU_DIAG_INVALID_NUM_LIT);
+  assert_string_equal(diags.items[1].args[0], "0xg");
+
+  tau_token_table_free(&table);
+
+  // tables without a single literal never allocate the side table
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, NULL, __func__, "a b c", 5);
+  assert_int_equal(table.literal_count, 0);
+  assert_null(table.literals);
+  assert_false(tau_token_table_literal(&table, 1, &literal));
+
+  tau_token_table_free(&table);
+  tau_diag_list_free(&diags);
+}
+
+static void assert_str_literal(const struct tau_token_table *table, token_id_t token, const char *want, size_t len) {
+  union tau_literal literal;
+  assert_true(tau_token_table_literal(table, token, &literal));
+  assert_int_equal(literal.str_value.len, len);
+  assert_memory_equal(table->strings.data + literal.str_value.offset, want, len);
+  assert_int_equal(table->strings.data[literal.str_value.offset + len], '\0');
+}
+
+static void test_str_literal_values(void **state) {
+  UNUSED(state);
+  const char *buf_data =
+      "a = \"tab\\t\" + \"\\x41\\u00e9\\U0001F600\\0\" + \"tab\\t\"\n"
+      "b = \"\\q\\xZ\\uD800\\U00110000\" + \"\" + \"A\\u00e9\\U0001f600\\x00\"";
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, &diags, __func__, buf_data, strlen(buf_data));
+
+  // a = STR + STR + STR EOL b = STR + STR + STR EOF, equal strings share their place in the pool
+  assert_int_equal(table.count, 16);
+  assert_int_equal(table.literal_count, 6);
+  assert_str_literal(&table, 2, "tab\t", 4);
+  assert_str_literal(&table, 4, "A\xc3\xa9\xf0\x9f\x98\x80\0", 8);
+  assert_str_literal(&table, 6, "tab\t", 4);
+  assert_str_literal(&table, 10, "\\q\\xZ\\uD800\\U00110000", 21);
+  assert_str_literal(&table, 12, "", 0);
+  assert_str_literal(&table, 14, "A\xc3\xa9\xf0\x9f\x98\x80\0", 8);
+  assert_int_equal(table.strings.count, 4);
+  assert_int_equal(table.strings.size, 5 + 9 + 22 + 1);
+
+  // invalid escapes are kept as written and reported with the hex digits they have
+  assert_int_equal(diags.count, 4);
+  const char *want_args[] = {"\\q", "\\x", "\\uD800", "\\U00110000"};
+  const size_t want_cols[] = {5, 7, 10, 16};
+  for (size_t i = 0; i < diags.count; i++) {
+    assert_int_equal(diags.items[i].code, TAU_DIAG_INVALID_ESCAPE);
+    assert_int_equal(diags.items[i].loc.row, 1);
+    assert_int_equal(diags.items[i].loc.col, want_cols[i]);
+    assert_string_equal(diags.items[i].args[0], want_args[i]);
+  }
+
+  // tokens pushed from a lexer decoding into the pool of another table keep their strings there
+  struct tau_token_table more;
+  tau_token_table_init(&more);
+  const char *more_data = "\"zz\" \"tab\\t\"";
+  struct tau_token token = tau_token_start(__func__, more_data, strlen(more_data));
+  token.strings = &table.strings;
+  do {
+    token = tau_token_next(token);
+    tau_token_table_push(&more, &token, more_data);
+  } while (token.type != TAU_TOKEN_TYPE_EOF);
+
+  assert_int_equal(more.literal_count, 2);
+  assert_int_equal(more.strings.count, 0);
+  union tau_literal literal;
+  assert_true(tau_token_table_literal(&more, 0, &literal));
+  assert_memory_equal(table.strings.data + literal.str_value.offset, "zz", 3);
+  assert_true(tau_token_table_literal(&more, 1, &literal));
+  assert_memory_equal(table.strings.data + literal.str_value.offset, "tab\t", 5);
+  assert_int_equal(table.strings.count, 5);
+
+  tau_token_table_free(&more);
+  tau_token_table_free(&table);
+  tau_diag_list_free(&diags);
+}
+
+static void test_comments(void **state) {
+  UNUSED(state);
+  const char *buf_data =
+      "// license header\n"
+      "/* spanning\n   lines */\n"
+      "let a = 1 // trailing\n"
+      "\n"
+      "  // alone on its line\n"
+      "let /* inline */ b = (1, // inside parenthesis\n"
+      "  2)\n";
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, NULL, __func__, buf_data, strlen(buf_data));
+
+  // comments on lines of their own neither start the buffer with nor add end of line tokens
+  const uint8_t want[] = {
+      TAU_TOKEN_TYPE_KEYWORD, TAU_TOKEN_TYPE_IDENTIFIER, TAU_TOKEN_TYPE_PUNCT,   TAU_TOKEN_TYPE_INT_LIT,
+      TAU_TOKEN_TYPE_EOL,     TAU_TOKEN_TYPE_KEYWORD,    TAU_TOKEN_TYPE_IDENTIFIER, TAU_TOKEN_TYPE_PUNCT,
+      TAU_TOKEN_TYPE_PUNCT,   TAU_TOKEN_TYPE_INT_LIT,    TAU_TOKEN_TYPE_PUNCT,   TAU_TOKEN_TYPE_INT_LIT,
+      TAU_TOKEN_TYPE_PUNCT,   TAU_TOKEN_TYPE_EOL,        TAU_TOKEN_TYPE_EOF,
+  };
+  assert_int_equal(table.count, sizeof(want));
+  assert_memory_equal(table.types, want, sizeof(want));
+  assert_int_equal(table.offsets[0], strstr(buf_data, "let a") - buf_data);
+  assert_int_equal(table.offsets[5], strstr(buf_data, "let /*") - buf_data);
+  assert_int_equal(table.offsets[6], strstr(buf_data, "b =") - buf_data);
+
+  // a block comment without an end takes the rest of the buffer
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+  buf_data = "a /* b\nc";
+  tau_token_table_lex(&table, &diags, __func__, buf_data, strlen(buf_data));
+  assert_int_equal(table.count, 2);
+  assert_int_equal(table.types[1], TAU_TOKEN_TYPE_EOF);
+  assert_int_equal(diags.count, 1);
+  assert_int_equal(diags.items[0].code, TAU_DIAG_UNCLOSED_COMMENT);
+  assert_int_equal(diags.items[0].loc.col, 2);
+  assert_int_equal(diags.items[0].len, 6);
+
+  tau_diag_list_free(&diags);
+  tau_token_table_free(&table);
+}
+
+static void test_doc_comments(void **state) {
+  UNUSED(state);
+  const char *buf_data =
+      "/// module doc\n"
+      "module m\n"
+      "//// ruler\n"
+      "/** first */\n"
+      "/// second\n"
+      "let a = 1 /// trailing, not a doc\n"
+      "/**/\n"
+      "let b = 2\n";
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, NULL, __func__, buf_data, strlen(buf_data));
+  assert_null(table.doc_lens);
+  uint32_t plain_count = table.count;
+  tau_token_table_free(&table);
+
+  // the same tokens, with doc comments attached to the token on the line after them
+  tau_token_table_init(&table);
+  table.keep_docs = true;
+  tau_token_table_lex(&table, NULL, __func__, buf_data, strlen(buf_data));
+  assert_int_equal(table.count, plain_count);
+  assert_int_equal(table.codes[0], TAU_KEYWORD_MODULE);
+  assert_int_equal(table.doc_lens[0], strlen("/// module doc"));
+  assert_int_equal(table.doc_offsets[0], 0);
+  assert_int_equal(table.doc_lens[1], 0);
+
+  const char *first = strstr(buf_data, "/** first");
+  assert_int_equal(table.types[3], TAU_TOKEN_TYPE_KEYWORD);
+  assert_int_equal(table.doc_offsets[3], first - buf_data);
+  assert_int_equal(table.doc_lens[3], strstr(buf_data, "\nlet a") - first);
+  for (uint32_t i = 4; i < table.count; i++) {
+    assert_int_equal(table.doc_lens[i], 0);
+  }
+
+  tau_token_table_free(&table);
+}
+
+static void test_error_loc(void **state) {
+  UNUSED(state);
+  const char *buf_data = "a\n\"\xc3\xa9\" \"b";
+  const char *buf_name = __func__;
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+
+  // tokens only carry offsets, the row and column of an error are worked out once it is reported
+  tau_token_table_lex(&table, &diags, buf_name, buf_data, strlen(buf_data));
+  assert_int_equal(diags.count, 1);
+  assert_string_equal(diags.items[0].loc.buf_name, buf_name);
+  assert_int_equal(diags.items[0].loc.row, 1);
+  assert_int_equal(diags.items[0].loc.col, 4);
+
+  struct tau_token token = tau_token_start(buf_name, buf_data, strlen(buf_data));
+  for (size_t i = 0; i < 4; i++) {
+    token = tau_token_next(token);
+  }
+
+  assert_int_equal(token.buf - buf_data, 7);
+  assert_int_equal(tau_token_loc(&token).row, 1);
+  assert_int_equal(tau_token_loc(&token).col, 4);
+
+  tau_diag_list_free(&diags);
+  tau_token_table_free(&table);
+}
+
+static void test_invalid_utf8(void **state) {
+  UNUSED(state);
+  const char *buf_data = "a \xC0\xAF \xE2\x82\xAC b";
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  struct tau_diag_list diags;
+  tau_diag_list_init(&diags);
+
+  // each malformed byte is reported on its own, a well formed but unknown character as a whole
+  tau_token_table_lex(&table, &diags, __func__, buf_data, strlen(buf_data));
+  assert_int_equal(diags.count, 3);
+  assert_int_equal(diags.items[0].code, TAU_DIAG_INVALID_UTF8);
+  assert_string_equal(diags.items[0].args[0], "0xC0");
+  assert_int_equal(diags.items[0].len, 1);
+  assert_int_equal(diags.items[1].code, TAU_DIAG_INVALID_UTF8);
+  assert_string_equal(diags.items[1].args[0], "0xAF");
+  assert_int_equal(diags.items[1].loc.col, 3);
+  assert_int_equal(diags.items[2].code, TAU_DIAG_UNKNOWN_CHARACTER);
+  assert_string_equal(diags.items[2].args[1], "U+20AC");
+  assert_int_equal(diags.items[2].len, 3);
+
+  // string bodies and comments are validated too, well formed sequences in them are fine
+  tau_diag_list_free(&diags);
+  tau_diag_list_init(&diags);
+  buf_data = "let s = \"\xff\xc3\xa9\xC0\xAF\" // \xff \xe2\x82\xac\n/* \xED\xA0\x80 */ \"unclosed \xfe\n";
+  tau_token_table_lex(&table, &diags, __func__, buf_data, strlen(buf_data));
+  const char *want_args[] = {"0xFF", "0xC0", "0xAF", "0xFF", "0xED", "0xA0", "0x80", "0xFE"};
+  const size_t want_rows[] = {0, 0, 0, 0, 1, 1, 1, 1};
+  const size_t want_cols[] = {9, 11, 12, 17, 3, 4, 4, 18};
+  assert_int_equal(diags.count, 9);
+  for (size_t i = 0; i < 8; i++) {
+    assert_int_equal(diags.items[i].code, TAU_DIAG_INVALID_UTF8);
+    assert_string_equal(diags.items[i].args[0], want_args[i]);
+    assert_int_equal(diags.items[i].loc.row, want_rows[i]);
+    assert_int_equal(diags.items[i].loc.col, want_cols[i]);
+  }
+
+  assert_int_equal(diags.items[8].code, TAU_DIAG_UNCLOSED_STRING);
+
+  tau_diag_list_free(&diags);
+  tau_token_table_free(&table);
+}
+
 int main() {
   UNUSED_TYPE(jmp_buf);
   UNUSED_TYPE(va_list);
@@ -423,12 +800,21 @@ int main() {
       cmocka_unit_test(test_tokenize_punct_single),      // a single punct symbol
       cmocka_unit_test(test_tokenize_punct_multiple),    // multiple punct symbols
       cmocka_unit_test(test_tokenize_punct_lumped),      // multiple punct symbols lumped together
+      cmocka_unit_test(test_tokenize_punct_all),         // every punct symbol, longest match first
       cmocka_unit_test(test_tokenize_identifier),        // identifier
       cmocka_unit_test(test_tokenize_bol_lit),           // boolean literal
       cmocka_unit_test(test_tokenize_nil_unit_lit),      // "unit" or "nil" literal
       cmocka_unit_test(test_tokenize_keyword),           // "module" keyword
+      cmocka_unit_test(test_tokenize_keyword_exact),     // keywords match whole words only
       cmocka_unit_test(test_bracket_balance),            // bracket balance count
       cmocka_unit_test(test_non_eol_elision),            // don't emit EOL if brackets are unbalanced
+      cmocka_unit_test(test_token_table),                // whole buffer lexed into a token table
+      cmocka_unit_test(test_literal_values),             // numeric literals are decoded as they are lexed
+      cmocka_unit_test(test_str_literal_values),         // string literals are decoded into a shared pool
+      cmocka_unit_test(test_comments),                   // comments are skipped like spaces
+      cmocka_unit_test(test_doc_comments),               // doc comments can be kept for the token after them
+      cmocka_unit_test(test_error_loc),                  // error rows and columns come from byte offsets
+      cmocka_unit_test(test_invalid_utf8),               // malformed bytes are reported wherever they are
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
@@ -0,0 +1,113 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include "../src/line_index.h"
+
+#include <string.h>
+
+#include "../src/ast.h"
+#include "../src/common.h"
+
+static void test_line_index_loc(void **state) {
+  UNUSED(state);
+  const char *test = "ab\ncd\n\nefg";
+  size_t test_len = strlen(test);
+  struct tau_line_index index;
+  tau_line_index_init(&index);
+  assert_int_equal(index.count, 0);
+
+  struct tau_loc loc = tau_line_index_loc(&index, __func__, test, test_len, 0);
+  assert_int_equal(index.count, 4);
+  assert_int_equal(loc.row, 0);
+  assert_int_equal(loc.col, 0);
+
+  loc = tau_line_index_loc(&index, __func__, test, test_len, 2);
+  assert_int_equal(loc.row, 0);
+  assert_int_equal(loc.col, 2);
+
+  loc = tau_line_index_loc(&index, __func__, test, test_len, 4);
+  assert_int_equal(loc.row, 1);
+  assert_int_equal(loc.col, 1);
+
+  loc = tau_line_index_loc(&index, __func__, test, test_len, 6);
+  assert_int_equal(loc.row, 2);
+  assert_int_equal(loc.col, 0);
+
+  loc = tau_line_index_loc(&index, __func__, test, test_len, test_len);
+  assert_int_equal(loc.row, 3);
+  assert_int_equal(loc.col, 3);
+  assert_string_equal(loc.buf_name, __func__);
+
+  tau_line_index_free(&index);
+}
+
+static void test_line_index_code_point_col(void **state) {
+  UNUSED(state);
+  const char *test = "\xc3\xa9t\xc3\xa9\n\xce\xbb \xe2\x82\xac x";
+  size_t test_len = strlen(test);
+  struct tau_line_index index;
+  tau_line_index_init(&index);
+
+  // columns count code points, so multi byte characters before the offset only move it by one
+  struct tau_loc loc = tau_line_index_loc(&index, __func__, test, test_len, 5);
+  assert_int_equal(loc.row, 0);
+  assert_int_equal(loc.col, 3);
+
+  loc = tau_line_index_loc(&index, __func__, test, test_len, test_len - 1);
+  assert_int_equal(loc.row, 1);
+  assert_int_equal(loc.col, 4);
+
+  // the scan without an index agrees with it
+  for (size_t offset = 0; offset <= test_len; offset++) {
+    struct tau_loc indexed = tau_line_index_loc(&index, __func__, test, test_len, offset);
+    struct tau_loc scanned = tau_line_index_scan_loc(__func__, test, offset);
+    assert_int_equal(indexed.row, scanned.row);
+    assert_int_equal(indexed.col, scanned.col);
+  }
+
+  tau_line_index_free(&index);
+}
+
+static void test_ast_node_loc(void **state) {
+  UNUSED(state);
+  const char *test = "let\n  x";
+  struct tau_ast ast;
+  ast_init(&ast, __func__, test, strlen(test));
+  assert_int_equal(ast_size(&ast), 0);
+
+  node_id_t node = ast_node_new(&ast, TAU_NODE_ATOM, NODE_NULL, NODE_NULL);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_int_equal(ast_size(&ast), 1);
+  ast_node(&ast, node)->offset = 6;
+  ast_node(&ast, node)->len = 1;
+
+  size_t len = 0;
+  const char *text = ast_node_text(&ast, node, &len);
+  assert_int_equal(len, 1);
+  assert_int_equal(text[0], 'x');
+
+  struct tau_loc loc = ast_node_loc(&ast, node);
+  assert_int_equal(loc.row, 1);
+  assert_int_equal(loc.col, 2);
+  ast_free(&ast);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_line_index_loc),
+      cmocka_unit_test(test_line_index_code_point_col),
+      cmocka_unit_test(test_ast_node_loc),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,158 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/num_lit.h"
+
+static uint64_t decode_int(const char *text, enum tau_num_base base, enum tau_num_lit_status status) {
+  uint64_t value = 0;
+  assert_int_equal(tau_num_lit_decode_int(text, strlen(text), base, &value), status);
+  return value;
+}
+
+// Bit for bit, so the sign of zero and the last bit of the mantissa count
+static void assert_float_decodes(const char *text, double want, enum tau_num_lit_status status) {
+  double got = 0;
+  assert_int_equal(tau_num_lit_decode_float(text, strlen(text), &got), status);
+  uint64_t got_bits;
+  uint64_t want_bits;
+  memcpy(&got_bits, &got, sizeof(got));
+  memcpy(&want_bits, &want, sizeof(want));
+  assert_int_equal(got_bits, want_bits);
+}
+
+static void test_decode_int(void **state) {
+  UNUSED(state);
+  assert_int_equal(decode_int("0", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OK), 0);
+  assert_int_equal(decode_int("123", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OK), 123);
+  assert_int_equal(decode_int("12345678", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OK), 12345678);
+  assert_int_equal(decode_int("000000000000000000000042", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OK), 42);
+  assert_int_equal(decode_int("18446744073709551615", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OK), UINT64_MAX);
+  assert_int_equal(decode_int("18446744073709551616", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OUT_OF_RANGE), UINT64_MAX);
+  assert_int_equal(decode_int("99999999999999999999999", TAU_NUM_BASE_DEC, TAU_NUM_LIT_OUT_OF_RANGE), UINT64_MAX);
+
+  assert_int_equal(decode_int("0b1010", TAU_NUM_BASE_BIN, TAU_NUM_LIT_OK), 10);
+  assert_int_equal(decode_int("0b1111111100000000", TAU_NUM_BASE_BIN, TAU_NUM_LIT_OK), 0xFF00);
+  assert_int_equal(decode_int("0o7070", TAU_NUM_BASE_OCT, TAU_NUM_LIT_OK), 07070);
+  assert_int_equal(decode_int("0o1777777777777777777777", TAU_NUM_BASE_OCT, TAU_NUM_LIT_OK), UINT64_MAX);
+  assert_int_equal(decode_int("0o2000000000000000000000", TAU_NUM_BASE_OCT, TAU_NUM_LIT_OUT_OF_RANGE), UINT64_MAX);
+  assert_int_equal(decode_int("0xFAFA", TAU_NUM_BASE_HEX, TAU_NUM_LIT_OK), 0xFAFA);
+  assert_int_equal(decode_int("0xdeadBEEF01234567", TAU_NUM_BASE_HEX, TAU_NUM_LIT_OK), 0xDEADBEEF01234567);
+  assert_int_equal(decode_int("0x0000000000000000FFFFFFFFFFFFFFFF", TAU_NUM_BASE_HEX, TAU_NUM_LIT_OK), UINT64_MAX);
+  assert_int_equal(decode_int("0x10000000000000000", TAU_NUM_BASE_HEX, TAU_NUM_LIT_OUT_OF_RANGE), UINT64_MAX);
+
+  // the lexer takes the byte after a base prefix whatever it is
+  assert_int_equal(decode_int("0xg", TAU_NUM_BASE_HEX, TAU_NUM_LIT_INVALID), 0);
+  assert_int_equal(decode_int("0b2", TAU_NUM_BASE_BIN, TAU_NUM_LIT_INVALID), 0);
+  assert_int_equal(decode_int("0o8", TAU_NUM_BASE_OCT, TAU_NUM_LIT_INVALID), 0);
+}
+
+static void test_decode_int_bases(void **state) {
+  UNUSED(state);
+  // every length and every digit in every base, SWAR blocks and scalar tails alike
+  static const char digits[] = "0123456789abcdef";
+  const char *prefixes[] = {[TAU_NUM_BASE_DEC] = "", [TAU_NUM_BASE_BIN] = "0b", [TAU_NUM_BASE_OCT] = "0o",
+                            [TAU_NUM_BASE_HEX] = "0x"};
+  const uint64_t radixes[] = {[TAU_NUM_BASE_DEC] = 10, [TAU_NUM_BASE_BIN] = 2, [TAU_NUM_BASE_OCT] = 8,
+                              [TAU_NUM_BASE_HEX] = 16};
+  srand(11);
+  for (int base = TAU_NUM_BASE_DEC; base <= TAU_NUM_BASE_HEX; base++) {
+    for (int round = 0; round < 1000; round++) {
+      uint64_t want = ((uint64_t)rand() << 40 ^ (uint64_t)rand() << 20 ^ (uint64_t)rand()) >> (rand() % 64);
+      char text[80];
+      char reversed[70];
+      size_t len = 0;
+      for (uint64_t rest = want; len == 0 || rest > 0; rest /= radixes[base]) {
+        reversed[len++] = digits[rest % radixes[base]];
+      }
+
+      size_t prefix_len = strlen(prefixes[base]);
+      memcpy(text, prefixes[base], prefix_len);
+      for (size_t i = 0; i < len; i++) {
+        text[prefix_len + i] = reversed[len - 1 - i];
+      }
+
+      text[prefix_len + len] = '\0';
+      assert_int_equal(decode_int(text, base, TAU_NUM_LIT_OK), want);
+    }
+  }
+}
+
+static void test_decode_float(void **state) {
+  UNUSED(state);
+  assert_float_decodes("0.0", 0.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("0.12", 0.12, TAU_NUM_LIT_OK);
+  assert_float_decodes("0.12e+10", 0.12e+10, TAU_NUM_LIT_OK);
+  assert_float_decodes("1.", 1.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("1.e-3", 1e-3, TAU_NUM_LIT_OK);
+  assert_float_decodes("000123.4500", 123.45, TAU_NUM_LIT_OK);
+  assert_float_decodes("3.141592653589793238462643383279", 3.141592653589793, TAU_NUM_LIT_OK);
+
+  // the largest and smallest doubles, subnormals and the limits where they round to infinity and zero
+  assert_float_decodes("1.7976931348623157e+308", 1.7976931348623157e+308, TAU_NUM_LIT_OK);
+  assert_float_decodes("1.7976931348623158e+308", 1.7976931348623157e+308, TAU_NUM_LIT_OK);
+  assert_float_decodes("1.7976931348623159e+308", HUGE_VAL, TAU_NUM_LIT_OUT_OF_RANGE);
+  assert_float_decodes("1.0e+400", HUGE_VAL, TAU_NUM_LIT_OUT_OF_RANGE);
+  assert_float_decodes("2.2250738585072014e-308", 2.2250738585072014e-308, TAU_NUM_LIT_OK);
+  assert_float_decodes("2.2250738585072011e-308", 2.2250738585072011e-308, TAU_NUM_LIT_OK);
+  assert_float_decodes("4.9406564584124654e-324", 4.9406564584124654e-324, TAU_NUM_LIT_OK);
+  assert_float_decodes("2.4703282292062328e-324", 4.9406564584124654e-324, TAU_NUM_LIT_OK);
+  assert_float_decodes("2.4703282292062327e-324", 0.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("1.0e-99999", 0.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("0.0e+99999", 0.0, TAU_NUM_LIT_OK);
+
+  // ties round to even, which takes every digit of a long literal into account
+  assert_float_decodes("9007199254740993.0", 9007199254740992.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("9007199254740993.00000000000000000000001", 9007199254740994.0, TAU_NUM_LIT_OK);
+  assert_float_decodes("9007199254740995.0", 9007199254740996.0, TAU_NUM_LIT_OK);
+
+  assert_float_decodes("1.0e+", 0.0, TAU_NUM_LIT_INVALID);
+}
+
+static void test_decode_float_round_trip(void **state) {
+  UNUSED(state);
+  // every double printed with enough digits reads back as itself, and shorter ones match strtod
+  srand(7);
+  for (int round = 0; round < 100000; round++) {
+    // literals have no sign
+    uint64_t bits = ((uint64_t)rand() << 62 ^ (uint64_t)rand() << 31 ^ (uint64_t)rand()) & ~(1ull << 63);
+    double want;
+    memcpy(&want, &bits, sizeof(want));
+    if (!isfinite(want)) {
+      continue;
+    }
+
+    // %e leaves the point out when no digit follows it, and float literals need one
+    char text[64];
+    snprintf(text, sizeof(text), "%.*e", 1 + rand() % 17, want);
+
+    // rounding to fewer digits can take the largest doubles past the limit
+    double rounded = strtod(text, NULL);
+    assert_float_decodes(text, rounded, isinf(rounded) ? TAU_NUM_LIT_OUT_OF_RANGE : TAU_NUM_LIT_OK);
+  }
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_decode_int),               // every base, leading zeros and the 64-bit limit
+      cmocka_unit_test(test_decode_int_bases),         // random values in every base and length
+      cmocka_unit_test(test_decode_float),             // limits, subnormals and ties
+      cmocka_unit_test(test_decode_float_round_trip),  // random doubles read back the same as strtod
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
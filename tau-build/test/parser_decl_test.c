@@ -15,21 +15,20 @@ static void test_parse_let_decl(void **state) {
   const char *test =
       "let a: A prototype;"
       "let b: B = 0;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_let_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_let_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_let_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LET_DECL (LET_DECONSTRUCTION b (TYPE_BIND B)) (DATA_BIND 0))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_let_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LET_DECL (LET_DECONSTRUCTION b (TYPE_BIND B)) (DATA_BIND 0))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_proc_decl(void **state) {
@@ -41,12 +40,12 @@ static void test_parse_proc_decl(void **state) {
       "proc c(): C {};"
       "proc d(arg: Arg): D prototype;"
       "proc e(x: X, y: Y): E prototype;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_proc_decl(&token);
-  assert_non_null(node);
+  node = parse_proc_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(PROC_DECL "
       " (PROC_DECONSTRUCTION a "
@@ -57,12 +56,11 @@ static void test_parse_proc_decl(void **state) {
       " ) "
       " (PROTOTYPE_SUFFIX)"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_proc_decl(&token);
-  assert_non_null(node);
+  node = parse_proc_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(PROC_DECL "
       " (PROC_DECONSTRUCTION b "
@@ -73,12 +71,11 @@ static void test_parse_proc_decl(void **state) {
       " ) "
       " (DATA_BIND 1)"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_proc_decl(&token);
-  assert_non_null(node);
+  node = parse_proc_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(PROC_DECL "
       " (PROC_DECONSTRUCTION c "
@@ -89,12 +86,11 @@ static void test_parse_proc_decl(void **state) {
       " ) "
       " (BLOCK)"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_proc_decl(&token);
-  assert_non_null(node);
+  node = parse_proc_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(PROC_DECL "
       " (PROC_DECONSTRUCTION d "
@@ -109,12 +105,11 @@ static void test_parse_proc_decl(void **state) {
       " ) "
       " (PROTOTYPE_SUFFIX)"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_proc_decl(&token);
-  assert_non_null(node);
+  node = parse_proc_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(PROC_DECL "
       " (PROC_DECONSTRUCTION e "
@@ -132,9 +127,9 @@ static void test_parse_proc_decl(void **state) {
       " ) "
       " (PROTOTYPE_SUFFIX)"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_type_decl(void **state) {
@@ -142,21 +137,20 @@ static void test_parse_type_decl(void **state) {
   const char *test =
       "type A prototype;"
       "type B = b;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_type_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(TYPE_DECL (TYPE_DECONSTRUCTION A) (PROTOTYPE_SUFFIX))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_type_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(TYPE_DECL (TYPE_DECONSTRUCTION A) (PROTOTYPE_SUFFIX))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_type_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(TYPE_DECL (TYPE_DECONSTRUCTION B) (DATA_BIND b))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_type_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(TYPE_DECL (TYPE_DECONSTRUCTION B) (DATA_BIND b))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_extern_decl(void **state) {
@@ -165,18 +159,18 @@ static void test_parse_extern_decl(void **state) {
       "extern let a: A prototype;"
       "extern proc b(): B prototype;"
       "extern type C prototype;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_extern_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(EXTERN_DECL (LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX)))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_extern_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node,
+                       "(EXTERN_DECL (LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_extern_decl(&token);
-  assert_non_null(node);
+  node = parse_extern_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   const char *topology =
       "(EXTERN_DECL "
       " (PROC_DECL "
@@ -189,15 +183,14 @@ static void test_parse_extern_decl(void **state) {
       "  (PROTOTYPE_SUFFIX)"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_extern_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(EXTERN_DECL (TYPE_DECL (TYPE_DECONSTRUCTION C) (PROTOTYPE_SUFFIX)))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_extern_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(EXTERN_DECL (TYPE_DECL (TYPE_DECONSTRUCTION C) (PROTOTYPE_SUFFIX)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_decl(void **state) {
@@ -207,18 +200,17 @@ static void test_parse_decl(void **state) {
       "proc b(): B prototype;"
       "type C prototype;"
       "extern type D prototype;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(DECL (LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX)))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(DECL (LET_DECL (LET_DECONSTRUCTION a (TYPE_BIND A)) (PROTOTYPE_SUFFIX)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_decl(&token);
-  assert_non_null(node);
+  node = parse_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   const char *topology =
       "(DECL"
       " (PROC_DECL "
@@ -231,21 +223,20 @@ static void test_parse_decl(void **state) {
       "  (PROTOTYPE_SUFFIX)"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(DECL (TYPE_DECL (TYPE_DECONSTRUCTION C) (PROTOTYPE_SUFFIX)))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(DECL (TYPE_DECL (TYPE_DECONSTRUCTION C) (PROTOTYPE_SUFFIX)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_decl(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(DECL (EXTERN_DECL (TYPE_DECL (TYPE_DECONSTRUCTION D) (PROTOTYPE_SUFFIX))))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  node = parse_decl(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node,
+                       "(DECL (EXTERN_DECL (TYPE_DECL (TYPE_DECONSTRUCTION D) (PROTOTYPE_SUFFIX))))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_decls(void **state) {
@@ -256,12 +247,12 @@ static void test_parse_decls(void **state) {
       "type A prototype;"
       "type B prototype;"
       "type C prototype;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_decls(&token);
-  assert_non_null(node);
+  node = parse_decls(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   const char *topology =
       "(DECLS"
       " (DECL (TYPE_DECL (TYPE_DECONSTRUCTION A) (PROTOTYPE_SUFFIX))"
@@ -270,8 +261,50 @@ static void test_parse_decls(void **state) {
       "   )"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
+  assert_node_topology(&parser.ast, node, topology);
+  parser_free(&parser);
+}
+
+static void test_parse_decls_recovery(void **state) {
+  UNUSED(state);
+  const char *test =
+      "type A prototype;"
+      "type ) prototype; ) ) ;"
+      "type B prototype prototype;"
+      "proc ) = 1; type C prototype;";
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  // every error is reported once and skipped up to the next declaration keyword
+  node = parse_decls(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  const char *topology =
+      "(DECLS"
+      " (DECL (TYPE_DECL (TYPE_DECONSTRUCTION A) (PROTOTYPE_SUFFIX))"
+      "   (DECL (ERROR)"
+      "     (DECL (TYPE_DECL (TYPE_DECONSTRUCTION B) (PROTOTYPE_SUFFIX))"
+      "       (DECL (ERROR)"
+      "         (DECL (ERROR)"
+      "           (DECL (TYPE_DECL (TYPE_DECONSTRUCTION C) (PROTOTYPE_SUFFIX)))"
+      "         )"
+      "       )"
+      "     )"
+      "   )"
+      " )"
+      ")";
+  assert_node_topology(&parser.ast, node, topology);
+  assert_int_equal(parser.diags.count, 3);
+  assert_true(match(&parser, TAU_TOKEN_TYPE_EOF, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  // an error spans the tokens it skipped
+  node_id_t error = ast_node_left(&parser.ast, ast_node_right(&parser.ast, ast_node_left(&parser.ast, node)));
+  size_t error_len = 0;
+  const char *error_text = ast_node_text(&parser.ast, error, &error_len);
+  assert_int_equal(ast_node_type(&parser.ast, error), TAU_NODE_ERROR);
+  assert_int_equal(error_len, strlen("type ) prototype; ) ) ;"));
+  assert_memory_equal(error_text, "type ) prototype; ) ) ;", error_len);
+  parser_free(&parser);
 }
 
 int main() {
@@ -279,12 +312,13 @@ int main() {
   UNUSED_TYPE(va_list);
 
   const struct CMUnitTest tests[] = {
-      cmocka_unit_test(test_parse_let_decl),     // all let variations
-      cmocka_unit_test(test_parse_proc_decl),    // all proc variations
-      cmocka_unit_test(test_parse_type_decl),    // all type variations
-      cmocka_unit_test(test_parse_extern_decl),  // all extern variations
-      cmocka_unit_test(test_parse_decl),         // any decl
-      cmocka_unit_test(test_parse_decls),        // decls
+      cmocka_unit_test(test_parse_let_decl),        // all let variations
+      cmocka_unit_test(test_parse_proc_decl),       // all proc variations
+      cmocka_unit_test(test_parse_type_decl),       // all type variations
+      cmocka_unit_test(test_parse_extern_decl),     // all extern variations
+      cmocka_unit_test(test_parse_decl),            // any decl
+      cmocka_unit_test(test_parse_decls),           // decls
+      cmocka_unit_test(test_parse_decls_recovery),  // broken decls leave errors in the list
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
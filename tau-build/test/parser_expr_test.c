@@ -11,105 +11,97 @@
 static void test_parse_atom(void **state) {
   UNUSED(state);
   const char *test = "120 id 0.1 +";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_atom(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "120");
-  node_free(node);
-
-  node = parse_atom(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "id");
-  node_free(node);
-
-  node = parse_atom(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "0.1");
-  node_free(node);
-
-  node = parse_atom(&token);
-  assert_null(node);
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_atom(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "120");
+
+  node = parse_atom(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "id");
+
+  node = parse_atom(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "0.1");
+
+  node = parse_atom(&parser);
+  assert_int_equal(node, NODE_NULL);
+  parser_free(&parser);
 }
 
 static void test_parse_primary_expr(void **state) {
   UNUSED(state);
   const char *test = "123; (123); ((123));";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_primary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "123");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_primary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "123");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_primary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "123");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_primary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "123");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_primary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "123");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_primary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "123");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_static_lookup_expr(void **state) {
   UNUSED(state);
   const char *test = "a::b; a::b::c; a::b.0;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(STATIC_LOOKUP_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(STATIC_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(VALUE_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) 0)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(STATIC_LOOKUP_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(STATIC_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(VALUE_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) 0)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_value_lookup_expr(void **state) {
   UNUSED(state);
   const char *test = "a.b; a.b.c; a.b.0;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(VALUE_LOOKUP_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(VALUE_LOOKUP_EXPR (VALUE_LOOKUP_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_value_lookup_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(VALUE_LOOKUP_EXPR (VALUE_LOOKUP_EXPR a b) 0)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(VALUE_LOOKUP_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(VALUE_LOOKUP_EXPR (VALUE_LOOKUP_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_value_lookup_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(VALUE_LOOKUP_EXPR (VALUE_LOOKUP_EXPR a b) 0)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_subscription_expr(void **state) {
@@ -125,421 +117,402 @@ static void test_parse_subscription_expr(void **state) {
       "h[1][2];"
       "i[1](2);"
       "j(1)[2];";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
   const char *topology = NULL;
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR a (CALLING_ARGS))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR b (CALLING_ARGS (CALLING_ARG 1)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR c (CALLING_ARGS (CALLING_ARG 1 (CALLING_ARG 2))))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR (SUBSCRIPTION_EXPR d (CALLING_ARGS (CALLING_ARG 1))) (CALLING_ARGS (CALLING_ARG 2)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR e (INDEXING_ARGS))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR f (INDEXING_ARGS (INDEXING_ARG 1)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology = "(SUBSCRIPTION_EXPR g (INDEXING_ARGS (INDEXING_ARG 1 (INDEXING_ARG 2))))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(SUBSCRIPTION_EXPR (SUBSCRIPTION_EXPR h (INDEXING_ARGS (INDEXING_ARG 1))) (INDEXING_ARGS (INDEXING_ARG 2)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(SUBSCRIPTION_EXPR (SUBSCRIPTION_EXPR i (INDEXING_ARGS (INDEXING_ARG 1))) (CALLING_ARGS (CALLING_ARG 2)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_subscription_expr(&token);
-  assert_non_null(node);
+  node = parse_subscription_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       "(SUBSCRIPTION_EXPR (SUBSCRIPTION_EXPR j (CALLING_ARGS (CALLING_ARG 1))) (INDEXING_ARGS (INDEXING_ARG 2)))";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_unary_expr(void **state) {
   UNUSED(state);
   const char *test = "-1; +a; !~1;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_unary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_NEG_EXPR 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_unary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_POS_EXPR a)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_unary_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_LOG_NOT_EXPR (U_BIT_NOT_EXPR 1))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_unary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_NEG_EXPR 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_unary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_POS_EXPR a)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_unary_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_LOG_NOT_EXPR (U_BIT_NOT_EXPR 1))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_proof_expr(void **state) {
   UNUSED(state);
   const char *test = "a:b; a:b:c; a:b::c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_proof_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(PROOF_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_proof_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(PROOF_EXPR (PROOF_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_proof_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(PROOF_EXPR a (STATIC_LOOKUP_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_proof_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(PROOF_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_proof_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(PROOF_EXPR (PROOF_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_proof_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(PROOF_EXPR a (STATIC_LOOKUP_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_ref_expr(void **state) {
   UNUSED(state);
   const char *test = "&a; &a::b; &a::b.c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_ref_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_REF_EXPR a)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_ref_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_REF_EXPR (STATIC_LOOKUP_EXPR a b))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_ref_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(U_REF_EXPR (VALUE_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_ref_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_REF_EXPR a)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_ref_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_REF_EXPR (STATIC_LOOKUP_EXPR a b))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_ref_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(U_REF_EXPR (VALUE_LOOKUP_EXPR (STATIC_LOOKUP_EXPR a b) c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_fact_expr(void **state) {
   UNUSED(state);
-  const char *test = "a*b; a*b/c; -a%b;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_fact_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(MUL_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_fact_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(DIV_EXPR (MUL_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_fact_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(REM_EXPR (U_NEG_EXPR a) b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  const char *test = "a*b; a*b/c; -a%b; b*&a; b/&a; a+b*&a;";
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_fact_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(MUL_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_fact_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(DIV_EXPR (MUL_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_fact_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(REM_EXPR (U_NEG_EXPR a) b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  // right operands take references too
+  node = parse_fact_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(MUL_EXPR b (U_REF_EXPR a))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_fact_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(DIV_EXPR b (U_REF_EXPR a))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ADD_EXPR a (MUL_EXPR b (U_REF_EXPR a)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_term_expr(void **state) {
   UNUSED(state);
   const char *test = "a+b; a+b-c; -a-b;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_term_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ADD_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_term_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(SUB_EXPR (ADD_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_term_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(SUB_EXPR (U_NEG_EXPR a) b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_term_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ADD_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_term_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(SUB_EXPR (ADD_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_term_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(SUB_EXPR (U_NEG_EXPR a) b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_bit_shift_expr(void **state) {
   UNUSED(state);
   const char *test = "a>>b; a<<b>>c; a>>b*c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_bit_shift_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RSH_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_shift_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RSH_EXPR (LSH_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_shift_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RSH_EXPR a (MUL_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_bit_shift_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RSH_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_shift_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RSH_EXPR (LSH_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_shift_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RSH_EXPR a (MUL_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_bit_and_expr(void **state) {
   UNUSED(state);
   const char *test = "a&b; a&b&c; a&b>>c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_bit_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_AND_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_AND_EXPR (BIT_AND_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_AND_EXPR a (RSH_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_bit_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_AND_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_AND_EXPR (BIT_AND_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_AND_EXPR a (RSH_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_bit_or_expr(void **state) {
   UNUSED(state);
   const char *test = "a|b; a|b^c; a|b&c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_bit_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_OR_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_XOR_EXPR (BIT_OR_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_bit_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BIT_OR_EXPR a (BIT_AND_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_bit_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_OR_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_XOR_EXPR (BIT_OR_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_bit_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BIT_OR_EXPR a (BIT_AND_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_cmp_expr(void **state) {
   UNUSED(state);
   const char *test = "a>b; a>=b<=c; a<b|c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_cmp_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(GT_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_cmp_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LE_EXPR (GE_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_cmp_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LT_EXPR a (BIT_OR_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_cmp_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(GT_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_cmp_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LE_EXPR (GE_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_cmp_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LT_EXPR a (BIT_OR_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_rel_expr(void **state) {
   UNUSED(state);
   const char *test = "a==b; a==b!=c; a==b>c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_rel_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(EQ_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_rel_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(NE_EXPR (EQ_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_rel_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(EQ_EXPR a (GT_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_rel_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(EQ_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_rel_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(NE_EXPR (EQ_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_rel_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(EQ_EXPR a (GT_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_log_and_expr(void **state) {
   UNUSED(state);
   const char *test = "a&&b; a&&b&&c; a&&b==c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_log_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_AND_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_log_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_AND_EXPR (LOG_AND_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_log_and_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_AND_EXPR a (EQ_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_log_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_AND_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_log_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_AND_EXPR (LOG_AND_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_log_and_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_AND_EXPR a (EQ_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_log_or_expr(void **state) {
   UNUSED(state);
   const char *test = "a||b; a||b||c; a||b&&c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_log_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_OR_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_log_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_OR_EXPR (LOG_OR_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_log_or_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(LOG_OR_EXPR a (LOG_AND_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_log_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_OR_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_log_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_OR_EXPR (LOG_OR_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_log_or_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(LOG_OR_EXPR a (LOG_AND_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_cast_expr(void **state) {
   UNUSED(state);
   const char *test = "a as b; a as b as c; a as b || c;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_cast_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(CAST_EXPR a b)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_cast_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(CAST_EXPR (CAST_EXPR a b) c)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_cast_expr(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(CAST_EXPR a (LOG_OR_EXPR b c))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_cast_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(CAST_EXPR a b)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_cast_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(CAST_EXPR (CAST_EXPR a b) c)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_cast_expr(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(CAST_EXPR a (LOG_OR_EXPR b c))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 int main() {
@@ -11,47 +11,44 @@
 static void test_parse_return_stmt(void **state) {
   UNUSED(state);
   const char *test = "return; return 0; return a + b;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_return_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RETURN_STMT)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_return_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RETURN_STMT 0)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_return_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(RETURN_STMT (ADD_EXPR a b))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_return_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RETURN_STMT)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_return_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RETURN_STMT 0)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_return_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(RETURN_STMT (ADD_EXPR a b))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_continue_and_break_stmt(void **state) {
   UNUSED(state);
   const char *test = "continue; break;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_continue_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(CONTINUE_STMT)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_break_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(BREAK_STMT)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_continue_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(CONTINUE_STMT)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_break_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(BREAK_STMT)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_if_stmt(void **state) {
@@ -63,12 +60,12 @@ static void test_parse_if_stmt(void **state) {
       "if a { } elif b { } elif c { };"
       "if a { } elif b { } elif c { } else { };"
       "if a { } else { };";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
 
-  node = parse_if_stmt(&token);
-  assert_non_null(node);
+  node = parse_if_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       ""
       "(IF_STMT "
@@ -78,12 +75,11 @@ static void test_parse_if_stmt(void **state) {
       "   )"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_if_stmt(&token);
-  assert_non_null(node);
+  node = parse_if_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       ""
       "(IF_STMT "
@@ -98,12 +94,11 @@ static void test_parse_if_stmt(void **state) {
       "   )"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_if_stmt(&token);
-  assert_non_null(node);
+  node = parse_if_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       ""
       "(IF_STMT "
@@ -123,12 +118,11 @@ static void test_parse_if_stmt(void **state) {
       "   )"
       " )"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_if_stmt(&token);
-  assert_non_null(node);
+  node = parse_if_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       ""
       "(IF_STMT "
@@ -149,12 +143,11 @@ static void test_parse_if_stmt(void **state) {
       " )"
       " (ELSE_BRANCH (BLOCK))"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
 
-  node = parse_if_stmt(&token);
-  assert_non_null(node);
+  node = parse_if_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
   topology =
       ""
       "(IF_STMT "
@@ -165,23 +158,54 @@ static void test_parse_if_stmt(void **state) {
       " )"
       " (ELSE_BRANCH (BLOCK))"
       ")";
-  assert_node_topology(node, topology);
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  assert_node_topology(&parser.ast, node, topology);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_while_stmt(void **state) {
   UNUSED(state);
   const char *test = "while a { };";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_while_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(WHILE_STMT (EXPR_WITH_BLOCK a (BLOCK)))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_while_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(WHILE_STMT (EXPR_WITH_BLOCK a (BLOCK)))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
+}
+
+static void test_parse_block_recovery(void **state) {
+  UNUSED(state);
+  const char *test = "while a { b = ; return 1 ) ; while c { d = ( } ; e = 2 ; };";
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  // each broken statement is replaced by an error and parsing goes on with the next one, a nested block is closed
+  // before its parent
+  node = parse_while_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  const char *topology =
+      "(WHILE_STMT (EXPR_WITH_BLOCK a"
+      " (BLOCK"
+      "   (STATEMENT_OR_DECL (ERROR)"
+      "     (STATEMENT_OR_DECL (RETURN_STMT 1)"
+      "       (STATEMENT_OR_DECL (ERROR)"
+      "         (STATEMENT_OR_DECL (WHILE_STMT (EXPR_WITH_BLOCK c (BLOCK (STATEMENT_OR_DECL (ERROR)))))"
+      "           (STATEMENT_OR_DECL (ASSIGN_STMT e 2))"
+      "         )"
+      "       )"
+      "     )"
+      "   )"
+      " )"
+      "))";
+  assert_node_topology(&parser.ast, node, topology);
+  assert_int_equal(parser.diags.count, 3);
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_assign_and_accumulative_stmt(void **state) {
@@ -200,101 +224,89 @@ static void test_assign_and_accumulative_stmt(void **state) {
       "a <<= 1;"
       "a.b = 1;"
       "a[0] = 1;";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ASSIGN_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_ADD_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_SUB_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_MUL_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_DIV_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_REM_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_BIT_AND_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_BIT_OR_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_BIT_XOR_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_RSH_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ACCUM_LSH_STMT a 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ASSIGN_STMT (VALUE_LOOKUP_EXPR a b) 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
-
-  node = parse_assign_stmt(&token);
-  assert_non_null(node);
-  assert_node_topology(node, "(ASSIGN_STMT (SUBSCRIPTION_EXPR a (INDEXING_ARGS (INDEXING_ARG 0))) 1)");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ASSIGN_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_ADD_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_SUB_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_MUL_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_DIV_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_REM_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_BIT_AND_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_BIT_OR_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_BIT_XOR_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_RSH_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ACCUM_LSH_STMT a 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ASSIGN_STMT (VALUE_LOOKUP_EXPR a b) 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+
+  node = parse_assign_stmt(&parser);
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(ASSIGN_STMT (SUBSCRIPTION_EXPR a (INDEXING_ARGS (INDEXING_ARG 0))) 1)");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 static void test_parse_subscription_stmt(void **state) {
   UNUSED(state);
   const char *test = "a();";
-  struct tau_token start = tau_token_start(__func__, test, strlen(test));
-  struct tau_token token = tau_token_next(start);
-  struct tau_node *node = NULL;
-
-  node = parse_assign_stmt(&token);  // one upper level because we want to descend
-  assert_non_null(node);
-  assert_node_topology(node, "(SUBSCRIPTION_EXPR a (CALLING_ARGS))");
-  node_free(node);
-  assert_true(match_and_consume(&token, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  struct tau_parser parser;
+  parser_init(&parser, __func__, test, strlen(test));
+  node_id_t node = NODE_NULL;
+
+  node = parse_assign_stmt(&parser);  // one upper level because we want to descend
+  assert_int_not_equal(node, NODE_NULL);
+  assert_node_topology(&parser.ast, node, "(SUBSCRIPTION_EXPR a (CALLING_ARGS))");
+  assert_true(match_and_consume(&parser, TAU_TOKEN_TYPE_EOL, TAU_PUNCT_NONE, TAU_KEYWORD_NONE));
+  parser_free(&parser);
 }
 
 int main() {
@@ -306,6 +318,7 @@ int main() {
       cmocka_unit_test(test_parse_continue_and_break_stmt),  // continue, break
       cmocka_unit_test(test_parse_if_stmt),                  // all if variants
       cmocka_unit_test(test_parse_while_stmt),               // all while variants
+      cmocka_unit_test(test_parse_block_recovery),           // broken statements leave errors in the block
       cmocka_unit_test(test_assign_and_accumulative_stmt),   // all assign and accumulative stmt variants
       cmocka_unit_test(test_parse_subscription_stmt),        // call statements
   };
@@ -0,0 +1,596 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <stdlib.h>
+#include <string.h>
+#include <tau/parser.h>
+#include <threads.h>
+
+#include "../src/common.h"
+#include "../src/ast.h"
+#include "../src/hash.h"
+
+#define PARSER_TEST_THREADS 4
+#define PARSER_TEST_ROUNDS 64
+#define PARSER_TEST_GARBAGE_LINES 10000
+#define PARSER_TEST_GARBAGE_LINE "let ( { ) ] proc } type ;\n"
+
+static const char *valid_unit =
+    "module a::b\n"
+    "type A prototype\n"
+    "let a: A = 1 + 2 * 3\n"
+    "proc b(arg: A): A { return arg; }\n";
+
+static void test_parse_buffer(void **state) {
+  UNUSED(state);
+  struct tau_parse_result *result = tau_parse_buffer(__func__, valid_unit, strlen(valid_unit), NULL);
+  assert_non_null(result);
+  assert_true(tau_parse_result_ok(result));
+  assert_int_equal(tau_parse_result_diagnostic_count(result), 0);
+
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+  node_id_t root = tau_parse_result_root(result);
+  assert_int_equal(ast_node_type(ast, root), TAU_NODE_COMPILATION_UNIT);
+  assert_int_equal(ast_node_type(ast, ast_node_left(ast, root)), TAU_NODE_MODULE_DECL);
+  assert_int_equal(ast_node_type(ast, ast_node_right(ast, root)), TAU_NODE_DECLS);
+
+  struct tau_parse_stats stats = tau_parse_result_stats(result);
+  assert_int_equal(stats.buf_size, strlen(valid_unit));
+  assert_int_equal(stats.node_count, ast_size(ast));
+  assert_true(stats.token_count > 20);
+  assert_true(stats.token_bytes > 0);
+  assert_true(stats.arena_reserved >= stats.arena_peak);
+  tau_parse_result_free(result);
+}
+
+static void test_parse_buffer_diagnostics(void **state) {
+  UNUSED(state);
+  const char *test =
+      "module a\n"
+      "let a: A = \"b\n";
+  struct tau_parse_result *result = tau_parse_buffer(__func__, test, strlen(test), NULL);
+  assert_non_null(result);
+  assert_false(tau_parse_result_ok(result));
+  assert_true(tau_parse_result_diagnostic_count(result) >= 1);
+
+  struct tau_parse_diagnostic diag = tau_parse_result_diagnostic(result, 0);
+  assert_int_equal(diag.severity, TAU_PARSE_SEVERITY_ERROR);
+  assert_int_equal(diag.row, 1);
+  assert_int_equal(diag.col, 11);
+  assert_non_null(strstr(diag.message, "unclosed string literal"));
+  tau_parse_result_free(result);
+
+  test = "let a: A = 1\n";
+  result = tau_parse_buffer(__func__, test, strlen(test), NULL);
+  assert_false(tau_parse_result_ok(result));
+  assert_int_equal(tau_parse_result_root(result), NODE_NULL);
+  assert_non_null(strstr(tau_parse_result_diagnostic(result, 0).message, "<module decl>"));
+  tau_parse_result_free(result);
+}
+
+static void test_parse_buffer_recovery(void **state) {
+  UNUSED(state);
+  const char *test =
+      "module a\n"
+      "let a: U32 = 1 2\n"
+      "let b: U32 = 2\n"
+      "proc c(): U32 = )\n"
+      "proc d(x: U32): U32 { x = x +\n"
+      "  return x ]\n"
+      "}\n";
+  struct tau_parse_result *result = tau_parse_buffer(__func__, test, strlen(test), NULL);
+  assert_false(tau_parse_result_ok(result));
+  assert_int_not_equal(tau_parse_result_root(result), NODE_NULL);
+
+  // one error per broken construct, in the order they appear
+  static const size_t rows[] = {1, 3, 4, 5};
+  assert_int_equal(tau_parse_result_diagnostic_count(result), sizeof(rows) / sizeof(rows[0]));
+  for (size_t i = 0; i < sizeof(rows) / sizeof(rows[0]); i++) {
+    assert_int_equal(tau_parse_result_diagnostic(result, i).row, rows[i]);
+  }
+
+  struct tau_parse_diagnostic diag = tau_parse_result_diagnostic(result, 0);
+  assert_string_equal(diag.code, "E0003");
+  assert_int_equal(diag.col, 15);
+  assert_int_equal(diag.len, 1);
+
+  tau_parse_result_free(result);
+
+  // garbage is skipped in a single pass, whatever its shape
+  size_t line_len = strlen(PARSER_TEST_GARBAGE_LINE);
+  size_t size = strlen("module a\n") + PARSER_TEST_GARBAGE_LINES * line_len;
+  char *garbage = malloc(size + 1);
+  strcpy(garbage, "module a\n");
+  for (size_t i = 1; i <= PARSER_TEST_GARBAGE_LINES; i++) {
+    memcpy(garbage + size - i * line_len, PARSER_TEST_GARBAGE_LINE, line_len);
+  }
+
+  garbage[size] = '\0';
+
+  result = tau_parse_buffer(__func__, garbage, size, NULL);
+  assert_int_not_equal(tau_parse_result_root(result), NODE_NULL);
+  assert_true(tau_parse_result_diagnostic_count(result) >= PARSER_TEST_GARBAGE_LINES);
+  tau_parse_result_free(result);
+
+  // the same errors on every line fold into a handful of diagnostics, all of them still counted
+  struct tau_parse_options options = {.diagnostic_limit = 8, .fold_diagnostics = true};
+  result = tau_parse_buffer_with_options(__func__, garbage, size, &options);
+  assert_true(tau_parse_result_diagnostic_count(result) <= 8);
+  assert_true(tau_parse_result_diagnostic(result, 0).repeat_count >= PARSER_TEST_GARBAGE_LINES - 1);
+  assert_true(tau_parse_result_error_count(result) >= PARSER_TEST_GARBAGE_LINES);
+  tau_parse_result_free(result);
+  free(garbage);
+}
+
+static int parse_many(void *arg) {
+  size_t *node_count = arg;
+  for (int i = 0; i < PARSER_TEST_ROUNDS; i++) {
+    struct tau_parse_result *result = tau_parse_buffer("parse_many", valid_unit, strlen(valid_unit), NULL);
+    if (!tau_parse_result_ok(result)) {
+      tau_parse_result_free(result);
+      return 1;
+    }
+
+    *node_count = tau_parse_result_stats(result).node_count;
+    tau_parse_result_free(result);
+  }
+
+  return 0;
+}
+
+static void test_parse_buffer_threads(void **state) {
+  UNUSED(state);
+  thrd_t threads[PARSER_TEST_THREADS];
+  size_t node_counts[PARSER_TEST_THREADS] = {0};
+  for (int i = 0; i < PARSER_TEST_THREADS; i++) {
+    assert_int_equal(thrd_create(&threads[i], parse_many, &node_counts[i]), thrd_success);
+  }
+
+  for (int i = 0; i < PARSER_TEST_THREADS; i++) {
+    int res = -1;
+    assert_int_equal(thrd_join(threads[i], &res), thrd_success);
+    assert_int_equal(res, 0);
+    assert_int_equal(node_counts[i], node_counts[0]);
+  }
+}
+
+// NOLINTNEXTLINE(misc-no-recursion)
+static void assert_same_tree(const struct tau_ast *a, node_id_t a_id, const struct tau_ast *b, node_id_t b_id) {
+  assert_int_equal(a_id == NODE_NULL, b_id == NODE_NULL);
+  if (a_id == NODE_NULL) {
+    return;
+  }
+
+  const struct tau_node *a_node = ast_node(a, a_id);
+  const struct tau_node *b_node = ast_node(b, b_id);
+  assert_int_equal(a_node->type, b_node->type);
+  assert_int_equal(ast_node_offset(a, a_id), ast_node_offset(b, b_id));
+  assert_int_equal(a_node->len, b_node->len);
+  assert_int_equal(a_node->token_type, b_node->token_type);
+  assert_int_equal(a_node->token_code, b_node->token_code);
+  assert_same_tree(a, a_node->left, b, b_node->left);
+  assert_same_tree(a, a_node->right, b, b_node->right);
+}
+
+struct edit_session {
+  char bufs[2][256];
+  int current;
+  struct tau_parse_result *result;
+};
+
+// Replaces old_len bytes at offset with text, reparses, and checks the tree against a parse from scratch
+static bool apply_edit(struct edit_session *session, size_t offset, size_t old_len, const char *text) {
+  const char *old_buf = session->bufs[session->current];
+  char *new_buf = session->bufs[1 - session->current];
+  size_t new_len = strlen(text);
+  assert_true(strlen(old_buf) - old_len + new_len < sizeof(session->bufs[0]));
+  memcpy(new_buf, old_buf, offset);
+  memcpy(new_buf + offset, text, new_len);
+  strcpy(new_buf + offset + new_len, old_buf + offset + old_len);
+  session->current = 1 - session->current;
+
+  struct tau_parse_edit edit = {.offset = offset, .old_len = old_len, .new_len = new_len};
+  bool incremental = tau_parse_result_reparse(session->result, new_buf, strlen(new_buf), edit);
+  struct tau_parse_result *fresh = tau_parse_buffer(__func__, new_buf, strlen(new_buf), NULL);
+  assert_int_equal(tau_parse_result_ok(session->result), tau_parse_result_ok(fresh));
+  assert_int_equal(tau_parse_result_diagnostic_count(session->result), tau_parse_result_diagnostic_count(fresh));
+  assert_int_equal(tau_parse_result_error_count(session->result), tau_parse_result_error_count(fresh));
+  for (size_t i = 0; i < tau_parse_result_diagnostic_count(fresh); i++) {
+    struct tau_parse_diagnostic got = tau_parse_result_diagnostic(session->result, i);
+    struct tau_parse_diagnostic want = tau_parse_result_diagnostic(fresh, i);
+    assert_string_equal(got.code, want.code);
+    assert_string_equal(got.message, want.message);
+    assert_int_equal(got.row, want.row);
+    assert_int_equal(got.col, want.col);
+    assert_int_equal(got.len, want.len);
+  }
+
+  assert_int_equal(tau_parse_result_stats(session->result).token_count, tau_parse_result_stats(fresh).token_count);
+  assert_same_tree(tau_parse_result_ast(session->result), tau_parse_result_root(session->result),
+                   tau_parse_result_ast(fresh), tau_parse_result_root(fresh));
+  tau_parse_result_free(fresh);
+  return incremental;
+}
+
+static size_t offset_of(const struct edit_session *session, const char *needle) {
+  const char *buf = session->bufs[session->current];
+  const char *found = strstr(buf, needle);
+  assert_non_null(found);
+  return (size_t)(found - buf);
+}
+
+static node_id_t nth_decl(const struct tau_parse_result *result, int n) {
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+  node_id_t decl = ast_node_left(ast, ast_node_right(ast, tau_parse_result_root(result)));
+  for (int i = 0; i < n; i++) {
+    decl = ast_node_right(ast, decl);
+  }
+
+  return decl;
+}
+
+static void test_parse_result_reparse(void **state) {
+  UNUSED(state);
+  struct edit_session session = {0};
+  strcpy(session.bufs[0], valid_unit);
+  session.result = tau_parse_buffer(__func__, session.bufs[0], strlen(valid_unit), NULL);
+  assert_true(tau_parse_result_ok(session.result));
+  node_id_t type_decl = nth_decl(session.result, 0);
+  node_id_t proc_decl = nth_decl(session.result, 2);
+
+  // the let declaration is the only one parsed again, the others keep their nodes
+  assert_true(apply_edit(&session, offset_of(&session, "2 * 3"), 1, "20"));
+  assert_int_equal(nth_decl(session.result, 0), type_decl);
+  assert_int_equal(nth_decl(session.result, 2), proc_decl);
+
+  // whole declarations appear and go away, including at the end of the buffer
+  assert_true(apply_edit(&session, offset_of(&session, "let a"), 0, "let z: A = 7\n"));
+  assert_int_equal(nth_decl(session.result, 3), proc_decl);
+  assert_true(apply_edit(&session, offset_of(&session, "let z"), 13, ""));
+  assert_true(apply_edit(&session, strlen(session.bufs[session.current]), 0, "type B prototype\n"));
+  assert_true(apply_edit(&session, offset_of(&session, " = 1"), 1, "   "));
+
+  // the module header goes through a full parse
+  assert_false(apply_edit(&session, offset_of(&session, "a::b"), 1, "c"));
+  type_decl = nth_decl(session.result, 0);
+  proc_decl = nth_decl(session.result, 2);
+
+  // declarations holding errors are replaced like the others, diagnostics after the edit follow their text
+  assert_true(apply_edit(&session, offset_of(&session, "20"), 0, ") "));
+  assert_false(tau_parse_result_ok(session.result));
+  assert_int_equal(nth_decl(session.result, 0), type_decl);
+  assert_true(apply_edit(&session, offset_of(&session, "proc b"), 0, "let s: Str = \"\\uDC00\"\n"));
+  assert_true(apply_edit(&session, offset_of(&session, "let a"), 0, "\n\n"));
+  assert_int_equal(tau_parse_result_diagnostic_count(session.result), 2);
+  assert_true(apply_edit(&session, offset_of(&session, "return arg"), 10, "return arg * 2"));
+  assert_true(apply_edit(&session, offset_of(&session, ") 20"), 2, ""));
+  assert_true(apply_edit(&session, offset_of(&session, "let s"), 22, ""));
+  assert_true(tau_parse_result_ok(session.result));
+  assert_true(apply_edit(&session, offset_of(&session, "20"), 2, "(4 + 5)"));
+  tau_parse_result_free(session.result);
+
+  // a list that drops or folds diagnostics cannot have some of them swapped out
+  const char *broken = "module m\nlet a: A = )\nlet b: A = 1\n";
+  struct tau_parse_options options = {.diagnostic_limit = 8};
+  struct tau_parse_result *result = tau_parse_buffer_with_options(__func__, broken, strlen(broken), &options);
+  assert_false(tau_parse_result_ok(result));
+  struct tau_parse_edit edit = {.offset = strlen(broken) - 2, .old_len = 1, .new_len = 1};
+  assert_false(tau_parse_result_reparse(result, "module m\nlet a: A = )\nlet b: A = 2\n", strlen(broken), edit));
+  tau_parse_result_free(result);
+}
+
+// Sum of the integer literals still in the tree, counting them in count
+static uint64_t sum_int_literals(const struct tau_parse_result *result, int *count) {
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+  uint64_t sum = 0;
+  *count = 0;
+  for (node_id_t id = 1; id <= ast_size(ast); id++) {
+    uint64_t value;
+    if (tau_parse_result_node_int(result, id, &value)) {
+      sum += value;
+      (*count)++;
+    }
+  }
+
+  return sum;
+}
+
+static void test_parse_result_compaction(void **state) {
+  UNUSED(state);
+  char buf[] = "module m\nlet a: A = 7\nlet b: A = 0\n";
+  size_t len = strlen(buf);
+  size_t digit = len - 2;
+  struct tau_parse_result *result = tau_parse_buffer(__func__, buf, len, NULL);
+  size_t token_bytes = tau_parse_result_stats(result).token_bytes;
+
+  // edits keep the tokens of the last full parse alone until what they replaced outgrows it, then one compacts them
+  int incremental = 0;
+  struct tau_parse_edit edit = {.offset = digit, .old_len = 1, .new_len = 1};
+  while (true) {
+    buf[digit] = (char)('1' + incremental % 9);
+    if (!tau_parse_result_reparse(result, buf, len, edit)) {
+      break;
+    }
+
+    incremental++;
+    assert_int_equal(tau_parse_result_stats(result).token_bytes, token_bytes);
+    if (incremental % 1000 == 0) {
+      int count;
+      assert_int_equal(sum_int_literals(result, &count), 7 + (uint64_t)(buf[digit] - '0'));
+      assert_int_equal(count, 2);
+    }
+  }
+
+  assert_true(incremental > 1000);
+  int count;
+  assert_int_equal(sum_int_literals(result, &count), 7 + (uint64_t)(buf[digit] - '0'));
+  assert_int_equal(count, 2);
+  assert_true(tau_parse_result_reparse(result, buf, len, edit));
+  tau_parse_result_free(result);
+}
+
+static node_id_t first_of_type(const struct tau_ast *ast, enum tau_node_type type) {
+  for (node_id_t id = 1; id <= ast_size(ast); id++) {
+    if (ast_node_type(ast, id) == type) {
+      return id;
+    }
+  }
+
+  return NODE_NULL;
+}
+
+static void test_parse_result_hashes(void **state) {
+  UNUSED(state);
+  const char *moved =
+      "module a::b\n"
+      "type A prototype\n"
+      "let a: A = 1 + 2 * 30\n"
+      "\n\n"
+      "proc b(arg: A): A { return arg; }\n";
+  struct tau_parse_result *a = tau_parse_buffer(__func__, valid_unit, strlen(valid_unit), NULL);
+  struct tau_parse_result *b = tau_parse_buffer(__func__, moved, strlen(moved), NULL);
+  assert_int_equal(tau_parse_result_content_hash(a), tau_hash64(valid_unit, strlen(valid_unit), 0));
+  assert_int_not_equal(tau_parse_result_content_hash(a), tau_parse_result_content_hash(b));
+
+  // the edited declaration changes and so does the unit, the others keep their hash even once moved
+  assert_int_equal(tau_parse_result_node_hash(a, nth_decl(a, 0)), tau_parse_result_node_hash(b, nth_decl(b, 0)));
+  assert_int_not_equal(tau_parse_result_node_hash(a, nth_decl(a, 1)), tau_parse_result_node_hash(b, nth_decl(b, 1)));
+  assert_int_equal(tau_parse_result_node_hash(a, nth_decl(a, 2)), tau_parse_result_node_hash(b, nth_decl(b, 2)));
+  assert_int_not_equal(tau_parse_result_node_hash(a, tau_parse_result_root(a)),
+                       tau_parse_result_node_hash(b, tau_parse_result_root(b)));
+
+  // a reparse to the same text ends up with the same hashes
+  char edited[256];
+  strcpy(edited, valid_unit);
+  size_t at = (size_t)(strstr(edited, " * 3") - edited) + 4;
+  memmove(edited + at + 3, edited + at, strlen(edited + at) + 1);
+  memcpy(edited + at, "0\n\n", 3);
+  assert_string_equal(edited, moved);
+  struct tau_parse_edit edit = {.offset = at, .old_len = 0, .new_len = 3};
+  assert_true(tau_parse_result_reparse(a, edited, strlen(edited), edit));
+  assert_int_equal(tau_parse_result_content_hash(a), tau_parse_result_content_hash(b));
+  assert_int_equal(tau_parse_result_node_hash(a, tau_parse_result_root(a)),
+                   tau_parse_result_node_hash(b, tau_parse_result_root(b)));
+  tau_parse_result_free(a);
+  tau_parse_result_free(b);
+
+  // a block covers every statement in it, a statement only itself
+  const char *two = "module m\nproc f(): A { x = 1\n y = 2 }\n";
+  const char *changed = "module m\nproc f(): A { x = 1\n y = 3 }\n";
+  a = tau_parse_buffer(__func__, two, strlen(two), NULL);
+  b = tau_parse_buffer(__func__, changed, strlen(changed), NULL);
+  const struct tau_ast *a_ast = tau_parse_result_ast(a);
+  const struct tau_ast *b_ast = tau_parse_result_ast(b);
+  node_id_t a_stmt = first_of_type(a_ast, TAU_NODE_STATEMENT_OR_DECL);
+  node_id_t b_stmt = first_of_type(b_ast, TAU_NODE_STATEMENT_OR_DECL);
+  assert_int_equal(tau_parse_result_node_hash(a, a_stmt), tau_parse_result_node_hash(b, b_stmt));
+  assert_int_not_equal(tau_parse_result_node_hash(a, ast_node_right(a_ast, a_stmt)),
+                       tau_parse_result_node_hash(b, ast_node_right(b_ast, b_stmt)));
+  assert_int_not_equal(tau_parse_result_node_hash(a, first_of_type(a_ast, TAU_NODE_BLOCK)),
+                       tau_parse_result_node_hash(b, first_of_type(b_ast, TAU_NODE_BLOCK)));
+  tau_parse_result_free(a);
+  tau_parse_result_free(b);
+}
+
+static void test_parse_result_node_doc(void **state) {
+  UNUSED(state);
+  const char *buf =
+      "// Copyright header, not a doc comment\n"
+      "module docs\n"
+      "\n"
+      "/// Adds two numbers.\n"
+      "/// Wraps around on overflow.\n"
+      "proc add(a: U32, b: U32): U32 = a + b\n"
+      "let c: U32 = add(1, 2)  /// trailing comments document nothing\n"
+      "/** A prototype. */\n"
+      "type T prototype\n";
+  size_t len = strlen(buf);
+  struct tau_parse_options options = {.keep_doc_comments = true};
+  struct tau_parse_result *result = tau_parse_buffer_with_options(__func__, buf, len, &options);
+  assert_true(tau_parse_result_ok(result));
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+
+  size_t doc_len = 0;
+  const char *doc = tau_parse_result_node_doc(result, first_of_type(ast, TAU_NODE_PROC_DECL), &doc_len);
+  const char *want = "/// Adds two numbers.\n/// Wraps around on overflow.";
+  assert_non_null(doc);
+  assert_int_equal(doc_len, strlen(want));
+  assert_memory_equal(doc, want, doc_len);
+
+  doc = tau_parse_result_node_doc(result, first_of_type(ast, TAU_NODE_TYPE_DECL), &doc_len);
+  assert_non_null(doc);
+  assert_memory_equal(doc, "/** A prototype. */", doc_len);
+  assert_null(tau_parse_result_node_doc(result, first_of_type(ast, TAU_NODE_MODULE_DECL), &doc_len));
+  assert_null(tau_parse_result_node_doc(result, first_of_type(ast, TAU_NODE_LET_DECL), &doc_len));
+  assert_int_equal(doc_len, 0);
+
+  // reparses are full ones, so docs stay in step with the buffer
+  char *edited = strdup(buf);
+  edited[strstr(buf, "Adds") - buf] = 'a';
+  assert_false(tau_parse_result_reparse(result, edited, len, (struct tau_parse_edit){strstr(buf, "Adds") - buf, 1, 1}));
+  doc = tau_parse_result_node_doc(result, first_of_type(ast, TAU_NODE_PROC_DECL), &doc_len);
+  assert_memory_equal(doc, "/// adds", strlen("/// adds"));
+  tau_parse_result_free(result);
+  free(edited);
+
+  // without the option the same buffer parses to the same tree and keeps no docs
+  result = tau_parse_buffer(__func__, buf, len, NULL);
+  assert_true(tau_parse_result_ok(result));
+  assert_null(tau_parse_result_node_doc(result, first_of_type(tau_parse_result_ast(result), TAU_NODE_PROC_DECL),
+                                        &doc_len));
+  tau_parse_result_free(result);
+}
+
+// Values of the literal atoms under id in tree order, integers as doubles
+static size_t collect_literals(const struct tau_parse_result *result, node_id_t id, double *values, size_t count) {
+  if (id == NODE_NULL) {
+    return count;
+  }
+
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+  uint64_t int_value;
+  double flt_value;
+  if (ast_node_type(ast, id) == TAU_NODE_ATOM && tau_parse_result_node_int(result, id, &int_value)) {
+    values[count++] = (double)int_value;
+  } else if (ast_node_type(ast, id) == TAU_NODE_ATOM && tau_parse_result_node_float(result, id, &flt_value)) {
+    values[count++] = flt_value;
+  }
+
+  count = collect_literals(result, ast_node_left(ast, id), values, count);
+  return collect_literals(result, ast_node_right(ast, id), values, count);
+}
+
+static void test_parse_result_node_literal(void **state) {
+  UNUSED(state);
+  struct edit_session session = {0};
+  strcpy(session.bufs[0],
+         "module lits\n"
+         "let a: U64 = 0x1F + 0b101 * 0o17\n"
+         "let b: F64 = 2.5e+1 - 18446744073709551615\n");
+  session.result = tau_parse_buffer(__func__, session.bufs[0], strlen(session.bufs[0]), NULL);
+  assert_true(tau_parse_result_ok(session.result));
+
+  double values[8];
+  assert_int_equal(collect_literals(session.result, tau_parse_result_root(session.result), values, 0), 5);
+  assert_true(values[0] == 31 && values[1] == 5 && values[2] == 15 && values[3] == 25.0);
+  assert_true(values[4] == (double)UINT64_MAX);
+
+  const struct tau_ast *ast = tau_parse_result_ast(session.result);
+  uint64_t int_value;
+  double flt_value;
+  assert_false(tau_parse_result_node_int(session.result, first_of_type(ast, TAU_NODE_MODULE_DECL), &int_value));
+  for (node_id_t id = 1; id <= ast_size(ast); id++) {
+    if (ast_node_token_type(ast, id) == TAU_TOKEN_TYPE_FLT_LIT) {
+      assert_false(tau_parse_result_node_int(session.result, id, &int_value));
+      assert_true(tau_parse_result_node_float(session.result, id, &flt_value));
+    }
+  }
+
+  // literals of the declarations parsed again come from their new tokens, the ones after them keep theirs
+  assert_true(apply_edit(&session, offset_of(&session, "0b101"), 5, "0x10 + 7"));
+  assert_int_equal(collect_literals(session.result, tau_parse_result_root(session.result), values, 0), 6);
+  assert_true(values[0] == 31 && values[1] == 16 && values[2] == 7 && values[3] == 15 && values[4] == 25.0);
+  assert_true(apply_edit(&session, offset_of(&session, "let b"), 0, "let c: U64 = 3\n"));
+  assert_int_equal(collect_literals(session.result, tau_parse_result_root(session.result), values, 0), 7);
+  assert_true(values[4] == 3 && values[5] == 25.0 && values[6] == (double)UINT64_MAX);
+  tau_parse_result_free(session.result);
+
+  // values too large for their type are errors of the lexer
+  const char *too_large = "module m\nlet a: U64 = 18446744073709551616\n";
+  struct tau_parse_result *result = tau_parse_buffer(__func__, too_large, strlen(too_large), NULL);
+  assert_false(tau_parse_result_ok(result));
+  assert_int_equal(tau_parse_result_diagnostic_count(result), 1);
+  assert_string_equal(tau_parse_result_diagnostic(result, 0).code, "E0008");
+  tau_parse_result_free(result);
+}
+
+// String literal nodes reachable from id, in source order
+static size_t collect_strings(struct tau_parse_result *result, node_id_t id, const char **texts, size_t count) {
+  if (id == NODE_NULL) {
+    return count;
+  }
+
+  const struct tau_ast *ast = tau_parse_result_ast(result);
+  size_t len;
+  const char *text = tau_parse_result_node_string(result, id, &len);
+  if (ast_node_type(ast, id) == TAU_NODE_ATOM && text != NULL) {
+    assert_int_equal(len, strlen(text));
+    texts[count++] = text;
+  }
+
+  count = collect_strings(result, ast_node_left(ast, id), texts, count);
+  return collect_strings(result, ast_node_right(ast, id), texts, count);
+}
+
+static void test_parse_result_node_string(void **state) {
+  UNUSED(state);
+  struct edit_session session = {0};
+  strcpy(session.bufs[0],
+         "module strs\n"
+         "let a: Str = \"a\\tb\"\n"
+         "let b: Str = \"a\\u0009b\"\n"
+         "let c: Str = \"\\u00e9t\\u00e9\"\n");
+  session.result = tau_parse_buffer(__func__, session.bufs[0], strlen(session.bufs[0]), NULL);
+  assert_true(tau_parse_result_ok(session.result));
+
+  // literals equal once decoded are the same string of the pool
+  const char *texts[8];
+  assert_int_equal(collect_strings(session.result, tau_parse_result_root(session.result), texts, 0), 3);
+  assert_string_equal(texts[0], "a\tb");
+  assert_ptr_equal(texts[1], texts[0]);
+  assert_string_equal(texts[2], "\xc3\xa9t\xc3\xa9");
+  size_t size;
+  const char *strings = tau_parse_result_strings(session.result, &size);
+  assert_int_equal(size, 4 + 6);
+  assert_memory_equal(strings, "a\tb\0\xc3\xa9t\xc3\xa9", size);
+
+  size_t len;
+  const struct tau_ast *ast = tau_parse_result_ast(session.result);
+  assert_null(tau_parse_result_node_string(session.result, first_of_type(ast, TAU_NODE_MODULE_DECL), &len));
+  assert_int_equal(len, 0);
+
+  // literals of the declarations parsed again are added, the replaced ones stay in the pool
+  assert_true(apply_edit(&session, offset_of(&session, "\\u0009"), 6, "c"));
+  assert_int_equal(collect_strings(session.result, tau_parse_result_root(session.result), texts, 0), 3);
+  assert_string_equal(texts[0], "a\tb");
+  assert_string_equal(texts[1], "acb");
+  assert_string_equal(texts[2], "\xc3\xa9t\xc3\xa9");
+  tau_parse_result_strings(session.result, &size);
+  assert_int_equal(size, 4 + 6 + 4);
+  tau_parse_result_free(session.result);
+
+  // escapes that stand for nothing are errors of the lexer
+  const char *invalid = "module m\nlet a: Str = \"\\uDC00\"\n";
+  struct tau_parse_result *result = tau_parse_buffer(__func__, invalid, strlen(invalid), NULL);
+  assert_false(tau_parse_result_ok(result));
+  assert_int_equal(tau_parse_result_diagnostic_count(result), 1);
+  assert_string_equal(tau_parse_result_diagnostic(result, 0).code, "E0009");
+  tau_parse_result_free(result);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_parse_buffer),               // a whole compilation unit
+      cmocka_unit_test(test_parse_buffer_diagnostics),   // errors are collected into the result
+      cmocka_unit_test(test_parse_buffer_recovery),      // parsing goes on after a syntax error
+      cmocka_unit_test(test_parse_buffer_threads),       // concurrent parses share nothing
+      cmocka_unit_test(test_parse_result_reparse),       // edits only parse the declarations they touch
+      cmocka_unit_test(test_parse_result_compaction),    // reparses hold on to bounded memory
+      cmocka_unit_test(test_parse_result_hashes),        // subtree hashes only change with the code under them
+      cmocka_unit_test(test_parse_result_node_doc),      // doc comments are handed out by node
+      cmocka_unit_test(test_parse_result_node_literal),  // literal values are handed out by node
+      cmocka_unit_test(test_parse_result_node_string),   // decoded string literals are handed out by node
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
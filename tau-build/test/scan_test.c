@@ -0,0 +1,136 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include "../src/scan.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "../src/common.h"
+
+#define SCAN_TEST_BUF_SIZE 200
+
+typedef size_t (*scan_func_t)(const char *buf, size_t len);
+
+// Runs of every length up to a few vector widths, at every alignment, stopped by every kind of byte
+static void assert_scan_matches_scalar(scan_func_t scan, const char *body, const char *stops) {
+  char buf[SCAN_TEST_BUF_SIZE];
+  size_t body_len = strlen(body);
+  size_t stops_len = strlen(stops);
+  for (enum tau_scan_isa isa = TAU_SCAN_ISA_SCALAR; isa < TAU_SCAN_ISA_COUNT; isa++) {
+    if (!tau_scan_select(isa)) {
+      continue;
+    }
+
+    for (size_t offset = 0; offset < 32; offset++) {
+      for (size_t run = 0; run + offset < SCAN_TEST_BUF_SIZE - 1; run += 3) {
+        for (size_t i = 0; i < run; i++) {
+          buf[offset + i] = body[(i * 7 + run) % body_len];
+        }
+
+        buf[offset + run] = stops[run % stops_len];
+        assert_int_equal(scan(buf + offset, run + 1), run);
+        assert_int_equal(scan(buf + offset, run), run);
+      }
+    }
+  }
+}
+
+static void test_scan_spaces(void **state) {
+  UNUSED(state);
+  enum tau_scan_isa selected = tau_scan_selected();
+  assert_scan_matches_scalar(tau_scan_spaces, " \t", "a\n\r\"\x80\xff\x01");
+  tau_scan_select(selected);
+}
+
+static void test_scan_ident_body(void **state) {
+  UNUSED(state);
+  enum tau_scan_isa selected = tau_scan_selected();
+  assert_scan_matches_scalar(tau_scan_ident_body, "azAZ09_$mQ5", " \t\n@[`{/:\x7f\x80\xc3\xff");
+  tau_scan_select(selected);
+}
+
+static void test_scan_str_body(void **state) {
+  UNUSED(state);
+  enum tau_scan_isa selected = tau_scan_selected();
+  assert_scan_matches_scalar(tau_scan_str_body, "ab c\t\x01\x7f\xc3\xa9\xf0\x9f\x98\x80'", "\"\\\n\r");
+  tau_scan_select(selected);
+}
+
+// Sequences of every kind, well formed or not, glued at random so they straddle vector blocks at every offset
+static void test_scan_utf8(void **state) {
+  UNUSED(state);
+  static const char *pieces[] = {
+      // well formed
+      "a", "module x ", "\xC3\xA9", "\xE2\x82\xAC", "\xF0\x9F\x98\x8C", "\xEF\xBF\xBD", "\xF4\x8F\xBF\xBF",
+      "\xED\x9F\xBF",
+      // stray continuation, overlongs, surrogate, past U+10FFFF, impossible and truncated
+      "\x80", "\xC0\xAF", "\xE0\x80\xAF", "\xED\xA0\x80", "\xF4\x90\x80\x80", "\xF5", "\xC3", "\xE2\x82",
+      "\xF0\x9F\x98", "\xFF",
+  };
+  enum { VALID_PIECES = 8, PIECE_COUNT = sizeof(pieces) / sizeof(pieces[0]) };
+
+  enum tau_scan_isa selected = tau_scan_selected();
+  char buf[SCAN_TEST_BUF_SIZE];
+  uint32_t seed = 12345;
+  for (int round = 0; round < 4000; round++) {
+    // mostly well formed, with at most one bad piece so the expected run is known
+    size_t len = 0;
+    size_t want = SIZE_MAX;
+    while (len + 8 < SCAN_TEST_BUF_SIZE - 1) {
+      seed = seed * 1103515245u + 12345u;
+      uint32_t pick = (seed >> 16) % (round % 4 == 0 ? PIECE_COUNT : VALID_PIECES);
+      if (pick >= VALID_PIECES) {
+        if (want != SIZE_MAX) {
+          continue;
+        }
+
+        want = len;
+      }
+
+      size_t piece_len = strlen(pieces[pick]);
+      memcpy(buf + len, pieces[pick], piece_len);
+      len += piece_len;
+    }
+
+    want = want == SIZE_MAX ? len : want;
+    for (enum tau_scan_isa isa = TAU_SCAN_ISA_SCALAR; isa < TAU_SCAN_ISA_COUNT; isa++) {
+      if (tau_scan_select(isa)) {
+        assert_int_equal(tau_scan_utf8(buf, len), want);
+      }
+    }
+  }
+
+  tau_scan_select(selected);
+}
+
+static void test_scan_select(void **state) {
+  UNUSED(state);
+  enum tau_scan_isa selected = tau_scan_selected();
+  assert_true(tau_scan_select(TAU_SCAN_ISA_SCALAR));
+  assert_int_equal(tau_scan_selected(), TAU_SCAN_ISA_SCALAR);
+  assert_string_equal(tau_scan_get_isa_name(TAU_SCAN_ISA_SCALAR), "scalar");
+  assert_true(tau_scan_select(selected));
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_scan_spaces),
+      cmocka_unit_test(test_scan_ident_body),
+      cmocka_unit_test(test_scan_str_body),
+      cmocka_unit_test(test_scan_utf8),
+      cmocka_unit_test(test_scan_select),
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,108 @@
+//
+// Created on 10/17/26.
+//
+#define _POSIX_C_SOURCE 200809L
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../src/common.h"
+#include "../src/lexer.h"
+#include "../src/source.h"
+
+#define SOURCE_TEST_PATH_MAX 64
+
+static void write_file(char *path, const char *content, size_t len) {
+  strcpy(path, "/tmp/tau_source_test_XXXXXX");
+  int fd = mkstemp(path);
+  assert_true(fd >= 0);
+  assert_int_equal(write(fd, content, len), (ssize_t)len);
+  close(fd);
+}
+
+static void test_source_mapped(void **state) {
+  UNUSED(state);
+  char path[SOURCE_TEST_PATH_MAX];
+  const char *content = "module a\nlet b: U32 = 1\n";
+  write_file(path, content, strlen(content));
+
+  struct tau_source source;
+  assert_int_equal(tau_source_open(&source, path), 0);
+  unlink(path);
+  assert_int_equal(source.kind, TAU_SOURCE_MAPPED);
+  assert_int_equal(source.size, strlen(content));
+  assert_memory_equal(source.data, content, source.size);
+  assert_int_equal(source.data[source.size], '\0');
+
+  // tokens point straight into the mapping
+  struct tau_token token = tau_token_next(tau_token_start(path, source.data, source.size));
+  assert_ptr_equal(token.buf, source.data);
+  tau_source_close(&source);
+  assert_int_equal(source.kind, TAU_SOURCE_EMPTY);
+}
+
+// A file filling its pages exactly still gets a NUL byte right after its last byte
+static void test_source_page_sized(void **state) {
+  UNUSED(state);
+  size_t size = (size_t)sysconf(_SC_PAGESIZE) * 2;
+  char *content = malloc(size);
+  memset(content, ' ', size);
+  memcpy(content, "module a", 8);
+  content[size - 1] = 'b';
+
+  char path[SOURCE_TEST_PATH_MAX];
+  write_file(path, content, size);
+  struct tau_source source;
+  assert_int_equal(tau_source_open(&source, path), 0);
+  unlink(path);
+  assert_int_equal(source.size, size);
+  assert_int_equal(source.data[size - 1], 'b');
+  assert_int_equal(source.data[size], '\0');
+
+  struct tau_token_table table;
+  tau_token_table_init(&table);
+  tau_token_table_lex(&table, NULL, path, source.data, source.size);
+  assert_int_equal(table.count, 4);
+  assert_int_equal(table.types[2], TAU_TOKEN_TYPE_IDENTIFIER);
+  assert_int_equal(table.offsets[2], size - 1);
+  assert_int_equal(table.types[3], TAU_TOKEN_TYPE_EOF);
+  tau_token_table_free(&table);
+  tau_source_close(&source);
+  free(content);
+}
+
+static void test_source_errors(void **state) {
+  UNUSED(state);
+  struct tau_source source;
+  assert_int_equal(tau_source_open(&source, "/tmp/tau_source_test_missing"), ENOENT);
+  assert_int_equal(tau_source_open(&source, "/tmp"), EISDIR);
+
+  char path[SOURCE_TEST_PATH_MAX];
+  write_file(path, "", 0);
+  assert_int_equal(tau_source_open(&source, path), 0);
+  unlink(path);
+  assert_int_equal(source.size, 0);
+  assert_int_equal(source.data[0], '\0');
+  tau_source_close(&source);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_source_mapped),      // regular files are mapped, not copied
+      cmocka_unit_test(test_source_page_sized),  // the lexer can always peek past the end
+      cmocka_unit_test(test_source_errors),      // missing files, directories and empty files
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,101 @@
+//
+// Created on 10/18/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../src/common.h"
+#include "../src/str_pool.h"
+
+static void test_str_pool_intern(void **state) {
+  UNUSED(state);
+  struct tau_str_pool pool;
+  tau_str_pool_init(&pool);
+
+  // strings are packed one after the other, each with a NUL after it
+  assert_int_equal(tau_str_pool_intern(&pool, "abc", 3), 0);
+  assert_int_equal(tau_str_pool_intern(&pool, "", 0), 4);
+  assert_int_equal(tau_str_pool_intern(&pool, "a\0b", 3), 5);
+  assert_int_equal(pool.size, 9);
+  assert_int_equal(pool.count, 3);
+  assert_memory_equal(pool.data, "abc\0\0a\0b\0", 9);
+
+  // equal strings share the first one, prefixes and strings with a NUL in them are not equal
+  assert_int_equal(tau_str_pool_intern(&pool, "abc", 3), 0);
+  assert_int_equal(tau_str_pool_intern(&pool, "", 0), 4);
+  assert_int_equal(tau_str_pool_intern(&pool, "a\0b", 3), 5);
+  assert_int_equal(tau_str_pool_intern(&pool, "ab", 2), 9);
+  assert_int_equal(tau_str_pool_intern(&pool, "a", 1), 12);
+  assert_int_equal(pool.size, 14);
+  assert_int_equal(pool.count, 5);
+
+  tau_str_pool_free(&pool);
+}
+
+static void test_str_pool_reserve(void **state) {
+  UNUSED(state);
+  struct tau_str_pool pool;
+  tau_str_pool_init(&pool);
+
+  // only part of what was reserved is kept, a duplicate leaves nothing behind
+  char *dest = tau_str_pool_reserve(&pool, 10);
+  memcpy(dest, "hello", 5);
+  assert_int_equal(tau_str_pool_commit(&pool, 5), 0);
+  dest = tau_str_pool_reserve(&pool, 10);
+  memcpy(dest, "hello", 5);
+  assert_int_equal(tau_str_pool_commit(&pool, 5), 0);
+  assert_int_equal(pool.size, 6);
+  assert_string_equal(pool.data, "hello");
+
+  // a cleared pool hands out the same offsets again
+  tau_str_pool_clear(&pool);
+  assert_int_equal(pool.size, 0);
+  assert_int_equal(tau_str_pool_intern(&pool, "world", 5), 0);
+  assert_int_equal(tau_str_pool_intern(&pool, "hello", 5), 6);
+
+  tau_str_pool_free(&pool);
+}
+
+static void test_str_pool_grow(void **state) {
+  UNUSED(state);
+  struct tau_str_pool pool;
+  tau_str_pool_init(&pool);
+
+  // enough strings to regrow both the data and the slots, every one still found afterwards
+  uint32_t offsets[10000];
+  char text[16];
+  for (int i = 0; i < 10000; i++) {
+    int len = snprintf(text, sizeof(text), "s%d", i);
+    offsets[i] = tau_str_pool_intern(&pool, text, len);
+  }
+
+  assert_int_equal(pool.count, 10000);
+  for (int i = 0; i < 10000; i++) {
+    int len = snprintf(text, sizeof(text), "s%d", i);
+    assert_int_equal(tau_str_pool_intern(&pool, text, len), offsets[i]);
+    assert_string_equal(pool.data + offsets[i], text);
+  }
+
+  assert_int_equal(pool.count, 10000);
+  tau_str_pool_free(&pool);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_str_pool_intern),   // equal strings are stored once, NUL terminated
+      cmocka_unit_test(test_str_pool_reserve),  // decoding in place and clearing
+      cmocka_unit_test(test_str_pool_grow),     // many strings regrow the data and the slots
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
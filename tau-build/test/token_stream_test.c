@@ -0,0 +1,254 @@
+//
+// Created on 10/17/26.
+//
+// clang-format off
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <cmocka.h>
+// clang-format on
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../src/diag.h"
+#include "../src/lexer.h"
+#include "../src/token_stream.h"
+
+// Every kind of token, a comment and a literal to straddle chunk boundaries and a few errors to report
+#define STREAM_TEST_SOURCE                                            \
+  "/// the module\n"                                                  \
+  "module stream::test\n"                                             \
+  "\n"                                                                \
+  "/* a block\n   comment */ let a: F64 = 0.12e+10;\n"                \
+  "let b = 0x1f + 0b1010 - 0o7070 >>= \"\\n\\xFA\\\"\\u00e9\\q\"\n"   \
+  "// trailing comment \xff\n"                                        \
+  "/** doc */\n"                                                      \
+  "proc f(x: [U32]): {Str} = (x[0] + 1) * \"\xc3\xa9\xe2\x82\xac\"\n" \
+  "let \xe2\x82\xac = \xC0\xAF a \xE2\x82\n"                          \
+  "let c = \"unclosed \xC0\n"                                         \
+  "true false unit nil letter iffy types as\n"                        \
+  "a /* never closed\n b"
+
+// Hands out the buffer in reads of 1 to max_read bytes, never more than asked for
+struct chunked_reader {
+  const char *data;
+  size_t size;
+  size_t pos;
+  size_t max_read;
+  size_t reads;
+};
+
+static size_t chunked_read(void *ctx, char *dest, size_t cap) {
+  struct chunked_reader *reader = ctx;
+  size_t n = 1 + reader->reads++ % reader->max_read;
+  n = n < cap ? n : cap;
+  n = n < reader->size - reader->pos ? n : reader->size - reader->pos;
+  memcpy(dest, reader->data + reader->pos, n);
+  reader->pos += n;
+  return n;
+}
+
+static void assert_diags_equal(const struct tau_diag_list *want, const struct tau_diag_list *got) {
+  assert_int_equal(got->count, want->count);
+  assert_int_equal(got->error_count, want->error_count);
+  for (size_t i = 0; i < want->count; i++) {
+    assert_int_equal(got->items[i].code, want->items[i].code);
+    assert_int_equal(got->items[i].loc.row, want->items[i].loc.row);
+    assert_int_equal(got->items[i].loc.col, want->items[i].loc.col);
+    assert_int_equal(got->items[i].loc.offset, want->items[i].loc.offset);
+    assert_int_equal(got->items[i].len, want->items[i].len);
+    assert_string_equal(got->items[i].message, want->items[i].message);
+  }
+}
+
+// Streams buf in chunks of chunk_size and checks every token, doc and diagnostic against lexing it whole, returns the
+// capacity the window ended with
+static size_t assert_stream_matches(const char *buf, size_t size, size_t chunk_size, size_t max_read, bool keep_docs) {
+  struct tau_diag_list want_diags;
+  struct tau_diag_list got_diags;
+  tau_diag_list_init(&want_diags);
+  tau_diag_list_init(&got_diags);
+  struct tau_str_pool want_strings;
+  struct tau_str_pool got_strings;
+  tau_str_pool_init(&want_strings);
+  tau_str_pool_init(&got_strings);
+
+  struct chunked_reader reader = {.data = buf, .size = size, .max_read = max_read};
+  struct tau_token_stream stream;
+  tau_token_stream_init(&stream, "stream", chunk_size, chunked_read, &reader);
+  stream.diags = &got_diags;
+  stream.strings = &got_strings;
+  stream.keep_docs = keep_docs;
+
+  struct tau_token want = tau_token_start("stream", buf, size);
+  want.diags = &want_diags;
+  want.strings = &want_strings;
+  want.keep_docs = keep_docs;
+  do {
+    want = tau_token_next(want);
+    struct tau_token got = tau_token_stream_next(&stream);
+    assert_int_equal(got.type, want.type);
+    assert_int_equal(tau_token_stream_offset(&stream, &got), want.buf - buf);
+    assert_int_equal(got.len, want.len);
+    assert_memory_equal(got.buf, want.buf, want.len);
+    assert_int_equal(got.punct, want.punct);
+    assert_int_equal(got.keyword, want.keyword);
+    assert_int_equal(got.num_base, want.num_base);
+    assert_int_equal(got.par_balance, want.par_balance);
+    assert_int_equal(got.sbr_balance, want.sbr_balance);
+    assert_int_equal(got.cbr_balance, want.cbr_balance);
+    assert_int_equal(got.doc_len, want.doc_len);
+    if (want.doc_len > 0) {
+      assert_memory_equal(got.doc, want.doc, want.doc_len);
+    }
+
+    if (want.type == TAU_TOKEN_TYPE_STR_LIT) {
+      assert_int_equal(got.literal.str_value.len, want.literal.str_value.len);
+      assert_memory_equal(got_strings.data + got.literal.str_value.offset,
+                          want_strings.data + want.literal.str_value.offset, want.literal.str_value.len);
+    }
+
+    struct tau_loc got_loc = tau_token_stream_loc(&stream, &got);
+    struct tau_loc want_loc = tau_token_loc(&want);
+    assert_int_equal(got_loc.row, want_loc.row);
+    assert_int_equal(got_loc.col, want_loc.col);
+    assert_int_equal(got_loc.offset, want_loc.offset);
+  } while (want.type != TAU_TOKEN_TYPE_EOF);
+
+  // exhausted streams keep handing out the end of file
+  assert_int_equal(tau_token_stream_next(&stream).type, TAU_TOKEN_TYPE_EOF);
+  assert_diags_equal(&want_diags, &got_diags);
+
+  size_t capacity = stream.window_capacity;
+  tau_token_stream_free(&stream);
+  tau_diag_list_free(&want_diags);
+  tau_diag_list_free(&got_diags);
+  tau_str_pool_free(&want_strings);
+  tau_str_pool_free(&got_strings);
+  return capacity;
+}
+
+static void test_stream_matches_lexer(void **state) {
+  UNUSED(state);
+  const char *buf = STREAM_TEST_SOURCE;
+  size_t size = strlen(buf);
+  for (size_t chunk_size = 1; chunk_size <= 17; chunk_size++) {
+    assert_stream_matches(buf, size, chunk_size, chunk_size, false);
+    assert_stream_matches(buf, size, chunk_size, 3, true);
+  }
+
+  assert_stream_matches(buf, size, 4096, 4096, false);
+  assert_stream_matches("", 0, 1, 1, false);
+  assert_stream_matches("a\0b", 3, 1, 1, false);
+}
+
+static void test_stream_window(void **state) {
+  UNUSED(state);
+  // long input with short tokens keeps the window at two chunks
+  size_t size = 1000000;
+  char *buf = malloc(size);
+  assert_non_null(buf);
+  for (size_t i = 0; i < size; i++) {
+    buf[i] = "let a = 1\n"[i % 10];
+  }
+
+  struct chunked_reader reader = {.data = buf, .size = size, .max_read = 64};
+  struct tau_token_stream stream;
+  tau_token_stream_init(&stream, __func__, 64, chunked_read, &reader);
+  size_t count = 0;
+  while (tau_token_stream_next(&stream).type != TAU_TOKEN_TYPE_EOF) {
+    count++;
+  }
+
+  assert_int_equal(count, size / 10 * 5);
+  assert_int_equal(stream.window_capacity, 2 * 64 + 1);
+  tau_token_stream_free(&stream);
+
+  // a string literal longer than the window grows it to fit
+  memset(buf, 'x', size);
+  buf[0] = '"';
+  buf[size - 1] = '"';
+  reader = (struct chunked_reader){.data = buf, .size = size, .max_read = 64};
+  tau_token_stream_init(&stream, __func__, 64, chunked_read, &reader);
+  struct tau_token token = tau_token_stream_next(&stream);
+  assert_int_equal(token.type, TAU_TOKEN_TYPE_STR_LIT);
+  assert_int_equal(token.len, size);
+  assert_true(stream.window_capacity <= 2 * size + 1);
+  assert_int_equal(tau_token_stream_next(&stream).type, TAU_TOKEN_TYPE_EOF);
+  tau_token_stream_free(&stream);
+  free(buf);
+}
+
+static void test_stream_trivia(void **state) {
+  UNUSED(state);
+  // spaces and comments between tokens are dropped once skipped however long they run, doc comments are kept
+  const char *runs[][3] = {
+      {"a", " ", "b"},
+      {"a /*", "x\xff*", "*/ b"},
+      {"a /*", "\xe2\x82\xac", "*/ b"},
+      {"a //", "x", "\nb"},
+      {"a /*", " \xC0", ""},
+      {"f(a /*", "\n", "*/ )"},
+      {"", " ", "a"},
+      {"/*", "x", "*/\n\nb"},
+  };
+  size_t size = 20000;
+  char *buf = malloc(size + 1);  // lexing the whole buffer looks at the byte after it
+  assert_non_null(buf);
+  for (size_t i = 0; i < sizeof(runs) / sizeof(runs[0]); i++) {
+    size_t head = strlen(runs[i][0]);
+    size_t body = strlen(runs[i][1]);
+    size_t tail = strlen(runs[i][2]);
+    memcpy(buf, runs[i][0], head);
+    size_t len = head;
+    while (len + body + tail <= size) {
+      memcpy(buf + len, runs[i][1], body);
+      len += body;
+    }
+
+    memcpy(buf + len, runs[i][2], tail);
+    len += tail;
+    buf[len] = '\0';
+    assert_true(assert_stream_matches(buf, len, 64, 64, false) <= 4 * 64 + 1);
+    assert_true(assert_stream_matches(buf, len, 64, 7, true) <= 4 * 64 + 1);
+  }
+
+  free(buf);
+}
+
+static void test_stream_file(void **state) {
+  UNUSED(state);
+  FILE *file = tmpfile();
+  assert_non_null(file);
+  fputs("let a = 1\nlet b = a", file);
+  rewind(file);
+
+  struct tau_token_stream stream;
+  tau_token_stream_init(&stream, __func__, 4, tau_token_read_file, file);
+  struct tau_token token;
+  size_t count = 0;
+  do {
+    token = tau_token_stream_next(&stream);
+    count++;
+  } while (token.type != TAU_TOKEN_TYPE_EOF);
+
+  assert_int_equal(count, 10);
+  tau_token_stream_free(&stream);
+  fclose(file);
+}
+
+int main() {
+  UNUSED_TYPE(jmp_buf);
+  UNUSED_TYPE(va_list);
+
+  const struct CMUnitTest tests[] = {
+      cmocka_unit_test(test_stream_matches_lexer),  // same tokens and errors as lexing the whole buffer
+      cmocka_unit_test(test_stream_window),         // the window only grows for tokens that do not fit
+      cmocka_unit_test(test_stream_trivia),         // long spaces and comments are not kept in the window
+      cmocka_unit_test(test_stream_file),           // FILE * reader
+  };
+
+  return cmocka_run_group_tests(tests, NULL, NULL);
+}
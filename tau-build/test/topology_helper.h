@@ -11,7 +11,7 @@
 #include "../src/log.h"
 #include "../src/parser_internal.h"
 #include "../src/parser_match.h"
-#define HANDLED_IDENTIFIER_TO_NODE_TYPE 74
+#define HANDLED_IDENTIFIER_TO_NODE_TYPE 75
 
 static enum tau_node_type identifier_to_node_type(const char *name, size_t len) {
   const char *anode_names[TAU_NODE_COUNT] = {
@@ -89,6 +89,7 @@ static enum tau_node_type identifier_to_node_type(const char *name, size_t len)
       [TAU_NODE_DECL] = "DECL",
       [TAU_NODE_DECLS] = "DECLS",
       [TAU_NODE_COMPILATION_UNIT] = "COMPILATION_UNIT",
+      [TAU_NODE_ERROR] = "ERROR",
   };
   static_assert(HANDLED_IDENTIFIER_TO_NODE_TYPE == TAU_NODE_COUNT);
 
@@ -104,89 +105,83 @@ static enum tau_node_type identifier_to_node_type(const char *name, size_t len)
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-static struct tau_node *parse_topology_expr(struct tau_token *ahead) {
-  struct tau_node *node = NULL;
-  struct tau_node *left = NULL;
-  struct tau_node *right = NULL;
-  struct tau_token node_start = *ahead;
-  if (match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
-    struct tau_node *identifier = parse_atom(ahead);
-    MUST_OR_FAIL(identifier && identifier->type == TAU_NODE_ATOM, ahead, "<topology identifier>");
-    enum tau_node_type target_type = identifier_to_node_type(identifier->token.buf, identifier->token.len);
-    node_free(identifier);
-
-    if (!match(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE)) {
-      left = parse_topology_expr(ahead);
+static node_id_t parse_topology_expr(struct tau_parser *parser) {
+  node_id_t left = NODE_NULL;
+  node_id_t right = NODE_NULL;
+  token_id_t node_start = parser->ahead;
+  if (match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_LPAR, TAU_KEYWORD_NONE)) {
+    node_id_t identifier = parse_atom(parser);
+    MUST_OR_RETURN_NULL(identifier && node_at(parser, identifier)->type == TAU_NODE_ATOM, parser,
+                        "<topology identifier>");
+    size_t identifier_len = 0;
+    const char *identifier_buf = ast_node_text(&parser->ast, identifier, &identifier_len);
+    enum tau_node_type target_type = identifier_to_node_type(identifier_buf, identifier_len);
+
+    if (!match(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE)) {
+      left = parse_topology_expr(parser);
     }
 
-    if (!match(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE)) {
-      right = parse_topology_expr(ahead);
+    if (!match(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE)) {
+      right = parse_topology_expr(parser);
     }
 
-    node = node_new_binary(target_type, node_start, left, right);
-    MUST_OR_FAIL(match_and_consume(ahead, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), ahead,
-                 "<closing topology `)`>");
+    node_id_t node = node_new_binary(parser, target_type, node_start, left, right);
+    MUST_OR_RETURN_NULL(match_and_consume(parser, TAU_TOKEN_TYPE_PUNCT, TAU_PUNCT_RPAR, TAU_KEYWORD_NONE), parser,
+                        "<closing topology `)`>");
     return node;
   }
 
-  struct tau_node *atomic = parse_atom(ahead);
-  MUST_OR_FAIL(atomic, ahead, "<atomic topology expression>");
+  node_id_t atomic = parse_atom(parser);
+  MUST_OR_RETURN_NULL(atomic, parser, "<atomic topology expression>");
   return atomic;
-handle_fail:
-  if (node != NULL) {
-    node_free(node);
-  }
-
-  if (left != NULL) {
-    node_free(left);
-  }
-
-  if (right != NULL) {
-    node_free(right);
-  }
-
-  return NULL;
 }
 
 // NOLINTNEXTLINE(misc-no-recursion)
-static void assert_nodes_equal(struct tau_node *given, struct tau_node *expected) {
-  assert(given != NULL && "assert_nodes_equal: given cannot be null");
-  assert(expected != NULL && "assert_nodes_equal: expected cannot be null");
+static void assert_nodes_equal(const struct tau_ast *given_ast, node_id_t given, const struct tau_ast *expected_ast,
+                               node_id_t expected) {
+  assert(given != NODE_NULL && "assert_nodes_equal: given cannot be null");
+  assert(expected != NODE_NULL && "assert_nodes_equal: expected cannot be null");
 
-  assert_int_equal(given->type, expected->type);
-  if (given->type == TAU_NODE_ATOM) {
+  assert_int_equal(ast_node_type(given_ast, given), ast_node_type(expected_ast, expected));
+  if (ast_node_type(given_ast, given) == TAU_NODE_ATOM) {
     char given_str[250] = {0};
     char expected_str[250] = {0};
-    strncpy(given_str, given->token.buf, given->token.len);
-    strncpy(expected_str, expected->token.buf, expected->token.len);
+    size_t given_len = 0;
+    size_t expected_len = 0;
+    const char *given_buf = ast_node_text(given_ast, given, &given_len);
+    const char *expected_buf = ast_node_text(expected_ast, expected, &expected_len);
+    strncpy(given_str, given_buf, given_len);
+    strncpy(expected_str, expected_buf, expected_len);
     assert_string_equal(given_str, expected_str);
   }
 
-  if (expected->left != NULL) {
-    assert_non_null(given->left);
-    assert_nodes_equal(given->left, expected->left);
+  if (ast_node_left(expected_ast, expected) != NODE_NULL) {
+    assert_int_not_equal(ast_node_left(given_ast, given), NODE_NULL);
+    assert_nodes_equal(given_ast, ast_node_left(given_ast, given), expected_ast, ast_node_left(expected_ast, expected));
   }
 
-  if (expected->right != NULL) {
-    assert_non_null(given->right);
-    assert_nodes_equal(given->right, expected->right);
+  if (ast_node_right(expected_ast, expected) != NODE_NULL) {
+    assert_int_not_equal(ast_node_right(given_ast, given), NODE_NULL);
+    assert_nodes_equal(given_ast, ast_node_right(given_ast, given), expected_ast,
+                       ast_node_right(expected_ast, expected));
   }
 }
 
-static void assert_node_topology(struct tau_node *given_node, const char *expected_str) {
-  assert(given_node != NULL && "assert_node_topology: given_node cannot be null");
+static void assert_node_topology(const struct tau_ast *given_ast, node_id_t given_node, const char *expected_str) {
+  assert(given_ast != NULL && "assert_node_topology: given_ast cannot be null");
+  assert(given_node != NODE_NULL && "assert_node_topology: given_node cannot be null");
   assert(expected_str != NULL && "assert_node_topology: expected_str cannot be null");
 
   size_t expected_len = strlen(expected_str);
   char *topology_name = calloc(expected_len + 1, sizeof(char));
   strcpy(topology_name, expected_str);
-  struct tau_token start = tau_token_start(topology_name, expected_str, expected_len);
-  struct tau_token head = tau_token_next(start);
-  struct tau_node *expected_node = parse_topology_expr(&head);
-  assert(expected_node != NULL && "assert_node_topology: could not parse expected_str topology program");
-  assert_nodes_equal(given_node, expected_node);
+  struct tau_parser topology_parser;
+  parser_init(&topology_parser, topology_name, expected_str, expected_len);
+  node_id_t expected_node = parse_topology_expr(&topology_parser);
+  assert(expected_node != NODE_NULL && "assert_node_topology: could not parse expected_str topology program");
+  assert_nodes_equal(given_ast, given_node, &topology_parser.ast, expected_node);
+  parser_free(&topology_parser);
   free(topology_name);
-  node_free(expected_node);
 }
 
 #endif  // TAU_TOPOLOGY_HELPER_H
\ No newline at end of file
@@ -10,6 +10,8 @@
 
 #include "../src/utf8.h"
 
+#include <string.h>
+
 #include "../src/common.h"
 
 static void test_tau_enc_cp_to_bytes(void **state) {
@@ -46,105 +48,157 @@ static void test_tau_dec_bytes_to_cp(void **state) {
   assert_int_equal(codepoint, 0x1F60C);
 }
 
+// Decodes src and checks that validation agrees: well formed sequences decode to their code point, anything else to
+// the replacement character one byte at a time
+static void assert_decodes(const char *src, size_t len, uint32_t want) {
+  uint32_t codepoint = 0;
+  uint8_t want_len = want == UNICODE_REPLACEMENT_CHARACTER ? 1 : (uint8_t)len;
+  assert_int_equal(tau_dec_bytes_to_cp(src, &codepoint), want_len);
+  assert_int_equal(codepoint, want);
+  assert_int_equal(tau_utf8_validate(src, len), want == UNICODE_REPLACEMENT_CHARACTER ? 0 : len);
+}
+
 static void test_boundary_condition(void **state) {
   UNUSED(state);
   uint32_t codepoint = 0L;
 
   // 2.1 First possible sequence of a certain length
-  // 2.1.1 1 byte (U-00000000):
+  // 2.1.1 1 byte (U-00000000), NUL ends the buffer and is never decoded
   assert_int_equal(tau_dec_bytes_to_cp("\x00\0\0\0", &codepoint), 1);
   assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
 
-  // 2.1.2 2 bytes (U-00000080):
-  assert_int_equal(tau_dec_bytes_to_cp("\xC1\x80\0\0", &codepoint), 2);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  // 2.1.2 2 bytes (U-00000080), C1 80 is its overlong form
+  assert_decodes("\xC2\x80", 2, 0x80);
+  assert_decodes("\xC1\x80", 2, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.1.3 3 bytes (U-00000800):
-  assert_int_equal(tau_dec_bytes_to_cp("\xE0\xA0\x80\0", &codepoint), 3);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xE0\xA0\x80", 3, 0x800);
 
   // 2.1.4 4 bytes (U-00010000):
-  assert_int_equal(tau_dec_bytes_to_cp("\xF0\x90\x80\x80", &codepoint), 4);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF0\x90\x80\x80", 4, 0x10000);
 
   // 2.1.5 5 bytes (U-00200000):
-  assert_int_equal(tau_dec_bytes_to_cp("\xF8\x88\x80\x80\x80", &codepoint), 5);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF8\x88\x80\x80\x80", 5, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.1.6 6 bytes (U-04000000):
-  assert_int_equal(tau_dec_bytes_to_cp("\xFC\x84\x80\x80\x80\x80", &codepoint), 6);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xFC\x84\x80\x80\x80\x80", 6, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.2 Last possible sequence of a certain length
   // 2.2.1 1 byte  (U-0000007F):
-  assert_int_equal(tau_dec_bytes_to_cp("\x7F\0\0", &codepoint), 1);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\x7F", 1, 0x7F);
 
   // 2.2.2  2 bytes (U-000007FF):
-  assert_int_equal(tau_dec_bytes_to_cp("\xDF\xBF\0", &codepoint), 2);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xDF\xBF", 2, 0x7FF);
 
   // 2.2.3  3 bytes (U-0000FFFF):
-  assert_int_equal(tau_dec_bytes_to_cp("\xEF\xBF\xBF", &codepoint), 3);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xEF\xBF\xBF", 3, 0xFFFF);
 
   // 2.2.4  4 bytes (U-001FFFFF):
-  assert_int_equal(tau_dec_bytes_to_cp("\xF7\xBF\xBF\xBF", &codepoint), 4);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF7\xBF\xBF\xBF", 4, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.2.5  5 bytes (U-03FFFFFF):
-  assert_int_equal(tau_dec_bytes_to_cp("\xFB\xBF\xBF\xBF\xBF", &codepoint), 5);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xFB\xBF\xBF\xBF\xBF", 5, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.2.6  6 bytes (U-7FFFFFFF):
-  assert_int_equal(tau_dec_bytes_to_cp("\xFD\xBF\xBF\xBF\xBF\xBF", &codepoint), 6);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xFD\xBF\xBF\xBF\xBF\xBF", 6, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.3 Other boundary conditions
   // 2.3.1  U-0000D7FF = ed 9f bf
-  assert_int_equal(tau_dec_bytes_to_cp("\xED\x9F\xBF", &codepoint), 3);
-  assert_int_equal(codepoint, 0xD7FF);  // NOTE(cedmundo): Not really searching for non-defined unicode characters
-  // assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xED\x9F\xBF", 3, 0xD7FF);
 
   // 2.3.2  U-0000E000 = ee 80 80
-  assert_int_equal(tau_dec_bytes_to_cp("\xEE\x80\x80", &codepoint), 3);
-  assert_int_equal(codepoint, 0xE000);  // NOTE(cedmundo): Not really searching for non-defined unicode characters
-  // assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xEE\x80\x80", 3, 0xE000);
 
-  // 2.3.3  U-0000FFFD = ef bf bd
+  // 2.3.3  U-0000FFFD = ef bf bd, decoded as a sequence of 3 bytes
   assert_int_equal(tau_dec_bytes_to_cp("\xEF\xBF\xBD", &codepoint), 3);
   assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
 
   // 2.3.4  U-0010FFFF = f4 8f bf bf
-  assert_int_equal(tau_dec_bytes_to_cp("\xF4\x8F\xBF\xBF", &codepoint), 4);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF4\x8F\xBF\xBF", 4, 0x10FFFF);
 
   // 2.3.5  U-00110000 = f4 90 80 80
-  assert_int_equal(tau_dec_bytes_to_cp("\xF4\x90\x80\x80", &codepoint), 4);
-  assert_int_equal(codepoint, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF4\x90\x80\x80", 4, UNICODE_REPLACEMENT_CHARACTER);
 }
 
 static void test_malformed_sequences(void **state) {
   UNUSED(state);
   // 3.1 Unexpected continuation bytes
+  assert_decodes("\x80", 1, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xBF", 1, UNICODE_REPLACEMENT_CHARACTER);
+  assert_int_equal(tau_utf8_validate("a\xC3\xA9\x80", 4), 3);
+
   // 3.2 Lonely start characters
+  assert_decodes("\xC3 ", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xE2 ", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF0 ", 2, UNICODE_REPLACEMENT_CHARACTER);
+
   // 3.3 Sequences with last continuation byte missing
+  assert_decodes("\xE2\x82", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF0\x9F\x98", 3, UNICODE_REPLACEMENT_CHARACTER);
+  assert_int_equal(tau_utf8_validate("\xE2\x82\xAC", 2), 0);
+
   // 3.4 Concatenation of incomplete sequences
+  assert_int_equal(tau_utf8_validate("ab\xC3\xE2\x82\xF0\x9F\x98", 8), 2);
+
   // 3.5 Impossible bytes
+  assert_decodes("\xFE", 1, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xFF", 1, UNICODE_REPLACEMENT_CHARACTER);
 }
 
 static void test_overlong_sequences(void **state) {
   UNUSED(state);
   // 4.1 Examples of an overlong ASCII character
+  assert_decodes("\xC0\xAF", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xE0\x80\xAF", 3, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF0\x80\x80\xAF", 4, UNICODE_REPLACEMENT_CHARACTER);
+
   // 4.2 Maximum overlong sequences
+  assert_decodes("\xC1\xBF", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xE0\x9F\xBF", 3, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xF0\x8F\xBF\xBF", 4, UNICODE_REPLACEMENT_CHARACTER);
+
   // 4.3 Overlong representation of NUL character
+  assert_decodes("\xC0\x80", 2, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xE0\x80\x80", 3, UNICODE_REPLACEMENT_CHARACTER);
 }
 
 static void test_illegal_code_positions(void **state) {
   UNUSED(state);
   // 5.1 Single UTF-16 surrogates
+  assert_decodes("\xED\xA0\x80", 3, UNICODE_REPLACEMENT_CHARACTER);
+  assert_decodes("\xED\xBF\xBF", 3, UNICODE_REPLACEMENT_CHARACTER);
+
   // 5.2 Paired UTF-16 surrogates
-  // 5.3 Non-character code positions
+  assert_int_equal(tau_utf8_validate("\xED\xA0\x80\xED\xB0\x80", 6), 0);
+
+  // 5.3 Non-character code positions are well formed
+  assert_decodes("\xEF\xBF\xBE", 3, 0xFFFE);
+  assert_decodes("\xEF\xB7\x90", 3, 0xFDD0);
+}
+
+static void test_bulk_decode(void **state) {
+  UNUSED(state);
+  // long enough for the eight byte ASCII steps, with sequences of every length in between
+  const char *text = "module caf\xC3\xA9 // \xE2\x82\xAC and \xF0\x9F\x98\x8C, then plain ASCII again";
+  size_t len = strlen(text);
+  assert_int_equal(tau_utf8_validate(text, len), len);
+
+  uint32_t decoded[64];
+  size_t count = tau_utf8_decode(text, len, decoded);
+  assert_int_equal(count, tau_utf8_count_codepoints(text, len));
+  assert_int_equal(count, len - 1 - 2 - 3);
+  assert_int_equal(decoded[0], 'm');
+  assert_int_equal(decoded[10], 0xE9);
+  assert_int_equal(decoded[15], 0x20AC);
+  assert_int_equal(decoded[21], 0x1F60C);
+  assert_int_equal(decoded[count - 1], 'n');
+
+  // malformed bytes come out as replacement characters and decoding carries on
+  count = tau_utf8_decode("a\xFF\xE2\x82z", 5, decoded);
+  assert_int_equal(count, 5);
+  assert_int_equal(decoded[1], UNICODE_REPLACEMENT_CHARACTER);
+  assert_int_equal(decoded[2], UNICODE_REPLACEMENT_CHARACTER);
+  assert_int_equal(decoded[4], 'z');
 }
 
 int main() {
@@ -154,6 +208,7 @@ int main() {
       cmocka_unit_test(test_tau_enc_cp_to_bytes), cmocka_unit_test(test_tau_dec_bytes_to_cp),
       cmocka_unit_test(test_boundary_condition),  cmocka_unit_test(test_malformed_sequences),
       cmocka_unit_test(test_overlong_sequences),  cmocka_unit_test(test_illegal_code_positions),
+      cmocka_unit_test(test_bulk_decode),
   };
 
   return cmocka_run_group_tests(tests, NULL, NULL);
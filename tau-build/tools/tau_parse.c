@@ -0,0 +1,90 @@
+//
+// Created on 10/17/26.
+//
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tau/driver.h>
+
+#define TAU_PARSE_DEFAULT_DIAGNOSTIC_LIMIT 1000
+
+static void usage(const char *argv0) {
+  fprintf(stderr, "usage: %s [-j threads] [-f text|json] [-l limit] [-c dir] [-s] file...\n", argv0);
+  fprintf(stderr, "  -j threads  number of parser threads, 0 for one per core (default 0)\n");
+  fprintf(stderr, "  -f format   diagnostics format, text or json (default text)\n");
+  fprintf(stderr, "  -l limit    diagnostics kept per file once repeats are folded, 0 for no limit (default %d)\n",
+          TAU_PARSE_DEFAULT_DIAGNOSTIC_LIMIT);
+  fprintf(stderr, "  -c dir      parse cache directory, files parsed before without errors are not parsed again\n");
+  fprintf(stderr, "  -s          print throughput stats once done\n");
+}
+
+int main(int argc, char **argv) {
+  struct tau_driver_options options = {
+      .thread_count = 0,
+      .diagnostic_limit = TAU_PARSE_DEFAULT_DIAGNOSTIC_LIMIT,
+      .fold_diagnostics = true,
+  };
+  enum tau_parse_format format = TAU_PARSE_FORMAT_TEXT;
+  bool print_stats = false;
+  int first_path = 1;
+  for (; first_path < argc && argv[first_path][0] == '-'; first_path++) {
+    const char *arg = argv[first_path];
+    if (strcmp(arg, "-j") == 0 && first_path + 1 < argc) {
+      char *end = NULL;
+      options.thread_count = strtoul(argv[++first_path], &end, 10);
+      if (*end != '\0') {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (strcmp(arg, "-f") == 0 && first_path + 1 < argc) {
+      const char *name = argv[++first_path];
+      if (strcmp(name, "text") != 0 && strcmp(name, "json") != 0) {
+        usage(argv[0]);
+        return 2;
+      }
+
+      format = strcmp(name, "json") == 0 ? TAU_PARSE_FORMAT_JSON : TAU_PARSE_FORMAT_TEXT;
+    } else if (strcmp(arg, "-l") == 0 && first_path + 1 < argc) {
+      char *end = NULL;
+      options.diagnostic_limit = strtoul(argv[++first_path], &end, 10);
+      if (*end != '\0') {
+        usage(argv[0]);
+        return 2;
+      }
+    } else if (strcmp(arg, "-c") == 0 && first_path + 1 < argc) {
+      options.cache_dir = argv[++first_path];
+    } else if (strcmp(arg, "-s") == 0) {
+      print_stats = true;
+    } else if (strcmp(arg, "--") == 0) {
+      first_path++;
+      break;
+    } else {
+      usage(argv[0]);
+      return 2;
+    }
+  }
+
+  if (first_path >= argc) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  struct tau_driver_result *result =
+      tau_driver_parse_files((const char *const *)&argv[first_path], (size_t)(argc - first_path), &options);
+  // the whole report reaches the stream in a single write
+  tau_driver_result_write_diagnostics(result, format, format == TAU_PARSE_FORMAT_JSON ? stdout : stderr);
+
+  if (print_stats) {
+    struct tau_driver_stats stats = tau_driver_result_stats(result);
+    double seconds = (double)stats.wall_ns / 1e9;
+    printf("%zu files, %zu bytes, %zu tokens, %zu nodes, %zu errors\n", tau_driver_result_module_count(result),
+           stats.byte_count, stats.token_count, stats.node_count, stats.error_count);
+    printf("%zu threads, %zu steals, %zu cached, %.3f ms, %.2f MB/s\n", stats.thread_count, stats.steal_count,
+           stats.cache_hit_count, seconds * 1e3, seconds > 0 ? (double)stats.byte_count / seconds / 1e6 : 0.0);
+  }
+
+  int status = tau_driver_result_ok(result) ? 0 : 1;
+  tau_driver_result_free(result);
+  return status;
+}